@@ -0,0 +1,155 @@
+#include "AddOnPreferences.hpp"
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace AddOnPreferences {
+
+static const Int32  PreferencesVersion = 1;
+static const UInt32 PreferencesMagic = 0x46504C48; // "HLPF"
+
+typedef std::map<std::string, std::string> SectionMap;
+
+// ---------------- Сериализация ----------------
+void PutUInt32 (std::string& out, UInt32 value)
+{
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void PutUInt64 (std::string& out, UInt64 value)
+{
+    PutUInt32(out, static_cast<UInt32>(value & 0xFFFFFFFFu));
+    PutUInt32(out, static_cast<UInt32>(value >> 32));
+}
+
+void PutBytes (std::string& out, const std::string& value)
+{
+    PutUInt32(out, static_cast<UInt32>(value.size()));
+    out.append(value);
+}
+
+void PutString (std::string& out, const GS::UniString& value)
+{
+    PutBytes(out, std::string(value.ToCStr(0, MaxUSize, CC_UTF8).Get()));
+}
+
+bool Reader::GetUInt32 (UInt32& value)
+{
+    if (data.size() - position < 4) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<UInt32>(static_cast<unsigned char>(data[position + i])) << (8 * i);
+    }
+    position += 4;
+    return true;
+}
+
+bool Reader::GetUInt64 (UInt64& value)
+{
+    UInt32 low = 0;
+    UInt32 high = 0;
+    if (!GetUInt32(low) || !GetUInt32(high)) {
+        return false;
+    }
+    value = (static_cast<UInt64>(high) << 32) | low;
+    return true;
+}
+
+bool Reader::GetBytes (std::string& value)
+{
+    UInt32 length = 0;
+    if (!GetUInt32(length) || data.size() - position < length) {
+        return false;
+    }
+    value.assign(data, position, length);
+    position += length;
+    return true;
+}
+
+bool Reader::GetString (GS::UniString& value)
+{
+    std::string utf8;
+    if (!GetBytes(utf8)) {
+        return false;
+    }
+    value = GS::UniString(utf8.c_str(), CC_UTF8);
+    return true;
+}
+
+// ---------------- Секции ----------------
+static SectionMap LoadSections ()
+{
+    SectionMap sections;
+
+    Int32 version = 0;
+    GSSize size = 0;
+    if (ACAPI_AddOnIntegration_GetPreferences(&version, &size, nullptr) != NoError || size <= 0 || version != PreferencesVersion) {
+        return sections;
+    }
+
+    std::vector<char> buffer(static_cast<size_t>(size));
+    if (ACAPI_AddOnIntegration_GetPreferences(&version, &size, buffer.data()) != NoError) {
+        return sections;
+    }
+
+    const std::string data(buffer.data(), buffer.size());
+    Reader reader(data);
+    UInt32 magic = 0;
+    UInt32 count = 0;
+    if (!reader.GetUInt32(magic) || magic != PreferencesMagic || !reader.GetUInt32(count)) {
+        return sections;
+    }
+    for (UInt32 i = 0; i < count; ++i) {
+        std::string tag;
+        std::string value;
+        if (!reader.GetBytes(tag) || !reader.GetBytes(value)) {
+            break;
+        }
+        sections[tag] = value;
+    }
+    return sections;
+}
+
+bool ReadSection (const char* tag, std::string& data)
+{
+    const SectionMap sections = LoadSections();
+    const auto found = sections.find(tag);
+    if (found == sections.end()) {
+        return false;
+    }
+    data = found->second;
+    return true;
+}
+
+bool WriteSection (const char* tag, const std::string& data)
+{
+    SectionMap sections = LoadSections();
+    if (data.empty()) {
+        sections.erase(tag);
+    } else {
+        sections[tag] = data;
+    }
+
+    std::string blob;
+    PutUInt32(blob, PreferencesMagic);
+    PutUInt32(blob, static_cast<UInt32>(sections.size()));
+    for (const auto& section : sections) {
+        PutBytes(blob, section.first);
+        PutBytes(blob, section.second);
+    }
+
+    const GSErrCode err = ACAPI_AddOnIntegration_SetPreferences(PreferencesVersion, static_cast<GSSize>(blob.size()), blob.data());
+#ifdef DEBUG_UI_LOGS
+    if (err != NoError) {
+        ACAPI_WriteReport("[Prefs] Не удалось сохранить секцию %s: %d", false, tag, (int)err);
+    }
+#endif
+    return err == NoError;
+}
+
+} // namespace AddOnPreferences
@@ -0,0 +1,45 @@
+#ifndef ADDONPREFERENCES_HPP
+#define ADDONPREFERENCES_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+#include <string>
+
+// Настройки аддона (ACAPI_AddOnIntegration_Get/SetPreferences) — один блок байтов на аддон.
+// Делим его на именованные секции, чтобы разные модули не затирали данные друг друга.
+namespace AddOnPreferences {
+
+    // Прочитать секцию; false — секции нет
+    bool ReadSection (const char* tag, std::string& data);
+
+    // Записать секцию (пустые данные — удалить) и сохранить настройки
+    bool WriteSection (const char* tag, const std::string& data);
+
+    // ---------------- Простая бинарная сериализация ----------------
+    void PutUInt32 (std::string& out, UInt32 value);
+    void PutUInt64 (std::string& out, UInt64 value);
+    void PutString (std::string& out, const GS::UniString& value);
+    void PutBytes (std::string& out, const std::string& value);
+
+    class Reader {
+    public:
+        explicit Reader (const std::string& data) : data(data) {}
+
+        bool GetUInt32 (UInt32& value);
+        bool GetUInt64 (UInt64& value);
+        bool GetString (GS::UniString& value);
+        bool GetBytes (std::string& value);
+        bool IsAtEnd () const { return position == data.size(); }
+        // Сколько байтов осталось — проверить длину массива до выделения памяти под него
+        size_t GetRemaining () const { return data.size() - position; }
+
+    private:
+        const std::string& data;
+        size_t             position = 0;
+    };
+
+} // namespace AddOnPreferences
+
+#endif // ADDONPREFERENCES_HPP
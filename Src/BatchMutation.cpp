@@ -0,0 +1,207 @@
+#include "BatchMutation.hpp"
+
+#include <chrono>
+
+namespace BatchMutation {
+
+static const double ChunkSeconds = 0.1;      // дольше — окно прогресса и «Отмена» отзываются с задержкой
+
+using Clock = std::chrono::steady_clock;
+
+struct RunState {
+    bool                    running = false;
+    bool                    canceled = false;
+    bool                    windowOpen = false;
+    GS::UniString           title;
+    GS::UniString           phaseTitle;
+    UInt32                  phaseTotal = 0;
+    UInt32                  phaseDone = 0;
+    UInt32                  steps = 0;
+    UInt32                  chunks = 0;
+    GS::Array<ElementError> errors;
+    GS::Array<std::function<void ()>> commitActions;
+    Clock::time_point       chunkStarted;
+};
+
+static RunState state;
+
+static double SecondsSince(Clock::time_point started)
+{
+    return std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+// ---------------- Окно прогресса ----------------
+static void ShowPhase()
+{
+    Int32 maxValue = static_cast<Int32>(state.phaseTotal);
+    bool showPercent = state.phaseTotal > 0;
+    ACAPI_ProcessWindow_SetNextProcessPhase(&state.phaseTitle, &maxValue, &showPercent);
+    Int32 value = static_cast<Int32>(state.phaseDone);
+    ACAPI_ProcessWindow_SetProcessValue(&value);
+}
+
+static void OpenWindow()
+{
+    Int32 phaseCount = 1;
+    if (ACAPI_ProcessWindow_InitProcessWindow(&state.title, &phaseCount) == NoError) {
+        state.windowOpen = true;
+        ShowPhase();
+    }
+}
+
+static void CloseWindow()
+{
+    if (state.windowOpen) {
+        ACAPI_ProcessWindow_CloseProcessWindow();
+        state.windowOpen = false;
+    }
+}
+
+// Конец отрезка: прогресс и проверка отмены
+static void EndChunk()
+{
+    ++state.chunks;
+    if (!state.windowOpen) {
+        OpenWindow();
+    } else {
+        Int32 value = static_cast<Int32>(state.phaseDone);
+        ACAPI_ProcessWindow_SetProcessValue(&value);
+    }
+    if (state.windowOpen && ACAPI_ProcessWindow_IsProcessCanceled()) {
+        state.canceled = true;
+    }
+    state.chunkStarted = Clock::now();
+}
+
+// ---------------- Работа ----------------
+void BeginPhase(const GS::UniString& title, UInt32 total)
+{
+    if (!state.running) {
+        return;
+    }
+    state.phaseTitle = title;
+    state.phaseTotal = total;
+    state.phaseDone = 0;
+    if (state.windowOpen) {
+        ShowPhase();
+    }
+}
+
+bool Step(UInt32 count)
+{
+    if (!state.running) {
+        return true;
+    }
+    state.steps += count;
+    state.phaseDone += count;
+    if (!state.canceled && SecondsSince(state.chunkStarted) >= ChunkSeconds) {
+        EndChunk();
+    }
+    return !state.canceled;
+}
+
+void Fail(const API_Guid& guid, GSErrCode code)
+{
+    if (!state.running) {
+        return;
+    }
+    ElementError error;
+    error.guid = guid;
+    error.code = code;
+    state.errors.Push(error);
+}
+
+void OnCommit(const std::function<void ()>& action)
+{
+    if (!state.running) {
+        action();
+        return;
+    }
+    state.commitActions.Push(action);
+}
+
+bool IsRunning()
+{
+    return state.running;
+}
+
+// Вложенный Run: та же команда и то же окно; в отчёт — только то, что добавила эта работа.
+// Свой этап на время работы, затем окно возвращается к этапу внешнего Run
+static Report RunNested(const GS::UniString& title, UInt32 total, const Work& work)
+{
+    const auto started = Clock::now();
+    const UInt32 stepsBefore = state.steps;
+    const UIndex errorsBefore = state.errors.GetSize();
+    const GS::UniString outerTitle = state.phaseTitle;
+    const UInt32 outerTotal = state.phaseTotal;
+    const UInt32 outerDone = state.phaseDone;
+    BeginPhase(title, total);
+    const GSErrCode err = work();
+
+    state.phaseTitle = outerTitle;
+    state.phaseTotal = outerTotal;
+    state.phaseDone = outerDone;
+    if (state.windowOpen) {
+        ShowPhase();
+    }
+
+    Report report;
+    report.canceled = state.canceled;
+    report.success = (err == NoError && !state.canceled);
+    report.steps = state.steps - stepsBefore;
+    for (UIndex i = errorsBefore; i < state.errors.GetSize(); ++i) {
+        report.errors.Push(state.errors[i]);
+    }
+    report.seconds = SecondsSince(started);
+    return report;
+}
+
+Report Run(const GS::UniString& undoName, const GS::UniString& title, UInt32 total, const Work& work)
+{
+    if (state.running) {
+        return RunNested(title, total, work);
+    }
+
+    const auto started = Clock::now();
+    state = RunState();
+    state.running = true;
+    state.title = title;
+    state.phaseTitle = title;
+    state.phaseTotal = total;
+    state.chunkStarted = started;
+
+    GSErrCode workErr = NoError;
+    const GSErrCode err = ACAPI_CallUndoableCommand(undoName, [&]() -> GSErrCode {
+        workErr = work();
+        // Ошибка из команды — Archicad откатывает всё, что работа успела изменить
+        if (state.canceled) {
+            return APIERR_CANCEL;
+        }
+        return workErr;
+    });
+    CloseWindow();
+
+    Report report;
+    report.canceled = state.canceled;
+    report.success = (err == NoError && workErr == NoError && !state.canceled);
+    report.steps = state.steps;
+    report.chunks = state.chunks + 1;
+    report.errors = state.errors;
+    report.seconds = SecondsSince(started);
+    const GS::Array<std::function<void ()>> commitActions = state.commitActions;
+    state = RunState();
+    if (report.success) {
+        for (const std::function<void ()>& action : commitActions) {
+            action();
+        }
+    }
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[BatchMutation] %s: шагов %u, отрезков %u, ошибок %u, %s, %.3f с", false,
+        undoName.ToCStr().Get(), (unsigned)report.steps, (unsigned)report.chunks, (unsigned)report.errors.GetSize(),
+        report.canceled ? "отменено" : (report.success ? "сохранено" : "откатано"), report.seconds);
+#endif
+    return report;
+}
+
+} // namespace BatchMutation
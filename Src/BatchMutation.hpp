@@ -0,0 +1,59 @@
+#ifndef BATCHMUTATION_HPP
+#define BATCHMUTATION_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+#include <functional>
+
+// Общая обвязка для пакетных изменений модели (ID, слои, видимость).
+// Работа выполняется одной Undo-командой и отмечает шаги через Step. Раз в ChunkSeconds
+// (а не на каждом элементе) обновляется окно прогресса Archicad и проверяется «Отмена»;
+// окно открывается, только если работа длится дольше одного такого отрезка.
+// Отмена или ошибка работы — команда возвращает ошибку и Archicad откатывает её целиком,
+// так что модель не остаётся изменённой наполовину. Ошибки по элементам копятся в отчёте.
+// Run внутри работы другого Run выполняется в составе внешней команды: общий прогресс,
+// общая отмена и общий откат; после него окно возвращается к этапу внешней работы.
+namespace BatchMutation {
+
+    struct ElementError {
+        API_Guid  guid = APINULLGuid;
+        GSErrCode code = NoError;
+    };
+
+    struct Report {
+        bool                    success = false;    // команда выполнена и сохранена
+        bool                    canceled = false;   // отменено пользователем, изменения откатаны
+        UInt32                  steps = 0;          // выполнено шагов
+        UInt32                  chunks = 0;         // отрезков между проверками отмены
+        GS::Array<ElementError> errors;
+        double                  seconds = 0.0;
+    };
+
+    using Work = std::function<GSErrCode ()>;
+
+    // Выполнить work одной Undo-командой undoName; title — заголовок окна прогресса,
+    // total — ожидаемое число шагов (для процентов)
+    Report Run(const GS::UniString& undoName, const GS::UniString& title, UInt32 total, const Work& work);
+
+    // Начать этап работы: подзаголовок окна прогресса и число его шагов
+    void BeginPhase(const GS::UniString& title, UInt32 total);
+
+    // Отметить выполненные шаги. false — пользователь нажал «Отмена»: работа должна
+    // остановиться и вернуть APIERR_CANCEL. Вне Run всегда true
+    bool Step(UInt32 count = 1);
+
+    // Ошибка по элементу — в отчёт текущего Run (вне Run ничего не делает)
+    void Fail(const API_Guid& guid, GSErrCode code);
+
+    // Действие после сохранения команды (обновить кэши аддона); при откате не выполняется.
+    // Вне Run выполняется сразу
+    void OnCommit(const std::function<void ()>& action);
+
+    // Идёт ли сейчас Run
+    bool IsRunning();
+
+} // namespace BatchMutation
+
+#endif // BATCHMUTATION_HPP
@@ -15,11 +15,23 @@ extern "C" {
 
 #include "HelpPalette.hpp"
 #include "LayerHelper.hpp"
+#include "LayerPlan.hpp"
+#include "LayerRules.hpp"
+#include "LayerUsage.hpp"
+#include "IdRenumber.hpp"
+#include "BatchMutation.hpp"
+#include "ElementIdIndex.hpp"
 #include "IdLayersPalette.hpp"
 #include "SelectionPropertyHelper.hpp"
 #include "SelectionMetricsHelper.hpp"
 #include "SelectionDetailsPalette.hpp"
+#include "SelectionGroupHelper.hpp"
+#include "PropertyValueLoader.hpp"
+#include "SendXlsHelper.hpp"
+#include "ExportTemplates.hpp"
+#include "SelectionSets.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <cstring>
@@ -87,6 +99,43 @@ static GS::Array<GS::UniString> GetStringArrayFromJavaScriptVariable(GS::Ref<JS:
 	return result;
 }
 
+// --- Extract array of GUIDs (strings) from JS::Base, skipping invalid ones ---
+static GS::Array<API_Guid> GetGuidArrayFromJavaScriptVariable(GS::Ref<JS::Base> jsVariable)
+{
+	GS::Array<API_Guid> guids;
+	for (const GS::UniString& guidStr : GetStringArrayFromJavaScriptVariable(jsVariable)) {
+		API_Guid guid = APIGuidFromString(guidStr.ToCStr().Get());
+		if (guid != APINULLGuid) {
+			guids.Push(guid);
+		}
+	}
+	return guids;
+}
+
+// --- Extract bool from JS::Base (supports true / 1 / "1" / "true") ---
+static bool GetBoolFromJs(GS::Ref<JS::Base> p, bool def = false)
+{
+	if (GS::Ref<JS::Value> v = GS::DynamicCast<JS::Value>(p)) {
+		const auto t = v->GetType();
+		if (t == JS::Value::BOOL)    return v->GetBool();
+		if (t == JS::Value::INTEGER) return v->GetInteger() != 0;
+		if (t == JS::Value::STRING)  return v->GetString() == "1" || v->GetString() == "true";
+	}
+	return def;
+}
+
+// --- Parse array of column tokens ("type" / "id" / "layer" / property GUID) ---
+static GS::Array<SelectionGroupHelper::Column> GetColumnsFromJs(GS::Ref<JS::Base> p)
+{
+	GS::Array<SelectionGroupHelper::Column> columns;
+	for (const GS::UniString& token : GetStringArrayFromJavaScriptVariable(p)) {
+		SelectionGroupHelper::Column column;
+		if (SelectionGroupHelper::ParseColumn(token, column))
+			columns.Push(column);
+	}
+	return columns;
+}
+
 template<class Type>
 static GS::Ref<JS::Base> ConvertToJavaScriptVariable(const Type& cppVariable)
 {
@@ -104,6 +153,169 @@ GS::Ref<JS::Base> ConvertToJavaScriptVariable(const SelectionHelper::ElementInfo
 	return js;
 }
 
+template<>
+GS::Ref<JS::Base> ConvertToJavaScriptVariable(const PropertyValueLoader::CellValue& cell)
+{
+	GS::Ref<JS::Array> js = new JS::Array();
+	js->AddItem(ConvertToJavaScriptVariable(APIGuidToString(cell.elemGuid)));
+	js->AddItem(ConvertToJavaScriptVariable((Int32)cell.column));
+	js->AddItem(ConvertToJavaScriptVariable(cell.valueString));
+	return js;
+}
+
+template<>
+GS::Ref<JS::Base> ConvertToJavaScriptVariable(const SendXlsHelper::ExportResult& result)
+{
+	GS::Ref<JS::Object> js = new JS::Object();
+	js->AddItem("success", new JS::Value(result.success));
+	js->AddItem("rows", new JS::Value((Int32)result.rows));
+	js->AddItem("bytes", new JS::Value((double)result.bytes));
+	js->AddItem("seconds", new JS::Value(result.seconds));
+	js->AddItem("path", new JS::Value(result.path));
+	js->AddItem("pulled", new JS::Value((Int32)result.pulled));
+	js->AddItem("reused", new JS::Value((Int32)result.reused));
+	js->AddItem("removed", new JS::Value((Int32)result.removed));
+	return js;
+}
+
+template<>
+GS::Ref<JS::Base> ConvertToJavaScriptVariable(const SendXlsHelper::SnapshotDiffResult& result)
+{
+	GS::Ref<JS::Object> js = new JS::Object();
+	js->AddItem("success", new JS::Value(result.success));
+	js->AddItem("added", new JS::Value((double)result.added));
+	js->AddItem("removed", new JS::Value((double)result.removed));
+	js->AddItem("changed", new JS::Value((double)result.changed));
+	js->AddItem("unchanged", new JS::Value((double)result.unchanged));
+	js->AddItem("seconds", new JS::Value(result.seconds));
+
+	GS::Ref<JS::Array> columns = new JS::Array();
+	for (UIndex i = 0; i < result.columnNames.GetSize(); ++i) {
+		GS::Ref<JS::Object> column = new JS::Object();
+		column->AddItem("name", new JS::Value(result.columnNames[i]));
+		column->AddItem("changes", new JS::Value((double)result.columnChanges[i]));
+		columns->AddItem(column);
+	}
+	js->AddItem("columns", columns);
+
+	GS::Ref<JS::Array> rows = new JS::Array();
+	for (const SendXlsHelper::SnapshotDiffRow& row : result.rows) {
+		GS::Ref<JS::Object> jsRow = new JS::Object();
+		jsRow->AddItem("status", new JS::Value(row.status));
+		jsRow->AddItem("guid", new JS::Value(row.guid));
+		jsRow->AddItem("id", new JS::Value(row.id));
+		jsRow->AddItem("changed", new JS::Value(row.changedColumns));
+		rows->AddItem(jsRow);
+	}
+	js->AddItem("rows", rows);
+	return js;
+}
+
+static GS::UniString CellFormatToString(SendXlsHelper::CellFormat format)
+{
+	switch (format) {
+		case SendXlsHelper::CellFormat::Number: return "number";
+		case SendXlsHelper::CellFormat::Text:   return "text";
+		default:                                return "auto";
+	}
+}
+
+static SendXlsHelper::CellFormat CellFormatFromString(const GS::UniString& text)
+{
+	if (text.IsEqual("number", GS::CaseInsensitive)) return SendXlsHelper::CellFormat::Number;
+	if (text.IsEqual("text", GS::CaseInsensitive))   return SendXlsHelper::CellFormat::Text;
+	return SendXlsHelper::CellFormat::Auto;
+}
+
+// [шаблон, базовое имя, ключи групп[], ключи порядка[], начало, шаг, ...]
+static IdRenumber::Options GetRenumberOptions(const GS::Array<GS::Ref<JS::Base>>& items)
+{
+	IdRenumber::Options options;
+	if (items.GetSize() >= 1) options.pattern = GetStringFromJavaScriptVariable(items[0]);
+	if (items.GetSize() >= 2) options.base = GetStringFromJavaScriptVariable(items[1]);
+	if (items.GetSize() >= 3) options.groupBy = GetStringArrayFromJavaScriptVariable(items[2]);
+	if (items.GetSize() >= 4) options.orderBy = GetStringArrayFromJavaScriptVariable(items[3]);
+	if (items.GetSize() >= 5) options.start = (Int32)GetDoubleFromJs(items[4], 1.0);
+	if (items.GetSize() >= 6) options.step = (Int32)GetDoubleFromJs(items[5], 1.0);
+	options.base.Trim();
+	return options;
+}
+
+// Ошибки пакетного изменения по элементам: [[guid, код], ...], не больше limit
+static GS::Ref<JS::Array> ConvertElementErrors(const GS::Array<BatchMutation::ElementError>& errors, UInt32 limit = 200)
+{
+	GS::Ref<JS::Array> js = new JS::Array();
+	for (UIndex i = 0; i < errors.GetSize() && i < limit; ++i) {
+		GS::Ref<JS::Array> item = new JS::Array();
+		item->AddItem(new JS::Value(APIGuidToString(errors[i].guid)));
+		item->AddItem(new JS::Value((Int32)errors[i].code));
+		js->AddItem(item);
+	}
+	return js;
+}
+
+// rowLimit — сколько строк предпросмотра отдать в палитру (итоги считаются по всем)
+static GS::Ref<JS::Base> ConvertRenumberResult(const IdRenumber::Result& result, UInt32 rowLimit)
+{
+	GS::Ref<JS::Object> js = new JS::Object();
+	js->AddItem("success", new JS::Value(result.success));
+	js->AddItem("total", new JS::Value((Int32)result.rows.GetSize()));
+	js->AddItem("changed", new JS::Value((Int32)result.changed));
+	js->AddItem("duplicates", new JS::Value((Int32)result.duplicates));
+	js->AddItem("conflicts", new JS::Value((Int32)result.conflicts));
+	js->AddItem("groups", new JS::Value((Int32)result.groups));
+	js->AddItem("failed", new JS::Value((Int32)result.failed));
+	js->AddItem("canceled", new JS::Value(result.canceled));
+	js->AddItem("elementErrors", ConvertElementErrors(result.elementErrors));
+	js->AddItem("collectSeconds", new JS::Value(result.collectSeconds));
+	js->AddItem("applySeconds", new JS::Value(result.applySeconds));
+
+	GS::Ref<JS::Array> rows = new JS::Array();
+	for (UIndex i = 0; i < result.rows.GetSize() && i < rowLimit; ++i) {
+		const IdRenumber::Row& row = result.rows[i];
+		GS::Ref<JS::Array> item = new JS::Array();
+		item->AddItem(new JS::Value(APIGuidToString(row.guid)));
+		item->AddItem(new JS::Value(row.oldID));
+		item->AddItem(new JS::Value(row.newID));
+		rows->AddItem(item);
+	}
+	js->AddItem("rows", rows);
+
+	GS::Ref<JS::Array> errors = new JS::Array();
+	for (const GS::UniString& error : result.errors) {
+		errors->AddItem(new JS::Value(error));
+	}
+	js->AddItem("errors", errors);
+	return js;
+}
+
+template<>
+GS::Ref<JS::Base> ConvertToJavaScriptVariable(const ExportTemplates::Template& item)
+{
+	GS::Ref<JS::Object> js = new JS::Object();
+	js->AddItem("name", new JS::Value(item.name));
+	js->AddItem("format", new JS::Value(SendXlsHelper::GetFormatExtension(item.format)));
+
+	GS::Ref<JS::Array> columns = new JS::Array();
+	for (const ExportTemplates::ColumnSpec& column : item.columns) {
+		GS::Ref<JS::Object> jsColumn = new JS::Object();
+		jsColumn->AddItem("token", new JS::Value(column.token));
+		jsColumn->AddItem("header", new JS::Value(column.header));
+		jsColumn->AddItem("format", new JS::Value(CellFormatToString(column.format)));
+		jsColumn->AddItem("decimals", new JS::Value(column.decimals));
+		columns->AddItem(jsColumn);
+	}
+	js->AddItem("columns", columns);
+
+	GS::Ref<JS::Array> groupBy = new JS::Array();
+	for (const GS::UniString& token : item.groupBy) {
+		groupBy->AddItem(new JS::Value(token));
+	}
+	js->AddItem("groupBy", groupBy);
+	js->AddItem("targetPath", new JS::Value(item.targetPath));
+	return js;
+}
+
 template<>
 GS::Ref<JS::Base> ConvertToJavaScriptVariable(const LayerHelper::LayerInfo& layerInfo)
 {
@@ -113,6 +325,47 @@ GS::Ref<JS::Base> ConvertToJavaScriptVariable(const LayerHelper::LayerInfo& laye
 	return js;
 }
 
+template<>
+GS::Ref<JS::Base> ConvertToJavaScriptVariable(const LayerPlan::Result& result)
+{
+	GS::Ref<JS::Object> js = new JS::Object();
+	js->AddItem("success", new JS::Value(result.success));
+	js->AddItem("dryRun", new JS::Value(result.dryRun));
+	js->AddItem("canceled", new JS::Value(result.canceled));
+	js->AddItem("foldersCreated", new JS::Value((Int32)result.foldersCreated));
+	js->AddItem("layersCreated", new JS::Value((Int32)result.layersCreated));
+	js->AddItem("elementsMoved", new JS::Value((Int32)result.elementsMoved));
+	js->AddItem("elementsFailed", new JS::Value((Int32)result.elementsFailed));
+	js->AddItem("conflicts", new JS::Value((Int32)result.conflicts));
+	js->AddItem("parseSeconds", new JS::Value(result.parseSeconds));
+	js->AddItem("resolveSeconds", new JS::Value(result.resolveSeconds));
+	js->AddItem("applySeconds", new JS::Value(result.applySeconds));
+
+	GS::Ref<JS::Array> entries = new JS::Array();
+	for (const LayerPlan::EntryReport& entry : result.entries) {
+		GS::Ref<JS::Object> item = new JS::Object();
+		item->AddItem("folder", new JS::Value(entry.folderPath));
+		item->AddItem("layer", new JS::Value(entry.layerName));
+		item->AddItem("hidden", new JS::Value((Int32)entry.hidden));
+		item->AddItem("folderExists", new JS::Value(entry.folderExists));
+		item->AddItem("layerExists", new JS::Value(entry.layerExists));
+		item->AddItem("elements", new JS::Value((Int32)entry.elements));
+		item->AddItem("unchanged", new JS::Value((Int32)entry.unchanged));
+		item->AddItem("moved", new JS::Value((Int32)entry.moved));
+		item->AddItem("failed", new JS::Value((Int32)entry.failed));
+		item->AddItem("unmatchedPatterns", new JS::Value((Int32)entry.unmatchedPatterns));
+		entries->AddItem(item);
+	}
+	js->AddItem("entries", entries);
+
+	GS::Ref<JS::Array> messages = new JS::Array();
+	for (const GS::UniString& message : result.messages) {
+		messages->AddItem(new JS::Value(message));
+	}
+	js->AddItem("messages", messages);
+	return js;
+}
+
 template<class Type>
 static GS::Ref<JS::Base> ConvertToJavaScriptVariable(const GS::Array<Type>& cppArray)
 {
@@ -137,15 +390,6 @@ static void EnsureModelWindowIsActive()
 	(void)changeErr;
 }
 
-// --------------------- Project event handler ---------------------
-static GSErrCode NotificationHandler(API_NotifyEventID notifID, Int32 /*param*/)
-{
-	if (notifID == APINotify_Quit) {
-		BrowserRepl::DestroyInstance();
-	}
-	return NoError;
-}
-
 // --------------------- BrowserRepl impl ---------------------
 BrowserRepl::BrowserRepl() :
 	DG::Palette(ACAPI_GetOwnResModule(), BrowserReplResId, ACAPI_GetOwnResModule(), paletteGuid),
@@ -154,8 +398,6 @@ BrowserRepl::BrowserRepl() :
 	buttonLayers(GetReference(), ToolbarButtonLayersId),
 	buttonSupport(GetReference(), ToolbarButtonSupportId)
 {
-	ACAPI_ProjectOperation_CatchProjectEvent(APINotify_Quit, NotificationHandler);
-
 	Attach(*this);
 	AttachToAllItems(*this);
 	BeginEventProcessing();
@@ -220,8 +462,71 @@ void BrowserRepl::RegisterACAPIJavaScriptObject(DG::Browser& targetBrowser)
 
 	jsACAPI->AddItem(new JS::Function("ChangeSelectedElementsID", [](GS::Ref<JS::Base> param) {
 		const GS::UniString baseID = GetStringFromJavaScriptVariable(param);
-		const bool success = SelectionHelper::ChangeSelectedElementsID(baseID);
-		return ConvertToJavaScriptVariable(success);
+		SelectionHelper::UpdateElementsIdResult result;
+		const bool success = SelectionHelper::ChangeSelectedElementsID(baseID, &result);
+		GS::Ref<JS::Object> jsResult = new JS::Object();
+		jsResult->AddItem("success", ConvertToJavaScriptVariable(success));
+		jsResult->AddItem("updated", ConvertToJavaScriptVariable((Int32)result.updated));
+		jsResult->AddItem("unchanged", ConvertToJavaScriptVariable((Int32)result.unchanged));
+		jsResult->AddItem("failed", ConvertToJavaScriptVariable((Int32)result.failed));
+		jsResult->AddItem("requested", ConvertToJavaScriptVariable((Int32)result.requested));
+		jsResult->AddItem("canceled", ConvertToJavaScriptVariable(result.canceled));
+		jsResult->AddItem("errors", ConvertElementErrors(result.elementErrors));
+		return jsResult;
+		}));
+
+	// Перенумерация выделенных элементов по шаблону.
+	// Параметр: [шаблон, базовое имя, ключи групп[], ключи порядка[], начало, шаг, строк в ответе]
+	jsACAPI->AddItem(new JS::Function("PreviewRenumber", [](GS::Ref<JS::Base> param) {
+		GS::Array<GS::Ref<JS::Base>> items;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			items = params->GetItemArray();
+		}
+		UInt32 rowLimit = 500;
+		if (items.GetSize() >= 7) {
+			const double requested = GetDoubleFromJs(items[6], 500.0);
+			if (requested >= 0.0) rowLimit = (UInt32)requested;
+		}
+		const GS::Array<API_Guid> elements = SelectionGroupHelper::GetScopeElements(false);
+		return ConvertRenumberResult(IdRenumber::Preview(elements, GetRenumberOptions(items)), rowLimit);
+		}));
+
+	// Параметр — как у PreviewRenumber; всё одной Undo-командой
+	jsACAPI->AddItem(new JS::Function("ApplyRenumber", [](GS::Ref<JS::Base> param) {
+		GS::Array<GS::Ref<JS::Base>> items;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			items = params->GetItemArray();
+		}
+		const GS::Array<API_Guid> elements = SelectionGroupHelper::GetScopeElements(false);
+		return ConvertRenumberResult(IdRenumber::Apply(elements, GetRenumberOptions(items)), 0);
+		}));
+
+	// Повторяющиеся ID по всей модели: [[ID, [guid, ...]], ...]
+	jsACAPI->AddItem(new JS::Function("GetDuplicateIds", [](GS::Ref<JS::Base>) {
+		GS::Ref<JS::Array> js = new JS::Array();
+		for (const ElementIdIndex::DuplicateGroup& group : ElementIdIndex::GetDuplicates()) {
+			GS::Ref<JS::Array> item = new JS::Array();
+			item->AddItem(new JS::Value(group.id));
+			GS::Ref<JS::Array> guids = new JS::Array();
+			for (const API_Guid& guid : group.guids) {
+				guids->AddItem(new JS::Value(APIGuidToString(guid)));
+			}
+			item->AddItem(guids);
+			js->AddItem(item);
+		}
+		return js;
+		}));
+
+	// Параметр: [основа ID, начиная с] -> наименьший незанятый номер
+	jsACAPI->AddItem(new JS::Function("GetNextFreeIdNumber", [](GS::Ref<JS::Base> param) {
+		GS::UniString prefix;
+		Int32 start = 1;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) prefix = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) start = (Int32)GetDoubleFromJs(items[1], 1.0);
+		}
+		return new JS::Value(ElementIdIndex::GetNextFreeNumber(prefix, start));
 		}));
 
 	jsACAPI->AddItem(new JS::Function("SetElementsID", [](GS::Ref<JS::Base> param) {
@@ -247,7 +552,11 @@ void BrowserRepl::RegisterACAPIJavaScriptObject(DG::Browser& targetBrowser)
 		SelectionHelper::UpdateElementsIdResult result = SelectionHelper::UpdateElementsID(guids, newId);
 		GS::Ref<JS::Object> jsResult = new JS::Object();
 		jsResult->AddItem("updated", ConvertToJavaScriptVariable((Int32)result.updated));
+		jsResult->AddItem("unchanged", ConvertToJavaScriptVariable((Int32)result.unchanged));
+		jsResult->AddItem("failed", ConvertToJavaScriptVariable((Int32)result.failed));
 		jsResult->AddItem("requested", ConvertToJavaScriptVariable((Int32)result.requested));
+		jsResult->AddItem("canceled", ConvertToJavaScriptVariable(result.canceled));
+		jsResult->AddItem("errors", ConvertElementErrors(result.elementErrors));
 		return jsResult;
 		}));
 
@@ -267,12 +576,85 @@ void BrowserRepl::RegisterACAPIJavaScriptObject(DG::Browser& targetBrowser)
 		GS::Ref<JS::Object> jsResult = new JS::Object();
 		jsResult->AddItem("applied", ConvertToJavaScriptVariable((Int32)result.applied));
 		jsResult->AddItem("requested", ConvertToJavaScriptVariable((Int32)result.requested));
+		jsResult->AddItem("added", ConvertToJavaScriptVariable((Int32)result.added));
+		jsResult->AddItem("removed", ConvertToJavaScriptVariable((Int32)result.removed));
 
 		EnsureModelWindowIsActive();
 
 		return jsResult;
 		}));
 
+	// --- Selection sets ---
+	jsACAPI->AddItem(new JS::Function("GetSelectionSets", [](GS::Ref<JS::Base>) {
+		GS::Ref<JS::Array> js = new JS::Array();
+		for (const SelectionSets::SetInfo& info : SelectionSets::GetSets()) {
+			GS::Ref<JS::Object> obj = new JS::Object();
+			obj->AddItem("name", ConvertToJavaScriptVariable(info.name));
+			obj->AddItem("count", ConvertToJavaScriptVariable((Int32)info.count));
+			js->AddItem(obj);
+		}
+		return js;
+	}));
+
+	// Параметр: [имя, [GUID — пусто = выделение]]
+	jsACAPI->AddItem(new JS::Function("SaveSelectionSet", [](GS::Ref<JS::Base> param) {
+		GS::UniString name;
+		GS::Array<API_Guid> elements;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) name = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) elements = GetGuidArrayFromJavaScriptVariable(items[1]);
+		}
+		name.Trim();
+		if (elements.IsEmpty()) {
+			elements = SelectionGroupHelper::GetScopeElements(false);
+		}
+
+		GS::Ref<JS::Object> jsResult = new JS::Object();
+		jsResult->AddItem("success", ConvertToJavaScriptVariable(!name.IsEmpty() && !elements.IsEmpty() && SelectionSets::SaveSet(name, elements)));
+		jsResult->AddItem("count", ConvertToJavaScriptVariable((Int32)elements.GetSize()));
+		return jsResult;
+	}));
+
+	jsACAPI->AddItem(new JS::Function("DeleteSelectionSet", [](GS::Ref<JS::Base> param) {
+		return ConvertToJavaScriptVariable(SelectionSets::DeleteSet(GetStringFromJavaScriptVariable(param)));
+	}));
+
+	// Параметр: [набор A, "" | "union" | "intersection" | "difference", набор B, сохранить как]
+	jsACAPI->AddItem(new JS::Function("ApplySelectionSet", [](GS::Ref<JS::Base> param) {
+		GS::UniString left;
+		GS::UniString operation;
+		GS::UniString right;
+		GS::UniString saveAs;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) left = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) operation = GetStringFromJavaScriptVariable(items[1]);
+			if (items.GetSize() >= 3) right = GetStringFromJavaScriptVariable(items[2]);
+			if (items.GetSize() >= 4) saveAs = GetStringFromJavaScriptVariable(items[3]);
+		} else {
+			left = GetStringFromJavaScriptVariable(param);
+		}
+		saveAs.Trim();
+
+		const SelectionSets::ApplyResult result = SelectionSets::Apply(left, SelectionSets::ParseOperation(operation), right, saveAs);
+
+		GS::Ref<JS::Object> jsResult = new JS::Object();
+		jsResult->AddItem("success", ConvertToJavaScriptVariable(result.success));
+		jsResult->AddItem("count", ConvertToJavaScriptVariable((Int32)result.count));
+		jsResult->AddItem("saved", ConvertToJavaScriptVariable(result.saved));
+		jsResult->AddItem("mergeMs", new JS::Value(result.mergeSeconds * 1000.0));
+		jsResult->AddItem("applied", ConvertToJavaScriptVariable((Int32)result.selection.applied));
+		jsResult->AddItem("requested", ConvertToJavaScriptVariable((Int32)result.selection.requested));
+		jsResult->AddItem("added", ConvertToJavaScriptVariable((Int32)result.selection.added));
+		jsResult->AddItem("removed", ConvertToJavaScriptVariable((Int32)result.selection.removed));
+
+		if (result.success) {
+			EnsureModelWindowIsActive();
+		}
+		return jsResult;
+	}));
+
 	jsACAPI->AddItem(new JS::Function("GetSelectedProperties", [](GS::Ref<JS::Base> param) {
 		API_Guid requestedGuid = APINULLGuid;
 		if (param != nullptr) {
@@ -321,6 +703,288 @@ void BrowserRepl::RegisterACAPIJavaScriptObject(DG::Browser& targetBrowser)
 		return jsMetrics;
 	}));
 
+	// --- Lazy property columns API ---
+	jsACAPI->AddItem(new JS::Function("SetPropertyColumns", [](GS::Ref<JS::Base> param) {
+		PropertyValueLoader::SetColumns(GetGuidArrayFromJavaScriptVariable(param));
+		return ConvertToJavaScriptVariable(true);
+	}));
+
+	// Параметр: [ [видимые GUID], [индексы видимых колонок], [GUID для предзагрузки по приоритету] ]
+	jsACAPI->AddItem(new JS::Function("RequestPropertyValues", [](GS::Ref<JS::Base> param) {
+		GS::Array<API_Guid> visibleElems;
+		GS::Array<UIndex> visibleColumns;
+		GS::Array<API_Guid> prefetchElems;
+
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) visibleElems = GetGuidArrayFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) {
+				if (GS::Ref<JS::Array> jsColumns = GS::DynamicCast<JS::Array>(items[1])) {
+					for (const GS::Ref<JS::Base>& item : jsColumns->GetItemArray()) {
+						const double column = GetDoubleFromJs(item, -1.0);
+						if (column >= 0.0) visibleColumns.Push(static_cast<UIndex>(column));
+					}
+				}
+			}
+			if (items.GetSize() >= 3) prefetchElems = GetGuidArrayFromJavaScriptVariable(items[2]);
+		}
+
+		GS::Ref<JS::Object> jsResult = new JS::Object();
+		jsResult->AddItem("cells", ConvertToJavaScriptVariable(PropertyValueLoader::Request(visibleElems, visibleColumns, prefetchElems)));
+		jsResult->AddItem("pending", ConvertToJavaScriptVariable((Int32)PropertyValueLoader::GetPendingCount()));
+		return jsResult;
+	}));
+
+	jsACAPI->AddItem(new JS::Function("LoadPendingPropertyValues", [](GS::Ref<JS::Base> param) {
+		const double budgetMs = GetDoubleFromJs(param, 15.0);
+
+		GS::Ref<JS::Object> jsResult = new JS::Object();
+		jsResult->AddItem("cells", ConvertToJavaScriptVariable(PropertyValueLoader::LoadPending(budgetMs)));
+		jsResult->AddItem("pending", ConvertToJavaScriptVariable((Int32)PropertyValueLoader::GetPendingCount()));
+		return jsResult;
+	}));
+
+	// --- Group-by API ---
+	// Параметр: [ [колонки группировки], [колонки агрегации], вся модель (bool) ]
+	jsACAPI->AddItem(new JS::Function("GroupElements", [](GS::Ref<JS::Base> param) {
+		GS::Array<SelectionGroupHelper::Column> groupBy;
+		GS::Array<SelectionGroupHelper::Column> aggregateColumns;
+		bool wholeModel = false;
+
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) groupBy = GetColumnsFromJs(items[0]);
+			if (items.GetSize() >= 2) aggregateColumns = GetColumnsFromJs(items[1]);
+			if (items.GetSize() >= 3) wholeModel = GetBoolFromJs(items[2]);
+		}
+
+		const GS::Array<API_Guid> elements = SelectionGroupHelper::GetScopeElements(wholeModel);
+		const SelectionGroupHelper::GroupResult result = SelectionGroupHelper::GroupElements(elements, groupBy, aggregateColumns);
+
+		GS::Ref<JS::Array> jsGroups = new JS::Array();
+		for (const SelectionGroupHelper::Group& group : result.groups) {
+			GS::Ref<JS::Object> obj = new JS::Object();
+			obj->AddItem("keys", ConvertToJavaScriptVariable(group.keyValues));
+			obj->AddItem("count", new JS::Value((Int32)group.count));
+
+			GS::Ref<JS::Array> jsAggregates = new JS::Array();
+			for (const SelectionGroupHelper::Aggregate& aggregate : group.aggregates) {
+				GS::Ref<JS::Object> agg = new JS::Object();
+				agg->AddItem("sum", new JS::Value(aggregate.sum));
+				agg->AddItem("min", new JS::Value(aggregate.min));
+				agg->AddItem("max", new JS::Value(aggregate.max));
+				agg->AddItem("n", new JS::Value((Int32)aggregate.numericCount));
+				jsAggregates->AddItem(agg);
+			}
+			obj->AddItem("aggregates", jsAggregates);
+			jsGroups->AddItem(obj);
+		}
+
+		GS::Ref<JS::Object> jsResult = new JS::Object();
+		jsResult->AddItem("elements", new JS::Value((Int32)result.elementCount));
+		jsResult->AddItem("groups", jsGroups);
+		return jsResult;
+	}));
+
+	// --- Send to Excel API ---
+	// Параметр: [ [колонки], [заголовки], BOM (bool), [GUID элементов — пусто = текущее выделение] ]
+	jsACAPI->AddItem(new JS::Function("SaveSendXls", [](GS::Ref<JS::Base> param) {
+		GS::Array<SendXlsHelper::ExportColumn> columns;
+		SendXlsHelper::ExportOptions options;
+		GS::Array<API_Guid> elements;
+
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			const GS::Array<GS::UniString> tokens = (items.GetSize() >= 1) ? GetStringArrayFromJavaScriptVariable(items[0]) : GS::Array<GS::UniString>();
+			const GS::Array<GS::UniString> headers = (items.GetSize() >= 2) ? GetStringArrayFromJavaScriptVariable(items[1]) : GS::Array<GS::UniString>();
+			for (UIndex i = 0; i < tokens.GetSize(); ++i) {
+				SendXlsHelper::ExportColumn column;
+				if (SendXlsHelper::ParseColumn(tokens[i], column)) {
+					column.header = (i < headers.GetSize()) ? headers[i] : tokens[i];
+					columns.Push(column);
+				}
+			}
+			if (items.GetSize() >= 3) options.writeBom = GetBoolFromJs(items[2], true);
+			if (items.GetSize() >= 4) elements = GetGuidArrayFromJavaScriptVariable(items[3]);
+			if (items.GetSize() >= 5 && GetStringFromJavaScriptVariable(items[4]).IsEqual("xlsx", GS::CaseInsensitive)) {
+				options.format = SendXlsHelper::ExportFormat::Xlsx;
+			}
+		}
+		if (elements.IsEmpty()) {
+			elements = SelectionGroupHelper::GetScopeElements(false);
+		}
+
+		GS::UniString path;
+		if (columns.IsEmpty() || elements.IsEmpty() || !SendXlsHelper::AskSavePath("Отправить в Excel", SendXlsHelper::GetFormatExtension(options.format), path)) {
+			return ConvertToJavaScriptVariable(SendXlsHelper::ExportResult());
+		}
+
+		return ConvertToJavaScriptVariable(SendXlsHelper::ExportToFile(elements, columns, path, options));
+	}));
+
+	// Снимок выделения (.tssnap). Параметр: [ [колонки], [заголовки], [GUID элементов — пусто = текущее выделение] ]
+	jsACAPI->AddItem(new JS::Function("SaveSnapshot", [](GS::Ref<JS::Base> param) {
+		GS::Array<SendXlsHelper::ExportColumn> columns;
+		GS::Array<API_Guid> elements;
+
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			const GS::Array<GS::UniString> tokens = (items.GetSize() >= 1) ? GetStringArrayFromJavaScriptVariable(items[0]) : GS::Array<GS::UniString>();
+			const GS::Array<GS::UniString> headers = (items.GetSize() >= 2) ? GetStringArrayFromJavaScriptVariable(items[1]) : GS::Array<GS::UniString>();
+			for (UIndex i = 0; i < tokens.GetSize(); ++i) {
+				SendXlsHelper::ExportColumn column;
+				if (SendXlsHelper::ParseColumn(tokens[i], column)) {
+					column.header = (i < headers.GetSize()) ? headers[i] : tokens[i];
+					columns.Push(column);
+				}
+			}
+			if (items.GetSize() >= 3) elements = GetGuidArrayFromJavaScriptVariable(items[2]);
+		}
+		if (elements.IsEmpty()) {
+			elements = SelectionGroupHelper::GetScopeElements(false);
+		}
+
+		GS::UniString path;
+		if (columns.IsEmpty() || elements.IsEmpty() || !SendXlsHelper::AskSavePath("Сохранить снимок", "tssnap", path)) {
+			return ConvertToJavaScriptVariable(SendXlsHelper::ExportResult());
+		}
+		return ConvertToJavaScriptVariable(SendXlsHelper::SaveSnapshot(elements, columns, path));
+	}));
+
+	// Сравнение снимков. Параметр: [старый путь, новый путь] — пустые пути спрашиваются диалогом.
+	// Результат — сводка, первые 500 отличий и пути, чтобы выгрузить то же сравнение
+	jsACAPI->AddItem(new JS::Function("CompareSnapshots", [](GS::Ref<JS::Base> param) {
+		GS::Array<GS::UniString> paths = GetStringArrayFromJavaScriptVariable(param);
+		while (paths.GetSize() < 2) {
+			paths.Push(GS::UniString());
+		}
+		if ((paths[0].IsEmpty() && !SendXlsHelper::AskOpenPath("Старый снимок", paths[0])) ||
+			(paths[1].IsEmpty() && !SendXlsHelper::AskOpenPath("Новый снимок", paths[1]))) {
+			return ConvertToJavaScriptVariable(SendXlsHelper::SnapshotDiffResult());
+		}
+
+		GS::Ref<JS::Base> js = ConvertToJavaScriptVariable(SendXlsHelper::CompareSnapshots(paths[0], paths[1], 500));
+		if (GS::Ref<JS::Object> object = GS::DynamicCast<JS::Object>(js)) {
+			object->AddItem("oldPath", new JS::Value(paths[0]));
+			object->AddItem("newPath", new JS::Value(paths[1]));
+		}
+		return js;
+	}));
+
+	// Параметр: [старый путь, новый путь, "csv" | "xlsx"]
+	jsACAPI->AddItem(new JS::Function("ExportSnapshotDiff", [](GS::Ref<JS::Base> param) {
+		GS::UniString oldPath;
+		GS::UniString newPath;
+		SendXlsHelper::ExportOptions options;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) oldPath = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) newPath = GetStringFromJavaScriptVariable(items[1]);
+			if (items.GetSize() >= 3 && GetStringFromJavaScriptVariable(items[2]).IsEqual("xlsx", GS::CaseInsensitive)) {
+				options.format = SendXlsHelper::ExportFormat::Xlsx;
+			}
+		}
+
+		GS::UniString path;
+		if (oldPath.IsEmpty() || newPath.IsEmpty() || !SendXlsHelper::AskSavePath("Выгрузить сравнение снимков", SendXlsHelper::GetFormatExtension(options.format), path)) {
+			return ConvertToJavaScriptVariable(SendXlsHelper::ExportResult());
+		}
+		return ConvertToJavaScriptVariable(SendXlsHelper::ExportSnapshotDiff(oldPath, newPath, path, options));
+	}));
+
+	// --- Export templates ---
+	jsACAPI->AddItem(new JS::Function("GetExportTemplates", [](GS::Ref<JS::Base>) {
+		GS::Ref<JS::Array> js = new JS::Array();
+		for (const ExportTemplates::Template& item : ExportTemplates::GetTemplates()) {
+			js->AddItem(ConvertToJavaScriptVariable(item));
+		}
+		return js;
+	}));
+
+	// [name, "csv"|"xlsx", [[token, header, "auto"|"number"|"text", decimals], ...], groupByTokens[]]
+	jsACAPI->AddItem(new JS::Function("SaveExportTemplate", [](GS::Ref<JS::Base> param) {
+		ExportTemplates::Template item;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) item.name = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2 && GetStringFromJavaScriptVariable(items[1]).IsEqual("csv", GS::CaseInsensitive)) {
+				item.format = SendXlsHelper::ExportFormat::Csv;
+			}
+			if (items.GetSize() >= 3) {
+				if (GS::Ref<JS::Array> jsColumns = GS::DynamicCast<JS::Array>(items[2])) {
+					for (const GS::Ref<JS::Base>& jsColumn : jsColumns->GetItemArray()) {
+						GS::Ref<JS::Array> fields = GS::DynamicCast<JS::Array>(jsColumn);
+						if (fields == nullptr || fields->GetItemArray().IsEmpty()) {
+							continue;
+						}
+						const GS::Array<GS::Ref<JS::Base>>& f = fields->GetItemArray();
+						ExportTemplates::ColumnSpec column;
+						column.token = GetStringFromJavaScriptVariable(f[0]);
+						if (f.GetSize() >= 2) column.header = GetStringFromJavaScriptVariable(f[1]);
+						if (f.GetSize() >= 3) column.format = CellFormatFromString(GetStringFromJavaScriptVariable(f[2]));
+						// 0..MaxDecimals; NaN из JS — 0
+						if (f.GetSize() >= 4) column.decimals = (Int32)std::max(0.0, std::min(GetDoubleFromJs(f[3], 6.0), (double)TableWriter::MaxDecimals));
+						item.columns.Push(column);
+					}
+				}
+			}
+			if (items.GetSize() >= 4) item.groupBy = GetStringArrayFromJavaScriptVariable(items[3]);
+		}
+		item.name.Trim();
+		if (item.name.IsEmpty() || item.columns.IsEmpty()) {
+			return ConvertToJavaScriptVariable(false);
+		}
+		return ConvertToJavaScriptVariable(ExportTemplates::SaveTemplate(item));
+	}));
+
+	jsACAPI->AddItem(new JS::Function("DeleteExportTemplate", [](GS::Ref<JS::Base> param) {
+		return ConvertToJavaScriptVariable(ExportTemplates::DeleteTemplate(GetStringFromJavaScriptVariable(param)));
+	}));
+
+	// Параметр: [имя, [GUID — пусто = выделение], обновить (bool)]
+	jsACAPI->AddItem(new JS::Function("ExportWithTemplate", [](GS::Ref<JS::Base> param) {
+		GS::UniString name;
+		GS::Array<API_Guid> elements;
+		bool refresh = false;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) name = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) elements = GetGuidArrayFromJavaScriptVariable(items[1]);
+			if (items.GetSize() >= 3) refresh = GetBoolFromJs(items[2], false);
+		}
+		if (elements.IsEmpty()) {
+			elements = SelectionGroupHelper::GetScopeElements(false);
+		}
+
+		const ExportTemplates::CompiledTemplate* plan = ExportTemplates::GetCompiledTemplate(name);
+		if (plan == nullptr || elements.IsEmpty()) {
+			return ConvertToJavaScriptVariable(SendXlsHelper::ExportResult());
+		}
+
+		// «Обновить» — в тот же файл без диалога, из API читаются только изменённые элементы
+		SendXlsHelper::ExportOptions options;
+		options.format = plan->format;
+		options.manifest = SendXlsHelper::ManifestMode::Rebuild;
+		GS::UniString path;
+		for (const ExportTemplates::Template& item : ExportTemplates::GetTemplates()) {
+			if (refresh && item.name == name && !item.targetPath.IsEmpty()) {
+				path = item.targetPath;
+				options.manifest = SendXlsHelper::ManifestMode::Reuse;
+			}
+		}
+		if (path.IsEmpty() && !SendXlsHelper::AskSavePath("Отправить в Excel", SendXlsHelper::GetFormatExtension(plan->format), path)) {
+			return ConvertToJavaScriptVariable(SendXlsHelper::ExportResult());
+		}
+
+		const SendXlsHelper::ExportResult result = plan->grouped
+			? SendXlsHelper::ExportGroupsToFile(elements, plan->groups, path, options)
+			: SendXlsHelper::ExportToFile(elements, plan->columns, path, options);
+		if (result.success) {
+			ExportTemplates::SetTargetPath(name, path);
+		}
+		return ConvertToJavaScriptVariable(result);
+	}));
+
 	// --- Layers API ---
 	jsACAPI->AddItem(new JS::Function("CreateLayerAndMoveElements", [](GS::Ref<JS::Base> param) {
 		LayerHelper::LayerCreationParams params;
@@ -347,11 +1011,165 @@ void BrowserRepl::RegisterACAPIJavaScriptObject(DG::Browser& targetBrowser)
 		return ConvertToJavaScriptVariable(success);
 		}));
 
+	// План раскладки по слоям (CSV/JSON). Параметр: [путь — пусто = спросить, пробный прогон (bool)]
+	jsACAPI->AddItem(new JS::Function("ImportLayerPlan", [](GS::Ref<JS::Base> param) {
+		GS::UniString path;
+		bool dryRun = true;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) path = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) dryRun = GetBoolFromJs(items[1], true);
+		}
+		if (path.IsEmpty() && !SendXlsHelper::AskOpenPath("План слоёв (CSV или JSON)", path)) {
+			return ConvertToJavaScriptVariable(LayerPlan::Result());
+		}
+
+		LayerPlan::Plan plan;
+		LayerPlan::LoadPlan(path, plan);
+		GS::Ref<JS::Base> js = ConvertToJavaScriptVariable(LayerPlan::Run(plan, dryRun));
+		if (GS::Ref<JS::Object> object = GS::DynamicCast<JS::Object>(js)) {
+			object->AddItem("path", new JS::Value(path));
+		}
+		return js;
+		}));
+
+	// Правила раскладки по слоям: текст хранится в настройках аддона
+	jsACAPI->AddItem(new JS::Function("GetLayerRules", [](GS::Ref<JS::Base>) {
+		return ConvertToJavaScriptVariable(LayerRules::GetRulesText());
+		}));
+
+	// Параметр: текст правил; ответ — { success, errors[] } (с ошибками разбора тоже сохраняется)
+	jsACAPI->AddItem(new JS::Function("SaveLayerRules", [](GS::Ref<JS::Base> param) {
+		GS::Array<GS::UniString> errors;
+		const bool success = LayerRules::SaveRulesText(GetStringFromJavaScriptVariable(param), errors);
+		GS::Ref<JS::Object> js = new JS::Object();
+		js->AddItem("success", new JS::Value(success));
+		GS::Ref<JS::Array> jsErrors = new JS::Array();
+		for (const GS::UniString& error : errors) {
+			jsErrors->AddItem(new JS::Value(error));
+		}
+		js->AddItem("errors", jsErrors);
+		return js;
+		}));
+
+	// Параметр: [пробный прогон (bool), только выделение (bool)]
+	jsACAPI->AddItem(new JS::Function("RunLayerRules", [](GS::Ref<JS::Base> param) {
+		bool dryRun = true;
+		bool selectionOnly = false;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) dryRun = GetBoolFromJs(items[0], true);
+			if (items.GetSize() >= 2) selectionOnly = GetBoolFromJs(items[1], false);
+		}
+
+		const LayerRules::RunResult result = LayerRules::Run(dryRun, selectionOnly);
+		GS::Ref<JS::Base> js = ConvertToJavaScriptVariable(result.plan);
+		if (GS::Ref<JS::Object> object = GS::DynamicCast<JS::Object>(js)) {
+			object->AddItem("scanned", new JS::Value((Int32)result.scanned));
+			object->AddItem("matched", new JS::Value((Int32)result.matched));
+			object->AddItem("evaluateSeconds", new JS::Value(result.evaluateSeconds));
+		}
+		return js;
+		}));
+
+	// Параметр: [[имя слоя, путь папки — пусто = корень], ...]; всё одной Undo-командой
+	jsACAPI->AddItem(new JS::Function("MoveLayersToFolders", [](GS::Ref<JS::Base> param) {
+		GS::Array<LayerHelper::LayerFolderMove> moves;
+		GS::Array<GS::UniString> missing;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			for (const GS::Ref<JS::Base>& jsMove : params->GetItemArray()) {
+				const GS::Array<GS::UniString> fields = GetStringArrayFromJavaScriptVariable(jsMove);
+				if (fields.IsEmpty()) {
+					continue;
+				}
+				LayerHelper::LayerFolderMove move;
+				move.layerIndex = LayerHelper::FindLayerByName(fields[0]);
+				if (!move.layerIndex.IsPositive()) {
+					missing.Push(fields[0]);
+					continue;
+				}
+				if (fields.GetSize() >= 2) move.folderPath = fields[1];
+				moves.Push(move);
+			}
+		}
+
+		LayerHelper::LayerReorganizeResult result;
+		const bool success = LayerHelper::MoveLayersToFolders(moves, &result) && missing.IsEmpty();
+
+		GS::Ref<JS::Object> js = new JS::Object();
+		js->AddItem("success", new JS::Value(success));
+		js->AddItem("moved", new JS::Value((Int32)result.moved));
+		js->AddItem("foldersCreated", new JS::Value((Int32)result.foldersCreated));
+		js->AddItem("moveCalls", new JS::Value((Int32)result.moveCalls));
+		js->AddItem("canceled", new JS::Value(result.canceled));
+		js->AddItem("seconds", new JS::Value(result.seconds));
+		GS::Ref<JS::Array> failed = new JS::Array();
+		for (const GS::UniString& name : missing) {
+			failed->AddItem(new JS::Value(name));
+		}
+		for (const API_AttributeIndex& index : result.failed) {
+			API_Attribute layer = {};
+			layer.header.typeID = API_LayerID;
+			layer.header.index = index;
+			if (ACAPI_Attribute_Get(&layer) == NoError) {
+				failed->AddItem(new JS::Value(GS::UniString(layer.header.name)));
+			}
+		}
+		js->AddItem("failed", failed);
+		return js;
+		}));
+
 	jsACAPI->AddItem(new JS::Function("GetLayersList", [](GS::Ref<JS::Base>) {
 		const GS::Array<LayerHelper::LayerInfo> layers = LayerHelper::GetLayersList();
 		return ConvertToJavaScriptVariable(layers);
 		}));
 
+	// Ответ — [[имя слоя, всего элементов, [[тип, количество], ...]], ...] для всех слоёв
+	jsACAPI->AddItem(new JS::Function("GetLayerUsage", [](GS::Ref<JS::Base>) {
+		GS::Ref<JS::Array> js = new JS::Array();
+		for (const LayerUsage::LayerUsageInfo& info : LayerUsage::GetLayerUsage()) {
+			GS::Ref<JS::Array> types = new JS::Array();
+			for (const LayerUsage::TypeCount& type : info.types) {
+				GS::Ref<JS::Array> item = new JS::Array();
+				item->AddItem(new JS::Value(type.typeName));
+				item->AddItem(new JS::Value((Int32)type.count));
+				types->AddItem(item);
+			}
+			GS::Ref<JS::Array> item = new JS::Array();
+			item->AddItem(new JS::Value(info.name));
+			item->AddItem(new JS::Value((Int32)info.total));
+			item->AddItem(types);
+			js->AddItem(item);
+		}
+		return js;
+		}));
+
+	// Параметр: [запрос, максимум результатов]; ответ — [[имя, папка, оценка], ...] по убыванию оценки
+	jsACAPI->AddItem(new JS::Function("SearchLayers", [](GS::Ref<JS::Base> param) {
+		GS::UniString query;
+		UInt32 limit = 200;
+		if (GS::Ref<JS::Array> params = GS::DynamicCast<JS::Array>(param)) {
+			const GS::Array<GS::Ref<JS::Base>>& items = params->GetItemArray();
+			if (items.GetSize() >= 1) query = GetStringFromJavaScriptVariable(items[0]);
+			if (items.GetSize() >= 2) {
+				const double requested = GetDoubleFromJs(items[1], 200.0);
+				if (requested >= 1.0) limit = (UInt32)requested;
+			}
+		} else {
+			query = GetStringFromJavaScriptVariable(param);
+		}
+
+		GS::Ref<JS::Array> js = new JS::Array();
+		for (const LayerHelper::LayerSearchResult& result : LayerHelper::SearchLayers(query, limit)) {
+			GS::Ref<JS::Array> item = new JS::Array();
+			item->AddItem(new JS::Value(result.name));
+			item->AddItem(new JS::Value(result.folder));
+			item->AddItem(new JS::Value((Int32)result.score));
+			js->AddItem(item);
+		}
+		return js;
+		}));
+
 	// --- Help / Palette control ---
 	jsACAPI->AddItem(new JS::Function("OpenHelp", [](GS::Ref<JS::Base> param) {
 		GS::UniString url;
@@ -0,0 +1,158 @@
+#include "CsvWriter.hpp"
+
+#include <cstring>
+
+CsvWriter::CsvWriter (std::FILE* file, const Options& options)
+	: m_file(file)
+	, m_options(options)
+{
+	m_buffer.reserve(m_options.bufferSize + 4096);
+	if (m_options.writeBom) {
+		m_buffer.append("\xEF\xBB\xBF");
+	}
+}
+
+CsvWriter::~CsvWriter ()
+{
+	Flush();
+}
+
+void CsvWriter::BeginField ()
+{
+	if (m_rowStarted) {
+		m_buffer.push_back(m_options.delimiter);
+	}
+	m_rowStarted = true;
+}
+
+void CsvWriter::WriteField (const char* utf8, size_t length)
+{
+	BeginField();
+
+	// Кавычки нужны только для полей с разделителем, кавычкой или переводом строки
+	bool needsQuotes = false;
+	for (size_t i = 0; i < length; ++i) {
+		const char c = utf8[i];
+		if (c == m_options.delimiter || c == '"' || c == '\n' || c == '\r') {
+			needsQuotes = true;
+			break;
+		}
+	}
+
+	if (!needsQuotes) {
+		m_buffer.append(utf8, length);
+		return;
+	}
+
+	m_buffer.push_back('"');
+	const char* begin = utf8;
+	const char* end = utf8 + length;
+	while (begin < end) {
+		const char* quote = static_cast<const char*>(std::memchr(begin, '"', static_cast<size_t>(end - begin)));
+		if (quote == nullptr) {
+			m_buffer.append(begin, static_cast<size_t>(end - begin));
+			break;
+		}
+		m_buffer.append(begin, static_cast<size_t>(quote - begin) + 1);
+		m_buffer.push_back('"');
+		begin = quote + 1;
+	}
+	m_buffer.push_back('"');
+}
+
+void CsvWriter::WriteNumber (double value, int maxDecimals)
+{
+	char text[64];
+	const size_t length = FormatNumber(value, maxDecimals, text, sizeof(text));
+	if (length == 0) {
+		WriteEmpty();
+		return;
+	}
+
+	BeginField();
+
+	// Точку меняем на десятичный разделитель локали
+	char* point = static_cast<char*>(std::memchr(text, '.', length));
+	if (point != nullptr) {
+		*point = m_options.decimalSeparator;
+	}
+	m_buffer.append(text, length);
+}
+
+void CsvWriter::WriteEmpty ()
+{
+	BeginField();
+}
+
+void CsvWriter::EndRow ()
+{
+	m_buffer.append("\r\n");
+	m_rowStarted = false;
+	m_rowCount++;
+	FlushIfFull();
+}
+
+// Пачка форматируется отдельным писателем в памяти с теми же разделителями
+ChunkOutput CsvWriter::FormatChunk (const RowChunk& chunk) const
+{
+	Options options = m_options;
+	options.writeBom = false;
+	options.bufferSize = chunk.textArena.size() + chunk.cells.size() * 16;
+	CsvWriter writer(nullptr, options);
+
+	const uint32_t rowCount = chunk.GetRowCount();
+	for (uint32_t row = 0; row < rowCount; ++row) {
+		for (uint32_t column = 0; column < chunk.columnCount; ++column) {
+			const RowChunk::Cell& cell = chunk.cells[row * chunk.columnCount + column];
+			switch (cell.kind) {
+				case RowChunk::Cell::Text:		writer.WriteField(chunk.textArena.data() + cell.offset, cell.length); break;
+				case RowChunk::Cell::Number:	writer.WriteNumber(cell.number, cell.decimals); break;
+				default:						writer.WriteEmpty(); break;
+			}
+		}
+		writer.EndRow();
+	}
+
+	ChunkOutput output;
+	output.bytes = writer.TakeBuffer();
+	output.rawSize = output.bytes.size();
+	output.rowCount = rowCount;
+	return output;
+}
+
+void CsvWriter::WriteChunk (const ChunkOutput& output)
+{
+	m_buffer.append(output.bytes);
+	m_rowCount += output.rowCount;
+	FlushIfFull();
+}
+
+void CsvWriter::FlushIfFull ()
+{
+	if (m_file != nullptr && m_buffer.size() >= m_options.bufferSize) {
+		Flush();
+	}
+}
+
+bool CsvWriter::Flush ()
+{
+	if (m_file == nullptr || m_buffer.empty()) {
+		return !m_error;
+	}
+
+	if (std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+		m_error = true;
+	}
+	m_bytesWritten += m_buffer.size();
+	m_buffer.clear();
+	return !m_error;
+}
+
+std::string CsvWriter::TakeBuffer ()
+{
+	std::string result;
+	result.swap(m_buffer);
+	m_bytesWritten += result.size();
+	m_buffer.reserve(m_options.bufferSize + 4096);
+	return result;
+}
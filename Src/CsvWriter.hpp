@@ -0,0 +1,58 @@
+#pragma once
+
+#include "TableWriter.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+// Потоковая запись CSV по RFC 4180.
+// Строки форматируются в буфер фиксированного размера и сбрасываются в файл по заполнении,
+// поэтому расход памяти не зависит от количества строк.
+// Без файла (file == nullptr) буфер не сбрасывается — его забирают через TakeBuffer().
+class CsvWriter : public TableWriter
+{
+public:
+	struct Options {
+		char	delimiter = ';';
+		char	decimalSeparator = '.';
+		bool	writeBom = true;			// UTF-8 BOM, чтобы Excel не гадал с кодировкой
+		size_t	bufferSize = 1 << 20;
+	};
+
+	CsvWriter (std::FILE* file, const Options& options);
+	~CsvWriter ();
+
+	CsvWriter (const CsvWriter&) = delete;
+	CsvWriter& operator= (const CsvWriter&) = delete;
+
+	// Поле в UTF-8; кавычки добавляются только если поле их требует
+	using TableWriter::WriteField;
+	void		WriteField (const char* utf8, size_t length) override;
+	void		WriteNumber (double value, int maxDecimals = 6) override;
+	void		WriteEmpty () override;
+	void		EndRow () override;
+
+	bool		Flush ();
+	bool		Finish () override { return Flush(); }
+	bool		HasError () const override { return m_error; }
+
+	std::string	TakeBuffer ();
+	unsigned long long GetBytesWritten () const override { return m_bytesWritten + m_buffer.size(); }
+
+	uint32_t	GetNextRow () const override { return m_rowCount + 1; }
+	ChunkOutput	FormatChunk (const RowChunk& chunk) const override;
+	void		WriteChunk (const ChunkOutput& output) override;
+
+private:
+	void		BeginField ();
+	void		FlushIfFull ();
+
+	std::FILE*			m_file;
+	Options				m_options;
+	std::string			m_buffer;
+	unsigned long long	m_bytesWritten = 0;
+	uint32_t			m_rowCount = 0;
+	bool				m_rowStarted = false;
+	bool				m_error = false;
+};
@@ -0,0 +1,547 @@
+#include "DeflateEncoder.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+namespace {
+
+const size_t	WindowSize = 32768;
+const size_t	BlockSize = 1 << 17;		// сколько входа копим перед сжатием блока
+const size_t	MinMatch = 3;
+const size_t	MaxMatch = 258;
+const size_t	LazyLimit = 32;				// более длинные совпадения берём сразу, без ленивой проверки
+const int		HashBits = 15;
+const int		EndOfBlock = 256;
+
+const int		LitLenCodes = 286;
+const int		DistCodes = 30;
+const int		CodeLengthCodes = 19;
+
+const uint16_t	LengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+								   35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t	LengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+									3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t	DistBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+								 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t	DistExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+								  7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+const uint8_t	CodeLengthOrder[CodeLengthCodes] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// Таблицы "длина -> код" и "дистанция -> код", строятся один раз
+struct CodeTables {
+	uint8_t lengthCode[MaxMatch + 1];
+	uint8_t distCode[WindowSize + 1];
+
+	CodeTables ()
+	{
+		for (int code = 0; code < 29; ++code) {
+			const int last = (code == 28) ? 258 : LengthBase[code] + (1 << LengthExtra[code]) - 1;
+			for (int length = LengthBase[code]; length <= last && length <= 258; ++length) {
+				lengthCode[length] = static_cast<uint8_t>(code);
+			}
+		}
+		lengthCode[258] = 28;
+		for (int code = 0; code < DistCodes; ++code) {
+			const int last = DistBase[code] + (1 << DistExtra[code]) - 1;
+			for (int dist = DistBase[code]; dist <= last && dist <= static_cast<int>(WindowSize); ++dist) {
+				distCode[dist] = static_cast<uint8_t>(code);
+			}
+		}
+	}
+};
+
+const CodeTables& GetCodeTables ()
+{
+	static const CodeTables tables;
+	return tables;
+}
+
+inline uint32_t Hash3 (const uint8_t* p)
+{
+	return ((static_cast<uint32_t>(p[0]) << 10) ^ (static_cast<uint32_t>(p[1]) << 5) ^ p[2]) & ((1u << HashBits) - 1);
+}
+
+// Длины кодов Хаффмана, ограниченные maxBits. Если дерево вышло глубже —
+// сглаживаем частоты и строим заново (дерево остаётся полным, как требует inflate).
+void BuildCodeLengths (const uint32_t* freq, int count, int maxBits, uint8_t* lengths)
+{
+	std::vector<uint32_t> weights(freq, freq + count);
+	std::fill(lengths, lengths + count, uint8_t(0));
+
+	struct Node {
+		uint64_t	weight;
+		int			left;
+		int			right;
+	};
+
+	for (;;) {
+		std::vector<Node> nodes;
+		nodes.reserve(2 * count);
+		typedef std::pair<uint64_t, int> Item;
+		std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+		for (int symbol = 0; symbol < count; ++symbol) {
+			if (weights[symbol] > 0) {
+				queue.push(Item(weights[symbol], static_cast<int>(nodes.size())));
+				nodes.push_back({ weights[symbol], -1, symbol });
+			}
+		}
+		if (nodes.empty()) {
+			return;
+		}
+		if (nodes.size() == 1) {
+			lengths[nodes[0].right] = 1;
+			return;
+		}
+
+		while (queue.size() > 1) {
+			const Item a = queue.top(); queue.pop();
+			const Item b = queue.top(); queue.pop();
+			queue.push(Item(a.first + b.first, static_cast<int>(nodes.size())));
+			nodes.push_back({ a.first + b.first, a.second, b.second });
+		}
+
+		// Обход от корня: у листьев left == -1, а right хранит символ
+		int maxDepth = 0;
+		std::vector<std::pair<int, int>> stack;
+		stack.push_back(std::make_pair(queue.top().second, 0));
+		while (!stack.empty()) {
+			const std::pair<int, int> item = stack.back();
+			stack.pop_back();
+			const Node& node = nodes[item.first];
+			if (node.left < 0) {
+				lengths[node.right] = static_cast<uint8_t>(std::min(item.second, 255));
+				maxDepth = std::max(maxDepth, item.second);
+			} else {
+				stack.push_back(std::make_pair(node.left, item.second + 1));
+				stack.push_back(std::make_pair(node.right, item.second + 1));
+			}
+		}
+		if (maxDepth <= maxBits) {
+			return;
+		}
+
+		for (uint32_t& weight : weights) {
+			if (weight > 0) {
+				weight = (weight >> 1) | 1;
+			}
+		}
+	}
+}
+
+// Канонические коды по длинам; биты развёрнуты, т.к. поток пишется младшим битом вперёд
+void BuildCodes (const uint8_t* lengths, int count, uint16_t* codes)
+{
+	uint16_t lengthCount[16] = {};
+	for (int i = 0; i < count; ++i) {
+		lengthCount[lengths[i]]++;
+	}
+	lengthCount[0] = 0;
+
+	uint16_t nextCode[16] = {};
+	uint16_t code = 0;
+	for (int bits = 1; bits < 16; ++bits) {
+		code = static_cast<uint16_t>((code + lengthCount[bits - 1]) << 1);
+		nextCode[bits] = code;
+	}
+
+	for (int i = 0; i < count; ++i) {
+		const int length = lengths[i];
+		if (length == 0) {
+			codes[i] = 0;
+			continue;
+		}
+		uint16_t value = nextCode[length]++;
+		uint16_t reversed = 0;
+		for (int bit = 0; bit < length; ++bit) {
+			reversed = static_cast<uint16_t>((reversed << 1) | (value & 1));
+			value >>= 1;
+		}
+		codes[i] = reversed;
+	}
+}
+
+// inflate не принимает неполные наборы кодов, поэтому используем минимум два символа
+void EnsureTwoSymbols (uint32_t* freq, int count)
+{
+	int used = 0;
+	for (int i = 0; i < count && used < 2; ++i) {
+		if (freq[i] > 0) {
+			++used;
+		}
+	}
+	for (int i = 0; i < count && used < 2; ++i) {
+		if (freq[i] == 0) {
+			freq[i] = 1;
+			++used;
+		}
+	}
+}
+
+} // namespace
+
+DeflateEncoder::DeflateEncoder (int maxChainLength)
+	: m_maxChainLength(std::max(1, maxChainLength))
+	, m_head(size_t(1) << HashBits, -1)
+{
+	m_data.reserve(WindowSize + BlockSize + 4096);
+	m_symbols.reserve(BlockSize);
+}
+
+void DeflateEncoder::Write (const void* data, size_t size)
+{
+	if (m_finished) {
+		return;
+	}
+
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	while (size > 0) {
+		const size_t pending = m_data.size() - m_historyLength;
+		const size_t chunk = std::min(size, BlockSize - pending);
+		m_data.insert(m_data.end(), bytes, bytes + chunk);
+		bytes += chunk;
+		size -= chunk;
+
+		if (m_data.size() - m_historyLength >= BlockSize) {
+			CompressBlock(BlockSize, false);
+		}
+	}
+}
+
+void DeflateEncoder::Flush ()
+{
+	if (m_finished) {
+		return;
+	}
+	CompressPending(false);
+	EmitEmptyStoredBlock(false);
+}
+
+void DeflateEncoder::Finish ()
+{
+	if (m_finished) {
+		return;
+	}
+	CompressPending(true);
+	AlignToByte();
+	m_finished = true;
+}
+
+std::string DeflateEncoder::TakeOutput ()
+{
+	std::string result;
+	result.swap(m_out);
+	return result;
+}
+
+void DeflateEncoder::CompressPending (bool final)
+{
+	const size_t pending = m_data.size() - m_historyLength;
+	if (pending > 0) {
+		CompressBlock(pending, final);
+	} else if (final) {
+		EmitEmptyStoredBlock(true);
+	}
+}
+
+void DeflateEncoder::InsertUpTo (size_t position, size_t blockEnd)
+{
+	while (m_nextInsert <= position && m_nextInsert + MinMatch <= blockEnd) {
+		const uint32_t hash = Hash3(&m_data[m_nextInsert]);
+		m_prev[m_nextInsert] = m_head[hash];
+		m_head[hash] = static_cast<int32_t>(m_nextInsert);
+		++m_nextInsert;
+	}
+}
+
+void DeflateEncoder::FindMatch (size_t position, size_t blockEnd, size_t& length, size_t& distance) const
+{
+	length = 0;
+	distance = 0;
+	if (position + MinMatch > blockEnd) {
+		return;
+	}
+
+	const size_t maxLength = std::min(MaxMatch, blockEnd - position);
+	const uint8_t* current = &m_data[position];
+	int chain = m_maxChainLength;
+	int32_t candidate = m_head[Hash3(current)];
+
+	while (candidate >= 0 && chain-- > 0) {
+		const size_t candidatePos = static_cast<size_t>(candidate);
+		if (position - candidatePos > WindowSize) {
+			break;
+		}
+		const uint8_t* previous = &m_data[candidatePos];
+		if (previous[length] == current[length] && previous[0] == current[0]) {
+			size_t matched = 0;
+			while (matched < maxLength && previous[matched] == current[matched]) {
+				++matched;
+			}
+			if (matched > length) {
+				length = matched;
+				distance = position - candidatePos;
+				if (matched == maxLength) {
+					break;
+				}
+			}
+		}
+		candidate = m_prev[candidatePos];
+	}
+
+	if (length < MinMatch) {
+		length = 0;
+		distance = 0;
+	}
+}
+
+// ---------------- Сжатие блока ----------------
+void DeflateEncoder::CompressBlock (size_t blockLength, bool final)
+{
+	const size_t blockStart = m_historyLength;
+	const size_t blockEnd = blockStart + blockLength;
+
+	// Хеш-цепочки пересобираются на каждый блок: сначала история, потом сам блок
+	std::fill(m_head.begin(), m_head.end(), -1);
+	m_prev.assign(blockEnd, -1);
+	m_nextInsert = 0;
+
+	m_symbols.clear();
+	size_t position = blockStart;
+	while (position < blockEnd) {
+		if (position > 0) {
+			InsertUpTo(position - 1, blockEnd);
+		}
+
+		size_t length = 0;
+		size_t distance = 0;
+		FindMatch(position, blockEnd, length, distance);
+
+		if (length >= MinMatch && length < LazyLimit && position + 1 < blockEnd) {
+			// Ленивое сопоставление: если со следующего байта совпадение длиннее, отдаём литерал
+			InsertUpTo(position, blockEnd);
+			size_t nextLength = 0;
+			size_t nextDistance = 0;
+			FindMatch(position + 1, blockEnd, nextLength, nextDistance);
+			if (nextLength > length) {
+				length = 0;
+			}
+		}
+
+		if (length >= MinMatch) {
+			m_symbols.push_back({ static_cast<uint16_t>(length), static_cast<uint16_t>(distance) });
+			position += length;
+		} else {
+			m_symbols.push_back({ m_data[position], 0 });
+			++position;
+		}
+	}
+
+	EmitDynamicBlock(m_symbols, final);
+
+	// Оставляем последние 32 КБ как словарь для следующего блока
+	const size_t keep = std::min(WindowSize, blockEnd);
+	m_data.erase(m_data.begin(), m_data.begin() + static_cast<std::ptrdiff_t>(blockEnd - keep));
+	m_historyLength = keep;
+}
+
+void DeflateEncoder::EmitDynamicBlock (const std::vector<Symbol>& symbols, bool final)
+{
+	const CodeTables& tables = GetCodeTables();
+
+	uint32_t litFreq[LitLenCodes] = {};
+	uint32_t distFreq[DistCodes] = {};
+	size_t rawLength = 0;
+	for (const Symbol& symbol : symbols) {
+		if (symbol.dist == 0) {
+			litFreq[symbol.litLen]++;
+			rawLength += 1;
+		} else {
+			litFreq[257 + tables.lengthCode[symbol.litLen]]++;
+			distFreq[tables.distCode[symbol.dist]]++;
+			rawLength += symbol.litLen;
+		}
+	}
+	litFreq[EndOfBlock] = 1;
+	EnsureTwoSymbols(litFreq, LitLenCodes);
+	EnsureTwoSymbols(distFreq, DistCodes);
+
+	uint8_t litLengths[LitLenCodes];
+	uint8_t distLengths[DistCodes];
+	BuildCodeLengths(litFreq, LitLenCodes, 15, litLengths);
+	BuildCodeLengths(distFreq, DistCodes, 15, distLengths);
+
+	int litCount = LitLenCodes;
+	while (litCount > 257 && litLengths[litCount - 1] == 0) {
+		--litCount;
+	}
+	int distCount = DistCodes;
+	while (distCount > 1 && distLengths[distCount - 1] == 0) {
+		--distCount;
+	}
+
+	// Длины обоих алфавитов подряд, сжатые RLE-кодами 16/17/18
+	std::vector<uint8_t> allLengths(litLengths, litLengths + litCount);
+	allLengths.insert(allLengths.end(), distLengths, distLengths + distCount);
+
+	struct RunCode {
+		uint8_t symbol;
+		uint8_t extra;
+	};
+	std::vector<RunCode> runs;
+	uint32_t clFreq[CodeLengthCodes] = {};
+	for (size_t i = 0; i < allLengths.size();) {
+		const uint8_t value = allLengths[i];
+		size_t run = 1;
+		while (i + run < allLengths.size() && allLengths[i + run] == value) {
+			++run;
+		}
+
+		size_t left = run;
+		if (value == 0) {
+			while (left >= 11) {
+				const size_t n = std::min<size_t>(left, 138);
+				runs.push_back({ 18, static_cast<uint8_t>(n - 11) });
+				left -= n;
+			}
+			if (left >= 3) {
+				runs.push_back({ 17, static_cast<uint8_t>(left - 3) });
+				left = 0;
+			}
+		} else {
+			runs.push_back({ value, 0 });
+			--left;
+			while (left >= 3) {
+				const size_t n = std::min<size_t>(left, 6);
+				runs.push_back({ 16, static_cast<uint8_t>(n - 3) });
+				left -= n;
+			}
+		}
+		while (left > 0) {
+			runs.push_back({ value, 0 });
+			--left;
+		}
+		i += run;
+	}
+	for (const RunCode& code : runs) {
+		clFreq[code.symbol]++;
+	}
+	EnsureTwoSymbols(clFreq, CodeLengthCodes);
+
+	uint8_t clLengths[CodeLengthCodes];
+	BuildCodeLengths(clFreq, CodeLengthCodes, 7, clLengths);
+	int clCount = CodeLengthCodes;
+	while (clCount > 4 && clLengths[CodeLengthOrder[clCount - 1]] == 0) {
+		--clCount;
+	}
+
+	// Оценка размера: если динамический блок не выигрывает у stored — пишем как есть
+	uint64_t dynamicBits = 3 + 5 + 5 + 4 + 3 * static_cast<uint64_t>(clCount);
+	for (const RunCode& code : runs) {
+		dynamicBits += clLengths[code.symbol];
+		dynamicBits += (code.symbol == 16) ? 2 : (code.symbol == 17) ? 3 : (code.symbol == 18) ? 7 : 0;
+	}
+	for (int i = 0; i < LitLenCodes; ++i) {
+		if (i > EndOfBlock && litFreq[i] > 0) {
+			dynamicBits += static_cast<uint64_t>(litFreq[i]) * (litLengths[i] + LengthExtra[i - 257]);
+		} else {
+			dynamicBits += static_cast<uint64_t>(litFreq[i]) * litLengths[i];
+		}
+	}
+	for (int i = 0; i < DistCodes; ++i) {
+		dynamicBits += static_cast<uint64_t>(distFreq[i]) * (distLengths[i] + DistExtra[i]);
+	}
+	const uint64_t storedBits = (rawLength + 5 * (rawLength / 65535 + 1)) * 8 + 8;
+	if (storedBits < dynamicBits) {
+		EmitStoredBlocks(&m_data[m_historyLength], rawLength, final);
+		return;
+	}
+
+	uint16_t litCodes[LitLenCodes];
+	uint16_t distCodes[DistCodes];
+	uint16_t clCodes[CodeLengthCodes];
+	BuildCodes(litLengths, LitLenCodes, litCodes);
+	BuildCodes(distLengths, DistCodes, distCodes);
+	BuildCodes(clLengths, CodeLengthCodes, clCodes);
+
+	PutBits(final ? 1 : 0, 1);
+	PutBits(2, 2);
+	PutBits(static_cast<uint32_t>(litCount - 257), 5);
+	PutBits(static_cast<uint32_t>(distCount - 1), 5);
+	PutBits(static_cast<uint32_t>(clCount - 4), 4);
+	for (int i = 0; i < clCount; ++i) {
+		PutBits(clLengths[CodeLengthOrder[i]], 3);
+	}
+	for (const RunCode& code : runs) {
+		PutBits(clCodes[code.symbol], clLengths[code.symbol]);
+		if (code.symbol == 16) {
+			PutBits(code.extra, 2);
+		} else if (code.symbol == 17) {
+			PutBits(code.extra, 3);
+		} else if (code.symbol == 18) {
+			PutBits(code.extra, 7);
+		}
+	}
+
+	for (const Symbol& symbol : symbols) {
+		if (symbol.dist == 0) {
+			PutBits(litCodes[symbol.litLen], litLengths[symbol.litLen]);
+			continue;
+		}
+		const int lengthCode = tables.lengthCode[symbol.litLen];
+		PutBits(litCodes[257 + lengthCode], litLengths[257 + lengthCode]);
+		if (LengthExtra[lengthCode] > 0) {
+			PutBits(symbol.litLen - LengthBase[lengthCode], LengthExtra[lengthCode]);
+		}
+		const int distCode = tables.distCode[symbol.dist];
+		PutBits(distCodes[distCode], distLengths[distCode]);
+		if (DistExtra[distCode] > 0) {
+			PutBits(symbol.dist - DistBase[distCode], DistExtra[distCode]);
+		}
+	}
+	PutBits(litCodes[EndOfBlock], litLengths[EndOfBlock]);
+}
+
+void DeflateEncoder::EmitStoredBlocks (const uint8_t* data, size_t length, bool final)
+{
+	do {
+		const size_t chunk = std::min<size_t>(length, 65535);
+		const bool last = final && chunk == length;
+		PutBits(last ? 1 : 0, 1);
+		PutBits(0, 2);
+		AlignToByte();
+		PutBits(static_cast<uint32_t>(chunk), 16);
+		PutBits(static_cast<uint32_t>(~chunk & 0xFFFF), 16);
+		if (chunk > 0) {
+			m_out.append(reinterpret_cast<const char*>(data), chunk);
+			data += chunk;
+		}
+		length -= chunk;
+	} while (length > 0);
+}
+
+void DeflateEncoder::EmitEmptyStoredBlock (bool final)
+{
+	EmitStoredBlocks(nullptr, 0, final);
+}
+
+// ---------------- Битовый вывод ----------------
+void DeflateEncoder::PutBits (uint32_t value, int count)
+{
+	m_bitBuffer |= static_cast<uint64_t>(value) << m_bitCount;
+	m_bitCount += count;
+	while (m_bitCount >= 8) {
+		m_out.push_back(static_cast<char>(m_bitBuffer & 0xFF));
+		m_bitBuffer >>= 8;
+		m_bitCount -= 8;
+	}
+}
+
+void DeflateEncoder::AlignToByte ()
+{
+	if (m_bitCount > 0) {
+		m_out.push_back(static_cast<char>(m_bitBuffer & 0xFF));
+	}
+	m_bitBuffer = 0;
+	m_bitCount = 0;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Потоковый компрессор deflate (RFC 1951) без внешних зависимостей:
+// LZ77 с хеш-цепочками по окну 32 КБ и динамическими кодами Хаффмана на каждый блок.
+// Вход копится до размера блока, поэтому память ограничена окном и одним блоком.
+class DeflateEncoder
+{
+public:
+	explicit DeflateEncoder (int maxChainLength = 32);
+
+	void		Write (const void* data, size_t size);
+
+	// Сжать накопленное и выровнять поток по байту (sync flush, блок не последний)
+	void		Flush ();
+
+	// Сжать накопленное и закрыть поток последним блоком
+	void		Finish ();
+
+	// Забрать готовые сжатые байты
+	std::string	TakeOutput ();
+	size_t		GetOutputSize () const { return m_out.size(); }
+
+private:
+	struct Symbol {
+		uint16_t	litLen;		// литерал (dist == 0) или длина совпадения
+		uint16_t	dist;
+	};
+
+	void		CompressPending (bool final);
+	void		CompressBlock (size_t blockLength, bool final);
+	void		InsertUpTo (size_t position, size_t blockEnd);
+	void		FindMatch (size_t position, size_t blockEnd, size_t& length, size_t& distance) const;
+
+	void		EmitDynamicBlock (const std::vector<Symbol>& symbols, bool final);
+	void		EmitStoredBlocks (const uint8_t* data, size_t length, bool final);
+	void		EmitEmptyStoredBlock (bool final);
+
+	void		PutBits (uint32_t value, int count);
+	void		AlignToByte ();
+
+	int						m_maxChainLength;
+	std::vector<uint8_t>	m_data;			// история (до 32 КБ) + ещё не сжатый вход
+	size_t					m_historyLength = 0;
+
+	std::vector<int32_t>	m_head;
+	std::vector<int32_t>	m_prev;
+	size_t					m_nextInsert = 0;
+
+	std::vector<Symbol>		m_symbols;
+	std::string				m_out;
+	uint64_t				m_bitBuffer = 0;
+	int						m_bitCount = 0;
+	bool					m_finished = false;
+};
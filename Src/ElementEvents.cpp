@@ -0,0 +1,106 @@
+#include "ElementEvents.hpp"
+
+namespace ElementEvents {
+
+struct Subscriber {
+    ChangeListener onChange = nullptr;
+    BatchListener  onBatchEnd = nullptr;
+};
+
+static GS::Array<Subscriber> subscribers;
+static bool                  installed = false;
+static bool                  modelObserved = false;
+
+static void Dispatch(Change change, const API_Guid& guid)
+{
+    for (const Subscriber& subscriber : subscribers) {
+        subscriber.onChange(change, guid);
+    }
+}
+
+static GSErrCode ElementEventHandler(const API_NotifyElementType* notification)
+{
+    if (notification == nullptr) {
+        return NoError;
+    }
+
+    const API_Guid& guid = notification->elemHead.guid;
+    switch (notification->notifID) {
+        case APINotifyElement_New:
+        case APINotifyElement_Copy:
+            // Изменения и удаление приходят только для элементов с наблюдателем
+            ACAPI_Element_AttachObserver(guid);
+            Dispatch(Change::Added, guid);
+            break;
+
+        case APINotifyElement_Delete:
+        case APINotifyElement_Undo_Created:
+        case APINotifyElement_Redo_Deleted:
+            Dispatch(Change::Removed, guid);
+            break;
+
+        case APINotifyElement_Undo_Deleted:
+        case APINotifyElement_Redo_Created:
+            Dispatch(Change::Added, guid);
+            break;
+
+        case APINotifyElement_BeginEvents:
+            break;
+
+        case APINotifyElement_EndEvents:
+            for (const Subscriber& subscriber : subscribers) {
+                if (subscriber.onBatchEnd != nullptr) {
+                    subscriber.onBatchEnd();
+                }
+            }
+            break;
+
+        default:
+            // Изменение, Undo/Redo изменения и т.п. — подписчики перечитают элемент
+            if (guid != APINULLGuid) {
+                Dispatch(Change::Modified, guid);
+            }
+            break;
+    }
+    return NoError;
+}
+
+void Subscribe(ChangeListener onChange, BatchListener onBatchEnd)
+{
+    if (onChange == nullptr) {
+        return;
+    }
+    for (const Subscriber& subscriber : subscribers) {
+        if (subscriber.onChange == onChange) {
+            return;
+        }
+    }
+    Subscriber subscriber;
+    subscriber.onChange = onChange;
+    subscriber.onBatchEnd = onBatchEnd;
+    subscribers.Push(subscriber);
+
+    if (!installed) {
+        installed = true;
+        ACAPI_Element_InstallElementObserver(ElementEventHandler);
+        ACAPI_Notification_CatchNewElement(nullptr, ElementEventHandler);
+    }
+}
+
+void ObserveModel(const GS::Array<API_Guid>& elements)
+{
+    if (modelObserved) {
+        return;
+    }
+    modelObserved = true;
+    for (const API_Guid& guid : elements) {
+        ACAPI_Element_AttachObserver(guid);
+    }
+}
+
+void Reset()
+{
+    modelObserved = false;
+}
+
+} // namespace ElementEvents
@@ -0,0 +1,30 @@
+#ifndef ELEMENTEVENTS_HPP
+#define ELEMENTEVENTS_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+// Общая подписка на уведомления об элементах для модулей, которые держат свои индексы
+// по всей модели (счётчики слоёв, индекс ID). Обработчик в Archicad один на аддон,
+// поэтому события раздаются отсюда всем подписчикам.
+namespace ElementEvents {
+
+    enum class Change { Added, Modified, Removed };
+
+    using ChangeListener = void (*)(Change change, const API_Guid& guid);
+    using BatchListener = void (*)();     // конец пакета событий (одна команда пользователя)
+
+    // Подписаться; повторная подписка того же обработчика ничего не делает
+    void Subscribe(ChangeListener onChange, BatchListener onBatchEnd = nullptr);
+
+    // Повесить наблюдателей на элементы модели, чтобы приходили изменения и удаления.
+    // Достаточно одного раза за проект — повторный вызов ничего не делает
+    void ObserveModel(const GS::Array<API_Guid>& elements);
+
+    // Проект сменился — при следующем ObserveModel наблюдатели вешаются заново
+    void Reset();
+
+} // namespace ElementEvents
+
+#endif // ELEMENTEVENTS_HPP
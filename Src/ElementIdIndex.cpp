@@ -0,0 +1,270 @@
+#include "ElementIdIndex.hpp"
+#include "ElementEvents.hpp"
+
+namespace ElementIdIndex {
+
+static const USize MaxNumberDigits = 9;      // длиннее — не номер, а часть ID
+
+struct IndexState {
+    GS::HashTable<API_Guid, GS::UniString>                       idByGuid;
+    GS::HashTable<GS::UniString, GS::Array<API_Guid>>            guidsById;
+    // ID с несколькими элементами: список для выдачи и позиции для удаления за O(1)
+    GS::Array<GS::UniString>                                     duplicateIds;
+    GS::HashTable<GS::UniString, UIndex>                         duplicatePositions;
+    // Основа ID -> номер -> сколько элементов с ним
+    GS::HashTable<GS::UniString, GS::HashTable<Int32, UInt32>>   numbersByStem;
+    bool                                                         built = false;
+};
+
+static IndexState state;
+
+// "Сосна-07" -> "Сосна-", 7
+static bool SplitNumber(const GS::UniString& id, GS::UniString& stem, Int32& number)
+{
+    UIndex digitsStart = id.GetLength();
+    while (digitsStart > 0 && id.GetLength() - digitsStart < MaxNumberDigits) {
+        const GS::UniChar c = id[digitsStart - 1];
+        if (c < GS::UniChar('0') || c > GS::UniChar('9')) {
+            break;
+        }
+        --digitsStart;
+    }
+    if (digitsStart == id.GetLength()) {
+        return false;
+    }
+    stem = id.GetSubstring(0, digitsStart);
+    const GS::UniString digits = id.GetSubstring(digitsStart, id.GetLength() - digitsStart);
+    number = 0;
+    for (const char c : std::string(digits.ToCStr().Get())) {
+        number = number * 10 + (c - '0');
+    }
+    return true;
+}
+
+// ---------------- Дубликаты ----------------
+static void AddDuplicate(const GS::UniString& id)
+{
+    if (state.duplicatePositions.ContainsKey(id)) {
+        return;
+    }
+    state.duplicatePositions.Add(id, state.duplicateIds.GetSize());
+    state.duplicateIds.Push(id);
+}
+
+static void RemoveDuplicate(const GS::UniString& id)
+{
+    UIndex position = 0;
+    if (!state.duplicatePositions.Get(id, &position)) {
+        return;
+    }
+    // Последний ID — на место удаляемого
+    const UIndex last = state.duplicateIds.GetSize() - 1;
+    if (position != last) {
+        state.duplicateIds[position] = state.duplicateIds[last];
+        state.duplicatePositions.Put(state.duplicateIds[position], position);
+    }
+    state.duplicateIds.Delete(last);
+    state.duplicatePositions.Delete(id);
+}
+
+// ---------------- Учёт ID ----------------
+static void AddId(const API_Guid& guid, const GS::UniString& id)
+{
+    if (GS::Array<API_Guid>* guids = state.guidsById.GetPtr(id)) {
+        guids->Push(guid);
+        if (guids->GetSize() == 2) {
+            AddDuplicate(id);
+        }
+    } else {
+        GS::Array<API_Guid> single;
+        single.Push(guid);
+        state.guidsById.Add(id, single);
+    }
+
+    GS::UniString stem;
+    Int32 number = 0;
+    if (SplitNumber(id, stem, number)) {
+        GS::HashTable<Int32, UInt32>* numbers = state.numbersByStem.GetPtr(stem);
+        if (numbers == nullptr) {
+            state.numbersByStem.Add(stem, GS::HashTable<Int32, UInt32>());
+            numbers = state.numbersByStem.GetPtr(stem);
+        }
+        if (UInt32* uses = numbers->GetPtr(number)) {
+            ++*uses;
+        } else {
+            numbers->Add(number, 1);
+        }
+    }
+}
+
+static void RemoveId(const API_Guid& guid, const GS::UniString& id)
+{
+    if (GS::Array<API_Guid>* guids = state.guidsById.GetPtr(id)) {
+        for (UIndex i = 0; i < guids->GetSize(); ++i) {
+            if ((*guids)[i] == guid) {
+                guids->Delete(i);
+                break;
+            }
+        }
+        if (guids->GetSize() == 1) {
+            RemoveDuplicate(id);
+        } else if (guids->IsEmpty()) {
+            state.guidsById.Delete(id);
+        }
+    }
+
+    GS::UniString stem;
+    Int32 number = 0;
+    if (SplitNumber(id, stem, number)) {
+        if (GS::HashTable<Int32, UInt32>* numbers = state.numbersByStem.GetPtr(stem)) {
+            UInt32* uses = numbers->GetPtr(number);
+            if (uses != nullptr && --*uses == 0) {
+                numbers->Delete(number);
+            }
+        }
+    }
+}
+
+static void PutElement(const API_Guid& guid, const GS::UniString& id)
+{
+    if (const GS::UniString* old = state.idByGuid.GetPtr(guid)) {
+        if (*old == id) {
+            return;
+        }
+        const GS::UniString oldId = *old;
+        RemoveId(guid, oldId);
+    }
+    if (id.IsEmpty()) {
+        state.idByGuid.Delete(guid);
+        return;
+    }
+    state.idByGuid.Put(guid, id);
+    AddId(guid, id);
+}
+
+static void RemoveElement(const API_Guid& guid)
+{
+    GS::UniString id;
+    if (!state.idByGuid.Get(guid, &id)) {
+        return;
+    }
+    RemoveId(guid, id);
+    state.idByGuid.Delete(guid);
+}
+
+// ---------------- Уведомления ----------------
+static void OnElementChange(ElementEvents::Change change, const API_Guid& guid)
+{
+    if (!state.built) {
+        return;
+    }
+    GS::UniString id;
+    if (change == ElementEvents::Change::Removed ||
+        ACAPI_Element_GetElementInfoString(&guid, &id) != NoError) {
+        RemoveElement(guid);
+    } else {
+        PutElement(guid, id);
+    }
+}
+
+// ---------------- Проход по модели ----------------
+static void EnsureBuilt()
+{
+    if (state.built) {
+        return;
+    }
+    ElementEvents::Subscribe(OnElementChange);
+
+    GS::Array<API_Guid> elements;
+    ACAPI_Element_GetElemList(API_ZombieElemID, &elements);
+    for (const API_Guid& guid : elements) {
+        GS::UniString id;
+        if (ACAPI_Element_GetElementInfoString(&guid, &id) == NoError) {
+            PutElement(guid, id);
+        }
+    }
+    ElementEvents::ObserveModel(elements);
+    state.built = true;
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport(GS::UniString::Printf("[ElementIdIndex] ID: %u, повторяющихся: %u",
+        (unsigned)state.guidsById.GetSize(), (unsigned)state.duplicateIds.GetSize()), false);
+#endif
+}
+
+void Invalidate()
+{
+    state = IndexState();
+}
+
+void NoteIdChanged(const API_Guid& guid, const GS::UniString& newId)
+{
+    if (state.built) {
+        PutElement(guid, newId);
+    }
+}
+
+// ---------------- Запросы ----------------
+GS::Array<API_Guid> FindById(const GS::UniString& id)
+{
+    EnsureBuilt();
+    GS::Array<API_Guid> guids;
+    state.guidsById.Get(id, &guids);
+    return guids;
+}
+
+void ForEachId(const IdVisitor& visitor)
+{
+    EnsureBuilt();
+    for (const auto& [id, guids] : state.guidsById) {
+        visitor(id, guids);
+    }
+}
+
+UInt32 GetUseCount(const GS::UniString& id)
+{
+    EnsureBuilt();
+    const GS::Array<API_Guid>* guids = state.guidsById.GetPtr(id);
+    return (guids != nullptr) ? guids->GetSize() : 0;
+}
+
+bool IsTakenByOthers(const GS::UniString& id, const GS::HashTable<API_Guid, bool>& batch)
+{
+    EnsureBuilt();
+    if (const GS::Array<API_Guid>* guids = state.guidsById.GetPtr(id)) {
+        for (const API_Guid& guid : *guids) {
+            if (!batch.ContainsKey(guid)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+GS::Array<DuplicateGroup> GetDuplicates()
+{
+    EnsureBuilt();
+    GS::Array<DuplicateGroup> result;
+    result.SetCapacity(state.duplicateIds.GetSize());
+    for (const GS::UniString& id : state.duplicateIds) {
+        DuplicateGroup group;
+        group.id = id;
+        state.guidsById.Get(id, &group.guids);
+        result.Push(group);
+    }
+    return result;
+}
+
+Int32 GetNextFreeNumber(const GS::UniString& prefix, Int32 start)
+{
+    EnsureBuilt();
+    Int32 number = (start > 0) ? start : 0;
+    if (const GS::HashTable<Int32, UInt32>* numbers = state.numbersByStem.GetPtr(prefix)) {
+        while (numbers->ContainsKey(number)) {
+            ++number;
+        }
+    }
+    return number;
+}
+
+} // namespace ElementIdIndex
@@ -0,0 +1,47 @@
+#ifndef ELEMENTIDINDEX_HPP
+#define ELEMENTIDINDEX_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+#include <functional>
+
+// Индекс ID -> GUID по всей модели. Строится одним проходом при первом запросе,
+// дальше поддерживается по уведомлениям об элементах (ElementEvents) без пересчёта.
+// Для ID с числом в конце ("Сосна-07") помнит занятые номера по основе ("Сосна-").
+namespace ElementIdIndex {
+
+    // Элементы с данным ID
+    GS::Array<API_Guid> FindById(const GS::UniString& id);
+
+    // Обойти все ID индекса с их элементами (поиск по шаблону без прохода по модели)
+    using IdVisitor = std::function<void (const GS::UniString& id, const GS::Array<API_Guid>& guids)>;
+    void ForEachId(const IdVisitor& visitor);
+
+    // Сколько элементов носят ID — O(1)
+    UInt32 GetUseCount(const GS::UniString& id);
+
+    // ID занят элементом не из набора batch — O(1) на проверку
+    bool IsTakenByOthers(const GS::UniString& id, const GS::HashTable<API_Guid, bool>& batch);
+
+    struct DuplicateGroup {
+        GS::UniString        id;
+        GS::Array<API_Guid>  guids;
+    };
+
+    // Все ID, которые носят несколько элементов
+    GS::Array<DuplicateGroup> GetDuplicates();
+
+    // Наименьший свободный номер не меньше start для основы: "Сосна-" -> 8, если 1–7 заняты
+    Int32 GetNextFreeNumber(const GS::UniString& prefix, Int32 start = 1);
+
+    // ID изменён аддоном — обновить индекс сразу, не дожидаясь уведомления
+    void NoteIdChanged(const API_Guid& guid, const GS::UniString& newId);
+
+    // Забыть индекс (другой проект); следующий запрос пройдёт по модели заново
+    void Invalidate();
+
+} // namespace ElementIdIndex
+
+#endif // ELEMENTIDINDEX_HPP
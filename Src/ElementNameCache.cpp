@@ -0,0 +1,30 @@
+#include "ElementNameCache.hpp"
+
+// ---------------- Имя типа элемента ----------------
+const GS::UniString& ElementNameCache::GetTypeName (const API_ElemType& type)
+{
+    const UInt64 key = (static_cast<UInt64>(type.typeID) << 32) | static_cast<UInt64>(type.variationID);
+    if (!typeNames.ContainsKey(key)) {
+        GS::UniString typeName;
+        ACAPI_Element_GetElemTypeName(type, typeName);
+        typeNames.Add(key, typeName);
+    }
+    return typeNames[key];
+}
+
+// ---------------- Имя слоя по индексу ----------------
+const GS::UniString& ElementNameCache::GetLayerName (API_AttributeIndex layerIndex)
+{
+    const Int32 key = layerIndex.ToInt32_Deprecated();
+    if (!layerNames.ContainsKey(key)) {
+        GS::UniString layerName;
+        API_Attribute layerAttr = {};
+        layerAttr.header.typeID = API_LayerID;
+        layerAttr.header.index = layerIndex;
+        if (ACAPI_Attribute_Get(&layerAttr) == NoError) {
+            layerName = layerAttr.header.name;
+        }
+        layerNames.Add(key, layerName);
+    }
+    return layerNames[key];
+}
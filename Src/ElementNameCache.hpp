@@ -0,0 +1,20 @@
+#ifndef ELEMENTNAMECACHE_HPP
+#define ELEMENTNAMECACHE_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+// Кеш человекочитаемых имён типов и слоёв на время одного прохода по элементам:
+// каждое имя запрашивается у API один раз, а не для каждого элемента.
+class ElementNameCache {
+public:
+    const GS::UniString& GetTypeName (const API_ElemType& type);
+    const GS::UniString& GetLayerName (API_AttributeIndex layerIndex);
+
+private:
+    GS::HashTable<UInt64, GS::UniString> typeNames;
+    GS::HashTable<Int32, GS::UniString>  layerNames;
+};
+
+#endif // ELEMENTNAMECACHE_HPP
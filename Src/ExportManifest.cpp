@@ -0,0 +1,199 @@
+#include "ExportManifest.hpp"
+#include "AddOnPreferences.hpp"
+#include "FileIO.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace SendXlsHelper {
+
+static const UInt32 ManifestMagic = 0x4D535454; // "TTSM"
+static const UInt32 ManifestVersion = 1;
+
+// ---------------- Файл манифеста ----------------
+static GS::UniString GetManifestPath (const GS::UniString& outputPath)
+{
+    return outputPath + ".tscache";
+}
+
+static void PutGuid (std::string& out, const API_Guid& guid)
+{
+    AddOnPreferences::PutBytes(out, std::string(reinterpret_cast<const char*>(&guid), sizeof(API_Guid)));
+}
+
+static void PutDouble (std::string& out, double value)
+{
+    UInt64 bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    AddOnPreferences::PutUInt64(out, bits);
+}
+
+// ---------------- ExportManifest ----------------
+ExportManifest::ExportManifest (const GS::UniString& outputPath, const std::string& signature)
+    : path(GetManifestPath(outputPath))
+    , signature(signature)
+{
+}
+
+bool ExportManifest::Load ()
+{
+    records.Clear();
+    order.Clear();
+
+    std::string data;
+    if (!FileIO::ReadWholeFile(path, data)) {
+        return false;
+    }
+
+    AddOnPreferences::Reader reader(data);
+    UInt32 magic = 0;
+    UInt32 version = 0;
+    std::string storedSignature;
+    UInt32 count = 0;
+    if (!reader.GetUInt32(magic) || magic != ManifestMagic ||
+        !reader.GetUInt32(version) || version != ManifestVersion ||
+        !reader.GetBytes(storedSignature) || storedSignature != signature ||
+        !reader.GetUInt32(count)) {
+        return false;
+    }
+    // Длины из повреждённого файла не должны заказывать память больше, чем осталось данных:
+    // запись — не меньше 36 байт (GUID с длиной, метка, длина ID, число ячеек), ячейка — 16
+    if (count > reader.GetRemaining() / 36) {
+        return false;
+    }
+
+    for (UInt32 i = 0; i < count; ++i) {
+        std::string guidBytes;
+        Record record;
+        UInt32 cellCount = 0;
+        if (!reader.GetBytes(guidBytes) || guidBytes.size() != sizeof(API_Guid) ||
+            !reader.GetUInt64(record.modiStamp) || !reader.GetString(record.elemID) ||
+            !reader.GetUInt32(cellCount)) {
+            records.Clear();
+            order.Clear();
+            return false;
+        }
+        if (cellCount > reader.GetRemaining() / 16) {
+            records.Clear();
+            order.Clear();
+            return false;
+        }
+
+        record.cells.SetSize(cellCount);
+        for (ExportCell& cell : record.cells) {
+            UInt32 isNumber = 0;
+            UInt64 bits = 0;
+            if (!reader.GetUInt32(isNumber) || !reader.GetUInt64(bits) || !reader.GetString(cell.text)) {
+                records.Clear();
+                order.Clear();
+                return false;
+            }
+            cell.isNumber = (isNumber != 0);
+            std::memcpy(&cell.number, &bits, sizeof(bits));
+        }
+
+        API_Guid guid;
+        std::memcpy(&guid, guidBytes.data(), sizeof(API_Guid));
+        if (!records.ContainsKey(guid)) {
+            order.Push(guid);
+        }
+        records.Put(guid, record);
+    }
+    return true;
+}
+
+bool ExportManifest::Save () const
+{
+    std::string out;
+    AddOnPreferences::PutUInt32(out, ManifestMagic);
+    AddOnPreferences::PutUInt32(out, ManifestVersion);
+    AddOnPreferences::PutBytes(out, signature);
+
+    const size_t countOffset = out.size();
+    AddOnPreferences::PutUInt32(out, 0);
+
+    UInt32 count = 0;
+    for (const API_Guid& guid : order) {
+        const Record* record = records.GetPtr(guid);
+        if (record == nullptr || !record->seen) {
+            continue;
+        }
+        PutGuid(out, guid);
+        AddOnPreferences::PutUInt64(out, record->modiStamp);
+        AddOnPreferences::PutString(out, record->elemID);
+        AddOnPreferences::PutUInt32(out, record->cells.GetSize());
+        for (const ExportCell& cell : record->cells) {
+            AddOnPreferences::PutUInt32(out, cell.isNumber ? 1 : 0);
+            PutDouble(out, cell.number);
+            AddOnPreferences::PutString(out, cell.text);
+        }
+        ++count;
+    }
+
+    std::string countBytes;
+    AddOnPreferences::PutUInt32(countBytes, count);
+    out.replace(countOffset, countBytes.size(), countBytes);
+
+    std::FILE* file = FileIO::OpenFile(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool writeOk = (std::fwrite(out.data(), 1, out.size(), file) == out.size());
+    const bool closeOk = (std::fclose(file) == 0);
+    if (!writeOk || !closeOk) {
+        Remove();
+        return false;
+    }
+    return true;
+}
+
+void ExportManifest::Remove () const
+{
+#ifdef GS_WIN
+    _wremove(path.ToUStr().Get());
+#else
+    std::remove(path.ToCStr(0, MaxUSize, CC_UTF8).Get());
+#endif
+}
+
+const ExportManifest::Record* ExportManifest::Find (const API_Guid& guid, UInt64 modiStamp)
+{
+    Record* record = records.GetPtr(guid);
+    if (record == nullptr || record->modiStamp != modiStamp) {
+        return nullptr;
+    }
+    if (!record->seen) {
+        record->seen = true;
+        ++reused;
+    }
+    return record;
+}
+
+void ExportManifest::Put (const API_Guid& guid, UInt64 modiStamp, const GS::UniString& elemID, const GS::Array<ExportCell>& cells)
+{
+    Record record;
+    record.modiStamp = modiStamp;
+    record.elemID = elemID;
+    record.cells = cells;
+    record.seen = true;
+
+    if (!records.ContainsKey(guid)) {
+        order.Push(guid);
+    }
+    records.Put(guid, record);
+    ++pulled;
+}
+
+UInt32 ExportManifest::GetRemovedCount () const
+{
+    UInt32 removed = 0;
+    for (const API_Guid& guid : order) {
+        const Record* record = records.GetPtr(guid);
+        if (record != nullptr && !record->seen) {
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+} // namespace SendXlsHelper
@@ -0,0 +1,55 @@
+#ifndef EXPORTMANIFEST_HPP
+#define EXPORTMANIFEST_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+#include "SendXlsHelper.hpp"
+
+#include <string>
+
+namespace SendXlsHelper {
+
+    // Что уже выгружено в файл: по каждому элементу — modiStamp и прочитанные значения.
+    // Лежит рядом с файлом выгрузки (<файл>.tscache). При повторной выгрузке в тот же файл
+    // значения неизменённых элементов берутся отсюда, из API читаются только изменённые и новые;
+    // удалённые элементы просто не попадают в новый манифест.
+    class ExportManifest {
+    public:
+        struct Record {
+            UInt64                modiStamp = 0;
+            GS::UniString         elemID;
+            GS::Array<ExportCell> cells;       // значения свойств в порядке ElementRowSource
+            bool                  seen = false;
+        };
+
+        // signature — набор читаемых данных (свойства, ID); при несовпадении кэш не используется
+        ExportManifest (const GS::UniString& outputPath, const std::string& signature);
+
+        // Прочитать манифест; false — его нет, он повреждён или от другого набора колонок
+        bool Load ();
+        // Записать манифест только по элементам, встреченным в этой выгрузке
+        bool Save () const;
+        // Удалить манифест (выгрузка не удалась — кэш не должен разойтись с файлом)
+        void Remove () const;
+
+        // Запись элемента, если он не менялся с прошлой выгрузки
+        const Record* Find (const API_Guid& guid, UInt64 modiStamp);
+        void          Put (const API_Guid& guid, UInt64 modiStamp, const GS::UniString& elemID, const GS::Array<ExportCell>& cells);
+
+        UInt32 GetReusedCount () const { return reused; }
+        UInt32 GetPulledCount () const { return pulled; }
+        UInt32 GetRemovedCount () const;
+
+    private:
+        GS::UniString                   path;
+        std::string                     signature;
+        GS::HashTable<API_Guid, Record> records;
+        GS::Array<API_Guid>             order;       // порядок записей в файле
+        UInt32                          reused = 0;
+        UInt32                          pulled = 0;
+    };
+
+} // namespace SendXlsHelper
+
+#endif // EXPORTMANIFEST_HPP
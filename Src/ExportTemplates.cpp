@@ -0,0 +1,246 @@
+#include "ExportTemplates.hpp"
+#include "AddOnPreferences.hpp"
+
+namespace ExportTemplates {
+
+static const char*  SectionTag = "export-templates";
+static const UInt32 FormatVersion = 2; // 2 — добавлен targetPath
+
+static GS::Array<Template>                            templates;
+static bool                                           templatesLoaded = false;
+static GS::HashTable<GS::UniString, CompiledTemplate> compiledCache;
+
+// ---------------- Сериализация ----------------
+static std::string Serialize (const GS::Array<Template>& list)
+{
+    std::string out;
+    AddOnPreferences::PutUInt32(out, FormatVersion);
+    AddOnPreferences::PutUInt32(out, list.GetSize());
+    for (const Template& item : list) {
+        AddOnPreferences::PutString(out, item.name);
+        AddOnPreferences::PutUInt32(out, static_cast<UInt32>(item.format));
+        AddOnPreferences::PutUInt32(out, item.columns.GetSize());
+        for (const ColumnSpec& column : item.columns) {
+            AddOnPreferences::PutString(out, column.token);
+            AddOnPreferences::PutString(out, column.header);
+            AddOnPreferences::PutUInt32(out, static_cast<UInt32>(column.format));
+            AddOnPreferences::PutUInt32(out, static_cast<UInt32>(column.decimals));
+        }
+        AddOnPreferences::PutUInt32(out, item.groupBy.GetSize());
+        for (const GS::UniString& token : item.groupBy) {
+            AddOnPreferences::PutString(out, token);
+        }
+        AddOnPreferences::PutString(out, item.targetPath);
+    }
+    return out;
+}
+
+static bool Deserialize (const std::string& data, GS::Array<Template>& list)
+{
+    AddOnPreferences::Reader reader(data);
+    UInt32 version = 0;
+    UInt32 count = 0;
+    if (!reader.GetUInt32(version) || version < 1 || version > FormatVersion || !reader.GetUInt32(count)) {
+        return false;
+    }
+
+    for (UInt32 i = 0; i < count; ++i) {
+        Template item;
+        UInt32 format = 0;
+        UInt32 columnCount = 0;
+        if (!reader.GetString(item.name) || !reader.GetUInt32(format) || !reader.GetUInt32(columnCount)) {
+            return false;
+        }
+        item.format = (format == static_cast<UInt32>(SendXlsHelper::ExportFormat::Csv))
+            ? SendXlsHelper::ExportFormat::Csv : SendXlsHelper::ExportFormat::Xlsx;
+
+        for (UInt32 c = 0; c < columnCount; ++c) {
+            ColumnSpec column;
+            UInt32 cellFormat = 0;
+            UInt32 decimals = 0;
+            if (!reader.GetString(column.token) || !reader.GetString(column.header) ||
+                !reader.GetUInt32(cellFormat) || !reader.GetUInt32(decimals)) {
+                return false;
+            }
+            column.format = (cellFormat <= static_cast<UInt32>(SendXlsHelper::CellFormat::Text))
+                ? static_cast<SendXlsHelper::CellFormat>(cellFormat) : SendXlsHelper::CellFormat::Auto;
+            column.decimals = (decimals > static_cast<UInt32>(TableWriter::MaxDecimals)) ? TableWriter::MaxDecimals : static_cast<Int32>(decimals);
+            item.columns.Push(column);
+        }
+
+        UInt32 groupCount = 0;
+        if (!reader.GetUInt32(groupCount)) {
+            return false;
+        }
+        for (UInt32 g = 0; g < groupCount; ++g) {
+            GS::UniString token;
+            if (!reader.GetString(token)) {
+                return false;
+            }
+            item.groupBy.Push(token);
+        }
+        if (version >= 2 && !reader.GetString(item.targetPath)) {
+            return false;
+        }
+        list.Push(item);
+    }
+    return true;
+}
+
+static void EnsureLoaded ()
+{
+    if (templatesLoaded) {
+        return;
+    }
+    templatesLoaded = true;
+
+    std::string data;
+    if (AddOnPreferences::ReadSection(SectionTag, data) && !Deserialize(data, templates)) {
+        templates.Clear();
+#ifdef DEBUG_UI_LOGS
+        ACAPI_WriteReport("[ExportTemplates] Не удалось прочитать шаблоны из настроек", false);
+#endif
+    }
+}
+
+static bool Store ()
+{
+    compiledCache.Clear();
+    return AddOnPreferences::WriteSection(SectionTag, Serialize(templates));
+}
+
+// ---------------- Шаблоны ----------------
+const GS::Array<Template>& GetTemplates ()
+{
+    EnsureLoaded();
+    return templates;
+}
+
+bool SaveTemplate (const Template& exportTemplate)
+{
+    EnsureLoaded();
+    if (exportTemplate.name.IsEmpty()) {
+        return false;
+    }
+
+    for (Template& item : templates) {
+        if (item.name == exportTemplate.name) {
+            const GS::UniString targetPath = item.targetPath;
+            item = exportTemplate;
+            if (item.targetPath.IsEmpty()) {
+                item.targetPath = targetPath;
+            }
+            return Store();
+        }
+    }
+    templates.Push(exportTemplate);
+    return Store();
+}
+
+bool DeleteTemplate (const GS::UniString& name)
+{
+    EnsureLoaded();
+    for (UIndex i = 0; i < templates.GetSize(); ++i) {
+        if (templates[i].name == name) {
+            templates.Delete(i);
+            return Store();
+        }
+    }
+    return false;
+}
+
+bool SetTargetPath (const GS::UniString& name, const GS::UniString& path)
+{
+    EnsureLoaded();
+    for (Template& item : templates) {
+        if (item.name != name) {
+            continue;
+        }
+        if (item.targetPath == path) {
+            return true;
+        }
+        item.targetPath = path;
+        // План от пути не зависит — кэш собранных планов не сбрасываем
+        return AddOnPreferences::WriteSection(SectionTag, Serialize(templates));
+    }
+    return false;
+}
+
+// ---------------- Сборка плана ----------------
+static bool Compile (const Template& item, CompiledTemplate& compiled)
+{
+    compiled.format = item.format;
+
+    for (const ColumnSpec& spec : item.columns) {
+        SendXlsHelper::ExportColumn column;
+        if (!SendXlsHelper::ParseColumn(spec.token, column)) {
+            continue;
+        }
+        column.header = spec.header.IsEmpty() ? spec.token : spec.header;
+        column.formatter = SendXlsHelper::GetCellFormatter(spec.format);
+        column.decimals = spec.decimals;
+        compiled.columns.Push(column);
+    }
+
+    // Сводная: ключи — колонки группировки, суммы — остальные колонки свойств шаблона
+    GS::HashTable<API_Guid, bool> groupedProperties;
+    for (const GS::UniString& token : item.groupBy) {
+        SelectionGroupHelper::Column column;
+        if (!SelectionGroupHelper::ParseColumn(token, column)) {
+            continue;
+        }
+        GS::UniString header = token;
+        for (const ColumnSpec& spec : item.columns) {
+            if (spec.token.IsEqual(token, GS::CaseInsensitive) && !spec.header.IsEmpty()) {
+                header = spec.header;
+                break;
+            }
+        }
+        if (column.kind == SelectionGroupHelper::Column::Property) {
+            groupedProperties.Put(column.propertyGuid, true);
+        }
+        compiled.groups.groupBy.Push(column);
+        compiled.groups.groupHeaders.Push(header);
+    }
+    compiled.grouped = !compiled.groups.groupBy.IsEmpty();
+
+    if (compiled.grouped) {
+        for (const SendXlsHelper::ExportColumn& column : compiled.columns) {
+            if (column.kind != SendXlsHelper::ExportColumn::Property || groupedProperties.ContainsKey(column.propertyGuid)) {
+                continue;
+            }
+            SelectionGroupHelper::Column aggregate;
+            aggregate.kind = SelectionGroupHelper::Column::Property;
+            aggregate.propertyGuid = column.propertyGuid;
+            compiled.groups.aggregates.Push(aggregate);
+            compiled.groups.aggregateHeaders.Push(column.header);
+            compiled.groups.aggregateDecimals.Push(column.decimals);
+        }
+        return true;
+    }
+    return !compiled.columns.IsEmpty();
+}
+
+const CompiledTemplate* GetCompiledTemplate (const GS::UniString& name)
+{
+    EnsureLoaded();
+
+    if (CompiledTemplate* cached = compiledCache.GetPtr(name)) {
+        return cached;
+    }
+
+    for (const Template& item : templates) {
+        if (item.name != name) {
+            continue;
+        }
+        CompiledTemplate compiled;
+        if (!Compile(item, compiled)) {
+            return nullptr;
+        }
+        compiledCache.Add(name, compiled);
+        return compiledCache.GetPtr(name);
+    }
+    return nullptr;
+}
+
+} // namespace ExportTemplates
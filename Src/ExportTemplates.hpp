@@ -0,0 +1,54 @@
+#ifndef EXPORTTEMPLATES_HPP
+#define EXPORTTEMPLATES_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+#include "SendXlsHelper.hpp"
+
+namespace ExportTemplates {
+
+    // Колонка шаблона в том виде, как её задал пользователь
+    struct ColumnSpec {
+        GS::UniString             token;                                   // "guid", "type", "id", "layer" или GUID свойства
+        GS::UniString             header;
+        SendXlsHelper::CellFormat format = SendXlsHelper::CellFormat::Auto;
+        Int32                     decimals = 6;
+    };
+
+    // Шаблон экспорта «Отправить в Excel»; хранится в настройках аддона
+    struct Template {
+        GS::UniString                 name;
+        SendXlsHelper::ExportFormat   format = SendXlsHelper::ExportFormat::Xlsx;
+        GS::Array<ColumnSpec>         columns;
+        GS::Array<GS::UniString>      groupBy;   // пусто — строка на элемент, иначе сводная по группам
+        GS::UniString                 targetPath; // файл последней выгрузки; «Обновить» пишет в него повторно
+    };
+
+    // Собранный план шаблона: колонки разобраны, GUID свойств и форматтеры разрешены.
+    // Собирается один раз и переиспользуется до изменения шаблона.
+    struct CompiledTemplate {
+        SendXlsHelper::ExportFormat            format = SendXlsHelper::ExportFormat::Xlsx;
+        GS::Array<SendXlsHelper::ExportColumn> columns;
+        bool                                   grouped = false;
+        SendXlsHelper::GroupedExport           groups;
+    };
+
+    // Все шаблоны (при первом обращении читаются из настроек аддона)
+    const GS::Array<Template>& GetTemplates ();
+
+    // Сохранить шаблон (с тем же именем — заменить) и записать настройки
+    bool SaveTemplate (const Template& exportTemplate);
+
+    bool DeleteTemplate (const GS::UniString& name);
+
+    // Запомнить файл, в который выгружен шаблон
+    bool SetTargetPath (const GS::UniString& name, const GS::UniString& path);
+
+    // План шаблона по имени; nullptr — шаблона нет или в нём нет ни одной годной колонки.
+    // Указатель действителен до следующего изменения шаблонов или сборки другого плана.
+    const CompiledTemplate* GetCompiledTemplate (const GS::UniString& name);
+
+} // namespace ExportTemplates
+
+#endif // EXPORTTEMPLATES_HPP
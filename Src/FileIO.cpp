@@ -0,0 +1,34 @@
+#include "FileIO.hpp"
+
+namespace FileIO {
+
+std::FILE* OpenFile (const GS::UniString& path, const char* mode)
+{
+#ifdef GS_WIN
+    wchar_t wideMode[8] = {};
+    for (size_t i = 0; i + 1 < sizeof(wideMode) / sizeof(wideMode[0]) && mode[i] != '\0'; ++i) {
+        wideMode[i] = static_cast<wchar_t>(mode[i]);
+    }
+    return _wfopen(path.ToUStr().Get(), wideMode);
+#else
+    return fopen(path.ToCStr(0, MaxUSize, CC_UTF8).Get(), mode);
+#endif
+}
+
+bool ReadWholeFile (const GS::UniString& path, std::string& data)
+{
+    std::FILE* file = OpenFile(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    char buffer[1 << 16];
+    size_t read = 0;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.append(buffer, read);
+    }
+    const bool ok = (std::ferror(file) == 0);
+    std::fclose(file);
+    return ok;
+}
+
+} // namespace FileIO
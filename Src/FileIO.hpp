@@ -0,0 +1,22 @@
+#ifndef FILEIO_HPP
+#define FILEIO_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+#include <cstdio>
+#include <string>
+
+// Файлы по пути из Archicad (GS::UniString): на Windows — широкие пути, иначе UTF-8
+namespace FileIO {
+
+    // fopen с режимом "rb", "wb" и т.п.; nullptr — не удалось открыть
+    std::FILE* OpenFile (const GS::UniString& path, const char* mode);
+
+    // Дописать содержимое файла в data; false — файл не открылся или ошибка чтения
+    bool ReadWholeFile (const GS::UniString& path, std::string& data);
+
+} // namespace FileIO
+
+#endif // FILEIO_HPP
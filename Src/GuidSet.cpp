@@ -0,0 +1,112 @@
+#include "GuidSet.hpp"
+
+#include <algorithm>
+
+namespace GuidSet {
+
+// ---------------- Ключ ----------------
+Key FromBytes (const uint8_t bytes[16])
+{
+	Key key;
+	for (int i = 0; i < 8; ++i) {
+		key.high = (key.high << 8) | bytes[i];
+		key.low = (key.low << 8) | bytes[8 + i];
+	}
+	return key;
+}
+
+void ToBytes (const Key& key, uint8_t bytes[16])
+{
+	for (int i = 0; i < 8; ++i) {
+		bytes[7 - i] = static_cast<uint8_t>(key.high >> (8 * i));
+		bytes[15 - i] = static_cast<uint8_t>(key.low >> (8 * i));
+	}
+}
+
+// ---------------- Множество ----------------
+void Normalize (Set& keys)
+{
+	if (IsNormalized(keys)) {
+		return;
+	}
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+bool IsNormalized (const Set& keys)
+{
+	for (size_t i = 1; i < keys.size(); ++i) {
+		if (!(keys[i - 1] < keys[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool Contains (const Set& set, const Key& key)
+{
+	return std::binary_search(set.begin(), set.end(), key);
+}
+
+// ---------------- Слияния ----------------
+Set Union (const Set& a, const Set& b)
+{
+	Set result;
+	result.reserve(a.size() + b.size());
+	size_t i = 0;
+	size_t j = 0;
+	while (i < a.size() && j < b.size()) {
+		if (a[i] < b[j]) {
+			result.push_back(a[i++]);
+		} else if (b[j] < a[i]) {
+			result.push_back(b[j++]);
+		} else {
+			result.push_back(a[i++]);
+			++j;
+		}
+	}
+	result.insert(result.end(), a.begin() + i, a.end());
+	result.insert(result.end(), b.begin() + j, b.end());
+	return result;
+}
+
+Set Intersection (const Set& a, const Set& b)
+{
+	Set result;
+	result.reserve(std::min(a.size(), b.size()));
+	size_t i = 0;
+	size_t j = 0;
+	while (i < a.size() && j < b.size()) {
+		if (a[i] < b[j]) {
+			++i;
+		} else if (b[j] < a[i]) {
+			++j;
+		} else {
+			result.push_back(a[i++]);
+			++j;
+		}
+	}
+	return result;
+}
+
+Set Difference (const Set& a, const Set& b)
+{
+	Set result;
+	result.reserve(a.size());
+	size_t i = 0;
+	size_t j = 0;
+	while (i < a.size() && j < b.size()) {
+		if (a[i] < b[j]) {
+			result.push_back(a[i++]);
+		} else if (b[j] < a[i]) {
+			++j;
+		} else {
+			++i;
+			++j;
+		}
+	}
+	result.insert(result.end(), a.begin() + i, a.end());
+	return result;
+}
+
+} // namespace GuidSet
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Множества GUID для наборов выделения. GUID — 128-битное число из двух половин,
+// старшие байты — в high (порядок как у memcmp по 16 байтам), множество — отсортированный
+// массив без повторов. Объединение, пересечение и разность — один проход слиянием
+// двух массивов, O(n + m), без хеш-таблиц и без выделения памяти на элемент.
+// Только стандартная библиотека — проверяется и замеряется отдельно (Tools/GuidSetBench).
+namespace GuidSet {
+
+	struct Key {
+		uint64_t	high = 0;
+		uint64_t	low = 0;
+	};
+
+	inline bool operator< (const Key& a, const Key& b)
+	{
+		return a.high < b.high || (a.high == b.high && a.low < b.low);
+	}
+
+	inline bool operator== (const Key& a, const Key& b)
+	{
+		return a.high == b.high && a.low == b.low;
+	}
+
+	inline bool operator!= (const Key& a, const Key& b)
+	{
+		return !(a == b);
+	}
+
+	typedef std::vector<Key> Set;
+
+	// 16 байт GUID в том порядке, как они лежат в памяти
+	Key		FromBytes (const uint8_t bytes[16]);
+	void	ToBytes (const Key& key, uint8_t bytes[16]);
+
+	// Отсортировать и убрать повторы
+	void	Normalize (Set& keys);
+	bool	IsNormalized (const Set& keys);
+
+	bool	Contains (const Set& set, const Key& key);
+
+	// Аргументы — нормализованные множества; результат тоже нормализован
+	Set		Union (const Set& a, const Set& b);
+	Set		Intersection (const Set& a, const Set& b);
+	Set		Difference (const Set& a, const Set& b);		// a без b
+
+} // namespace GuidSet
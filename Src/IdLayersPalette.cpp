@@ -139,6 +139,16 @@ void IdLayersPalette::HidePalette()
 	GetInstance().Hide();
 }
 
+// Счётчики элементов в слоях изменились — палитра перечитает их сама
+void IdLayersPalette::UpdateLayerUsageOnHTML()
+{
+	if (!HasInstance() || !GetInstance().IsVisible())
+		return;
+
+	if (GetInstance().m_browserCtrl != nullptr)
+		GetInstance().m_browserCtrl->ExecuteJS("refreshLayerUsage()");
+}
+
 GSErrCode IdLayersPalette::RegisterPaletteControlCallBack()
 {
 	return ACAPI_RegisterModelessWindow(
@@ -0,0 +1,620 @@
+#include "IdRenumber.hpp"
+#include "ElementIdIndex.hpp"
+#include "ElementNameCache.hpp"
+#include "PropertyUtils.hpp"
+#include "SpatialOrder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace IdRenumber {
+
+static const UIndex MaxPropertyLookups = 32;   // сколько элементов просмотреть, разрешая имя свойства
+
+enum class Field { Text, Base, Counter, Layer, Type, ID, Property, X, Y, Hilbert, Rows, Path };
+
+// Ключ группы или порядка
+struct FieldRef {
+    Field  field = Field::Text;
+    UIndex slot = 0;             // номер свойства
+    bool   descending = false;
+    double rowHeight = 0.0;      // ширина полосы для rows; 0 — по плотности точек
+};
+
+// Кусок шаблона
+struct Segment {
+    Field         field = Field::Text;
+    GS::UniString text;
+    Int32         width = 0;     // ширина счётчика
+    UIndex        slot = 0;
+};
+
+// Разобранный шаблон, ключи и список нужных данных — чтобы при проходе по элементам
+// читать только то, что используется
+struct Plan {
+    GS::Array<Segment>                   segments;
+    GS::Array<FieldRef>                  groupKeys;
+    GS::Array<FieldRef>                  orderKeys;
+    GS::Array<GS::UniString>             propertyRefs;    // как записано: GUID или имя
+    GS::Array<API_Guid>                  propertyGuids;
+    GS::HashTable<GS::UniString, UIndex> propertySlots;   // ключ — propertyRefs в нижнем регистре
+    bool                                 needsLayer = false;
+    bool                                 needsType = false;
+    bool                                 needsBounds = false;
+};
+
+// ---------------- Разбор шаблона и ключей ----------------
+static bool HasPrefix(const GS::UniString& text, const char* prefix, GS::UniString& rest)
+{
+    const GS::UniString prefixText(prefix, CC_UTF8);
+    if (text.GetLength() <= prefixText.GetLength() ||
+        !text.GetSubstring(0, prefixText.GetLength()).IsEqual(prefixText, GS::CaseInsensitive)) {
+        return false;
+    }
+    rest = text.GetSubstring(prefixText.GetLength(), text.GetLength() - prefixText.GetLength());
+    rest.Trim();
+    return !rest.IsEmpty();
+}
+
+static bool IsName(const GS::UniString& text, const char* first, const char* second)
+{
+    return text.IsEqual(GS::UniString(first, CC_UTF8), GS::CaseInsensitive) ||
+           text.IsEqual(GS::UniString(second, CC_UTF8), GS::CaseInsensitive);
+}
+
+static UIndex AddPropertyRef(Plan& plan, const GS::UniString& reference)
+{
+    const GS::UniString key = reference.ToLowerCase();
+    UIndex slot = 0;
+    if (!plan.propertySlots.Get(key, &slot)) {
+        slot = plan.propertyRefs.GetSize();
+        plan.propertySlots.Add(key, slot);
+        plan.propertyRefs.Push(reference);
+    }
+    return slot;
+}
+
+static bool ParseField(const GS::UniString& token, bool allowPosition, Plan& plan, FieldRef& ref, GS::Array<GS::UniString>& errors)
+{
+    GS::UniString name = token;
+    name.Trim();
+    GS::UniString rest;
+    if (IsName(name, "layer", "слой")) {
+        ref.field = Field::Layer;
+        plan.needsLayer = true;
+    } else if (IsName(name, "type", "тип")) {
+        ref.field = Field::Type;
+        plan.needsType = true;
+    } else if (IsName(name, "id", "ид")) {
+        ref.field = Field::ID;
+    } else if (allowPosition && IsName(name, "x", "х")) {
+        ref.field = Field::X;
+        plan.needsBounds = true;
+    } else if (allowPosition && IsName(name, "y", "у")) {
+        ref.field = Field::Y;
+        plan.needsBounds = true;
+    } else if (allowPosition && IsName(name, "hilbert", "гильберт")) {
+        ref.field = Field::Hilbert;
+        plan.needsBounds = true;
+    } else if (allowPosition && IsName(name, "path", "маршрут")) {
+        ref.field = Field::Path;
+        plan.needsBounds = true;
+    } else if (allowPosition && IsName(name, "rows", "ряды")) {
+        ref.field = Field::Rows;
+        plan.needsBounds = true;
+    } else if (allowPosition && (HasPrefix(name, "rows:", rest) || HasPrefix(name, "ряды:", rest))) {
+        rest.ReplaceAll(",", ".");
+        const std::string text(rest.ToCStr().Get());
+        char* end = nullptr;
+        ref.rowHeight = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || ref.rowHeight <= 0.0) {
+            errors.Push(GS::UniString("Ширина полосы должна быть положительным числом: ") + name);
+            return false;
+        }
+        ref.field = Field::Rows;
+        plan.needsBounds = true;
+    } else if (HasPrefix(name, "prop:", rest) || HasPrefix(name, "свойство:", rest)) {
+        ref.field = Field::Property;
+        ref.slot = AddPropertyRef(plan, rest);
+    } else {
+        errors.Push(GS::UniString("Неизвестный ключ: ") + name);
+        return false;
+    }
+    return true;
+}
+
+static bool ParseKeys(const GS::Array<GS::UniString>& tokens, bool allowPosition, Plan& plan, GS::Array<FieldRef>& keys, GS::Array<GS::UniString>& errors)
+{
+    bool ok = true;
+    for (const GS::UniString& token : tokens) {
+        GS::UniString name = token;
+        name.Trim();
+        if (name.IsEmpty()) {
+            continue;
+        }
+        FieldRef ref;
+        if (name[0] == GS::UniChar('-')) {
+            ref.descending = true;
+            name = name.GetSubstring(1, name.GetLength() - 1);
+        } else if (name[0] == GS::UniChar('+')) {
+            name = name.GetSubstring(1, name.GetLength() - 1);
+        }
+        if (ParseField(name, allowPosition, plan, ref, errors)) {
+            keys.Push(ref);
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// {n}, {n:3}, {n:03} -> ширина счётчика
+static bool ParseCounter(const GS::UniString& token, Int32& width)
+{
+    if (token.IsEqual("n", GS::CaseInsensitive)) {
+        width = 0;
+        return true;
+    }
+    GS::UniString format;
+    if (!HasPrefix(token, "n:", format)) {
+        return false;
+    }
+    width = 0;
+    const std::string digits = format.ToCStr().Get();
+    for (const char c : digits) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        width = std::min<Int32>(width * 10 + (c - '0'), 12);
+    }
+    return true;
+}
+
+static bool CompilePattern(const GS::UniString& pattern, Plan& plan, GS::Array<GS::UniString>& errors)
+{
+    GS::UniString text;
+    auto flushText = [&]() {
+        if (!text.IsEmpty()) {
+            Segment segment;
+            segment.text = text;
+            plan.segments.Push(segment);
+            text.Clear();
+        }
+    };
+
+    UIndex i = 0;
+    while (i < pattern.GetLength()) {
+        if (pattern[i] != GS::UniChar('{')) {
+            text += pattern.GetSubstring(i, 1);
+            ++i;
+            continue;
+        }
+        UIndex close = i + 1;
+        while (close < pattern.GetLength() && pattern[close] != GS::UniChar('}')) ++close;
+        if (close == pattern.GetLength()) {
+            errors.Push(GS::UniString("Нет закрывающей } в шаблоне"));
+            return false;
+        }
+        GS::UniString token = pattern.GetSubstring(i + 1, close - i - 1);
+        token.Trim();
+        i = close + 1;
+
+        flushText();
+        Segment segment;
+        FieldRef ref;
+        if (token.IsEqual("base", GS::CaseInsensitive)) {
+            segment.field = Field::Base;
+        } else if (ParseCounter(token, segment.width)) {
+            segment.field = Field::Counter;
+        } else if (ParseField(token, false, plan, ref, errors)) {
+            segment.field = ref.field;
+            segment.slot = ref.slot;
+        } else {
+            return false;
+        }
+        plan.segments.Push(segment);
+    }
+    flushText();
+
+    if (plan.segments.IsEmpty()) {
+        errors.Push(GS::UniString("Пустой шаблон"));
+        return false;
+    }
+    return true;
+}
+
+// Имена свойств -> GUID по определениям первых элементов, где они есть
+static bool ResolveProperties(Plan& plan, const GS::Array<API_Guid>& elements, GS::Array<GS::UniString>& errors)
+{
+    plan.propertyGuids.SetSize(plan.propertyRefs.GetSize());
+    UIndex unresolved = 0;
+    for (UIndex slot = 0; slot < plan.propertyRefs.GetSize(); ++slot) {
+        plan.propertyGuids[slot] = APIGuidFromString(plan.propertyRefs[slot].ToCStr().Get());
+        if (plan.propertyGuids[slot] == APINULLGuid) {
+            ++unresolved;
+        }
+    }
+
+    for (UIndex e = 0; e < elements.GetSize() && e < MaxPropertyLookups && unresolved > 0; ++e) {
+        GS::Array<API_PropertyDefinition> definitions;
+        if (ACAPI_Element_GetPropertyDefinitions(elements[e], API_PropertyDefinitionFilter_All, definitions) != NoError) {
+            continue;
+        }
+        for (UIndex slot = 0; slot < plan.propertyRefs.GetSize(); ++slot) {
+            if (plan.propertyGuids[slot] != APINULLGuid) {
+                continue;
+            }
+            for (const API_PropertyDefinition& definition : definitions) {
+                if (definition.name.IsEqual(plan.propertyRefs[slot], GS::CaseInsensitive)) {
+                    plan.propertyGuids[slot] = definition.guid;
+                    --unresolved;
+                    break;
+                }
+            }
+        }
+    }
+
+    for (UIndex slot = 0; slot < plan.propertyRefs.GetSize(); ++slot) {
+        if (plan.propertyGuids[slot] == APINULLGuid) {
+            errors.Push(GS::UniString("Свойство не найдено: ") + plan.propertyRefs[slot]);
+        }
+    }
+    return unresolved == 0;
+}
+
+// ---------------- Данные элементов ----------------
+struct ElementData {
+    API_Guid      guid = APINULLGuid;
+    GS::UniString layer;
+    GS::UniString type;
+    GS::UniString id;
+    double        x = 0.0;
+    double        y = 0.0;
+    UIndex        group = 0;
+};
+
+struct Collected {
+    GS::Array<ElementData>   elements;
+    GS::Array<GS::UniString> properties;    // elements.GetSize() * slotCount, по строкам
+    USize                    slotCount = 0;
+};
+
+static void Collect(const Plan& plan, const GS::Array<API_Guid>& guids, Collected& collected)
+{
+    ElementNameCache names;
+    collected.slotCount = plan.propertyGuids.GetSize();
+    collected.elements.SetCapacity(guids.GetSize());
+    GS::Array<API_Property> properties;
+    GS::Array<GS::UniString> values;
+    values.SetSize(collected.slotCount);
+
+    for (const API_Guid& guid : guids) {
+        API_Elem_Head head = {};
+        head.guid = guid;
+        if (ACAPI_Element_GetHeader(&head) != NoError) {
+            continue;
+        }
+
+        ElementData data;
+        data.guid = guid;
+        ACAPI_Element_GetElementInfoString(&head.guid, &data.id);
+        if (plan.needsLayer) {
+            data.layer = names.GetLayerName(head.layer);
+        }
+        if (plan.needsType) {
+            data.type = names.GetTypeName(head.type);
+        }
+        if (plan.needsBounds) {
+            API_Box3D box = {};
+            if (ACAPI_Element_CalcBounds(&head, &box) == NoError) {
+                data.x = (box.xMin + box.xMax) / 2.0;
+                data.y = (box.yMin + box.yMax) / 2.0;
+            }
+        }
+
+        if (collected.slotCount > 0) {
+            for (GS::UniString& value : values) {
+                value.Clear();
+            }
+            properties.Clear();
+            if (ACAPI_Element_GetPropertyValuesByGuid(guid, plan.propertyGuids, properties) == NoError) {
+                for (const API_Property& property : properties) {
+                    for (UIndex slot = 0; slot < collected.slotCount; ++slot) {
+                        if (plan.propertyGuids[slot] == property.definition.guid) {
+                            PropertyUtils::PropertyToString(property, values[slot]);
+                        }
+                    }
+                }
+            }
+            collected.properties.Append(values);
+        }
+        collected.elements.Push(data);
+    }
+}
+
+static const GS::UniString& GetText(const Collected& collected, UIndex element, Field field, UIndex slot)
+{
+    static const GS::UniString empty;
+    const ElementData& data = collected.elements[element];
+    switch (field) {
+        case Field::Layer:    return data.layer;
+        case Field::Type:     return data.type;
+        case Field::ID:       return data.id;
+        case Field::Property: return collected.properties[element * collected.slotCount + slot];
+        default:              return empty;
+    }
+}
+
+// ---------------- Порядок ----------------
+// Место элемента на маршруте по плану — отдельно в каждой группе, чтобы у каждого
+// счётчика был свой непрерывный обход
+static std::vector<double> GetSpatialRanks(const FieldRef& ref, const Collected& collected, UIndex groupCount)
+{
+    SpatialOrder::Method method = SpatialOrder::Method::Hilbert;
+    if (ref.field == Field::Rows) {
+        method = SpatialOrder::Method::Rows;
+    } else if (ref.field == Field::Path) {
+        method = SpatialOrder::Method::NearestPath;
+    }
+
+    const UIndex count = collected.elements.GetSize();
+    std::vector<std::vector<UIndex>> members(groupCount);
+    for (UIndex i = 0; i < count; ++i) {
+        members[collected.elements[i].group].push_back(i);
+    }
+
+    std::vector<double> ranks(count, 0.0);
+    std::vector<SpatialOrder::Point> points;
+    for (const std::vector<UIndex>& group : members) {
+        points.resize(group.size());
+        for (size_t i = 0; i < group.size(); ++i) {
+            points[i].x = collected.elements[group[i]].x;
+            points[i].y = collected.elements[group[i]].y;
+        }
+        const std::vector<uint32_t> order = SpatialOrder::Order(points, method, ref.rowHeight);
+        for (size_t rank = 0; rank < order.size(); ++rank) {
+            ranks[group[order[rank]]] = static_cast<double>(rank);
+        }
+    }
+    return ranks;
+}
+
+// Сравнение с учётом чисел: цифры сравниваются как числа, остальное — побайтно (UTF-8)
+static int CompareNatural(const std::string& a, const std::string& b)
+{
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        const bool digitA = a[i] >= '0' && a[i] <= '9';
+        const bool digitB = b[j] >= '0' && b[j] <= '9';
+        if (digitA && digitB) {
+            while (i < a.size() && a[i] == '0') ++i;
+            while (j < b.size() && b[j] == '0') ++j;
+            size_t endA = i;
+            size_t endB = j;
+            while (endA < a.size() && a[endA] >= '0' && a[endA] <= '9') ++endA;
+            while (endB < b.size() && b[endB] >= '0' && b[endB] <= '9') ++endB;
+            if (endA - i != endB - j) {
+                return (endA - i < endB - j) ? -1 : 1;
+            }
+            const int order = a.compare(i, endA - i, b, j, endB - j);
+            if (order != 0) {
+                return order;
+            }
+            i = endA;
+            j = endB;
+            continue;
+        }
+        if (a[i] != b[j]) {
+            return (static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[j])) ? -1 : 1;
+        }
+        ++i;
+        ++j;
+    }
+    if (i < a.size()) return 1;
+    if (j < b.size()) return -1;
+    return 0;
+}
+
+struct SortKey {
+    bool                     numeric = false;
+    bool                     descending = false;
+    std::vector<std::string> texts;     // в нижнем регистре, UTF-8
+    std::vector<double>      numbers;
+};
+
+static std::vector<UIndex> SortElements(const Plan& plan, const Collected& collected, UIndex groupCount)
+{
+    const UIndex count = collected.elements.GetSize();
+    std::vector<UIndex> order(count);
+    for (UIndex i = 0; i < count; ++i) {
+        order[i] = i;
+    }
+    if (plan.orderKeys.IsEmpty()) {
+        return order;
+    }
+
+    // Ключи считаются один раз на элемент, а не в каждом сравнении
+    std::vector<SortKey> keys(plan.orderKeys.GetSize());
+    for (UIndex k = 0; k < plan.orderKeys.GetSize(); ++k) {
+        const FieldRef& ref = plan.orderKeys[k];
+        SortKey& key = keys[k];
+        key.descending = ref.descending;
+        key.numeric = (ref.field == Field::X || ref.field == Field::Y);
+        if (ref.field == Field::Hilbert || ref.field == Field::Rows || ref.field == Field::Path) {
+            key.numeric = true;
+            key.numbers = GetSpatialRanks(ref, collected, groupCount);
+        } else if (key.numeric) {
+            key.numbers.resize(count);
+            for (UIndex i = 0; i < count; ++i) {
+                key.numbers[i] = (ref.field == Field::X) ? collected.elements[i].x : collected.elements[i].y;
+            }
+        } else {
+            key.texts.resize(count);
+            for (UIndex i = 0; i < count; ++i) {
+                key.texts[i] = GetText(collected, i, ref.field, ref.slot).ToLowerCase().ToCStr(0, MaxUSize, CC_UTF8).Get();
+            }
+        }
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&keys](UIndex a, UIndex b) {
+        for (const SortKey& key : keys) {
+            int order = 0;
+            if (key.numeric) {
+                order = (key.numbers[a] < key.numbers[b]) ? -1 : (key.numbers[b] < key.numbers[a]) ? 1 : 0;
+            } else {
+                order = CompareNatural(key.texts[a], key.texts[b]);
+            }
+            if (order != 0) {
+                return key.descending ? order > 0 : order < 0;
+            }
+        }
+        return false;
+    });
+    return order;
+}
+
+// ---------------- Расчёт ----------------
+static GS::UniString FormatCounter(Int32 value, Int32 width)
+{
+    GS::UniString digits = GS::UniString::Printf("%d", (int)(value < 0 ? -value : value));
+    while ((Int32)digits.GetLength() < width) {
+        digits = GS::UniString("0") + digits;
+    }
+    return (value < 0) ? GS::UniString("-") + digits : digits;
+}
+
+static Result Compute(const GS::Array<API_Guid>& elements, const Options& options)
+{
+    Result result;
+    const auto started = std::chrono::steady_clock::now();
+
+    Plan plan;
+    // Разбираем всё, чтобы показать все ошибки сразу
+    bool compiled = CompilePattern(options.pattern, plan, result.errors);
+    compiled = ParseKeys(options.groupBy, false, plan, plan.groupKeys, result.errors) && compiled;
+    compiled = ParseKeys(options.orderBy, true, plan, plan.orderKeys, result.errors) && compiled;
+    if (!compiled || !ResolveProperties(plan, elements, result.errors)) {
+        return result;
+    }
+
+    Collected collected;
+    Collect(plan, elements, collected);
+
+    // Группы: свой счётчик на каждое сочетание значений ключей
+    GS::HashTable<GS::UniString, UIndex> groupIndices;
+    for (UIndex i = 0; i < collected.elements.GetSize(); ++i) {
+        GS::UniString key;
+        for (const FieldRef& ref : plan.groupKeys) {
+            key += GetText(collected, i, ref.field, ref.slot);
+            key += "\n";
+        }
+        UIndex group = 0;
+        if (!groupIndices.Get(key, &group)) {
+            group = groupIndices.GetSize();
+            groupIndices.Add(key, group);
+        }
+        collected.elements[i].group = group;
+    }
+    result.groups = groupIndices.GetSize();
+
+    std::vector<Int32> counters(result.groups, options.start);
+    GS::HashTable<GS::UniString, UInt32> idUses;
+    result.rows.SetCapacity(collected.elements.GetSize());
+    for (const UIndex i : SortElements(plan, collected, result.groups)) {
+        const ElementData& data = collected.elements[i];
+        Row row;
+        row.guid = data.guid;
+        row.oldID = data.id;
+        for (const Segment& segment : plan.segments) {
+            switch (segment.field) {
+                case Field::Text:    row.newID += segment.text; break;
+                case Field::Base:    row.newID += options.base; break;
+                case Field::Counter: row.newID += FormatCounter(counters[data.group], segment.width); break;
+                default:             row.newID += GetText(collected, i, segment.field, segment.slot); break;
+            }
+        }
+        counters[data.group] += options.step;
+        if (row.newID != row.oldID) {
+            ++result.changed;
+        }
+        UInt32* uses = idUses.GetPtr(row.newID);
+        if (uses != nullptr) {
+            ++*uses;
+        } else {
+            idUses.Add(row.newID, 1);
+        }
+        result.rows.Push(row);
+    }
+    // Конфликты с остальной моделью — по индексу ID, без прохода по модели
+    GS::HashTable<API_Guid, bool> batch;
+    for (const Row& row : result.rows) {
+        batch.Put(row.guid, true);
+    }
+    for (const Row& row : result.rows) {
+        if (idUses[row.newID] > 1) {
+            ++result.duplicates;
+        }
+        if (row.newID != row.oldID && ElementIdIndex::IsTakenByOthers(row.newID, batch)) {
+            ++result.conflicts;
+        }
+    }
+
+    result.collectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.success = true;
+    return result;
+}
+
+Result Preview(const GS::Array<API_Guid>& elements, const Options& options)
+{
+    return Compute(elements, options);
+}
+
+Result Apply(const GS::Array<API_Guid>& elements, const Options& options)
+{
+    Result result = Compute(elements, options);
+    if (!result.success || result.changed == 0) {
+        return result;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const BatchMutation::Report report = BatchMutation::Run("Renumber Elements ID", "Перенумерация ID", result.changed, [&]() -> GSErrCode {
+        for (Row& row : result.rows) {
+            if (row.newID == row.oldID) {
+                continue;
+            }
+            const GSErrCode err = ACAPI_Element_ChangeElementInfoString(&row.guid, &row.newID);
+            if (err != NoError) {
+                ++result.failed;
+                BatchMutation::Fail(row.guid, err);
+            } else {
+                const API_Guid guid = row.guid;
+                const GS::UniString newID = row.newID;
+                BatchMutation::OnCommit([guid, newID]() { ElementIdIndex::NoteIdChanged(guid, newID); });
+            }
+            if (!BatchMutation::Step()) {
+                return APIERR_CANCEL;
+            }
+        }
+        return NoError;
+    });
+    result.success = report.success;
+    result.canceled = report.canceled;
+    result.elementErrors = report.errors;
+    if (!report.success) {
+        // Команда откатана — не записан ни один ID
+        result.failed = result.changed;
+    }
+    result.applySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport(GS::UniString::Printf("[IdRenumber] Изменено ID: %u, ошибок: %u, расчёт %.3f с, запись %.3f с",
+        (unsigned)(result.changed - result.failed), (unsigned)result.failed, result.collectSeconds, result.applySeconds), false);
+#endif
+    return result;
+}
+
+} // namespace IdRenumber
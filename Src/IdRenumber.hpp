@@ -0,0 +1,65 @@
+#ifndef IDRENUMBER_HPP
+#define IDRENUMBER_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+#include "BatchMutation.hpp"
+
+// Пакетная перенумерация ID по шаблону.
+// Шаблон — текст с подстановками в фигурных скобках:
+//   {base}            базовое имя из настроек
+//   {n} {n:03}        счётчик (с шириной и нулями слева); в каждой группе свой
+//   {layer} {type}    слой и тип элемента
+//   {id}              текущий ID
+//   {prop:Зона}       значение свойства по имени или GUID
+// Группы (groupBy) и порядок (orderBy) задаются теми же ключами: layer, type, id, prop:...,
+// для порядка ещё x и y (центр габарита) и маршруты по плану (SpatialOrder), которые строятся
+// в каждой группе отдельно:
+//   hilbert           по кривой Гильберта
+//   rows, rows:2.5    змейкой по полосам сверху вниз (ширина полосы в метрах, без неё — по плотности)
+//   path              к ближайшему следующему элементу от левого верхнего угла
+// "-" перед ключом — по убыванию. Строки сравниваются с учётом чисел ("A2" раньше "A10").
+// Предпросмотр ничего не меняет; применение — одна Undo-команда (BatchMutation: прогресс,
+// отмена с откатом), неизменившиеся ID не пишутся.
+namespace IdRenumber {
+
+    struct Options {
+        GS::UniString            pattern = "{base}-{n:02}";
+        GS::UniString            base;
+        GS::Array<GS::UniString> groupBy;
+        GS::Array<GS::UniString> orderBy;      // пусто — порядок, в котором переданы элементы
+        Int32                    start = 1;
+        Int32                    step = 1;
+    };
+
+    struct Row {
+        API_Guid      guid = APINULLGuid;
+        GS::UniString oldID;
+        GS::UniString newID;
+    };
+
+    struct Result {
+        bool                     success = false;
+        GS::Array<Row>           rows;           // в порядке нумерации
+        UInt32                   changed = 0;    // новый ID отличается от текущего
+        UInt32                   duplicates = 0; // элементов с ID, который получил не только он
+        UInt32                   conflicts = 0;  // новый ID уже носит элемент вне набора
+        UInt32                   groups = 0;
+        UInt32                   failed = 0;     // не удалось записать
+        bool                     canceled = false;   // отменено — ничего не записано
+        GS::Array<GS::UniString> errors;         // ошибки шаблона и ключей
+        GS::Array<BatchMutation::ElementError> elementErrors;    // коды ошибок записи
+        double                   collectSeconds = 0.0;
+        double                   applySeconds = 0.0;
+    };
+
+    // Рассчитать новые ID без записи
+    Result Preview(const GS::Array<API_Guid>& elements, const Options& options);
+
+    // Рассчитать и записать одной Undo-командой
+    Result Apply(const GS::Array<API_Guid>& elements, const Options& options);
+
+} // namespace IdRenumber
+
+#endif // IDRENUMBER_HPP
@@ -1,5 +1,10 @@
 #include "LayerHelper.hpp"
 #include "APICommon.h"
+#include "BatchMutation.hpp"
+#include "LayerSearchIndex.hpp"
+#include "SelectionHelper.hpp"
+
+#include <chrono>
 
 namespace LayerHelper {
 
@@ -96,8 +101,175 @@ GS::Array<GS::UniString> ParseFolderPath(const GS::UniString& folderPath)
     return pathParts;
 }
 
-// ---------------- Создать папку для слоев ---------------- 
-bool CreateLayerFolder(const GS::UniString& folderPath, GS::Guid& folderGuid)
+// ---------------- Кэш дерева папок слоёв ----------------
+// Путь "A/B/C" (без корня "Слои") -> GUID папки со ссылками на родителя и детей.
+// Строится одним обходом дерева и дополняется при создании папок, так что разрешение
+// пути — проход по хеш-таблице, а не ACAPI_Attribute_GetFolder на каждый префикс.
+struct LayerFolderNode {
+    GS::Guid                  guid;
+    GS::UniString             parent;      // ключ родителя, пусто — корень
+    GS::Array<GS::UniString>  children;    // ключи подпапок
+};
+
+struct LayerFolderCache {
+    GS::HashTable<GS::UniString, LayerFolderNode> folders;
+    GS::Array<GS::UniString>                      rootChildren;
+    bool                                          built = false;
+};
+
+static LayerFolderCache layerFolderCache;
+
+// Поисковый индекс палитры: строится из результата GetLayersList, устаревает при изменениях слоёв.
+// signature — сумма хешей GUID и имён слоёв: переименование или замена слоя в Archicad
+// меняют её и при том же числе слоёв
+struct LayerSearchState {
+    LayerSearchIndex index;
+    UInt64           signature = 0;
+    bool             valid = false;
+};
+
+static LayerSearchState layerSearchState;
+
+static GS::UniString JoinFolderPath(const GS::Array<GS::UniString>& pathParts, UIndex count)
+{
+    GS::UniString result;
+    for (UIndex i = 0; i < count && i < pathParts.GetSize(); ++i) {
+        if (i > 0) result += "/";
+        result += pathParts[i];
+    }
+    return result;
+}
+
+static void AddFolderToCache(const GS::UniString& key, const GS::UniString& parentKey, const GS::Guid& guid)
+{
+    if (LayerFolderNode* existing = layerFolderCache.folders.GetPtr(key)) {
+        existing->guid = guid;
+        return;
+    }
+
+    LayerFolderNode node;
+    node.guid = guid;
+    node.parent = parentKey;
+    layerFolderCache.folders.Add(key, node);
+
+    if (parentKey.IsEmpty()) {
+        layerFolderCache.rootChildren.Push(key);
+    } else if (LayerFolderNode* parent = layerFolderCache.folders.GetPtr(parentKey)) {
+        parent->children.Push(key);
+    }
+}
+
+static void BuildLayerFolderCache()
+{
+    layerFolderCache.folders.Clear();
+    layerFolderCache.rootChildren.Clear();
+    layerFolderCache.built = true;
+
+    // Обход в ширину: родитель всегда попадает в кэш раньше своих подпапок
+    GS::Array<API_AttributeFolder> pending;
+    API_AttributeFolder root = {};
+    root.typeID = API_LayerID;
+    pending.Push(root);
+
+    for (UIndex next = 0; next < pending.GetSize(); ++next) {
+        API_AttributeFolderContent content = {};
+        if (ACAPI_Attribute_GetFolderContent(pending[next], content) != NoError)
+            continue;
+
+        for (const API_AttributeFolder& subfolder : content.subFolders) {
+            const GS::Array<GS::UniString> parts = RemoveRootFolderFromPath(subfolder.path);
+            if (parts.IsEmpty())
+                continue;
+            AddFolderToCache(JoinFolderPath(parts, parts.GetSize()), JoinFolderPath(parts, parts.GetSize() - 1), subfolder.guid);
+            pending.Push(subfolder);
+        }
+    }
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[LayerHelper] Кэш папок слоёв построен: %d папок", false, (int)layerFolderCache.folders.GetSize());
+#endif
+}
+
+static void InvalidateLayerFolderCache()
+{
+    layerFolderCache.folders.Clear();
+    layerFolderCache.rootChildren.Clear();
+    layerFolderCache.built = false;
+}
+
+// Пройти путь от корня; usedCache — хотя бы одна папка взята из кэша (GUID мог устареть)
+static bool WalkLayerFolderPath(const GS::Array<GS::UniString>& pathParts, bool create, GS::Guid& folderGuid, bool& usedCache)
+{
+    usedCache = false;
+    if (!layerFolderCache.built) {
+        BuildLayerFolderCache();
+    }
+
+    // Идём по пути от корня: известные папки берём из кэша, недостающие создаём
+    GS::Array<GS::UniString> currentPath;
+    GS::UniString parentKey;
+    
+    for (UIndex i = 0; i < pathParts.GetSize(); ++i) {
+        currentPath.Push(pathParts[i]);
+        const GS::UniString currentPathStr = parentKey.IsEmpty() ? pathParts[i] : parentKey + "/" + pathParts[i];
+
+        if (const LayerFolderNode* cached = layerFolderCache.folders.GetPtr(currentPathStr)) {
+            folderGuid = cached->guid;
+            parentKey = currentPathStr;
+            usedCache = true;
+            continue;
+        }
+        
+        // В кэше нет — папку могли создать в Archicad после построения кэша, проверяем
+        API_AttributeFolder folder = {};
+        folder.typeID = API_LayerID;
+        folder.path = currentPath;
+        GSErrCode err = ACAPI_Attribute_GetFolder(folder);
+        
+        if (err != NoError) {
+            if (!create) {
+                return false;
+            }
+            // Папка не существует, создаем её
+            folder = {};
+            folder.typeID = API_LayerID;
+            folder.path = currentPath;
+            
+            err = ACAPI_Attribute_CreateFolder(folder);
+            if (err != NoError) {
+#ifdef DEBUG_UI_LOGS
+                ACAPI_WriteReport("[LayerHelper] Ошибка создания папки '%s' (код: %d)", true, 
+                    currentPathStr.ToCStr().Get(), err);
+#endif
+                return false;
+            }
+#ifdef DEBUG_UI_LOGS
+            ACAPI_WriteReport("[LayerHelper] Создана папка: %s", false, currentPathStr.ToCStr().Get());
+#endif
+        } else {
+#ifdef DEBUG_UI_LOGS
+            ACAPI_WriteReport("[LayerHelper] Папка уже существует: %s", false, currentPathStr.ToCStr().Get());
+#endif
+        }
+
+        folderGuid = folder.guid;
+        AddFolderToCache(currentPathStr, parentKey, folderGuid);
+        parentKey = currentPathStr;
+    }
+
+    return true;
+}
+
+// Папка по этому пути существует и это именно она
+static bool IsLayerFolderAt(const GS::Array<GS::UniString>& pathParts, const GS::Guid& folderGuid)
+{
+    API_AttributeFolder folder = {};
+    folder.typeID = API_LayerID;
+    folder.path = pathParts;
+    return ACAPI_Attribute_GetFolder(folder) == NoError && folder.guid == folderGuid;
+}
+
+// ---------------- Найти (и при create — создать) папку для слоев ---------------- 
+static bool ResolveLayerFolder(const GS::UniString& folderPath, bool create, GS::Guid& folderGuid)
 {
     if (folderPath.IsEmpty()) {
         folderGuid = GS::Guid(); // Пустой GUID для корневой папки
@@ -138,87 +310,142 @@ bool CreateLayerFolder(const GS::UniString& folderPath, GS::Guid& folderGuid)
         return true;
     }
 
-    // Создаем папки пошагово
-    GS::Array<GS::UniString> currentPath;
-    
-    for (UIndex i = 0; i < cleanPathParts.GetSize(); ++i) {
-        currentPath.Push(cleanPathParts[i]);
-        
-        // Формируем строку пути для логирования
-        GS::UniString currentPathStr;
-        for (UIndex j = 0; j < currentPath.GetSize(); ++j) {
-            if (j > 0) currentPathStr += "/";
-            currentPathStr += currentPath[j];
+    // Кэш не знает об Undo/Redo и о папках, удалённых или переименованных вне аддона:
+    // найденную через кэш папку проверяем одним вызовом API, при промахе кэш строится заново
+    bool usedCache = false;
+    if (WalkLayerFolderPath(cleanPathParts, create, folderGuid, usedCache)) {
+        if (!usedCache || IsLayerFolderAt(cleanPathParts, folderGuid)) {
+            return true;
         }
-        
-        // Проверяем, существует ли папка
-        API_AttributeFolder existingFolder = {};
-        existingFolder.typeID = API_LayerID;
-        existingFolder.path = currentPath;
-        GSErrCode err = ACAPI_Attribute_GetFolder(existingFolder);
-        
-        if (err != NoError) {
-            // Папка не существует, создаем её
-            API_AttributeFolder folder = {};
-            folder.typeID = API_LayerID;
-            folder.path = currentPath;
-            
-            err = ACAPI_Attribute_CreateFolder(folder);
-            if (err != NoError) {
-#ifdef DEBUG_UI_LOGS
-                ACAPI_WriteReport("[LayerHelper] Ошибка создания папки '%s' (код: %d)", true, 
-                    currentPathStr.ToCStr().Get(), err);
-#endif
-                return false;
-            }
-#ifdef DEBUG_UI_LOGS
-            ACAPI_WriteReport("[LayerHelper] Создана папка: %s", false, currentPathStr.ToCStr().Get());
-#endif
-            
-            // Используем GUID созданной папки
-            folderGuid = folder.guid;
-#ifdef DEBUG_UI_LOGS
-            ACAPI_WriteReport("[LayerHelper] GUID созданной папки получен", false);
-            ACAPI_WriteReport("[LayerHelper] Папка создана успешно, GUID не пустой: %s", false, 
-                (folderGuid != GS::Guid()) ? "да" : "нет");
-#endif
-        } else {
-            // Папка существует, используем её GUID
-            folderGuid = existingFolder.guid;
+    } else if (!usedCache) {
+        return false;
+    }
+
 #ifdef DEBUG_UI_LOGS
-            ACAPI_WriteReport("[LayerHelper] Папка уже существует: %s", false, currentPathStr.ToCStr().Get());
+    ACAPI_WriteReport("[LayerHelper] Кэш папок слоёв устарел, перестраиваем", false);
 #endif
-        }
-    }
+    InvalidateLayerFolderCache();
+    return WalkLayerFolderPath(cleanPathParts, create, folderGuid, usedCache);
+}
 
-    return true;
+// ---------------- Создать папку для слоев ---------------- 
+bool CreateLayerFolder(const GS::UniString& folderPath, GS::Guid& folderGuid)
+{
+    return ResolveLayerFolder(folderPath, true, folderGuid);
 }
 
-// ---------------- Найти слой по имени, вернуть его индекс (0 если не найден) ----------------
-static API_AttributeIndex FindLayerByName(const GS::UniString& layerName)
+// ---------------- Найти папку для слоев, не создавая ---------------- 
+bool FindLayerFolder(const GS::UniString& folderPath, GS::Guid& folderGuid)
 {
-    API_AttributeIndex foundIndex = APIInvalidAttributeIndex;
+    return ResolveLayerFolder(folderPath, false, folderGuid);
+}
+
+// ---------------- Индекс слоёв по имени ----------------
+// Раньше поиск перебирал все слои через ACAPI_Attribute_Get — на шаблоне с тысячами слоёв
+// каждое создание слоя стоило тысяч вызовов API, а пакетное создание росло квадратично.
+struct LayerNameIndex {
+    GS::HashTable<GS::UniString, API_AttributeIndex> exact;
+    GS::HashTable<GS::UniString, API_AttributeIndex> folded;     // имена в нижнем регистре
+    GS::UInt32                                       layerCount = 0;
+    bool                                             built = false;
+};
+
+static LayerNameIndex layerIndexCache;
+
+static GS::UniString FoldLayerName(const GS::UniString& name)
+{
+    return name.ToLowerCase();
+}
 
-    // Получаем количество слоев
-    GS::UInt32 layerCount = 0;
-    if (ACAPI_Attribute_GetNum(API_LayerID, layerCount) != NoError || layerCount == 0)
-        return foundIndex;
+static void AddToLayerIndex(const GS::UniString& name, API_AttributeIndex index)
+{
+    layerIndexCache.exact.Put(name, index);
+    // При совпадении без учёта регистра побеждает первый слой — как при линейном поиске
+    const GS::UniString folded = FoldLayerName(name);
+    if (!layerIndexCache.folded.ContainsKey(folded)) {
+        layerIndexCache.folded.Add(folded, index);
+    }
+}
 
-    // Перебираем все слои и ищем совпадение по имени
-    for (Int32 i = 1; i <= static_cast<Int32>(layerCount); ++i) {
+static void BuildLayerIndex()
+{
+    layerIndexCache.exact.Clear();
+    layerIndexCache.folded.Clear();
+    layerIndexCache.layerCount = 0;
+    layerIndexCache.built = true;
+
+    if (ACAPI_Attribute_GetNum(API_LayerID, layerIndexCache.layerCount) != NoError)
+        return;
+
+    for (Int32 i = 1; i <= static_cast<Int32>(layerIndexCache.layerCount); ++i) {
         API_Attribute attr = {};
         attr.header.typeID = API_LayerID;
         attr.header.index = ACAPI_CreateAttributeIndex(i);
         if (ACAPI_Attribute_Get(&attr) != NoError)
             continue;
 
-        if (GS::UniString(attr.header.name) == layerName) {
-            foundIndex = ACAPI_CreateAttributeIndex(i);
-            break;
-        }
+        const GS::UniString name(attr.header.name);
+        if (!layerIndexCache.exact.ContainsKey(name))
+            AddToLayerIndex(name, attr.header.index);
     }
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[LayerHelper] Индекс слоёв построен: %u", false, (unsigned)layerIndexCache.layerCount);
+#endif
+}
 
-    return foundIndex;
+// Слой всё ещё существует и называется так же — одним вызовом API
+static bool IsLayerNamed(API_AttributeIndex index, const GS::UniString& layerName, bool caseInsensitive)
+{
+    API_Attribute attr = {};
+    attr.header.typeID = API_LayerID;
+    attr.header.index = index;
+    if (ACAPI_Attribute_Get(&attr) != NoError)
+        return false;
+
+    const GS::UniString name(attr.header.name);
+    return caseInsensitive ? name.IsEqual(layerName, GS::CaseInsensitive) : name == layerName;
+}
+
+static bool LookupLayer(const GS::UniString& layerName, bool caseInsensitive, API_AttributeIndex& index)
+{
+    return caseInsensitive
+        ? layerIndexCache.folded.Get(FoldLayerName(layerName), &index)
+        : layerIndexCache.exact.Get(layerName, &index);
+}
+
+void InvalidateLayerIndex()
+{
+    layerIndexCache.exact.Clear();
+    layerIndexCache.folded.Clear();
+    layerIndexCache.layerCount = 0;
+    layerIndexCache.built = false;
+    InvalidateLayerFolderCache();
+    layerSearchState.valid = false;
+}
+
+API_AttributeIndex FindLayerByName(const GS::UniString& layerName, bool caseInsensitive)
+{
+    if (!layerIndexCache.built)
+        BuildLayerIndex();
+
+    API_AttributeIndex index = APIInvalidAttributeIndex;
+    if (LookupLayer(layerName, caseInsensitive, index)) {
+        if (IsLayerNamed(index, layerName, caseInsensitive))
+            return index;
+        // Слой переименован или удалён мимо аддона (или откатан Undo) — индекс устарел
+        BuildLayerIndex();
+    } else {
+        // Промах: если слоёв стало больше (созданы в Archicad), индекс тоже устарел
+        GS::UInt32 layerCount = 0;
+        if (ACAPI_Attribute_GetNum(API_LayerID, layerCount) != NoError || layerCount == layerIndexCache.layerCount)
+            return APIInvalidAttributeIndex;
+        BuildLayerIndex();
+    }
+
+    index = APIInvalidAttributeIndex;
+    if (LookupLayer(layerName, caseInsensitive, index) && IsLayerNamed(index, layerName, caseInsensitive))
+        return index;
+    return APIInvalidAttributeIndex;
 }
 
 // ---------------- Создать слой в указанной папке ---------------- 
@@ -280,6 +507,16 @@ bool CreateLayer(const GS::UniString& folderPath, const GS::UniString& layerName
     // Создаем слой
     GSErrCode err = ACAPI_Attribute_Create(&layer, nullptr);
     if (err != NoError) {
+        // Имя могло освободиться/заняться мимо индекса (переименование в Archicad) — пересобираем и ищем ещё раз
+        InvalidateLayerIndex();
+        const API_AttributeIndex existingIdx = FindLayerByName(layerName);
+        if (existingIdx.IsPositive()) {
+            layerIndex = existingIdx;
+            if (!folderPath.IsEmpty()) {
+                MoveLayerToFolder(layerIndex, folderPath);
+            }
+            return true;
+        }
 #ifdef DEBUG_UI_LOGS
         ACAPI_WriteReport("[LayerHelper] Ошибка создания слоя: %s", true, layerName.ToCStr().Get());
 #endif
@@ -287,6 +524,14 @@ bool CreateLayer(const GS::UniString& folderPath, const GS::UniString& layerName
     }
 
     layerIndex = layer.header.index;
+    layerSearchState.valid = false;
+    if (layerIndexCache.built) {
+        AddToLayerIndex(layerName, layerIndex);
+        GS::UInt32 layerCount = 0;
+        if (ACAPI_Attribute_GetNum(API_LayerID, layerCount) == NoError) {
+            layerIndexCache.layerCount = layerCount;
+        }
+    }
     
     // Перемещаем слой в папку, если папка указана
     if (!folderPath.IsEmpty()) {
@@ -306,58 +551,145 @@ bool CreateLayer(const GS::UniString& folderPath, const GS::UniString& layerName
     return true;
 }
 
-// ---------------- Переместить выделенные элементы в указанный слой ----------------
-bool MoveSelectedElementsToLayer(API_AttributeIndex layerIndex)
+// ---------------- Переместить элементы в указанный слой ----------------
+// Слой меняется пакетно: ACAPI_Element_ChangeMore с маской только на header.layer,
+// по одному вызову на тип элемента. Если пакет целиком отклонён — элементы этого типа
+// переносятся по одному, чтобы отказ одного не останавливал остальные.
+struct LayerMoveGroup {
+    API_ElemType          type;
+    GS::Array<API_Guid>   guids;
+};
+
+static GSErrCode ChangeLayerOne(const API_Guid& guid, API_AttributeIndex layerIndex)
 {
-    // Получаем выделенные элементы
-    API_SelectionInfo selectionInfo = {};
-    GS::Array<API_Neig> selNeigs;
-    ACAPI_Selection_Get(&selectionInfo, &selNeigs, false, false);
-    BMKillHandle((GSHandle*)&selectionInfo.marquee.coords);
+    API_Element element = {};
+    element.header.guid = guid;
+    GSErrCode err = ACAPI_Element_Get(&element);
+    if (err != NoError)
+        return err;
 
-    if (selNeigs.IsEmpty()) {
+    API_Element mask = {};
+    ACAPI_ELEMENT_MASK_CLEAR(mask);
+    element.header.layer = layerIndex;
+    ACAPI_ELEMENT_MASK_SET(mask, API_Elem_Head, layer);
+    return ACAPI_Element_Change(&element, &mask, nullptr, 0, true);
+}
+
+bool MoveElementsToLayer(const GS::Array<API_Guid>& guids, API_AttributeIndex layerIndex, LayerMoveResult* result)
+{
+    LayerMoveResult localResult;
+    LayerMoveResult& stats = (result != nullptr) ? *result : localResult;
+    stats = LayerMoveResult();
+
+    // Группируем по типу; элементы, уже лежащие в целевом слое, не трогаем
+    GS::Array<LayerMoveGroup> groups;
+    for (const API_Guid& guid : guids) {
+        API_Elem_Head head = {};
+        head.guid = guid;
+        const GSErrCode headErr = ACAPI_Element_GetHeader(&head);
+        if (headErr != NoError) {
 #ifdef DEBUG_UI_LOGS
-        ACAPI_WriteReport("[LayerHelper] Нет выделенных элементов", false);
+            ACAPI_WriteReport("[LayerHelper] Ошибка получения элемента: %s", true, APIGuidToString(guid).ToCStr().Get());
 #endif
-        return false;
+            stats.failedGuids.Push(guid);
+            BatchMutation::Fail(guid, headErr);
+            continue;
+        }
+        if (head.layer == layerIndex) {
+            ++stats.unchanged;
+            continue;
+        }
+
+        LayerMoveGroup* group = nullptr;
+        for (LayerMoveGroup& candidate : groups) {
+            if (candidate.type == head.type) {
+                group = &candidate;
+                break;
+            }
+        }
+        if (group == nullptr) {
+            LayerMoveGroup newGroup;
+            newGroup.type = head.type;
+            groups.Push(newGroup);
+            group = &groups[groups.GetSize() - 1];
+        }
+        group->guids.Push(guid);
     }
 
+    // Непрочитанные и уже лежащие в слое — тоже пройденные шаги
+    BatchMutation::Step(stats.unchanged + stats.failedGuids.GetSize());
+
+    API_Element mask = {};
+    ACAPI_ELEMENT_MASK_CLEAR(mask);
+    ACAPI_ELEMENT_MASK_SET(mask, API_Elem_Head, layer);
+
+    for (LayerMoveGroup& group : groups) {
+        API_Element defPars = {};
+        defPars.header.type = group.type;
+        defPars.header.layer = layerIndex;
+
+        GSErrCode err = ACAPI_Element_ChangeMore(group.guids, &defPars, nullptr, &mask, 0, true);
+        if (err == NoError) {
+            stats.moved += group.guids.GetSize();
+            if (!BatchMutation::Step(group.guids.GetSize())) {
+                return false;
+            }
+            continue;
+        }
+
 #ifdef DEBUG_UI_LOGS
-    ACAPI_WriteReport("[LayerHelper] Перемещаем %d элементов в слой %s", false, (int)selNeigs.GetSize(), layerIndex.ToUniString().ToCStr().Get());
+        ACAPI_WriteReport("[LayerHelper] Пакетная смена слоя отклонена (код: %d) — переносим %d элементов по одному", false,
+            err, (int)group.guids.GetSize());
 #endif
-
-    // Перемещаем каждый элемент
-    for (const API_Neig& neig : selNeigs) {
-        API_Element element = {};
-        element.header.guid = neig.guid;
-        
-        GSErrCode err = ACAPI_Element_Get(&element);
-        if (err != NoError) {
+        for (const API_Guid& guid : group.guids) {
+            const GSErrCode oneErr = ChangeLayerOne(guid, layerIndex);
+            if (oneErr == NoError) {
+                ++stats.moved;
+            } else {
 #ifdef DEBUG_UI_LOGS
-            ACAPI_WriteReport("[LayerHelper] Ошибка получения элемента: %s", true, APIGuidToString(neig.guid).ToCStr().Get());
+                ACAPI_WriteReport("[LayerHelper] Ошибка изменения слоя элемента: %s", true, APIGuidToString(guid).ToCStr().Get());
 #endif
-            continue;
+                stats.failedGuids.Push(guid);
+                BatchMutation::Fail(guid, oneErr);
+            }
+            // Отмена — выходим; откатит всё команда BatchMutation::Run
+            if (!BatchMutation::Step()) {
+                return false;
+            }
         }
+    }
 
-        // Изменяем слой элемента
-        API_Element mask = {};
-        ACAPI_ELEMENT_MASK_CLEAR(mask);
-        
-        element.header.layer = layerIndex;
-        ACAPI_ELEMENT_MASK_SET(mask, API_Elem_Head, layer);
-
-        err = ACAPI_Element_Change(&element, &mask, nullptr, 0, true);
-        if (err != NoError) {
 #ifdef DEBUG_UI_LOGS
-            ACAPI_WriteReport("[LayerHelper] Ошибка изменения слоя элемента: %s", true, APIGuidToString(neig.guid).ToCStr().Get());
+    ACAPI_WriteReport("[LayerHelper] Перемещено в слой %s: %u, уже были в слое: %u, ошибок: %u", false,
+        layerIndex.ToUniString().ToCStr().Get(), (unsigned)stats.moved, (unsigned)stats.unchanged, (unsigned)stats.failedGuids.GetSize());
 #endif
-        } else {
+    return stats.failedGuids.IsEmpty();
+}
+
+// ---------------- Переместить выделенные элементы в указанный слой ----------------
+bool MoveSelectedElementsToLayer(API_AttributeIndex layerIndex, LayerMoveResult* result)
+{
+    // Получаем выделенные элементы
+    API_SelectionInfo selectionInfo = {};
+    GS::Array<API_Neig> selNeigs;
+    ACAPI_Selection_Get(&selectionInfo, &selNeigs, false, false);
+    BMKillHandle((GSHandle*)&selectionInfo.marquee.coords);
+
+    if (selNeigs.IsEmpty()) {
 #ifdef DEBUG_UI_LOGS
-            ACAPI_WriteReport("[LayerHelper] Элемент перемещен в слой: %s", false, APIGuidToString(neig.guid).ToCStr().Get());
+        ACAPI_WriteReport("[LayerHelper] Нет выделенных элементов", false);
 #endif
-        }
+        return false;
+    }
+
+    GS::Array<API_Guid> guids;
+    guids.SetCapacity(selNeigs.GetSize());
+    for (const API_Neig& neig : selNeigs) {
+        guids.Push(neig.guid);
     }
 
+    // Отказы отдельных элементов не прерывают операцию — они есть в result
+    MoveElementsToLayer(guids, layerIndex, result);
     return true;
 }
 
@@ -373,35 +705,38 @@ bool ChangeSelectedElementsID(const GS::UniString& baseID)
 
     if (selNeigs.IsEmpty()) return false;
 
-#ifdef DEBUG_UI_LOGS
-    ACAPI_WriteReport("[LayerHelper] Изменяем ID %d элементов с базовым названием: %s", false, (int)selNeigs.GetSize(), baseID.ToCStr().Get());
-#endif
+    // Создаем новый ID: baseID-01, baseID-02, etc.
+    GS::Array<SelectionHelper::ElementIdChange> changes;
+    changes.SetCapacity(selNeigs.GetSize());
+    for (UIndex i = 0; i < selNeigs.GetSize(); ++i) {
+        SelectionHelper::ElementIdChange change;
+        change.guid = selNeigs[i].guid;
+        change.newID = baseID;
+        if (selNeigs.GetSize() > 1) {
+            change.newID += GS::UniString::Printf("-%02d", (int)(i + 1));
+        }
+        changes.Push(change);
+    }
 
-    // Используем Undo-группу для возможности отмены
-    GSErrCode err = ACAPI_CallUndoableCommand("Change Elements ID", [&]() -> GSErrCode {
-        for (UIndex i = 0; i < selNeigs.GetSize(); ++i) {
-            // Создаем новый ID: baseID-01, baseID-02, etc.
-            GS::UniString newID = baseID;
-            if (selNeigs.GetSize() > 1) {
-                newID += GS::UniString::Printf("-%02d", (int)(i + 1));
-            }
+    // Элементы, у которых ID уже такой, не записываются
+    const SelectionHelper::UpdateElementsIdResult result = SelectionHelper::ChangeElementsID(changes);
 
-            // Изменяем ID элемента
-            if (ACAPI_Element_ChangeElementInfoString(&selNeigs[i].guid, &newID) != NoError) {
 #ifdef DEBUG_UI_LOGS
-                ACAPI_WriteReport("[LayerHelper] Ошибка изменения ID элемента: %s", true, APIGuidToString(selNeigs[i].guid).ToCStr().Get());
+    ACAPI_WriteReport("[LayerHelper] ID \"%s\": изменено %u, без изменений %u, ошибок %u", false, baseID.ToCStr().Get(),
+        (unsigned)result.updated, (unsigned)result.unchanged, (unsigned)result.failed);
 #endif
-                continue;
-            } else {
-#ifdef DEBUG_UI_LOGS
-                ACAPI_WriteReport("[LayerHelper] ID изменен: %s", false, newID.ToCStr().Get());
-#endif
-            }
-        }
-        return NoError;
-    });
 
-    return err == NoError;
+    // Отказы отдельных элементов (заблокированы и т.п.) не прерывают операцию
+    return result.failed < result.requested;
+}
+
+// Число выделенных элементов — для процентов в окне прогресса
+static UInt32 GetSelectionCount()
+{
+    API_SelectionInfo selectionInfo = {};
+    ACAPI_Selection_Get(&selectionInfo, nullptr, false, false);
+    BMKillHandle((GSHandle*)&selectionInfo.marquee.coords);
+    return (selectionInfo.sel_nElem > 0) ? static_cast<UInt32>(selectionInfo.sel_nElem) : 0;
 }
 
 // ---------------- Основная функция: создать папку, слой и переместить элементы ----------------
@@ -415,8 +750,9 @@ bool CreateLayerAndMoveElements(const LayerCreationParams& params)
         params.baseID.ToCStr().Get());
 #endif
 
-    // Используем Undo-группу для возможности отмены всей операции
-    GSErrCode err = ACAPI_CallUndoableCommand("Create Layer and Move Elements", [&]() -> GSErrCode {
+    // Одна Undo-команда на всю операцию: отмена или ошибка на любом этапе откатывает и слой,
+    // и перенос, и ID
+    const BatchMutation::Report report = BatchMutation::Run("Create Layer and Move Elements", "Создание слоя", 0, [&]() -> GSErrCode {
         // 1. Создаем слой
         API_AttributeIndex layerIndex;
         if (!CreateLayer(params.folderPath, params.layerName, layerIndex)) {
@@ -427,12 +763,16 @@ bool CreateLayerAndMoveElements(const LayerCreationParams& params)
         }
 
         // 2. Перемещаем элементы в новый слой
+        BatchMutation::BeginPhase("Перенос элементов в слой", GetSelectionCount());
         if (!MoveSelectedElementsToLayer(layerIndex)) {
 #ifdef DEBUG_UI_LOGS
             ACAPI_WriteReport("[LayerHelper] Ошибка перемещения элементов", true);
 #endif
             return APIERR_GENERAL;
         }
+        if (!BatchMutation::Step(0)) {
+            return APIERR_CANCEL;
+        }
 
         // 3. Изменяем ID элементов (только если baseID не пустой)
         if (!params.baseID.IsEmpty()) {
@@ -464,7 +804,11 @@ bool CreateLayerAndMoveElements(const LayerCreationParams& params)
         return NoError;
     });
 
-    return err == NoError;
+    if (!report.success) {
+        // Созданные слой и папки откатаны вместе с командой — кэши могли их запомнить
+        InvalidateLayerIndex();
+    }
+    return report.success;
 }
 
 // ---------------- Переместить слой в папку ---------------- 
@@ -488,40 +832,23 @@ bool MoveLayerToFolder(API_AttributeIndex layerIndex, const GS::UniString& folde
         return true;
     }
 
-    // Пытаемся переместить слой в папку через изменение атрибута
-    API_Attribute layer = {};
-    layer.header.typeID = API_LayerID;
-    layer.header.index = layerIndex;
-    
-    GSErrCode err = ACAPI_Attribute_Get(&layer);
-    if (err != NoError) {
-#ifdef DEBUG_UI_LOGS
-        ACAPI_WriteReport("[LayerHelper] Не удалось получить информацию о слое (код: %d)", true, err);
-        ACAPI_WriteReport("[LayerHelper] Слой остался в корне, но папка создана: %s", false, folderPath.ToCStr().Get());
-#endif
-        return true;
-    }
-    
-    // Пытаемся переместить слой в папку через ACAPI_Attribute_Move
-    // Сначала получаем GUID слоя
+    // Получаем GUID слоя (один запрос атрибута)
     API_Attribute currentLayer = {};
     currentLayer.header.typeID = API_LayerID;
     currentLayer.header.index = layerIndex;
     
-    err = ACAPI_Attribute_Get(&currentLayer);
+    GSErrCode err = ACAPI_Attribute_Get(&currentLayer);
     if (err != NoError) {
 #ifdef DEBUG_UI_LOGS
         ACAPI_WriteReport("[LayerHelper] Ошибка получения слоя для перемещения (код: %d)", true, err);
+        ACAPI_WriteReport("[LayerHelper] Слой остался в корне, но папка создана: %s", false, folderPath.ToCStr().Get());
 #endif
-        return false;
+        return true;
     }
     
     // Создаем массив GUID атрибутов для перемещения (слой)
     GS::Array<GS::Guid> attributesToMove;
-    // Попробуем конвертировать API_Guid в GS::Guid
-    GS::UniString guidStr = APIGuidToString(currentLayer.header.guid);
-    GS::Guid layerGuid(guidStr);
-    attributesToMove.Push(layerGuid);
+    attributesToMove.Push(APIGuid2GSGuid(currentLayer.header.guid));
     
     // Создаем пустой массив папок (мы не перемещаем папки)
     GS::Array<API_AttributeFolder> foldersToMove;
@@ -539,6 +866,16 @@ bool MoveLayerToFolder(API_AttributeIndex layerIndex, const GS::UniString& folde
 #ifdef DEBUG_UI_LOGS
     ACAPI_WriteReport("[LayerHelper] ACAPI_Attribute_Move вернул код: %d", false, err);
 #endif
+
+    if (err != NoError) {
+        // GUID из кэша мог устареть (папку удалили или переименовали в Archicad) — пересобираем и пробуем ещё раз
+        InvalidateLayerFolderCache();
+        GS::Guid freshGuid;
+        if (CreateLayerFolder(folderPath, freshGuid) && freshGuid != GS::Guid() && freshGuid != folderGuid) {
+            targetFolder.guid = freshGuid;
+            err = ACAPI_Attribute_Move(foldersToMove, attributesToMove, targetFolder);
+        }
+    }
     
     if (err != NoError) {
 #ifdef DEBUG_UI_LOGS
@@ -547,6 +884,7 @@ bool MoveLayerToFolder(API_AttributeIndex layerIndex, const GS::UniString& folde
         ACAPI_WriteReport("[LayerHelper] Слой остался в корне, но папка создана: %s", false, folderPath.ToCStr().Get());
 #endif
     } else {
+        layerSearchState.valid = false;
 #ifdef DEBUG_UI_LOGS
         ACAPI_WriteReport("[LayerHelper] Слой успешно перемещен в папку: %s", false, folderPath.ToCStr().Get());
 #endif
@@ -555,6 +893,165 @@ bool MoveLayerToFolder(API_AttributeIndex layerIndex, const GS::UniString& folde
     return true;
 }
 
+// ---------------- Перенести много слоёв по папкам ----------------
+struct LayerMoveDestination {
+    GS::UniString                 folderPath;
+    GS::Array<GS::Guid>           layerGuids;
+    GS::Array<API_AttributeIndex> layerIndices;
+};
+
+// "/A//B/" -> "A/B": один ключ группы на папку при любой записи пути
+static GS::UniString NormalizeFolderPath(const GS::UniString& folderPath)
+{
+    GS::UniString normalized;
+    for (const GS::UniString& part : ParseFolderPath(folderPath)) {
+        GS::UniString trimmed = part;
+        trimmed.Trim();
+        if (trimmed.IsEmpty())
+            continue;
+        if (!normalized.IsEmpty())
+            normalized += "/";
+        normalized += trimmed;
+    }
+    return normalized;
+}
+
+static GSErrCode MoveLayersToFolder(const GS::Array<GS::Guid>& layerGuids, const GS::Guid& folderGuid)
+{
+    const GS::Array<API_AttributeFolder> foldersToMove;
+    API_AttributeFolder targetFolder = {};
+    targetFolder.typeID = API_LayerID;
+    targetFolder.guid = folderGuid;   // пустой GUID — корень, как при обходе дерева
+    return ACAPI_Attribute_Move(foldersToMove, layerGuids, targetFolder);
+}
+
+static void MoveDestination(const LayerMoveDestination& destination, LayerReorganizeResult& stats)
+{
+    GS::Guid folderGuid;
+    if (!destination.folderPath.IsEmpty()) {
+        const bool existed = FindLayerFolder(destination.folderPath, folderGuid);
+        if (!existed) {
+            if (!CreateLayerFolder(destination.folderPath, folderGuid)) {
+                stats.failed.Append(destination.layerIndices);
+                return;
+            }
+            ++stats.foldersCreated;
+        }
+    }
+
+    ++stats.moveCalls;
+    GSErrCode err = MoveLayersToFolder(destination.layerGuids, folderGuid);
+    if (err != NoError && !destination.folderPath.IsEmpty()) {
+        // GUID папки из кэша мог устареть — пересобираем кэш и пробуем ещё раз
+        InvalidateLayerFolderCache();
+        GS::Guid freshGuid;
+        if (CreateLayerFolder(destination.folderPath, freshGuid) && freshGuid != folderGuid) {
+            folderGuid = freshGuid;
+            ++stats.moveCalls;
+            err = MoveLayersToFolder(destination.layerGuids, folderGuid);
+        }
+    }
+    if (err == NoError) {
+        stats.moved += destination.layerGuids.GetSize();
+        return;
+    }
+
+    // Пакет отклонён целиком — переносим по одному, чтобы найти слои, которые нельзя перенести
+    for (UIndex i = 0; i < destination.layerGuids.GetSize(); ++i) {
+        GS::Array<GS::Guid> single;
+        single.Push(destination.layerGuids[i]);
+        ++stats.moveCalls;
+        if (MoveLayersToFolder(single, folderGuid) == NoError) {
+            ++stats.moved;
+        } else {
+            stats.failed.Push(destination.layerIndices[i]);
+        }
+    }
+}
+
+bool MoveLayersToFolders(const GS::Array<LayerFolderMove>& moves, LayerReorganizeResult* result)
+{
+    LayerReorganizeResult localResult;
+    LayerReorganizeResult& stats = (result != nullptr) ? *result : localResult;
+    stats = LayerReorganizeResult();
+    if (moves.IsEmpty())
+        return true;
+
+    const auto started = std::chrono::steady_clock::now();
+
+    // GUID всех слоёв одним запросом вместо ACAPI_Attribute_Get на каждый слой
+    GS::HashTable<Int32, GS::Guid> layerGuids;
+    GS::Array<API_Attribute> layers;
+    if (ACAPI_Attribute_GetAttributesByType(API_LayerID, layers) == NoError) {
+        for (const API_Attribute& layer : layers) {
+            layerGuids.Put(layer.header.index.ToInt32_Deprecated(), APIGuid2GSGuid(layer.header.guid));
+        }
+    }
+
+    // Группы по папке назначения; слой, указанный несколько раз, идёт в последнюю папку
+    GS::Array<LayerMoveDestination> destinations;
+    GS::HashTable<GS::UniString, UIndex> destinationIndices;
+    GS::HashTable<Int32, UIndex> lastMove;
+    for (UIndex i = 0; i < moves.GetSize(); ++i) {
+        lastMove.Put(moves[i].layerIndex.ToInt32_Deprecated(), i);
+    }
+    for (UIndex i = 0; i < moves.GetSize(); ++i) {
+        const Int32 key = moves[i].layerIndex.ToInt32_Deprecated();
+        if (lastMove[key] != i)
+            continue;
+        GS::Guid layerGuid;
+        if (!layerGuids.Get(key, &layerGuid)) {
+            stats.failed.Push(moves[i].layerIndex);
+            continue;
+        }
+        const GS::UniString folderPath = NormalizeFolderPath(moves[i].folderPath);
+        UIndex destination = 0;
+        if (!destinationIndices.Get(folderPath, &destination)) {
+            destination = destinations.GetSize();
+            destinationIndices.Add(folderPath, destination);
+            LayerMoveDestination item;
+            item.folderPath = folderPath;
+            destinations.Push(item);
+        }
+        destinations[destination].layerGuids.Push(layerGuid);
+        destinations[destination].layerIndices.Push(moves[i].layerIndex);
+    }
+
+    bool committed = true;
+    if (!destinations.IsEmpty()) {
+        UInt32 layerCount = 0;
+        for (const LayerMoveDestination& destination : destinations) {
+            layerCount += destination.layerGuids.GetSize();
+        }
+        const BatchMutation::Report report = BatchMutation::Run("Move Layers to Folders", "Перенос слоёв в папки", layerCount, [&]() -> GSErrCode {
+            for (const LayerMoveDestination& destination : destinations) {
+                MoveDestination(destination, stats);
+                if (!BatchMutation::Step(destination.layerGuids.GetSize())) {
+                    return APIERR_CANCEL;
+                }
+            }
+            return NoError;
+        });
+        stats.canceled = report.canceled;
+        committed = report.success;
+        if (!committed) {
+            // Откат: ни один слой не перенесён, созданных папок нет
+            stats.moved = 0;
+            stats.foldersCreated = 0;
+            InvalidateLayerFolderCache();
+        }
+    }
+    if (stats.moved > 0)
+        layerSearchState.valid = false;
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[LayerHelper] MoveLayersToFolders: %u слоёв, %u папок назначения, %u вызовов Move, %.3f с", false,
+        (unsigned)stats.moved, (unsigned)destinations.GetSize(), (unsigned)stats.moveCalls, stats.seconds);
+#endif
+    return stats.failed.IsEmpty() && committed;
+}
+
 // ---------------- Скрыть/показать слой ---------------- 
 bool SetLayerVisibility(API_AttributeIndex layerIndex, bool hidden)
 {
@@ -585,10 +1082,12 @@ bool SetLayerVisibility(API_AttributeIndex layerIndex, bool hidden)
     
     // Сохраняем изменения через ACAPI_Attribute_Modify
     err = ACAPI_Attribute_Modify(&layer, nullptr);
+    BatchMutation::Step();
     if (err != NoError) {
 #ifdef DEBUG_UI_LOGS
         ACAPI_WriteReport("[LayerHelper] Ошибка установки видимости слоя (код: %d)", true, err);
 #endif
+        BatchMutation::Fail(layer.header.guid, err);
         return false;
     }
     
@@ -598,112 +1097,145 @@ bool SetLayerVisibility(API_AttributeIndex layerIndex, bool hidden)
     return true;
 }
 
-// ---------------- Рекурсивная функция для получения слоев из папки и её подпапок ---------------- 
-static void GetLayersFromFolderRecursive(
-    const GS::Array<GS::UniString>& folderPath,
-    GS::UniString currentPathStr,
-    GS::Array<LayerInfo>& layersList,
-    GS::Array<GS::UniString>& processedPaths)
+// ---------------- Имена всех слоёв по GUID одним запросом ---------------- 
+// Слагаемое подписи слоёв; сумма не зависит от порядка слоёв
+static UInt64 GetLayerSignatureTerm(const GS::Guid& guid, const GS::UniString& name)
 {
-    // Формируем строку пути для проверки циклов
-    if (currentPathStr.IsEmpty()) {
-        if (folderPath.GetSize() > 0) {
-            for (UIndex i = 0; i < folderPath.GetSize(); ++i) {
-                if (i > 0) currentPathStr += "/";
-                currentPathStr += folderPath[i];
-            }
-        } else {
-            currentPathStr = GS::UniString(""); // Корневая папка
-        }
-    }
-    
-    // Проверяем, не обрабатывали ли мы уже эту папку
-    for (UIndex i = 0; i < processedPaths.GetSize(); ++i) {
-        if (processedPaths[i] == currentPathStr)
-            return; // Уже обработана
-    }
-    processedPaths.Push(currentPathStr);
-    
-    // Получаем папку для использования в GetFolderContent
-    API_AttributeFolder folder = {};
-    folder.typeID = API_LayerID;
-    
-    // Для корневой папки не указываем path и guid - получаем корень
-    // Для остальных папок указываем path
-    if (folderPath.GetSize() > 0) {
-        folder.path = folderPath;
-        // Проверяем существование папки
-        if (ACAPI_Attribute_GetFolder(folder) != NoError)
-            return; // Папка не существует
-    }
-    
-    // Получаем содержимое папки
-    API_AttributeFolderContent folderContent = {};
-    GSErrCode err = ACAPI_Attribute_GetFolderContent(folder, folderContent);
-    
-    if (err != NoError) {
-        // Ошибка получения содержимого - пропускаем
-        return;
-    }
-    
-    // Обрабатываем атрибуты (слои) в этой папке
-    // attributeIds содержит массив GUID атрибутов (GS::Guid)
-    for (UIndex i = 0; i < folderContent.attributeIds.GetSize(); ++i) {
-        GS::Guid attrGuid = folderContent.attributeIds[i];
-        
-        // Конвертируем GS::Guid в API_Guid
-        API_Guid apiGuid = GSGuid2APIGuid(attrGuid);
-        
-        // Получаем атрибут по GUID
-        API_Attribute attr = {};
-        attr.header.typeID = API_LayerID;
-        attr.header.guid = apiGuid;
-        
-        // Получаем информацию об атрибуте через GUID
-        GSErrCode err = ACAPI_Attribute_Get(&attr);
-        if (err == NoError) {
-            LayerInfo info;
-            info.name = attr.header.name;
-            // Удаляем префикс "Слои/" или "Layers/" из пути папки
-            info.folder = RemoveRootFolderPrefix(currentPathStr);
-            layersList.Push(info);
-        }
-    }
-    
-    // Обрабатываем подпапки рекурсивно
-    // НЕ показываем корневую папку как отдельный элемент, только её содержимое
-    for (UIndex i = 0; i < folderContent.subFolders.GetSize(); ++i) {
-        const API_AttributeFolder& subfolder = folderContent.subFolders[i];
-        
-        // Формируем путь подпапки
-        GS::Array<GS::UniString> subfolderPath = subfolder.path;
-        GS::UniString subfolderPathStr;
-        for (UIndex j = 0; j < subfolderPath.GetSize(); ++j) {
-            if (j > 0) subfolderPathStr += "/";
-            subfolderPathStr += subfolderPath[j];
-        }
-        
-        // Удаляем префикс "Слои" или "Layers" из пути перед рекурсивным вызовом
-        GS::Array<GS::UniString> cleanedSubfolderPath = RemoveRootFolderFromPath(subfolderPath);
-        GS::UniString cleanedSubfolderPathStr = RemoveRootFolderPrefix(subfolderPathStr);
-        
-        // Рекурсивный вызов с очищенным путем
-        GetLayersFromFolderRecursive(cleanedSubfolderPath, cleanedSubfolderPathStr, layersList, processedPaths);
+    return static_cast<UInt64>(GS::CalculateHashValue(guid)) * 1000003u + GS::CalculateHashValue(name);
+}
+
+static GS::HashTable<GS::Guid, GS::UniString> GetLayerNamesByGuid(UInt64* signature = nullptr)
+{
+    GS::HashTable<GS::Guid, GS::UniString> names;
+    if (signature != nullptr)
+        *signature = 0;
+    GS::Array<API_Attribute> layers;
+    if (ACAPI_Attribute_GetAttributesByType(API_LayerID, layers) != NoError)
+        return names;
+
+    for (const API_Attribute& layer : layers) {
+        const GS::Guid guid = APIGuid2GSGuid(layer.header.guid);
+        const GS::UniString name(layer.header.name);
+        names.Put(guid, name);
+        if (signature != nullptr)
+            *signature += GetLayerSignatureTerm(guid, name);
     }
+    return names;
 }
 
 // ---------------- Получить список всех слоев с их папками ---------------- 
+// Обход дерева папок явным стеком в том же порядке, что и рекурсия: слои папки, затем подпапки
+// по порядку. Посещённые папки — хеш по GUID, путь папки строится из пути родителя,
+// имена слоёв берутся из одного пакетного запроса всех слоёв.
 GS::Array<LayerInfo> GetLayersList()
 {
+    struct PendingFolder {
+        API_AttributeFolder folder;
+        GS::UniString       path;       // без корня "Слои", пусто — корень
+    };
+
     GS::Array<LayerInfo> layersList;
-    GS::Array<GS::UniString> processedPaths;
+    UInt64 signature = 0;
+    const GS::HashTable<GS::Guid, GS::UniString> layerNames = GetLayerNamesByGuid(&signature);
+    GS::HashTable<GS::Guid, bool> visited;
 
-    // Начинаем с корневой папки (пустой путь)
     // Корневая папка не показывается как отдельный элемент, только её содержимое
-    GS::Array<GS::UniString> rootPath;
-    GetLayersFromFolderRecursive(rootPath, GS::UniString(""), layersList, processedPaths);
+    GS::Array<PendingFolder> stack;
+    PendingFolder root;
+    root.folder = {};
+    root.folder.typeID = API_LayerID;
+    stack.Push(root);
+    bool isRoot = true;
+
+    while (!stack.IsEmpty()) {
+        const PendingFolder current = stack.Pop();
+        if (!isRoot) {
+            if (visited.ContainsKey(current.folder.guid))
+                continue; // Уже обработана
+            visited.Add(current.folder.guid, true);
+        }
+        isRoot = false;
+
+        API_AttributeFolderContent folderContent = {};
+        if (ACAPI_Attribute_GetFolderContent(current.folder, folderContent) != NoError)
+            continue; // Ошибка получения содержимого - пропускаем
+
+        for (const GS::Guid& attrGuid : folderContent.attributeIds) {
+            LayerInfo info;
+            info.folder = current.path;
+            if (const GS::UniString* name = layerNames.GetPtr(attrGuid)) {
+                info.name = *name;
+            } else {
+                // Слоя нет в пакетном ответе — спрашиваем отдельно
+                API_Attribute attr = {};
+                attr.header.typeID = API_LayerID;
+                attr.header.guid = GSGuid2APIGuid(attrGuid);
+                if (ACAPI_Attribute_Get(&attr) != NoError)
+                    continue;
+                info.name = attr.header.name;
+            }
+            layersList.Push(info);
+        }
+
+        // В стек в обратном порядке, чтобы подпапки обходились по порядку
+        for (UIndex i = folderContent.subFolders.GetSize(); i > 0; --i) {
+            const API_AttributeFolder& subfolder = folderContent.subFolders[i - 1];
+            if (subfolder.path.IsEmpty())
+                continue;
+
+            PendingFolder child;
+            child.folder = subfolder;
+            if (current.path.IsEmpty()) {
+                // Первый уровень: путь может начинаться с "Слои"/"Layers"
+                const GS::Array<GS::UniString> cleanedPath = RemoveRootFolderFromPath(subfolder.path);
+                child.path = JoinFolderPath(cleanedPath, cleanedPath.GetSize());
+            } else {
+                child.path = current.path + "/" + subfolder.path.GetLast();
+            }
+            stack.Push(child);
+        }
+    }
+
+    // Список уже собран — заодно обновляем поисковый индекс
+    std::vector<LayerSearchIndex::Entry> searchEntries;
+    searchEntries.reserve(layersList.GetSize());
+    for (const LayerInfo& info : layersList) {
+        LayerSearchIndex::Entry entry;
+        entry.name = info.name.ToCStr(0, MaxUSize, CC_UTF8).Get();
+        entry.folder = info.folder.ToCStr(0, MaxUSize, CC_UTF8).Get();
+        searchEntries.push_back(entry);
+    }
+    layerSearchState.index.Build(searchEntries);
+    layerSearchState.valid = true;
+    layerSearchState.signature = signature;
 
     return layersList;
 }
 
+// ---------------- Поиск слоёв по имени и пути папки ---------------- 
+GS::Array<LayerSearchResult> SearchLayers(const GS::UniString& query, UInt32 limit)
+{
+    // Индекс перестраивается, если слои менялись через аддон или в Archicad: добавлены,
+    // удалены, переименованы (подпись GUID и имён одним пакетным запросом)
+    UInt64 signature = 0;
+    GetLayerNamesByGuid(&signature);
+    if (!layerSearchState.valid || signature != layerSearchState.signature) {
+        GetLayersList();
+    }
+
+    GS::Array<LayerSearchResult> results;
+    const std::vector<LayerSearchIndex::Match> matches =
+        layerSearchState.index.Search(query.ToCStr(0, MaxUSize, CC_UTF8).Get(), limit);
+    results.SetCapacity(static_cast<USize>(matches.size()));
+    for (const LayerSearchIndex::Match& match : matches) {
+        const LayerSearchIndex::Entry& entry = layerSearchState.index.GetEntry(match.entry);
+        LayerSearchResult result;
+        result.name = GS::UniString(entry.name.c_str(), CC_UTF8);
+        result.folder = GS::UniString(entry.folder.c_str(), CC_UTF8);
+        result.score = match.score;
+        results.Push(result);
+    }
+    return results;
+}
+
 } // namespace LayerHelper
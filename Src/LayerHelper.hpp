@@ -15,19 +15,43 @@ namespace LayerHelper {
         bool hideLayer = false;    // Скрыть слой после создания
     };
 
-    // Создать папку для слоев
+    // Создать папку для слоев (недостающие уровни пути создаются; известные берутся из кэша дерева папок)
     bool CreateLayerFolder(const GS::UniString& folderPath, GS::Guid& folderGuid);
 
+    // Найти папку для слоев без создания (false — какого-то уровня пути нет; пустой путь — корень)
+    bool FindLayerFolder(const GS::UniString& folderPath, GS::Guid& folderGuid);
+
+    // Найти слой по имени (APIInvalidAttributeIndex — нет такого).
+    // Ищет по индексу имя -> слой: строится одним проходом при первом поиске и дополняется
+    // при создании слоёв. Найденный слой сверяется с Archicad, так что переименования и
+    // удаления вне аддона индекс не обманывают.
+    API_AttributeIndex FindLayerByName(const GS::UniString& layerName, bool caseInsensitive = false);
+
+    // Сбросить индекс слоёв и кэш папок (смена проекта и т.п.); перестроятся при следующем обращении
+    void InvalidateLayerIndex();
+
     // Создать слой в указанной папке
     bool CreateLayer(const GS::UniString& folderPath, const GS::UniString& layerName, API_AttributeIndex& layerIndex);
 
-    // Переместить выделенные элементы в указанный слой
-    bool MoveSelectedElementsToLayer(API_AttributeIndex layerIndex);
+    // Итог переноса элементов в слой
+    struct LayerMoveResult {
+        UInt32              moved = 0;        // слой изменён
+        UInt32              unchanged = 0;    // уже были в целевом слое
+        GS::Array<API_Guid> failedGuids;      // не удалось изменить
+    };
+
+    // Переместить элементы в указанный слой (пакетно по типам элементов).
+    // false — часть элементов перенести не удалось, они перечислены в result
+    bool MoveElementsToLayer(const GS::Array<API_Guid>& guids, API_AttributeIndex layerIndex, LayerMoveResult* result = nullptr);
+
+    // Переместить выделенные элементы в указанный слой (false — нет выделения)
+    bool MoveSelectedElementsToLayer(API_AttributeIndex layerIndex, LayerMoveResult* result = nullptr);
 
     // Изменить ID всех выделенных элементов
     bool ChangeSelectedElementsID(const GS::UniString& baseID);
 
-    // Основная функция: создать папку, слой и переместить элементы
+    // Основная функция: создать папку, слой и переместить элементы.
+    // Одна Undo-команда (BatchMutation): отмена или ошибка откатывает всё
     bool CreateLayerAndMoveElements(const LayerCreationParams& params);
 
     // Вспомогательная функция: разбить путь к папке на массив
@@ -35,6 +59,27 @@ namespace LayerHelper {
 
     // Переместить слой в папку
     bool MoveLayerToFolder(API_AttributeIndex layerIndex, const GS::UniString& folderPath);
+
+    // Слой и папка, в которую его перенести (пустой путь — корень)
+    struct LayerFolderMove {
+        API_AttributeIndex layerIndex;
+        GS::UniString      folderPath;
+    };
+
+    // Итог массового переноса слоёв
+    struct LayerReorganizeResult {
+        UInt32                          moved = 0;
+        UInt32                          foldersCreated = 0;
+        UInt32                          moveCalls = 0;      // вызовов ACAPI_Attribute_Move
+        GS::Array<API_AttributeIndex>   failed;             // слой не найден или не перенесён
+        bool                            canceled = false;   // отменено — ничего не перенесено
+        double                          seconds = 0.0;
+    };
+
+    // Перенести много слоёв одной Undo-командой (BatchMutation): пары группируются по папке назначения,
+    // недостающие папки создаются по разу, на каждую папку — один ACAPI_Attribute_Move.
+    // false — часть слоёв перенести не удалось, они перечислены в result
+    bool MoveLayersToFolders(const GS::Array<LayerFolderMove>& moves, LayerReorganizeResult* result = nullptr);
     
     // Скрыть/показать слой
     bool SetLayerVisibility(API_AttributeIndex layerIndex, bool hidden);
@@ -48,6 +93,18 @@ namespace LayerHelper {
     // Получить список всех слоев с их папками
     GS::Array<LayerInfo> GetLayersList();
 
+    // Результат поиска слоя
+    struct LayerSearchResult {
+        GS::UniString name;
+        GS::UniString folder;
+        Int32         score = 0;   // больше — точнее совпадение
+    };
+
+    // Найти слои по имени и пути папки (термы через пробел, с ранжированием и нечётким поиском).
+    // Индекс строится по GetLayersList (в том числе при каждой перезагрузке списка палитрой)
+    // и перестраивается, если слои добавлены, удалены или переименованы
+    GS::Array<LayerSearchResult> SearchLayers(const GS::UniString& query, UInt32 limit);
+
 } // namespace LayerHelper
 
 #endif // LAYERHELPER_HPP
@@ -0,0 +1,721 @@
+#include "LayerPlan.hpp"
+#include "LayerHelper.hpp"
+#include "BatchMutation.hpp"
+#include "FileIO.hpp"
+#include "ElementIdIndex.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace LayerPlan {
+
+static const UIndex MaxMessages = 100;
+
+static GS::UniString FromUtf8(const std::string& text)
+{
+    return GS::UniString(text.c_str(), CC_UTF8);
+}
+
+static void AddMessage(GS::Array<GS::UniString>& messages, const GS::UniString& message)
+{
+    if (messages.GetSize() < MaxMessages) {
+        messages.Push(message);
+    } else if (messages.GetSize() == MaxMessages) {
+        messages.Push("…");
+    }
+}
+
+// ---------------- Значения ячеек ----------------
+static std::string TrimAscii(const std::string& text)
+{
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && (text[begin] == ' ' || text[begin] == '\t' || text[begin] == '\r' || text[begin] == '\n')) ++begin;
+    while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t' || text[end - 1] == '\r' || text[end - 1] == '\n')) --end;
+    return text.substr(begin, end - begin);
+}
+
+// "1"/"true"/"да"/"скрыть" -> 1, "0"/"false"/"нет" -> 0, пусто или непонятно -> -1
+static Int32 ParseHidden(const std::string& text)
+{
+    const GS::UniString value = FromUtf8(TrimAscii(text));
+    if (value.IsEmpty()) {
+        return -1;
+    }
+    static const char* yes[] = { "1", "true", "yes", "hidden", "да", "скрыть", "скрыт" };
+    static const char* no[] = { "0", "false", "no", "visible", "нет", "показать" };
+    for (const char* item : yes) {
+        if (value.IsEqual(GS::UniString(item, CC_UTF8), GS::CaseInsensitive)) return 1;
+    }
+    for (const char* item : no) {
+        if (value.IsEqual(GS::UniString(item, CC_UTF8), GS::CaseInsensitive)) return 0;
+    }
+    return -1;
+}
+
+// GUID ("XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX", фигурные скобки допускаются) или ID
+static void AddElementToken(Entry& entry, std::string token, bool forceId)
+{
+    token = TrimAscii(token);
+    if (token.empty()) {
+        return;
+    }
+    if (!forceId) {
+        std::string guidText = token;
+        if (guidText.size() == 38 && guidText.front() == '{' && guidText.back() == '}') {
+            guidText = guidText.substr(1, 36);
+        }
+        if (guidText.size() == 36 && guidText[8] == '-' && guidText[13] == '-' && guidText[18] == '-' && guidText[23] == '-') {
+            const API_Guid guid = APIGuidFromString(guidText.c_str());
+            if (guid != APINULLGuid) {
+                entry.guids.Push(guid);
+                return;
+            }
+        }
+    }
+    entry.idPatterns.Push(FromUtf8(token));
+}
+
+// Список элементов в одной ячейке: через пробел, табуляцию, | , или ;
+static void AddElementList(Entry& entry, const std::string& text)
+{
+    std::string token;
+    for (char c : text) {
+        if (c == ' ' || c == '\t' || c == '|' || c == ',' || c == ';' || c == '\r' || c == '\n') {
+            AddElementToken(entry, token, false);
+            token.clear();
+        } else {
+            token += c;
+        }
+    }
+    AddElementToken(entry, token, false);
+}
+
+static bool FinishEntry(Entry& entry, Plan& plan)
+{
+    if (entry.layerName.IsEmpty()) {
+        plan.errors.Push(GS::UniString::Printf("Строка %u: не указано имя слоя", (unsigned)entry.line));
+        return false;
+    }
+    plan.entries.Push(entry);
+    return true;
+}
+
+// ---------------- CSV ----------------
+enum CsvColumn { CsvFolder, CsvLayer, CsvHidden, CsvElements, CsvIgnored };
+
+static char DetectDelimiter(const std::string& text, size_t start)
+{
+    size_t semicolons = 0;
+    size_t commas = 0;
+    size_t tabs = 0;
+    bool quoted = false;
+    for (size_t i = start; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '"') quoted = !quoted;
+        if (quoted) continue;
+        if (c == '\n') break;
+        semicolons += (c == ';') ? 1 : 0;
+        commas += (c == ',') ? 1 : 0;
+        tabs += (c == '\t') ? 1 : 0;
+    }
+    if (tabs > semicolons && tabs > commas) return '\t';
+    return (commas > semicolons) ? ',' : ';';
+}
+
+// Следующая запись CSV; false — текст кончился. newlines — сколько переводов строк
+// съела запись (в ячейке в кавычках их может быть несколько)
+static bool ReadCsvRecord(const std::string& text, size_t& pos, char delimiter, std::vector<std::string>& cells, UInt32& newlines)
+{
+    cells.clear();
+    newlines = 0;
+    if (pos >= text.size()) {
+        return false;
+    }
+    std::string cell;
+    bool quoted = false;
+    while (pos < text.size()) {
+        const char c = text[pos++];
+        if (quoted) {
+            if (c == '"') {
+                if (pos < text.size() && text[pos] == '"') {
+                    cell += '"';
+                    ++pos;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                if (c == '\n') {
+                    ++newlines;
+                }
+                cell += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == delimiter) {
+            cells.push_back(cell);
+            cell.clear();
+        } else if (c == '\n') {
+            ++newlines;
+            break;
+        } else if (c != '\r') {
+            cell += c;
+        }
+    }
+    cells.push_back(cell);
+    return true;
+}
+
+static CsvColumn RecognizeHeader(const std::string& cell)
+{
+    const GS::UniString name = FromUtf8(TrimAscii(cell));
+    static const struct { const char* name; CsvColumn column; } names[] = {
+        { "folder", CsvFolder }, { "папка", CsvFolder },
+        { "layer", CsvLayer }, { "слой", CsvLayer },
+        { "hidden", CsvHidden }, { "скрыть", CsvHidden }, { "visibility", CsvHidden }, { "видимость", CsvHidden },
+        { "elements", CsvElements }, { "элементы", CsvElements }, { "guid", CsvElements }, { "id", CsvElements }
+    };
+    for (const auto& item : names) {
+        if (name.IsEqual(GS::UniString(item.name, CC_UTF8), GS::CaseInsensitive)) return item.column;
+    }
+    return CsvIgnored;
+}
+
+static void ParseCsv(const std::string& text, size_t start, Plan& plan)
+{
+    const char delimiter = DetectDelimiter(text, start);
+    std::vector<CsvColumn> columns = { CsvFolder, CsvLayer, CsvHidden, CsvElements };
+    std::vector<std::string> cells;
+    size_t pos = start;
+    UInt32 nextLine = 1;    // строка файла, с которой начинается следующая запись
+    UInt32 newlines = 0;
+    bool first = true;
+
+    for (;;) {
+        const UInt32 line = nextLine;
+        if (!ReadCsvRecord(text, pos, delimiter, cells, newlines)) {
+            break;
+        }
+        nextLine += newlines;
+        if (cells.size() == 1 && TrimAscii(cells[0]).empty()) {
+            continue;
+        }
+        if (first) {
+            first = false;
+            std::vector<CsvColumn> header;
+            bool isHeader = false;
+            for (const std::string& cell : cells) {
+                header.push_back(RecognizeHeader(cell));
+                isHeader = isHeader || header.back() == CsvLayer;
+            }
+            if (isHeader) {
+                columns = header;
+                continue;
+            }
+        }
+
+        Entry entry;
+        entry.line = line;
+        for (size_t i = 0; i < cells.size() && i < columns.size(); ++i) {
+            switch (columns[i]) {
+                case CsvFolder:   entry.folderPath = FromUtf8(TrimAscii(cells[i])); break;
+                case CsvLayer:    entry.layerName = FromUtf8(TrimAscii(cells[i])); break;
+                case CsvHidden:   entry.hidden = ParseHidden(cells[i]); break;
+                case CsvElements: AddElementList(entry, cells[i]); break;
+                default: break;
+            }
+        }
+        FinishEntry(entry, plan);
+    }
+}
+
+// ---------------- JSON ----------------
+// Разбор ровно в том объёме, который нужен плану: объекты, массивы, строки, числа, true/false/null
+struct JsonValue {
+    enum Kind { Null, Bool, Number, String, Array, Object };
+    Kind                        kind = Null;
+    bool                        boolean = false;
+    std::string                 text;           // String; Number — как в файле
+    std::vector<JsonValue>      items;          // Array, Object (значения)
+    std::vector<std::string>    names;          // Object (ключи)
+
+    const JsonValue* Find(const char* name) const
+    {
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (names[i] == name) return &items[i];
+        }
+        return nullptr;
+    }
+};
+
+class JsonReader {
+public:
+    JsonReader(const std::string& text, size_t start) : text(text), pos(start) {}
+
+    bool Parse(JsonValue& value)
+    {
+        if (!ParseValue(value, 0)) return false;
+        SkipSpace();
+        return pos == text.size();
+    }
+
+    size_t GetPosition() const { return pos; }
+
+private:
+    void SkipSpace()
+    {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) ++pos;
+    }
+
+    bool Expect(const char* word)
+    {
+        const size_t length = std::strlen(word);
+        if (text.compare(pos, length, word) != 0) return false;
+        pos += length;
+        return true;
+    }
+
+    static void AppendUtf8(std::string& out, UInt32 code)
+    {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool ReadHex4(UInt32& code)
+    {
+        if (pos + 4 > text.size()) return false;
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = text[pos++];
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= static_cast<UInt32>(c - '0');
+            else if (c >= 'a' && c <= 'f') code |= static_cast<UInt32>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') code |= static_cast<UInt32>(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    }
+
+    bool ParseString(std::string& out)
+    {
+        ++pos; // открывающая кавычка
+        while (pos < text.size()) {
+            const char c = text[pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) return false;
+            const char escape = text[pos++];
+            switch (escape) {
+                case '"':  out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/'; break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u': {
+                    UInt32 code = 0;
+                    if (!ReadHex4(code)) return false;
+                    // Суррогатная пара
+                    if (code >= 0xD800 && code <= 0xDBFF && pos + 6 <= text.size() && text[pos] == '\\' && text[pos + 1] == 'u') {
+                        pos += 2;
+                        UInt32 low = 0;
+                        if (!ReadHex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    AppendUtf8(out, code);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    bool ParseValue(JsonValue& value, int depth)
+    {
+        if (depth > 32) return false;
+        SkipSpace();
+        if (pos >= text.size()) return false;
+
+        const char c = text[pos];
+        if (c == '"') {
+            value.kind = JsonValue::String;
+            return ParseString(value.text);
+        }
+        if (c == '{' || c == '[') {
+            const bool isObject = (c == '{');
+            const char close = isObject ? '}' : ']';
+            value.kind = isObject ? JsonValue::Object : JsonValue::Array;
+            ++pos;
+            SkipSpace();
+            if (pos < text.size() && text[pos] == close) {
+                ++pos;
+                return true;
+            }
+            while (true) {
+                if (isObject) {
+                    SkipSpace();
+                    if (pos >= text.size() || text[pos] != '"') return false;
+                    value.names.emplace_back();
+                    if (!ParseString(value.names.back())) return false;
+                    SkipSpace();
+                    if (pos >= text.size() || text[pos] != ':') return false;
+                    ++pos;
+                }
+                value.items.emplace_back();
+                if (!ParseValue(value.items.back(), depth + 1)) return false;
+                SkipSpace();
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') {
+                    ++pos;
+                    continue;
+                }
+                if (text[pos] != close) return false;
+                ++pos;
+                return true;
+            }
+        }
+        if (Expect("true")) {
+            value.kind = JsonValue::Bool;
+            value.boolean = true;
+            return true;
+        }
+        if (Expect("false")) {
+            value.kind = JsonValue::Bool;
+            return true;
+        }
+        if (Expect("null")) {
+            return true;
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            value.kind = JsonValue::Number;
+            while (pos < text.size() && std::strchr("+-0123456789.eE", text[pos]) != nullptr) {
+                value.text += text[pos++];
+            }
+            return true;
+        }
+        return false;
+    }
+
+    const std::string& text;
+    size_t             pos;
+};
+
+static void AddJsonElements(Entry& entry, const JsonValue* value, bool forceId, bool forceGuid)
+{
+    if (value == nullptr) {
+        return;
+    }
+    if (value->kind == JsonValue::String) {
+        if (forceId) {
+            AddElementToken(entry, value->text, true);
+        } else {
+            AddElementList(entry, value->text);
+        }
+        return;
+    }
+    for (const JsonValue& item : value->items) {
+        if (item.kind != JsonValue::String) continue;
+        const USize before = entry.idPatterns.GetSize();
+        AddElementToken(entry, item.text, forceId);
+        // В "guids" не-GUID — ошибка в плане, а не шаблон ID
+        if (forceGuid && entry.idPatterns.GetSize() > before) {
+            entry.idPatterns.Pop();
+        }
+    }
+}
+
+static void ParseJson(const std::string& text, size_t start, Plan& plan)
+{
+    JsonValue root;
+    JsonReader reader(text, start);
+    if (!reader.Parse(root)) {
+        plan.errors.Push(GS::UniString::Printf("Ошибка JSON около позиции %u", (unsigned)reader.GetPosition()));
+        return;
+    }
+
+    const JsonValue* list = &root;
+    if (root.kind == JsonValue::Object) {
+        list = root.Find("layers");
+    }
+    if (list == nullptr || list->kind != JsonValue::Array) {
+        plan.errors.Push("JSON: ожидается массив слоёв или объект с полем \"layers\"");
+        return;
+    }
+
+    UInt32 index = 0;
+    for (const JsonValue& item : list->items) {
+        ++index;
+        if (item.kind != JsonValue::Object) {
+            plan.errors.Push(GS::UniString::Printf("Элемент %u: ожидается объект", (unsigned)index));
+            continue;
+        }
+        Entry entry;
+        entry.line = index;
+        if (const JsonValue* folder = item.Find("folder")) entry.folderPath = FromUtf8(folder->text);
+        if (const JsonValue* layer = item.Find("layer")) entry.layerName = FromUtf8(layer->text);
+        if (const JsonValue* hidden = item.Find("hidden")) {
+            entry.hidden = (hidden->kind == JsonValue::Bool) ? (hidden->boolean ? 1 : 0) : ParseHidden(hidden->text);
+        }
+        AddJsonElements(entry, item.Find("elements"), false, false);
+        AddJsonElements(entry, item.Find("guids"), false, true);
+        AddJsonElements(entry, item.Find("ids"), true, false);
+        FinishEntry(entry, plan);
+    }
+}
+
+// ---------------- Разбор плана ----------------
+bool ParsePlan(const std::string& utf8, Plan& plan)
+{
+    const auto started = std::chrono::steady_clock::now();
+    plan = Plan();
+
+    size_t start = 0;
+    if (utf8.size() >= 3 && utf8.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        start = 3;
+    }
+    size_t first = start;
+    while (first < utf8.size() && (utf8[first] == ' ' || utf8[first] == '\t' || utf8[first] == '\r' || utf8[first] == '\n')) ++first;
+
+    if (first < utf8.size() && (utf8[first] == '[' || utf8[first] == '{')) {
+        ParseJson(utf8, first, plan);
+    } else {
+        ParseCsv(utf8, start, plan);
+    }
+
+    plan.parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return !plan.entries.IsEmpty();
+}
+
+bool LoadPlan(const GS::UniString& path, Plan& plan)
+{
+    std::string data;
+    if (!FileIO::ReadWholeFile(path, data)) {
+        plan = Plan();
+        plan.errors.Push(GS::UniString("Не удалось прочитать файл: ") + path);
+        return false;
+    }
+    return ParsePlan(data, plan);
+}
+
+// ---------------- Поиск элементов по ID ----------------
+static bool HasWildcards(const GS::UniString& pattern)
+{
+    return pattern.Contains(GS::UniChar('*')) || pattern.Contains(GS::UniChar('?'));
+}
+
+bool MatchPattern(const GS::UniString& text, const GS::UniString& pattern)
+{
+    const USize textLength = text.GetLength();
+    const USize patternLength = pattern.GetLength();
+    USize t = 0;
+    USize p = 0;
+    USize star = MaxUSize;
+    USize mark = 0;
+    while (t < textLength) {
+        if (p < patternLength && (pattern[p] == GS::UniChar('?') || pattern[p] == text[t])) {
+            ++t;
+            ++p;
+        } else if (p < patternLength && pattern[p] == GS::UniChar('*')) {
+            star = p++;
+            mark = t;
+        } else if (star != MaxUSize) {
+            p = star + 1;
+            t = ++mark;
+        } else {
+            return false;
+        }
+    }
+    while (p < patternLength && pattern[p] == GS::UniChar('*')) ++p;
+    return p == patternLength;
+}
+
+// Шаблоны ID разрешаются по общему индексу ElementIdIndex — без прохода по модели
+static UInt32 ResolvePatterns(const Entry& entry, GS::Array<API_Guid>& resolved, GS::Array<GS::UniString>& messages)
+{
+    UInt32 unmatched = 0;
+    for (const GS::UniString& pattern : entry.idPatterns) {
+        const USize before = resolved.GetSize();
+        if (!HasWildcards(pattern)) {
+            resolved.Append(ElementIdIndex::FindById(pattern));
+        } else {
+            ElementIdIndex::ForEachId([&](const GS::UniString& id, const GS::Array<API_Guid>& guids) {
+                if (MatchPattern(id, pattern)) {
+                    resolved.Append(guids);
+                }
+            });
+        }
+        if (resolved.GetSize() == before) {
+            ++unmatched;
+            AddMessage(messages, GS::UniString::Printf("Строка %u: нет элементов с ID ", (unsigned)entry.line) + pattern);
+        }
+    }
+    return unmatched;
+}
+
+// ---------------- Выполнение плана ----------------
+Result Run(const Plan& plan, bool dryRun)
+{
+    Result result;
+    result.dryRun = dryRun;
+    result.parseSeconds = plan.parseSeconds;
+    for (const GS::UniString& error : plan.errors) {
+        AddMessage(result.messages, error);
+    }
+    if (plan.entries.IsEmpty()) {
+        return result;
+    }
+
+    // 1. Элементы каждой строки. Идём с конца: элемент, указанный в нескольких строках,
+    //    достаётся последней из них — так же, как если бы строки применялись по порядку
+    auto started = std::chrono::steady_clock::now();
+    const USize entryCount = plan.entries.GetSize();
+    GS::Array<GS::Array<API_Guid>> elements;
+    elements.SetSize(entryCount);
+    result.entries.SetSize(entryCount);
+    GS::HashTable<API_Guid, bool> claimed;
+
+    for (UIndex i = entryCount; i > 0; --i) {
+        const Entry& entry = plan.entries[i - 1];
+        EntryReport& report = result.entries[i - 1];
+        report.folderPath = entry.folderPath;
+        report.layerName = entry.layerName;
+        report.hidden = entry.hidden;
+
+        GS::Array<API_Guid> candidates = entry.guids;
+        report.unmatchedPatterns = ResolvePatterns(entry, candidates, result.messages);
+
+        GS::HashTable<API_Guid, bool> inEntry;
+        for (const API_Guid& guid : candidates) {
+            if (inEntry.ContainsKey(guid)) continue;
+            inEntry.Add(guid, true);
+            if (claimed.ContainsKey(guid)) {
+                ++result.conflicts;
+                continue;
+            }
+            claimed.Add(guid, true);
+            elements[i - 1].Push(guid);
+        }
+        report.elements = elements[i - 1].GetSize();
+    }
+
+    // 2. Что уже есть в проекте: папки и слои (по кэшам LayerHelper)
+    GS::HashTable<GS::UniString, bool> missingFolders;
+    GS::HashTable<GS::UniString, bool> missingLayers;
+    for (UIndex i = 0; i < entryCount; ++i) {
+        EntryReport& report = result.entries[i];
+        GS::Guid folderGuid;
+        report.folderExists = LayerHelper::FindLayerFolder(report.folderPath, folderGuid);
+        report.layerExists = LayerHelper::FindLayerByName(report.layerName).IsPositive();
+        if (!report.folderExists && !missingFolders.ContainsKey(report.folderPath)) {
+            missingFolders.Add(report.folderPath, true);
+            ++result.foldersCreated;
+        }
+        if (!report.layerExists && !missingLayers.ContainsKey(report.layerName)) {
+            missingLayers.Add(report.layerName, true);
+            ++result.layersCreated;
+        }
+    }
+    result.resolveSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    started = std::chrono::steady_clock::now();
+    if (dryRun) {
+        // 3а. Пробный прогон: сколько элементов уже в нужном слое и сколько не найдено
+        for (UIndex i = 0; i < entryCount; ++i) {
+            EntryReport& report = result.entries[i];
+            const API_AttributeIndex layerIndex = report.layerExists ? LayerHelper::FindLayerByName(report.layerName) : APIInvalidAttributeIndex;
+            for (const API_Guid& guid : elements[i]) {
+                API_Elem_Head head = {};
+                head.guid = guid;
+                if (ACAPI_Element_GetHeader(&head) != NoError) {
+                    ++report.failed;
+                } else if (report.layerExists && head.layer == layerIndex) {
+                    ++report.unchanged;
+                } else {
+                    ++report.moved;
+                }
+            }
+            result.elementsMoved += report.moved;
+            result.elementsFailed += report.failed;
+        }
+        result.success = true;
+    } else {
+        // 3б. Весь план — одна Undo-команда (BatchMutation); отказы отдельных элементов и слоёв
+        // её не прерывают, отмена пользователем откатывает весь план
+        UInt32 elementCount = 0;
+        for (UIndex i = 0; i < entryCount; ++i) {
+            elementCount += elements[i].GetSize();
+        }
+        const BatchMutation::Report batch = BatchMutation::Run("Layer Plan Import", "Раскладка по слоям", elementCount, [&]() -> GSErrCode {
+            for (UIndex i = 0; i < entryCount; ++i) {
+                EntryReport& report = result.entries[i];
+                API_AttributeIndex layerIndex;
+                if (!LayerHelper::CreateLayer(report.folderPath, report.layerName, layerIndex)) {
+                    report.failed = report.elements;
+                    result.elementsFailed += report.failed;
+                    AddMessage(result.messages, GS::UniString::Printf("Строка %u: не удалось создать слой ", (unsigned)plan.entries[i].line) + report.layerName);
+                    continue;
+                }
+
+                if (!elements[i].IsEmpty()) {
+                    LayerHelper::LayerMoveResult moveResult;
+                    LayerHelper::MoveElementsToLayer(elements[i], layerIndex, &moveResult);
+                    report.moved = moveResult.moved;
+                    report.unchanged = moveResult.unchanged;
+                    report.failed = moveResult.failedGuids.GetSize();
+                    result.elementsMoved += report.moved;
+                    result.elementsFailed += report.failed;
+                }
+
+                if (report.hidden >= 0 && !LayerHelper::SetLayerVisibility(layerIndex, report.hidden == 1)) {
+                    AddMessage(result.messages, GS::UniString::Printf("Строка %u: не удалось изменить видимость слоя ", (unsigned)plan.entries[i].line) + report.layerName);
+                }
+                if (!BatchMutation::Step(0)) {
+                    return APIERR_CANCEL;
+                }
+            }
+            return NoError;
+        });
+        result.success = batch.success;
+        result.canceled = batch.canceled;
+        if (!batch.success) {
+            // Команда откатана: слоёв и папок из плана нет, элементы на прежних местах
+            LayerHelper::InvalidateLayerIndex();
+            result.elementsMoved = 0;
+            for (EntryReport& report : result.entries) {
+                report.moved = 0;
+            }
+            result.messages.Insert(0, batch.canceled ? GS::UniString("Отменено — изменения откатаны") : GS::UniString("Ошибка — изменения откатаны"));
+        }
+    }
+    result.applySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[LayerPlan] %s: строк %u, папок %u, слоёв %u, элементов %u, ошибок %u, %.2f+%.2f+%.2f с", false,
+        dryRun ? "Пробный прогон" : "Импорт", (unsigned)entryCount, (unsigned)result.foldersCreated, (unsigned)result.layersCreated,
+        (unsigned)result.elementsMoved, (unsigned)result.elementsFailed, result.parseSeconds, result.resolveSeconds, result.applySeconds);
+#endif
+    return result;
+}
+
+} // namespace LayerPlan
@@ -0,0 +1,87 @@
+#ifndef LAYERPLAN_HPP
+#define LAYERPLAN_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+#include <string>
+
+// План раскладки по слоям из таблицы: папки, слои, видимость и элементы (GUID или шаблоны ID).
+// Весь план выполняется одной Undo-командой; пробный прогон только считает, что будет сделано.
+//
+// CSV (разделитель ; , или табуляция, UTF-8, кавычки по RFC 4180):
+//   folder;layer;hidden;elements
+//   Ландшафт/Деревья;Сосны;0;SOS-* 3F2504E0-4F89-11D3-9A0C-0305E82C3301
+// Заголовок необязателен (тогда колонки в этом порядке); допускаются русские имена колонок
+// (папка, слой, скрыть, элементы). Элементы — через пробел или |.
+//
+// JSON:
+//   [ { "folder": "Ландшафт/Деревья", "layer": "Сосны", "hidden": false,
+//       "elements": ["SOS-*"], "guids": ["..."], "ids": ["..."] } ]
+//   или { "layers": [ ... ] }
+//
+// Элемент, похожий на GUID, — GUID; остальное — ID элемента, * и ? — подстановочные знаки.
+namespace LayerPlan {
+
+    // Одна строка плана
+    struct Entry {
+        GS::UniString              folderPath;
+        GS::UniString              layerName;
+        Int32                      hidden = -1;      // -1 не задано, 0 показать, 1 скрыть
+        GS::Array<API_Guid>        guids;
+        GS::Array<GS::UniString>   idPatterns;
+        UInt32                     line = 0;         // строка CSV / номер объекта JSON
+    };
+
+    struct Plan {
+        GS::Array<Entry>           entries;
+        GS::Array<GS::UniString>   errors;           // строки, которые не удалось разобрать
+        double                     parseSeconds = 0.0;
+    };
+
+    // Разобрать план (CSV или JSON — по первому символу)
+    bool ParsePlan(const std::string& utf8, Plan& plan);
+
+    // Прочитать и разобрать файл плана
+    bool LoadPlan(const GS::UniString& path, Plan& plan);
+
+    // Итог по строке плана
+    struct EntryReport {
+        GS::UniString folderPath;
+        GS::UniString layerName;
+        Int32         hidden = -1;
+        bool          folderExists = false;
+        bool          layerExists = false;
+        UInt32        elements = 0;           // найдено элементов
+        UInt32        unchanged = 0;          // уже в нужном слое
+        UInt32        moved = 0;              // перенесено (пробный прогон — будет перенесено)
+        UInt32        failed = 0;
+        UInt32        unmatchedPatterns = 0;  // шаблоны ID без единого элемента
+    };
+
+    struct Result {
+        bool                       success = false;
+        bool                       dryRun = true;
+        bool                       canceled = false;     // отменено пользователем, изменения откатаны
+        GS::Array<EntryReport>     entries;
+        UInt32                     foldersCreated = 0;
+        UInt32                     layersCreated = 0;
+        UInt32                     elementsMoved = 0;
+        UInt32                     elementsFailed = 0;
+        UInt32                     conflicts = 0;         // элементы, указанные в нескольких строках (побеждает последняя)
+        GS::Array<GS::UniString>   messages;
+        double                     parseSeconds = 0.0;
+        double                     resolveSeconds = 0.0;
+        double                     applySeconds = 0.0;
+    };
+
+    // Выполнить план (dryRun — только отчёт, модель не меняется)
+    Result Run(const Plan& plan, bool dryRun);
+
+    // Сравнение с шаблоном ID: * — любая последовательность, ? — один символ (с учётом регистра)
+    bool MatchPattern(const GS::UniString& text, const GS::UniString& pattern);
+
+} // namespace LayerPlan
+
+#endif // LAYERPLAN_HPP
@@ -0,0 +1,669 @@
+#include "LayerRules.hpp"
+#include "AddOnPreferences.hpp"
+#include "ElementNameCache.hpp"
+#include "PropertyUtils.hpp"
+#include "SelectionGroupHelper.hpp"
+
+#include <chrono>
+#include <cstdlib>
+
+namespace LayerRules {
+
+static const char*  SectionTag = "layer-rules";
+static const UInt32 FormatVersion = 1;
+
+static GS::UniString rulesText;
+static bool          rulesLoaded = false;
+
+// ---------------- Разбор текста ----------------
+static bool IsSpace(GS::UniChar c)
+{
+    return c == GS::UniChar(' ') || c == GS::UniChar('\t') || c == GS::UniChar('\r');
+}
+
+static GS::UniString Trimmed(const GS::UniString& text)
+{
+    GS::UniString result = text;
+    result.Trim();
+    return result;
+}
+
+static GS::UniString Substring(const GS::UniString& text, UIndex from, UIndex to)
+{
+    return (to > from) ? text.GetSubstring(from, to - from) : GS::UniString();
+}
+
+// Первая из лексем вне кавычек, начиная с from; false — ни одной
+static bool FindOutsideQuotes(const GS::UniString& text, const GS::Array<GS::UniString>& tokens, UIndex from, UIndex& position, USize& length)
+{
+    bool quoted = false;
+    for (UIndex i = from; i < text.GetLength(); ++i) {
+        if (text[i] == GS::UniChar('"')) {
+            quoted = !quoted;
+            continue;
+        }
+        if (quoted) {
+            continue;
+        }
+        for (const GS::UniString& token : tokens) {
+            if (i + token.GetLength() <= text.GetLength() && text.GetSubstring(i, token.GetLength()).IsEqual(token, GS::CaseInsensitive)) {
+                position = i;
+                length = token.GetLength();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// "значение в кавычках" -> значение; "" внутри — одна кавычка
+static GS::UniString Unquote(const GS::UniString& text)
+{
+    GS::UniString value = Trimmed(text);
+    if (value.GetLength() >= 2 && value[0] == GS::UniChar('"') && value[value.GetLength() - 1] == GS::UniChar('"')) {
+        value = value.GetSubstring(1, value.GetLength() - 2);
+        value.ReplaceAll("\"\"", "\"");
+    }
+    return value;
+}
+
+static bool ParseNumber(const GS::UniString& text, double& number)
+{
+    GS::UniString normalized = Trimmed(text);
+    normalized.ReplaceAll(",", ".");
+    if (normalized.IsEmpty()) {
+        return false;
+    }
+    const GS::UniString::CStr cstr = normalized.ToCStr();
+    char* end = nullptr;
+    number = std::strtod(cstr.Get(), &end);
+    return end != nullptr && *end == '\0';
+}
+
+static bool IsOneOf(const GS::UniString& word, const char* first, const char* second, const char* third = nullptr)
+{
+    return word.IsEqual(GS::UniString(first, CC_UTF8), GS::CaseInsensitive) ||
+           word.IsEqual(GS::UniString(second, CC_UTF8), GS::CaseInsensitive) ||
+           (third != nullptr && word.IsEqual(GS::UniString(third, CC_UTF8), GS::CaseInsensitive));
+}
+
+static bool IsNumericOperator(Operator op)
+{
+    return op == Operator::Greater || op == Operator::Less || op == Operator::GreaterOrEqual || op == Operator::LessOrEqual;
+}
+
+static bool ParseField(const GS::UniString& name, Condition& condition, GS::UniString& error)
+{
+    if (IsOneOf(name, "type", "тип")) {
+        condition.field = Field::Type;
+        return true;
+    }
+    if (IsOneOf(name, "id", "ид")) {
+        condition.field = Field::ID;
+        return true;
+    }
+    if (IsOneOf(name, "layer", "слой")) {
+        condition.field = Field::Layer;
+        return true;
+    }
+    if (IsOneOf(name, "lib", "библ", "библиотека")) {
+        condition.field = Field::LibraryPart;
+        return true;
+    }
+
+    for (const char* prefix : { "prop:", "свойство:" }) {
+        const GS::UniString prefixText(prefix, CC_UTF8);
+        if (name.GetLength() > prefixText.GetLength() &&
+            name.GetSubstring(0, prefixText.GetLength()).IsEqual(prefixText, GS::CaseInsensitive)) {
+            const GS::UniString guidText = Trimmed(name.GetSubstring(prefixText.GetLength(), name.GetLength() - prefixText.GetLength()));
+            condition.field = Field::Property;
+            condition.propertyGuid = APIGuidFromString(guidText.ToCStr().Get());
+            if (condition.propertyGuid == APINULLGuid) {
+                error = GS::UniString("неверный GUID свойства ") + guidText;
+                return false;
+            }
+            return true;
+        }
+    }
+    error = GS::UniString("неизвестное поле ") + name;
+    return false;
+}
+
+static bool ParseCondition(const GS::UniString& text, Condition& condition, GS::UniString& error)
+{
+    const GS::UniString trimmed = Trimmed(text);
+    if (trimmed == "*") {
+        condition.field = Field::Any;
+        return true;
+    }
+
+    // Поле — до пробела или знака операции
+    UIndex i = 0;
+    while (i < trimmed.GetLength() && !IsSpace(trimmed[i]) &&
+           trimmed[i] != GS::UniChar('=') && trimmed[i] != GS::UniChar('!') && trimmed[i] != GS::UniChar('~') &&
+           trimmed[i] != GS::UniChar('<') && trimmed[i] != GS::UniChar('>')) {
+        ++i;
+    }
+    if (i == 0) {
+        error = GS::UniString("нет поля в условии ") + trimmed;
+        return false;
+    }
+    if (!ParseField(trimmed.GetSubstring(0, i), condition, error)) {
+        return false;
+    }
+    while (i < trimmed.GetLength() && IsSpace(trimmed[i])) ++i;
+
+    struct OperatorToken { const char* text; Operator op; bool word; };
+    static const OperatorToken operators[] = {
+        { "!=", Operator::NotEquals, false },      { ">=", Operator::GreaterOrEqual, false },
+        { "<=", Operator::LessOrEqual, false },    { "=", Operator::Equals, false },
+        { "~", Operator::Matches, false },         { ">", Operator::Greater, false },
+        { "<", Operator::Less, false },            { "содержит", Operator::Contains, true },
+        { "contains", Operator::Contains, true },
+    };
+    bool found = false;
+    for (const OperatorToken& token : operators) {
+        const GS::UniString tokenText(token.text, CC_UTF8);
+        const USize length = tokenText.GetLength();
+        if (i + length > trimmed.GetLength() || !trimmed.GetSubstring(i, length).IsEqual(tokenText, GS::CaseInsensitive)) {
+            continue;
+        }
+        if (token.word && i + length < trimmed.GetLength() && !IsSpace(trimmed[i + length])) {
+            continue;
+        }
+        condition.op = token.op;
+        i += length;
+        found = true;
+        break;
+    }
+    if (!found) {
+        error = GS::UniString("нет операции в условии ") + trimmed;
+        return false;
+    }
+
+    condition.value = Unquote(Substring(trimmed, i, trimmed.GetLength()));
+    if (IsNumericOperator(condition.op)) {
+        double number = 0.0;
+        if (condition.field != Field::Property) {
+            error = GS::UniString("сравнение чисел только для свойств: ") + trimmed;
+            return false;
+        }
+        if (!ParseNumber(condition.value, number)) {
+            error = GS::UniString("не число: ") + condition.value;
+            return false;
+        }
+    }
+    return true;
+}
+
+// "Папка/Подпапка/Слой [скрыть]"
+static bool ParseTarget(const GS::UniString& text, Rule& rule, GS::UniString& error)
+{
+    GS::UniString target = Trimmed(text);
+    if (target.GetLength() > 2 && target[target.GetLength() - 1] == GS::UniChar(']')) {
+        UIndex open = target.GetLength() - 1;
+        while (open > 0 && target[open] != GS::UniChar('[')) --open;
+        if (target[open] == GS::UniChar('[')) {
+            const GS::UniString flag = Trimmed(Substring(target, open + 1, target.GetLength() - 1));
+            if (IsOneOf(flag, "hide", "скрыть")) {
+                rule.hidden = 1;
+            } else if (IsOneOf(flag, "show", "показать")) {
+                rule.hidden = 0;
+            } else {
+                error = GS::UniString("неизвестный флаг [") + flag + "]";
+                return false;
+            }
+            target = Trimmed(target.GetSubstring(0, open));
+        }
+    }
+    target = Unquote(target);
+
+    UIndex slash = target.GetLength();
+    while (slash > 0 && target[slash - 1] != GS::UniChar('/')) --slash;
+    rule.layerName = Trimmed(Substring(target, slash, target.GetLength()));
+    rule.folderPath = (slash > 0) ? Trimmed(target.GetSubstring(0, slash - 1)) : GS::UniString();
+    if (rule.layerName.IsEmpty()) {
+        error = GS::UniString("не указан слой");
+        return false;
+    }
+    return true;
+}
+
+static bool ParseRule(const GS::UniString& line, Rule& rule, GS::UniString& error)
+{
+    static const GS::Array<GS::UniString> arrow = { GS::UniString("->") };
+    static const GS::Array<GS::UniString> conjunctions = {
+        GS::UniString("&&"), GS::UniString(" и ", CC_UTF8), GS::UniString(" and ")
+    };
+
+    UIndex arrowPosition = 0;
+    USize arrowLength = 0;
+    if (!FindOutsideQuotes(line, arrow, 0, arrowPosition, arrowLength)) {
+        error = GS::UniString("нет -> и целевого слоя");
+        return false;
+    }
+    if (!ParseTarget(Substring(line, arrowPosition + arrowLength, line.GetLength()), rule, error)) {
+        return false;
+    }
+
+    const GS::UniString conditions = line.GetSubstring(0, arrowPosition);
+    UIndex start = 0;
+    while (true) {
+        UIndex separator = conditions.GetLength();
+        USize separatorLength = 0;
+        const bool more = FindOutsideQuotes(conditions, conjunctions, start, separator, separatorLength);
+        Condition condition;
+        if (!ParseCondition(Substring(conditions, start, separator), condition, error)) {
+            return false;
+        }
+        rule.conditions.Push(condition);
+        if (!more) {
+            break;
+        }
+        start = separator + separatorLength;
+    }
+    return true;
+}
+
+bool ParseRules(const GS::UniString& text, RuleSet& ruleSet)
+{
+    ruleSet = RuleSet();
+    UInt32 lineNumber = 0;
+    UIndex start = 0;
+    while (start <= text.GetLength()) {
+        UIndex end = start;
+        while (end < text.GetLength() && text[end] != GS::UniChar('\n')) ++end;
+        ++lineNumber;
+
+        const GS::UniString line = Trimmed(Substring(text, start, end));
+        start = end + 1;
+        if (line.IsEmpty() || line[0] == GS::UniChar('#')) {
+            continue;
+        }
+
+        Rule rule;
+        rule.line = lineNumber;
+        GS::UniString error;
+        if (ParseRule(line, rule, error)) {
+            ruleSet.rules.Push(rule);
+        } else {
+            ruleSet.errors.Push(GS::UniString::Printf("Строка %u: ", (unsigned)lineNumber) + error);
+        }
+    }
+    return ruleSet.errors.IsEmpty();
+}
+
+// ---------------- Хранение ----------------
+static void EnsureLoaded()
+{
+    if (rulesLoaded) {
+        return;
+    }
+    rulesLoaded = true;
+
+    std::string data;
+    if (!AddOnPreferences::ReadSection(SectionTag, data)) {
+        return;
+    }
+    AddOnPreferences::Reader reader(data);
+    UInt32 version = 0;
+    if (!reader.GetUInt32(version) || version < 1 || version > FormatVersion || !reader.GetString(rulesText)) {
+        rulesText.Clear();
+#ifdef DEBUG_UI_LOGS
+        ACAPI_WriteReport("[LayerRules] Не удалось прочитать правила из настроек", false);
+#endif
+    }
+}
+
+const GS::UniString& GetRulesText()
+{
+    EnsureLoaded();
+    return rulesText;
+}
+
+bool SaveRulesText(const GS::UniString& text, GS::Array<GS::UniString>& errors)
+{
+    EnsureLoaded();
+    RuleSet ruleSet;
+    ParseRules(text, ruleSet);
+    errors = ruleSet.errors;
+
+    rulesText = text;
+    std::string data;
+    if (!text.IsEmpty()) {
+        AddOnPreferences::PutUInt32(data, FormatVersion);
+        AddOnPreferences::PutString(data, text);
+    }
+    return AddOnPreferences::WriteSection(SectionTag, data);
+}
+
+// ---------------- Сборка правил ----------------
+// Значения приведены к нижнему регистру и разобраны заранее, свойства всех правил
+// читаются одним запросом, условия внутри правила идут от дешёвых к дорогим
+struct CompiledCondition {
+    Field         field = Field::Any;
+    Operator      op = Operator::Equals;
+    GS::UniString value;          // в нижнем регистре
+    double        number = 0.0;
+    UIndex        slot = 0;       // номер свойства в propertyGuids
+};
+
+struct CompiledRule {
+    GS::Array<CompiledCondition> conditions;
+    UIndex                       target = 0;
+};
+
+struct CompiledRules {
+    GS::Array<CompiledRule>          rules;
+    GS::Array<LayerPlan::Entry>      targets;       // по одной на папку/слой
+    GS::Array<API_Guid>              propertyGuids;
+    GS::HashTable<API_Guid, UIndex>  propertySlots;
+};
+
+static UInt32 GetFieldCost(Field field)
+{
+    switch (field) {
+        case Field::Any:
+        case Field::Type:
+        case Field::Layer:       return 0;    // по заголовку
+        case Field::ID:          return 1;
+        case Field::Property:    return 2;
+        default:                 return 3;    // ACAPI_Element_Get + библиотечный элемент
+    }
+}
+
+static void Compile(const RuleSet& ruleSet, CompiledRules& compiled)
+{
+    GS::HashTable<GS::UniString, UIndex> targetIndices;
+
+    for (const Rule& rule : ruleSet.rules) {
+        CompiledRule compiledRule;
+
+        const GS::UniString targetKey = (rule.folderPath + "/" + rule.layerName).ToLowerCase();
+        if (!targetIndices.Get(targetKey, &compiledRule.target)) {
+            compiledRule.target = compiled.targets.GetSize();
+            targetIndices.Add(targetKey, compiledRule.target);
+            LayerPlan::Entry target;
+            target.folderPath = rule.folderPath;
+            target.layerName = rule.layerName;
+            target.line = rule.line;
+            compiled.targets.Push(target);
+        }
+        if (rule.hidden >= 0) {
+            compiled.targets[compiledRule.target].hidden = rule.hidden;
+        }
+
+        for (const Condition& condition : rule.conditions) {
+            if (condition.field == Field::Any) {
+                continue;
+            }
+            CompiledCondition compiledCondition;
+            compiledCondition.field = condition.field;
+            compiledCondition.op = condition.op;
+            compiledCondition.value = condition.value.ToLowerCase();
+            if (IsNumericOperator(condition.op)) {
+                ParseNumber(condition.value, compiledCondition.number);
+            }
+            if (condition.field == Field::Property) {
+                if (!compiled.propertySlots.Get(condition.propertyGuid, &compiledCondition.slot)) {
+                    compiledCondition.slot = compiled.propertyGuids.GetSize();
+                    compiled.propertySlots.Add(condition.propertyGuid, compiledCondition.slot);
+                    compiled.propertyGuids.Push(condition.propertyGuid);
+                }
+            }
+
+            // Вставка с сохранением порядка среди условий одной стоимости
+            UIndex position = compiledRule.conditions.GetSize();
+            while (position > 0 && GetFieldCost(compiledRule.conditions[position - 1].field) > GetFieldCost(condition.field)) {
+                --position;
+            }
+            compiledRule.conditions.Insert(position, compiledCondition);
+        }
+        compiled.rules.Push(compiledRule);
+    }
+}
+
+// ---------------- Проверка элементов ----------------
+// Данные элемента читаются лениво — только когда до условия с ними дошла очередь;
+// имена типов, слоёв и библиотечных элементов кешируются на весь проход
+class Evaluator {
+public:
+    explicit Evaluator(const CompiledRules& compiled) : compiled(compiled)
+    {
+        propertyTexts.SetSize(compiled.propertyGuids.GetSize());
+        propertyNumbers.SetSize(compiled.propertyGuids.GetSize());
+        propertyIsNumber.SetSize(compiled.propertyGuids.GetSize());
+    }
+
+    // Цель первого подошедшего правила; false — ни одно не подошло или элемента нет
+    bool Evaluate(const API_Guid& guid, UIndex& target)
+    {
+        head = {};
+        head.guid = guid;
+        if (ACAPI_Element_GetHeader(&head) != NoError) {
+            return false;
+        }
+        idLoaded = false;
+        propertiesLoaded = false;
+        libraryPartLoaded = false;
+
+        for (const CompiledRule& rule : compiled.rules) {
+            bool matches = true;
+            for (const CompiledCondition& condition : rule.conditions) {
+                if (!Test(condition)) {
+                    matches = false;
+                    break;
+                }
+            }
+            if (matches) {
+                target = rule.target;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static bool Compare(const GS::UniString& text, const CompiledCondition& condition)
+    {
+        switch (condition.op) {
+            case Operator::Equals:    return text == condition.value;
+            case Operator::NotEquals: return text != condition.value;
+            case Operator::Contains:  return text.Contains(condition.value);
+            case Operator::Matches:   return LayerPlan::MatchPattern(text, condition.value);
+            default:                  return false;
+        }
+    }
+
+    static bool CompareNumber(double number, const CompiledCondition& condition)
+    {
+        switch (condition.op) {
+            case Operator::Greater:        return number > condition.number;
+            case Operator::Less:           return number < condition.number;
+            case Operator::GreaterOrEqual: return number >= condition.number;
+            case Operator::LessOrEqual:    return number <= condition.number;
+            default:                       return false;
+        }
+    }
+
+    bool Test(const CompiledCondition& condition)
+    {
+        switch (condition.field) {
+            case Field::Type:        return Compare(GetTypeText(), condition);
+            case Field::Layer:       return Compare(GetLayerText(), condition);
+            case Field::ID:          return Compare(GetIDText(), condition);
+            case Field::LibraryPart: return Compare(GetLibraryPartText(), condition);
+            case Field::Property:
+                LoadProperties();
+                if (IsNumericOperator(condition.op)) {
+                    return propertyIsNumber[condition.slot] && CompareNumber(propertyNumbers[condition.slot], condition);
+                }
+                return Compare(propertyTexts[condition.slot], condition);
+            default:
+                return true;
+        }
+    }
+
+    const GS::UniString& GetTypeText()
+    {
+        const UInt64 key = (static_cast<UInt64>(head.type.typeID) << 32) | static_cast<UInt64>(head.type.variationID);
+        if (const GS::UniString* text = typeTexts.GetPtr(key)) {
+            return *text;
+        }
+        typeTexts.Add(key, names.GetTypeName(head.type).ToLowerCase());
+        return typeTexts[key];
+    }
+
+    const GS::UniString& GetLayerText()
+    {
+        const Int32 key = head.layer.ToInt32_Deprecated();
+        if (const GS::UniString* text = layerTexts.GetPtr(key)) {
+            return *text;
+        }
+        layerTexts.Add(key, names.GetLayerName(head.layer).ToLowerCase());
+        return layerTexts[key];
+    }
+
+    const GS::UniString& GetIDText()
+    {
+        if (!idLoaded) {
+            idLoaded = true;
+            id.Clear();
+            ACAPI_Element_GetElementInfoString(&head.guid, &id);
+            id = id.ToLowerCase();
+        }
+        return id;
+    }
+
+    // Имя библиотечного элемента объекта, светильника, окна или двери; у остальных — пусто
+    const GS::UniString& GetLibraryPartText()
+    {
+        if (libraryPartLoaded) {
+            return libraryPart;
+        }
+        libraryPartLoaded = true;
+        libraryPart.Clear();
+
+        const API_ElemTypeID typeID = head.type.typeID;
+        if (typeID != API_ObjectID && typeID != API_LampID && typeID != API_WindowID && typeID != API_DoorID) {
+            return libraryPart;
+        }
+        API_Element element = {};
+        element.header.guid = head.guid;
+        if (ACAPI_Element_Get(&element) != NoError) {
+            return libraryPart;
+        }
+        Int32 libInd = 0;
+        switch (typeID) {
+            case API_ObjectID: libInd = element.object.libInd; break;
+            case API_LampID:   libInd = element.lamp.libInd; break;
+            case API_WindowID: libInd = element.window.openingBase.libInd; break;
+            default:           libInd = element.door.openingBase.libInd; break;
+        }
+
+        if (const GS::UniString* text = libraryPartTexts.GetPtr(libInd)) {
+            libraryPart = *text;
+            return libraryPart;
+        }
+        API_LibPart libPart = {};
+        libPart.index = libInd;
+        if (ACAPI_LibraryPart_Get(&libPart) == NoError) {
+            libraryPart = GS::UniString(libPart.docu_UName).ToLowerCase();
+            delete libPart.location;
+        }
+        libraryPartTexts.Add(libInd, libraryPart);
+        return libraryPart;
+    }
+
+    void LoadProperties()
+    {
+        if (propertiesLoaded) {
+            return;
+        }
+        propertiesLoaded = true;
+        for (UIndex i = 0; i < propertyTexts.GetSize(); ++i) {
+            propertyTexts[i].Clear();
+            propertyIsNumber[i] = false;
+        }
+        properties.Clear();
+        if (ACAPI_Element_GetPropertyValuesByGuid(head.guid, compiled.propertyGuids, properties) != NoError) {
+            return;
+        }
+        for (const API_Property& property : properties) {
+            UIndex slot = 0;
+            if (!compiled.propertySlots.Get(property.definition.guid, &slot)) {
+                continue;
+            }
+            PropertyUtils::PropertyToString(property, propertyTexts[slot]);
+            propertyTexts[slot] = propertyTexts[slot].ToLowerCase();
+            propertyIsNumber[slot] = PropertyUtils::PropertyToDouble(property, propertyNumbers[slot]);
+        }
+    }
+
+    const CompiledRules&                   compiled;
+    ElementNameCache                       names;
+    GS::HashTable<UInt64, GS::UniString>   typeTexts;
+    GS::HashTable<Int32, GS::UniString>    layerTexts;
+    GS::HashTable<Int32, GS::UniString>    libraryPartTexts;
+
+    API_Elem_Head                          head = {};
+    bool                                   idLoaded = false;
+    bool                                   propertiesLoaded = false;
+    bool                                   libraryPartLoaded = false;
+    GS::UniString                          id;
+    GS::UniString                          libraryPart;
+    GS::Array<API_Property>                properties;
+    GS::Array<GS::UniString>               propertyTexts;
+    GS::Array<double>                      propertyNumbers;
+    GS::Array<bool>                        propertyIsNumber;
+};
+
+// ---------------- Выполнение ----------------
+RunResult Run(bool dryRun, bool selectionOnly)
+{
+    RunResult result;
+    result.plan.dryRun = dryRun;
+
+    RuleSet ruleSet;
+    ParseRules(GetRulesText(), ruleSet);
+
+    // Один проход: элемент уходит в цель первого подошедшего правила
+    const auto started = std::chrono::steady_clock::now();
+    CompiledRules compiled;
+    Compile(ruleSet, compiled);
+
+    LayerPlan::Plan plan;
+    plan.entries = compiled.targets;
+    plan.errors = ruleSet.errors;
+    if (!compiled.rules.IsEmpty()) {
+        const GS::Array<API_Guid> elements = SelectionGroupHelper::GetScopeElements(!selectionOnly);
+        Evaluator evaluator(compiled);
+        for (const API_Guid& guid : elements) {
+            ++result.scanned;
+            UIndex target = 0;
+            if (evaluator.Evaluate(guid, target)) {
+                plan.entries[target].guids.Push(guid);
+                ++result.matched;
+            }
+        }
+    }
+    result.evaluateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    // Цели без элементов не создаём
+    for (UIndex i = plan.entries.GetSize(); i > 0; --i) {
+        if (plan.entries[i - 1].guids.IsEmpty()) {
+            plan.entries.Delete(i - 1);
+        }
+    }
+    if (ruleSet.rules.IsEmpty() && ruleSet.errors.IsEmpty()) {
+        plan.errors.Push("Правила не заданы");
+    } else if (!ruleSet.rules.IsEmpty() && result.matched == 0) {
+        plan.errors.Push("Ни один элемент не подошёл под правила");
+    }
+
+    result.plan = LayerPlan::Run(plan, dryRun);
+    result.plan.dryRun = dryRun;
+    return result;
+}
+
+} // namespace LayerRules
@@ -0,0 +1,66 @@
+#ifndef LAYERRULES_HPP
+#define LAYERRULES_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+#include "LayerPlan.hpp"
+
+// Правила автоматической раскладки по слоям. Одна строка — одно правило:
+//   условие [&& условие ...] -> Папка/Подпапка/Слой [скрыть|показать]
+// Условия (все должны выполниться, регистр не важен):
+//   тип = Стена             type, id, слой/layer, библ/lib (имя библиотечного элемента),
+//   id ~ "СОС-*"            свойство:GUID / prop:GUID
+//   lib содержит Сосна      операции: = != ~ (шаблон * ?) содержит/contains,
+//   prop:GUID >= 2.5        для свойств ещё > < >= <= (числа)
+//   *                       любой элемент
+// Пустые строки и строки с # в начале пропускаются. Элемент получает первое подошедшее правило.
+// Весь набор проверяется за один проход по модели, перенос — одной Undo-командой (LayerPlan).
+namespace LayerRules {
+
+    enum class Field { Any, Type, ID, Layer, Property, LibraryPart };
+
+    enum class Operator { Equals, NotEquals, Contains, Matches, Greater, Less, GreaterOrEqual, LessOrEqual };
+
+    struct Condition {
+        Field          field = Field::Any;
+        API_Guid       propertyGuid = APINULLGuid;
+        Operator       op = Operator::Equals;
+        GS::UniString  value;
+    };
+
+    struct Rule {
+        GS::Array<Condition> conditions;     // И
+        GS::UniString        folderPath;
+        GS::UniString        layerName;
+        Int32                hidden = -1;     // -1 не задано, 0 показать, 1 скрыть
+        UInt32               line = 0;
+    };
+
+    struct RuleSet {
+        GS::Array<Rule>          rules;
+        GS::Array<GS::UniString> errors;      // строки, которые не удалось разобрать
+    };
+
+    // Разобрать текст правил
+    bool ParseRules(const GS::UniString& text, RuleSet& ruleSet);
+
+    // Текст правил из настроек аддона (пусто — правил нет)
+    const GS::UniString& GetRulesText();
+
+    // Сохранить текст правил; ошибки разбора — в errors (сохраняется и с ошибками)
+    bool SaveRulesText(const GS::UniString& text, GS::Array<GS::UniString>& errors);
+
+    struct RunResult {
+        LayerPlan::Result plan;               // отчёт по целевым слоям (строка = первое правило цели)
+        UInt32            scanned = 0;        // проверено элементов
+        UInt32            matched = 0;        // подошло под какое-либо правило
+        double            evaluateSeconds = 0.0;
+    };
+
+    // Применить сохранённые правила к модели или выделению (dryRun — только отчёт)
+    RunResult Run(bool dryRun, bool selectionOnly);
+
+} // namespace LayerRules
+
+#endif // LAYERRULES_HPP
@@ -0,0 +1,379 @@
+#include "LayerSearchIndex.hpp"
+
+#include <algorithm>
+
+static const int32_t ScoreExactName = 1000;
+static const int32_t ScoreNamePrefix = 600;
+static const int32_t ScoreNameWord = 400;
+static const int32_t ScoreNameSubstring = 250;
+static const int32_t ScoreFolderWord = 150;
+static const int32_t ScoreFolderSubstring = 100;
+static const int32_t ScoreFuzzyBase = 10;
+static const int32_t ScoreFuzzyRange = 40;
+
+static bool IsSeparator (char32_t c)
+{
+	if (c >= 128) {
+		return false;
+	}
+	return !((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'));
+}
+
+static uint64_t PackTrigram (const std::u32string& text, size_t position)
+{
+	return (static_cast<uint64_t>(text[position]) << 42) | (static_cast<uint64_t>(text[position + 1]) << 21) |
+		static_cast<uint64_t>(text[position + 2]);
+}
+
+static bool IsWordStart (const std::u32string& text, size_t position)
+{
+	return position == 0 || IsSeparator(text[position - 1]);
+}
+
+std::u32string LayerSearchIndex::Normalize (const std::string& utf8)
+{
+	std::u32string result;
+	result.reserve(utf8.size());
+	for (size_t i = 0; i < utf8.size(); ) {
+		const unsigned char lead = static_cast<unsigned char>(utf8[i]);
+		char32_t c = 0xFFFD;
+		size_t length = 1;
+		if (lead < 0x80) {
+			c = lead;
+		} else if ((lead & 0xE0) == 0xC0) {
+			length = 2;
+		} else if ((lead & 0xF0) == 0xE0) {
+			length = 3;
+		} else if ((lead & 0xF8) == 0xF0) {
+			length = 4;
+		}
+		if (length > 1) {
+			if (i + length > utf8.size()) {
+				length = utf8.size() - i;
+			} else {
+				c = lead & (0x7F >> length);
+				for (size_t k = 1; k < length; ++k) {
+					const unsigned char next = static_cast<unsigned char>(utf8[i + k]);
+					if ((next & 0xC0) != 0x80) {
+						c = 0xFFFD;
+						length = k;
+						break;
+					}
+					c = (c << 6) | (next & 0x3F);
+				}
+			}
+		}
+		i += length;
+
+		// Нижний регистр: ASCII, Latin-1, кириллица; ё приравнивается к е
+		if (c >= 'A' && c <= 'Z') {
+			c += 32;
+		} else if (c >= 0xC0 && c <= 0xDE && c != 0xD7) {
+			c += 32;
+		} else if (c >= 0x410 && c <= 0x42F) {
+			c += 32;
+		} else if (c >= 0x400 && c <= 0x40F) {
+			c += 80;
+		}
+		if (c == 0x451) {
+			c = 0x435;
+		}
+		result.push_back(c);
+	}
+	return result;
+}
+
+void LayerSearchIndex::Clear ()
+{
+	m_entries.clear();
+	m_texts.clear();
+	m_nameStart.clear();
+	m_rank.clear();
+	m_trigrams.clear();
+	m_words.clear();
+	m_marks.clear();
+	m_markGeneration = 0;
+}
+
+void LayerSearchIndex::Build (const std::vector<Entry>& entries)
+{
+	Clear();
+	m_entries = entries;
+	const uint32_t count = static_cast<uint32_t>(m_entries.size());
+	m_texts.reserve(count);
+	m_nameStart.reserve(count);
+
+	for (uint32_t entry = 0; entry < count; ++entry) {
+		std::u32string text = Normalize(m_entries[entry].folder);
+		if (!text.empty()) {
+			text.push_back('/');
+		}
+		m_nameStart.push_back(static_cast<uint32_t>(text.size()));
+		text += Normalize(m_entries[entry].name);
+
+		for (size_t position = 0; position + 3 <= text.size(); ++position) {
+			std::vector<uint32_t>& postings = m_trigrams[PackTrigram(text, position)];
+			if (postings.empty() || postings.back() != entry) {
+				postings.push_back(entry);
+			}
+		}
+		for (size_t position = 0; position < text.size(); ++position) {
+			if (IsSeparator(text[position]) || !IsWordStart(text, position)) {
+				continue;
+			}
+			size_t end = position;
+			while (end < text.size() && !IsSeparator(text[end])) {
+				++end;
+			}
+			m_words.push_back(Word { text.substr(position, end - position), entry });
+		}
+		m_texts.push_back(std::move(text));
+	}
+
+	std::sort(m_words.begin(), m_words.end(), [] (const Word& left, const Word& right) {
+		return left.text < right.text || (left.text == right.text && left.entry < right.entry);
+	});
+
+	std::vector<uint32_t> order(count);
+	for (uint32_t entry = 0; entry < count; ++entry) {
+		order[entry] = entry;
+	}
+	std::sort(order.begin(), order.end(), [this] (uint32_t left, uint32_t right) {
+		const std::u32string& leftText = m_texts[left];
+		const std::u32string& rightText = m_texts[right];
+		const int byName = leftText.compare(m_nameStart[left], std::u32string::npos, rightText, m_nameStart[right], std::u32string::npos);
+		return byName < 0 || (byName == 0 && leftText < rightText);
+	});
+	m_rank.resize(count);
+	for (uint32_t position = 0; position < count; ++position) {
+		m_rank[order[position]] = position;
+	}
+
+	m_marks.assign(count, 0);
+}
+
+// Позиция терма в записи: сначала в имени, затем где угодно.
+// Короткий терм (1–2 символа) ищется только в начале слова
+size_t LayerSearchIndex::FindTerm (uint32_t entry, const Term& term) const
+{
+	const std::u32string& text = m_texts[entry];
+	const bool wordOnly = term.text.size() < 3;
+	const size_t starts[2] = { m_nameStart[entry], 0 };
+	for (size_t from : starts) {
+		for (size_t position = text.find(term.text, from); position != std::u32string::npos; position = text.find(term.text, position + 1)) {
+			if (!wordOnly || IsWordStart(text, position)) {
+				return position;
+			}
+		}
+	}
+	return std::u32string::npos;
+}
+
+int32_t LayerSearchIndex::ScoreTerm (uint32_t entry, const Term& term, size_t position) const
+{
+	const size_t nameStart = m_nameStart[entry];
+	if (position >= nameStart) {
+		if (position == nameStart) {
+			return (term.text.size() == m_texts[entry].size() - nameStart) ? ScoreExactName : ScoreNamePrefix;
+		}
+		return IsWordStart(m_texts[entry], position) ? ScoreNameWord : ScoreNameSubstring;
+	}
+	return IsWordStart(m_texts[entry], position) ? ScoreFolderWord : ScoreFolderSubstring;
+}
+
+// Записи, которые могут содержать терм (проверяются потом FindTerm)
+void LayerSearchIndex::CollectCandidates (const Term& term, std::vector<uint32_t>& candidates) const
+{
+	candidates.clear();
+	if (!term.trigrams.empty()) {
+		// Самый короткий список триграмм терма; остальные триграммы проверит поиск подстроки
+		const std::vector<uint32_t>* shortest = nullptr;
+		for (uint64_t trigram : term.trigrams) {
+			const auto found = m_trigrams.find(trigram);
+			if (found == m_trigrams.end()) {
+				return;
+			}
+			if (shortest == nullptr || found->second.size() < shortest->size()) {
+				shortest = &found->second;
+			}
+		}
+		candidates = *shortest;
+		return;
+	}
+
+	// Короткий терм — слова с таким началом
+	const uint32_t generation = ++m_markGeneration;
+	auto word = std::lower_bound(m_words.begin(), m_words.end(), term.text, [] (const Word& item, const std::u32string& prefix) {
+		return item.text < prefix;
+	});
+	for (; word != m_words.end() && word->text.compare(0, term.text.size(), term.text) == 0; ++word) {
+		if (m_marks[word->entry] != generation) {
+			m_marks[word->entry] = generation;
+			candidates.push_back(word->entry);
+		}
+	}
+}
+
+// Расстояние Дамерау — Левенштейна (вставка, удаление, замена, перестановка соседних)
+// от терма до ближайшего начала слова: "плтка" ~ "плитка", "сосан" ~ "сосна обыкновенная"
+static size_t PrefixDistance (const std::u32string& term, const std::u32string& word, size_t maxDistance,
+	std::vector<size_t>& rows)
+{
+	const size_t columns = word.size() + 1;
+	rows.assign(3 * columns, 0);
+	size_t* previous2 = rows.data();
+	size_t* previous = previous2 + columns;
+	size_t* current = previous + columns;
+	for (size_t j = 0; j < columns; ++j) {
+		previous[j] = j;
+	}
+	for (size_t i = 1; i <= term.size(); ++i) {
+		current[0] = i;
+		size_t rowMin = current[0];
+		for (size_t j = 1; j < columns; ++j) {
+			const size_t cost = (term[i - 1] == word[j - 1]) ? 0 : 1;
+			size_t value = std::min(std::min(previous[j] + 1, current[j - 1] + 1), previous[j - 1] + cost);
+			if (i > 1 && j > 1 && term[i - 1] == word[j - 2] && term[i - 2] == word[j - 1]) {
+				value = std::min(value, previous2[j - 2] + 1);
+			}
+			current[j] = value;
+			rowMin = std::min(rowMin, value);
+		}
+		if (rowMin > maxDistance) {
+			return maxDistance + 1;
+		}
+		size_t* recycled = previous2;
+		previous2 = previous;
+		previous = current;
+		current = recycled;
+	}
+
+	// Слово может быть длиннее терма — сравниваем с его началами
+	size_t best = maxDistance + 1;
+	const size_t from = (term.size() > maxDistance) ? term.size() - maxDistance : 0;
+	for (size_t j = from; j < columns && j <= term.size() + maxDistance; ++j) {
+		best = std::min(best, previous[j]);
+	}
+	return best;
+}
+
+// Нечёткие совпадения по словарю слов: одна опечатка на 4–7 символов, две — на 8 и больше
+void LayerSearchIndex::AddFuzzyMatches (const Term& term, std::vector<Match>& matches) const
+{
+	const uint32_t generation = ++m_markGeneration;
+	for (const Match& match : matches) {
+		m_marks[match.entry] = generation;
+	}
+
+	const size_t maxDistance = (term.text.size() >= 8) ? 2 : 1;
+	std::vector<size_t> rows;
+	for (size_t first = 0; first < m_words.size(); ) {
+		size_t last = first + 1;
+		while (last < m_words.size() && m_words[last].text == m_words[first].text) {
+			++last;
+		}
+		const std::u32string& word = m_words[first].text;
+		const size_t lengthGap = (word.size() < term.text.size()) ? term.text.size() - word.size() : 0;
+		const size_t distance = (lengthGap > maxDistance) ? maxDistance + 1 : PrefixDistance(term.text, word, maxDistance, rows);
+		if (distance <= maxDistance) {
+			const int32_t score = ScoreFuzzyBase + static_cast<int32_t>(ScoreFuzzyRange * (maxDistance + 1 - distance) / (maxDistance + 1));
+			for (size_t k = first; k < last; ++k) {
+				const uint32_t entry = m_words[k].entry;
+				if (m_marks[entry] != generation) {
+					m_marks[entry] = generation;
+					matches.push_back(Match { entry, score });
+				}
+			}
+		}
+		first = last;
+	}
+}
+
+std::vector<LayerSearchIndex::Match> LayerSearchIndex::Search (const std::string& query, size_t limit) const
+{
+	std::vector<Match> matches;
+	if (limit == 0 || m_entries.empty()) {
+		return matches;
+	}
+
+	// Термы через пробел; повторяющиеся триграммы терма не нужны
+	std::vector<Term> terms;
+	const std::u32string normalized = Normalize(query);
+	for (size_t position = 0; position < normalized.size(); ) {
+		while (position < normalized.size() && (normalized[position] == ' ' || normalized[position] == '\t')) {
+			++position;
+		}
+		size_t end = position;
+		while (end < normalized.size() && normalized[end] != ' ' && normalized[end] != '\t') {
+			++end;
+		}
+		if (end > position) {
+			Term term;
+			term.text = normalized.substr(position, end - position);
+			for (size_t k = 0; k + 3 <= term.text.size(); ++k) {
+				term.trigrams.push_back(PackTrigram(term.text, k));
+			}
+			std::sort(term.trigrams.begin(), term.trigrams.end());
+			term.trigrams.erase(std::unique(term.trigrams.begin(), term.trigrams.end()), term.trigrams.end());
+			terms.push_back(std::move(term));
+		}
+		position = end;
+	}
+	if (terms.empty()) {
+		return matches;
+	}
+
+	// Кандидаты — по самому избирательному терму, остальные термы проверяются на каждом
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> termCandidates;
+	bool first = true;
+	for (const Term& term : terms) {
+		CollectCandidates(term, termCandidates);
+		if (first || termCandidates.size() < candidates.size()) {
+			candidates.swap(termCandidates);
+			first = false;
+		}
+		if (candidates.empty()) {
+			break;
+		}
+	}
+
+	for (uint32_t entry : candidates) {
+		int32_t score = 0;
+		bool matched = true;
+		for (const Term& term : terms) {
+			const size_t position = FindTerm(entry, term);
+			if (position == std::u32string::npos) {
+				matched = false;
+				break;
+			}
+			score += ScoreTerm(entry, term, position);
+		}
+		if (matched) {
+			matches.push_back(Match { entry, score });
+		}
+	}
+
+	if (matches.size() < limit && terms.size() == 1 && terms[0].text.size() >= 4) {
+		AddFuzzyMatches(terms[0], matches);
+	}
+
+	const auto better = [this] (const Match& left, const Match& right) {
+		if (left.score != right.score) {
+			return left.score > right.score;
+		}
+		const size_t leftLength = m_texts[left.entry].size() - m_nameStart[left.entry];
+		const size_t rightLength = m_texts[right.entry].size() - m_nameStart[right.entry];
+		if (leftLength != rightLength) {
+			return leftLength < rightLength;
+		}
+		return m_rank[left.entry] < m_rank[right.entry];
+	};
+	if (matches.size() > limit) {
+		std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(limit), matches.end(), better);
+		matches.resize(limit);
+	} else {
+		std::sort(matches.begin(), matches.end(), better);
+	}
+	return matches;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Поисковый индекс по слоям: имя слоя и путь папки, без учёта регистра (ё = е).
+// Термы запроса через пробел, все должны найтись:
+//   3+ символа — подстрока где угодно, кандидаты — пересечение списков триграмм;
+//   1–2 символа — начало слова, кандидаты — двоичный поиск по отсортированным словам.
+// Если точных совпадений меньше limit, одиночный терм от 4 символов ищется нечётко —
+// по расстоянию Дамерау — Левенштейна до начал слов (1 опечатка, с 8 символов — 2).
+// Ранжирование: имя целиком, начало имени, начало слова в имени, подстрока в имени,
+// затем совпадения только в папке, затем нечёткие; при равенстве — короче имя, по алфавиту.
+// Только стандартная библиотека — замер собирается отдельно (Tools/LayerSearchBench).
+class LayerSearchIndex
+{
+public:
+	struct Entry {
+		std::string	name;			// UTF-8
+		std::string	folder;			// UTF-8, "A/B/C", пусто — корень
+	};
+
+	struct Match {
+		uint32_t	entry = 0;		// номер записи в порядке Build
+		int32_t		score = 0;		// больше — выше в списке
+	};
+
+	void				Build (const std::vector<Entry>& entries);
+	void				Clear ();
+
+	std::vector<Match>	Search (const std::string& query, size_t limit) const;
+
+	size_t				GetSize () const { return m_entries.size(); }
+	const Entry&		GetEntry (uint32_t entry) const { return m_entries[entry]; }
+
+	// Нижний регистр UTF-8 -> кодовые точки (латиница, Latin-1, кириллица; ё -> е)
+	static std::u32string	Normalize (const std::string& utf8);
+
+private:
+	struct Word {
+		std::u32string	text;
+		uint32_t		entry;
+	};
+
+	struct Term {
+		std::u32string			text;
+		std::vector<uint64_t>	trigrams;
+	};
+
+	size_t		FindTerm (uint32_t entry, const Term& term) const;		// std::u32string::npos — нет
+	int32_t		ScoreTerm (uint32_t entry, const Term& term, size_t position) const;
+	void		CollectCandidates (const Term& term, std::vector<uint32_t>& candidates) const;
+	void		AddFuzzyMatches (const Term& term, std::vector<Match>& matches) const;
+
+	std::vector<Entry>										m_entries;
+	std::vector<std::u32string>								m_texts;		// "папка/имя" в нижнем регистре
+	std::vector<uint32_t>									m_nameStart;	// начало имени в m_texts
+	std::vector<uint32_t>									m_rank;			// место записи по алфавиту
+	std::unordered_map<uint64_t, std::vector<uint32_t>>		m_trigrams;		// номера записей по возрастанию
+	std::vector<Word>										m_words;		// отсортированы по text
+	// Рабочие массивы поиска (Search не потокобезопасен — вызывается из главного потока)
+	mutable std::vector<uint32_t>							m_marks;		// пометки кандидатов
+	mutable uint32_t										m_markGeneration = 0;
+};
@@ -0,0 +1,217 @@
+#include "LayerUsage.hpp"
+#include "ElementEvents.hpp"
+#include "ElementNameCache.hpp"
+#include "IdLayersPalette.hpp"
+
+namespace LayerUsage {
+
+// Слой и тип, с которыми элемент учтён в счётчиках, — чтобы при изменении или удалении
+// вычесть его из старого слоя, не перечитывая модель
+struct ElementRecord {
+    Int32  layer = 0;
+    UInt64 typeKey = 0;
+};
+
+struct TypeSlot {
+    UInt64 typeKey = 0;
+    UInt32 count = 0;
+};
+
+struct LayerCounts {
+    UInt32              total = 0;
+    GS::Array<TypeSlot> types;      // типов в слое немного — линейный поиск
+};
+
+struct UsageState {
+    GS::HashTable<API_Guid, ElementRecord> elements;
+    GS::HashTable<Int32, LayerCounts>      layers;
+    GS::HashTable<UInt64, API_ElemType>    types;
+    bool                                   built = false;
+    bool                                   changed = false;   // были изменения после последнего запроса
+};
+
+static UsageState usage;
+
+static UInt64 GetTypeKey(const API_ElemType& type)
+{
+    return (static_cast<UInt64>(type.typeID) << 32) | static_cast<UInt64>(type.variationID);
+}
+
+// ---------------- Счётчики ----------------
+static void AddCounts(const ElementRecord& record)
+{
+    LayerCounts* counts = usage.layers.GetPtr(record.layer);
+    if (counts == nullptr) {
+        usage.layers.Add(record.layer, LayerCounts());
+        counts = usage.layers.GetPtr(record.layer);
+    }
+    ++counts->total;
+    for (TypeSlot& slot : counts->types) {
+        if (slot.typeKey == record.typeKey) {
+            ++slot.count;
+            return;
+        }
+    }
+    TypeSlot slot;
+    slot.typeKey = record.typeKey;
+    slot.count = 1;
+    counts->types.Push(slot);
+}
+
+static void RemoveCounts(const ElementRecord& record)
+{
+    LayerCounts* counts = usage.layers.GetPtr(record.layer);
+    if (counts == nullptr) {
+        return;
+    }
+    if (counts->total > 0) {
+        --counts->total;
+    }
+    for (UIndex i = 0; i < counts->types.GetSize(); ++i) {
+        if (counts->types[i].typeKey == record.typeKey) {
+            if (--counts->types[i].count == 0) {
+                counts->types.Delete(i);
+            }
+            break;
+        }
+    }
+}
+
+static void PutElement(const API_Elem_Head& head)
+{
+    ElementRecord record;
+    record.layer = head.layer.ToInt32_Deprecated();
+    record.typeKey = GetTypeKey(head.type);
+
+    if (const ElementRecord* old = usage.elements.GetPtr(head.guid)) {
+        if (old->layer == record.layer && old->typeKey == record.typeKey) {
+            return;
+        }
+        RemoveCounts(*old);
+    }
+    usage.elements.Put(head.guid, record);
+    AddCounts(record);
+    if (!usage.types.ContainsKey(record.typeKey)) {
+        usage.types.Add(record.typeKey, head.type);
+    }
+    usage.changed = true;
+}
+
+static void RemoveElement(const API_Guid& guid)
+{
+    ElementRecord record;
+    if (!usage.elements.Get(guid, &record)) {
+        return;
+    }
+    RemoveCounts(record);
+    usage.elements.Delete(guid);
+    usage.changed = true;
+}
+
+static void RefreshElement(const API_Guid& guid)
+{
+    API_Elem_Head head = {};
+    head.guid = guid;
+    if (ACAPI_Element_GetHeader(&head) == NoError) {
+        PutElement(head);
+    } else {
+        RemoveElement(guid);
+    }
+}
+
+// ---------------- Уведомления ----------------
+static void OnElementChange(ElementEvents::Change change, const API_Guid& guid)
+{
+    if (!usage.built) {
+        return;
+    }
+    if (change == ElementEvents::Change::Removed) {
+        RemoveElement(guid);
+    } else {
+        RefreshElement(guid);
+    }
+}
+
+// Палитре — одно обновление на пакет событий, а не на каждый элемент
+static void OnBatchEnd()
+{
+    if (usage.built && usage.changed) {
+        IdLayersPalette::UpdateLayerUsageOnHTML();
+    }
+}
+
+// ---------------- Проход по модели ----------------
+static void EnsureBuilt()
+{
+    if (usage.built) {
+        return;
+    }
+    ElementEvents::Subscribe(OnElementChange, OnBatchEnd);
+
+    GS::Array<API_Guid> elements;
+    ACAPI_Element_GetElemList(API_ZombieElemID, &elements);
+    for (const API_Guid& guid : elements) {
+        API_Elem_Head head = {};
+        head.guid = guid;
+        if (ACAPI_Element_GetHeader(&head) != NoError) {
+            continue;
+        }
+        PutElement(head);
+    }
+    ElementEvents::ObserveModel(elements);
+    usage.built = true;
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport(GS::UniString::Printf("[LayerUsage] Учтено элементов: %u", (unsigned)usage.elements.GetSize()), false);
+#endif
+}
+
+void Invalidate()
+{
+    usage.elements.Clear();
+    usage.layers.Clear();
+    usage.types.Clear();
+    usage.built = false;
+    usage.changed = false;
+}
+
+// ---------------- Отчёт ----------------
+GS::Array<LayerUsageInfo> GetLayerUsage()
+{
+    EnsureBuilt();
+    usage.changed = false;
+
+    GS::Array<LayerUsageInfo> result;
+    GS::Array<API_Attribute> layers;
+    if (ACAPI_Attribute_GetAttributesByType(API_LayerID, layers) != NoError) {
+        return result;
+    }
+
+    ElementNameCache names;
+    result.SetCapacity(layers.GetSize());
+    for (const API_Attribute& layer : layers) {
+        LayerUsageInfo info;
+        info.name = layer.header.name;
+        if (const LayerCounts* counts = usage.layers.GetPtr(layer.header.index.ToInt32_Deprecated())) {
+            info.total = counts->total;
+            for (const TypeSlot& slot : counts->types) {
+                TypeCount typeCount;
+                API_ElemType type;
+                if (usage.types.Get(slot.typeKey, &type)) {
+                    typeCount.typeName = names.GetTypeName(type);
+                }
+                typeCount.count = slot.count;
+                // Вставка по убыванию — типов в слое единицы
+                UIndex position = info.types.GetSize();
+                while (position > 0 && info.types[position - 1].count < typeCount.count) {
+                    --position;
+                }
+                info.types.Insert(position, typeCount);
+            }
+        }
+        result.Push(info);
+    }
+    return result;
+}
+
+} // namespace LayerUsage
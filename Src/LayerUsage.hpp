@@ -0,0 +1,32 @@
+#ifndef LAYERUSAGE_HPP
+#define LAYERUSAGE_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+// Сколько элементов лежит в каждом слое, всего и по типам.
+// Считается одним проходом по элементам плана при первом запросе, дальше поддерживается
+// по уведомлениям об элементах (создание, изменение, удаление, Undo/Redo) без пересчёта.
+namespace LayerUsage {
+
+    struct TypeCount {
+        GS::UniString typeName;
+        UInt32        count = 0;
+    };
+
+    struct LayerUsageInfo {
+        GS::UniString          name;
+        UInt32                 total = 0;
+        GS::Array<TypeCount>   types;       // по убыванию count
+    };
+
+    // Все слои проекта, включая пустые
+    GS::Array<LayerUsageInfo> GetLayerUsage();
+
+    // Забыть счётчики (другой проект); следующий запрос пройдёт по модели заново
+    void Invalidate();
+
+} // namespace LayerUsage
+
+#endif // LAYERUSAGE_HPP
@@ -16,6 +16,11 @@
 #include    "IdLayersPalette.hpp"
 #include    "SelectionDetailsPalette.hpp"
 #include    "LicenseManager.hpp"
+#include    "LayerHelper.hpp"
+#include    "LayerUsage.hpp"
+#include    "ElementIdIndex.hpp"
+#include    "ElementEvents.hpp"
+#include    "SelectionSets.hpp"
 #include	"APICommon.h"
 
 // -----------------------------------------------------------------------------
@@ -48,6 +53,28 @@ static void	ShowOrHideBrowserRepl ()
 	}
 }
 
+// -----------------------------------------------------------------------------
+// ProjectEventHandler
+//		new/open/close/quit — регистрируется в Initialize, чтобы работать при любой
+//		открытой палитре, а не только при созданной BrowserRepl
+// -----------------------------------------------------------------------------
+
+static GSErrCode ProjectEventHandler (API_NotifyEventID notifID, Int32 /*param*/)
+{
+	if (notifID == APINotify_Quit) {
+		BrowserRepl::DestroyInstance ();
+	} else {
+		// Другой проект — индексы слоёв по имени, счётчики элементов, индекс ID
+		// и наборы выделения безымянного проекта относятся к старому
+		LayerHelper::InvalidateLayerIndex ();
+		LayerUsage::Invalidate ();
+		ElementIdIndex::Invalidate ();
+		ElementEvents::Reset ();
+		SelectionSets::OnProjectChanged ();
+	}
+	return NoError;
+}
+
 // -----------------------------------------------------------------------------
 // MenuCommandHandler
 //		called to perform the user-asked command
@@ -212,6 +239,11 @@ GSErrCode Initialize ()
     if (DBERROR (err != NoError))
         return err;
 
+    // 1а) События проекта — сброс кэшей аддона при смене проекта
+    err = ACAPI_ProjectOperation_CatchProjectEvent (APINotify_New | APINotify_NewAndReset | APINotify_Open | APINotify_Close | APINotify_Quit, ProjectEventHandler);
+    if (DBERROR (err != NoError))
+        return err;
+
     // 2) Нотификация выбора - регистрируется внутри SelectionDetailsPalette при создании
     // (не нужно регистрировать здесь, так как SelectionDetailsPalette сам подписывается)
 
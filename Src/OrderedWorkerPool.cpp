@@ -0,0 +1,101 @@
+#include "OrderedWorkerPool.hpp"
+
+#include <algorithm>
+
+// ---------------- OrderedWorkerPool ----------------
+OrderedWorkerPool::OrderedWorkerPool (unsigned threadCount)
+{
+	threadCount = std::max(1u, threadCount);
+	for (unsigned i = 0; i < threadCount; ++i) {
+		m_threads.emplace_back(&OrderedWorkerPool::WorkerLoop, this);
+	}
+}
+
+OrderedWorkerPool::~OrderedWorkerPool ()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+		m_tasks.clear();
+	}
+	m_taskReady.notify_all();
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+}
+
+unsigned OrderedWorkerPool::GetDefaultThreadCount ()
+{
+	const unsigned cores = std::thread::hardware_concurrency();
+	if (cores <= 2) {
+		return 1;
+	}
+	return std::min(cores - 1, 8u);
+}
+
+void OrderedWorkerPool::Submit (Task task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_tasks.push_back(std::make_pair(m_nextSubmit++, std::move(task)));
+	}
+	m_taskReady.notify_one();
+}
+
+bool OrderedWorkerPool::Next (ChunkOutput& output, bool wait)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	if (m_nextConsume == m_nextSubmit) {
+		return false;
+	}
+
+	auto found = m_results.find(m_nextConsume);
+	if (found == m_results.end()) {
+		if (!wait) {
+			return false;
+		}
+		m_resultReady.wait(lock, [this] { return m_results.count(m_nextConsume) > 0; });
+		found = m_results.find(m_nextConsume);
+	}
+
+	output = std::move(found->second);
+	m_results.erase(found);
+	m_nextConsume++;
+	return true;
+}
+
+size_t OrderedWorkerPool::GetInFlight () const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return static_cast<size_t>(m_nextSubmit - m_nextConsume);
+}
+
+void OrderedWorkerPool::WorkerLoop ()
+{
+	for (;;) {
+		std::pair<uint64_t, Task> item;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_taskReady.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+			if (m_stopping) {
+				return;
+			}
+			item = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+
+		ChunkOutput output;
+		try {
+			output = item.second();
+		} catch (...) {
+			output = ChunkOutput();
+			output.ok = false;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_results.emplace(item.first, std::move(output));
+		}
+		m_resultReady.notify_all();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "TableWriter.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул рабочих потоков, отдающий результаты строго в порядке постановки задач.
+// Задачи не должны трогать ACAPI — только чистые данные.
+class OrderedWorkerPool
+{
+public:
+	typedef std::function<ChunkOutput ()> Task;
+
+	explicit OrderedWorkerPool (unsigned threadCount);
+	~OrderedWorkerPool ();
+
+	OrderedWorkerPool (const OrderedWorkerPool&) = delete;
+	OrderedWorkerPool& operator= (const OrderedWorkerPool&) = delete;
+
+	void		Submit (Task task);
+
+	// Следующий результат по порядку. wait == false — только если уже готов.
+	// false — результата нет (или нет незабранных задач).
+	bool		Next (ChunkOutput& output, bool wait);
+
+	// Поставлено, но ещё не забрано через Next()
+	size_t		GetInFlight () const;
+
+	// Рекомендуемое число рабочих потоков: ядра минус главный поток
+	static unsigned GetDefaultThreadCount ();
+
+private:
+	void		WorkerLoop ();
+
+	mutable std::mutex							m_mutex;
+	std::condition_variable						m_taskReady;
+	std::condition_variable						m_resultReady;
+	std::deque<std::pair<uint64_t, Task>>		m_tasks;
+	std::map<uint64_t, ChunkOutput>				m_results;
+	uint64_t									m_nextSubmit = 0;
+	uint64_t									m_nextConsume = 0;
+	bool										m_stopping = false;
+	std::vector<std::thread>					m_threads;
+};
@@ -14,4 +14,28 @@ GSErrCode PropertyUtils::PropertyToString (const API_Property& property, GS::Uni
 	}
 
 	return ACAPI_Property_GetPropertyValueString (property, &propertyValue);
-}
\ No newline at end of file
+}
+
+
+bool PropertyUtils::PropertyToDouble (const API_Property& property, double& propertyValue)
+{
+	if (property.status != API_Property_HasValue || property.definition.collectionType != API_PropertySingleCollectionType) {
+		return false;
+	}
+
+	const API_PropertyValue& value = property.isDefault ? property.definition.defaultValue.basicValue : property.value;
+	if (value.variantStatus != API_VariantStatusNormal) {
+		return false;
+	}
+
+	switch (value.singleVariant.variant.type) {
+		case API_PropertyRealValueType:
+			propertyValue = value.singleVariant.variant.doubleValue;
+			return true;
+		case API_PropertyIntegerValueType:
+			propertyValue = static_cast<double> (value.singleVariant.variant.intValue);
+			return true;
+		default:
+			return false;
+	}
+}
@@ -15,6 +15,7 @@ namespace GS {
 namespace PropertyUtils {
 
 GSErrCode	PropertyToString (const API_Property& property, GS::UniString& propertyValue);
+bool		PropertyToDouble (const API_Property& property, double& propertyValue);
 
 }
 
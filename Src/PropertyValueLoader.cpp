@@ -0,0 +1,182 @@
+#include "PropertyValueLoader.hpp"
+#include "PropertyUtils.hpp"
+
+#include <chrono>
+
+namespace {
+
+struct ElementValues {
+	GS::Array<GS::UniString>	values;
+	GS::Array<bool>				loaded;
+	UInt32						loadedCount = 0;
+};
+
+GS::Array<API_Guid>							columns;
+GS::HashTable<API_Guid, ElementValues>		cache;
+
+// Очередь предзагрузки: элементы в порядке приоритета
+GS::Array<API_Guid>							pendingQueue;
+UIndex										pendingHead = 0;
+
+ElementValues& GetOrCreateEntry (const API_Guid& elemGuid)
+{
+	if (!cache.ContainsKey(elemGuid)) {
+		ElementValues entry;
+		entry.values.SetSize(columns.GetSize());
+		entry.loaded.SetSize(columns.GetSize());
+		for (UIndex i = 0; i < columns.GetSize(); ++i) {
+			entry.loaded[i] = false;
+		}
+		cache.Add(elemGuid, entry);
+	}
+	return cache[elemGuid];
+}
+
+// Прочитать недостающие колонки элемента одним вызовом API и дописать их в result
+void LoadColumns (const API_Guid& elemGuid, const GS::Array<UIndex>& wantedColumns, GS::Array<PropertyValueLoader::CellValue>& result)
+{
+	ElementValues& entry = GetOrCreateEntry(elemGuid);
+
+	// Колонка отмечается загруженной сразу — повтор в wantedColumns не запросит и не посчитает её дважды.
+	// Отсутствующие у элемента свойства тоже считаем загруженными (пустое значение)
+	GS::Array<UIndex> missingColumns;
+	GS::Array<API_Guid> missing;
+	GS::HashTable<API_Guid, bool> requested;
+	for (UIndex column : wantedColumns) {
+		if (column < columns.GetSize() && !entry.loaded[column]) {
+			entry.loaded[column] = true;
+			entry.loadedCount++;
+			missingColumns.Push(column);
+			if (!requested.ContainsKey(columns[column])) {
+				requested.Add(columns[column], true);
+				missing.Push(columns[column]);
+			}
+		}
+	}
+
+	if (!missing.IsEmpty()) {
+		GS::Array<API_Property> properties;
+		GS::HashTable<API_Guid, GS::UniString> loadedValues;
+		if (ACAPI_Element_GetPropertyValuesByGuid(elemGuid, missing, properties) == NoError) {
+			for (const API_Property& property : properties) {
+				GS::UniString value;
+				PropertyUtils::PropertyToString(property, value);
+				loadedValues.Put(property.definition.guid, value);
+			}
+		}
+		for (UIndex column : missingColumns) {
+			loadedValues.Get(columns[column], &entry.values[column]);
+		}
+	}
+
+	for (UIndex column : wantedColumns) {
+		if (column < columns.GetSize()) {
+			PropertyValueLoader::CellValue cell;
+			cell.elemGuid = elemGuid;
+			cell.column = column;
+			cell.valueString = entry.values[column];
+			result.Push(cell);
+		}
+	}
+}
+
+GS::Array<UIndex> AllColumns ()
+{
+	GS::Array<UIndex> all;
+	for (UIndex i = 0; i < columns.GetSize(); ++i) {
+		all.Push(i);
+	}
+	return all;
+}
+
+bool IsFullyLoaded (const API_Guid& elemGuid)
+{
+	const ElementValues* entry = cache.GetPtr(elemGuid);
+	return entry != nullptr && entry->loadedCount == columns.GetSize();
+}
+
+} // namespace
+
+void PropertyValueLoader::SetColumns (const GS::Array<API_Guid>& propertyGuids)
+{
+	if (propertyGuids == columns) {
+		return;
+	}
+
+	columns = propertyGuids;
+	Invalidate();
+}
+
+void PropertyValueLoader::Invalidate ()
+{
+	cache.Clear();
+	pendingQueue.Clear();
+	pendingHead = 0;
+}
+
+GS::Array<PropertyValueLoader::CellValue> PropertyValueLoader::Request (const GS::Array<API_Guid>& visibleElems,
+																		const GS::Array<UIndex>& visibleColumns,
+																		const GS::Array<API_Guid>& prefetchElems)
+{
+	GS::Array<CellValue> result;
+	if (columns.IsEmpty()) {
+		return result;
+	}
+
+	for (const API_Guid& elemGuid : visibleElems) {
+		LoadColumns(elemGuid, visibleColumns, result);
+	}
+
+	// Старая очередь больше не актуальна: приоритеты задаёт новое окно просмотра
+	pendingQueue.Clear();
+	pendingHead = 0;
+	for (const API_Guid& elemGuid : visibleElems) {
+		if (!IsFullyLoaded(elemGuid)) {
+			pendingQueue.Push(elemGuid);
+		}
+	}
+	for (const API_Guid& elemGuid : prefetchElems) {
+		if (!IsFullyLoaded(elemGuid)) {
+			pendingQueue.Push(elemGuid);
+		}
+	}
+
+	return result;
+}
+
+GS::Array<PropertyValueLoader::CellValue> PropertyValueLoader::LoadPending (double budgetMs)
+{
+	GS::Array<CellValue> result;
+	if (columns.IsEmpty()) {
+		return result;
+	}
+
+	const GS::Array<UIndex> allColumns = AllColumns();
+	const auto started = std::chrono::steady_clock::now();
+
+	while (pendingHead < pendingQueue.GetSize()) {
+		const API_Guid elemGuid = pendingQueue[pendingHead++];
+		if (IsFullyLoaded(elemGuid)) {
+			continue;
+		}
+
+		LoadColumns(elemGuid, allColumns, result);
+
+		const double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+		if (elapsedMs >= budgetMs) {
+			break;
+		}
+	}
+
+	if (pendingHead >= pendingQueue.GetSize()) {
+		pendingQueue.Clear();
+		pendingHead = 0;
+	}
+
+	return result;
+}
+
+UInt32 PropertyValueLoader::GetPendingCount ()
+{
+	return static_cast<UInt32>(pendingQueue.GetSize() - pendingHead);
+}
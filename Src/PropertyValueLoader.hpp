@@ -0,0 +1,36 @@
+#pragma once
+
+#include "GSRoot.hpp"
+#include "UniString.hpp"
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+
+// Ленивая загрузка значений свойств для таблицы выбранных элементов:
+// видимые ячейки читаются сразу, остальные — порциями в простое страницы.
+class PropertyValueLoader
+{
+public:
+	struct CellValue {
+		API_Guid		elemGuid;
+		UIndex			column = 0;
+		GS::UniString	valueString;
+	};
+
+	// Задать колонки (GUID свойств); при смене колонок кеш сбрасывается
+	static void SetColumns (const GS::Array<API_Guid>& propertyGuids);
+
+	// Сбросить кеш и очередь (например, после изменения выделения)
+	static void Invalidate ();
+
+	// Немедленно вернуть видимые ячейки и переупорядочить очередь предзагрузки:
+	// сначала остальные колонки видимых элементов, затем prefetchElems по порядку
+	static GS::Array<CellValue> Request (const GS::Array<API_Guid>& visibleElems,
+										 const GS::Array<UIndex>& visibleColumns,
+										 const GS::Array<API_Guid>& prefetchElems);
+
+	// Загрузить очередь в пределах бюджета времени (мс), вернуть загруженные ячейки
+	static GS::Array<CellValue> LoadPending (double budgetMs);
+
+	static UInt32 GetPendingCount ();
+};
@@ -5,6 +5,7 @@
 
 #include "DGBrowser.hpp"
 #include "BrowserRepl.hpp"
+#include "PropertyValueLoader.hpp"
 
 // -------------------- local helpers --------------------
 static GS::UniString LoadSelectionDetailsHtml()
@@ -194,6 +195,7 @@ void SelectionDetailsPalette::PanelCloseRequested(const DG::PanelCloseRequestEve
 GSErrCode SelectionDetailsPalette::SelectionChangeHandler(const API_Neig* neig)
 {
 	(void)neig; // unused parameter
+	PropertyValueLoader::Invalidate();
 	if (SelectionDetailsPalette::HasInstance())
 		SelectionDetailsPalette::UpdateSelectedElementsOnHTML();
 	return NoError;
@@ -0,0 +1,191 @@
+#include "SelectionGroupHelper.hpp"
+#include "PropertyUtils.hpp"
+#include "ElementNameCache.hpp"
+
+namespace SelectionGroupHelper {
+
+// Разделитель значений в ключе группы (не встречается в ID, именах слоёв и значениях свойств)
+static const GS::UniString KeySeparator("\x1F");
+
+// ---------------- Разобрать колонку из строки ----------------
+bool ParseColumn (const GS::UniString& token, Column& column)
+{
+    GS::UniString name = token;
+    name.Trim();
+    if (name.IsEmpty()) {
+        return false;
+    }
+
+    if (name.IsEqual("type", GS::CaseInsensitive)) {
+        column.kind = Column::Type;
+        return true;
+    }
+    if (name.IsEqual("id", GS::CaseInsensitive)) {
+        column.kind = Column::ID;
+        return true;
+    }
+    if (name.IsEqual("layer", GS::CaseInsensitive)) {
+        column.kind = Column::Layer;
+        return true;
+    }
+
+    const API_Guid propertyGuid = APIGuidFromString(name.ToCStr().Get());
+    if (propertyGuid == APINULLGuid) {
+        return false;
+    }
+    column.kind = Column::Property;
+    column.propertyGuid = propertyGuid;
+    return true;
+}
+
+// ---------------- Элементы для группировки ----------------
+GS::Array<API_Guid> GetScopeElements (bool wholeModel)
+{
+    GS::Array<API_Guid> elements;
+
+    if (wholeModel) {
+        ACAPI_Element_GetElemList(API_ZombieElemID, &elements);
+        return elements;
+    }
+
+    API_SelectionInfo selectionInfo = {};
+    GS::Array<API_Neig> selNeigs;
+    ACAPI_Selection_Get(&selectionInfo, &selNeigs, false, false);
+    BMKillHandle((GSHandle*)&selectionInfo.marquee.coords);
+
+    elements.SetCapacity(selNeigs.GetSize());
+    for (const API_Neig& neig : selNeigs) {
+        elements.Push(neig.guid);
+    }
+    return elements;
+}
+
+// ---------------- Хеш-агрегация элементов ----------------
+GroupResult GroupElements (const GS::Array<API_Guid>& elements,
+                           const GS::Array<Column>& groupBy,
+                           const GS::Array<Column>& aggregateColumns)
+{
+    GroupResult result;
+
+    // Собираем все нужные свойства в один список, чтобы читать их одним вызовом на элемент
+    GS::Array<API_Guid> propertyGuids;
+    GS::HashTable<API_Guid, UIndex> propertySlots;
+    bool needsID = false;
+    auto registerColumn = [&](const Column& column) {
+        if (column.kind == Column::ID) {
+            needsID = true;
+        } else if (column.kind == Column::Property && !propertySlots.ContainsKey(column.propertyGuid)) {
+            propertySlots.Add(column.propertyGuid, propertyGuids.GetSize());
+            propertyGuids.Push(column.propertyGuid);
+        }
+    };
+    for (const Column& column : groupBy) {
+        registerColumn(column);
+    }
+    for (const Column& column : aggregateColumns) {
+        registerColumn(column);
+    }
+
+    ElementNameCache names;
+    GS::HashTable<GS::UniString, UIndex> groupIndices;
+
+    GS::Array<GS::UniString> propertyStrings;
+    GS::Array<double>        propertyNumbers;
+    GS::Array<bool>          propertyIsNumber;
+    GS::Array<GS::UniString> keyValues;
+    GS::Array<API_Property>  properties;
+    propertyStrings.SetSize(propertyGuids.GetSize());
+    propertyNumbers.SetSize(propertyGuids.GetSize());
+    propertyIsNumber.SetSize(propertyGuids.GetSize());
+    keyValues.SetSize(groupBy.GetSize());
+
+    for (const API_Guid& guid : elements) {
+        API_Elem_Head elemHead = {};
+        elemHead.guid = guid;
+        if (ACAPI_Element_GetHeader(&elemHead) != NoError) {
+            continue;
+        }
+
+        GS::UniString elemID;
+        if (needsID) {
+            ACAPI_Element_GetElementInfoString(&elemHead.guid, &elemID);
+        }
+
+        for (UIndex i = 0; i < propertyGuids.GetSize(); ++i) {
+            propertyStrings[i].Clear();
+            propertyIsNumber[i] = false;
+        }
+        if (!propertyGuids.IsEmpty()) {
+            properties.Clear();
+            if (ACAPI_Element_GetPropertyValuesByGuid(guid, propertyGuids, properties) == NoError) {
+                for (const API_Property& property : properties) {
+                    UIndex slot = 0;
+                    if (!propertySlots.Get(property.definition.guid, &slot)) {
+                        continue;
+                    }
+                    PropertyUtils::PropertyToString(property, propertyStrings[slot]);
+                    propertyIsNumber[slot] = PropertyUtils::PropertyToDouble(property, propertyNumbers[slot]);
+                }
+            }
+        }
+
+        // Предварительно вычисляем значения колонок и ключ группы
+        GS::UniString groupKey;
+        for (UIndex c = 0; c < groupBy.GetSize(); ++c) {
+            const Column& column = groupBy[c];
+            switch (column.kind) {
+                case Column::Type:     keyValues[c] = names.GetTypeName(elemHead.type); break;
+                case Column::ID:       keyValues[c] = elemID; break;
+                case Column::Layer:    keyValues[c] = names.GetLayerName(elemHead.layer); break;
+                case Column::Property: keyValues[c] = propertyStrings[propertySlots[column.propertyGuid]]; break;
+            }
+            if (c > 0) {
+                groupKey += KeySeparator;
+            }
+            groupKey += keyValues[c];
+        }
+
+        UIndex groupIndex = 0;
+        if (!groupIndices.Get(groupKey, &groupIndex)) {
+            groupIndex = result.groups.GetSize();
+            groupIndices.Add(groupKey, groupIndex);
+
+            Group group;
+            group.keyValues = keyValues;
+            group.aggregates.SetSize(aggregateColumns.GetSize());
+            result.groups.Push(group);
+        }
+
+        Group& group = result.groups[groupIndex];
+        group.count++;
+
+        for (UIndex a = 0; a < aggregateColumns.GetSize(); ++a) {
+            const Column& column = aggregateColumns[a];
+            if (column.kind != Column::Property) {
+                continue;
+            }
+            const UIndex slot = propertySlots[column.propertyGuid];
+            if (!propertyIsNumber[slot]) {
+                continue;
+            }
+
+            const double value = propertyNumbers[slot];
+            Aggregate& aggregate = group.aggregates[a];
+            if (aggregate.numericCount == 0) {
+                aggregate.min = value;
+                aggregate.max = value;
+            } else {
+                if (value < aggregate.min) aggregate.min = value;
+                if (value > aggregate.max) aggregate.max = value;
+            }
+            aggregate.sum += value;
+            aggregate.numericCount++;
+        }
+
+        result.elementCount++;
+    }
+
+    return result;
+}
+
+} // namespace SelectionGroupHelper
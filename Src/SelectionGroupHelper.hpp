@@ -0,0 +1,50 @@
+#ifndef SELECTIONGROUPHELPER_HPP
+#define SELECTIONGROUPHELPER_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+
+namespace SelectionGroupHelper {
+
+    // Колонка группировки или агрегации
+    struct Column {
+        enum Kind { Type, ID, Layer, Property };
+
+        Kind     kind = Type;
+        API_Guid propertyGuid = APINULLGuid; // только для Kind::Property
+    };
+
+    // Разобрать колонку из строки: "type", "id", "layer" или GUID свойства
+    bool ParseColumn (const GS::UniString& token, Column& column);
+
+    // Числовые агрегаты по одной колонке
+    struct Aggregate {
+        double sum = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        UInt32 numericCount = 0; // Сколько элементов группы дали числовое значение
+    };
+
+    struct Group {
+        GS::Array<GS::UniString> keyValues;  // Значения колонок группировки
+        UInt32                   count = 0;  // Количество элементов в группе
+        GS::Array<Aggregate>     aggregates; // По одному на колонку агрегации
+    };
+
+    struct GroupResult {
+        UInt32           elementCount = 0; // Сколько элементов обработано
+        GS::Array<Group> groups;
+    };
+
+    // Элементы для группировки: текущее выделение или вся модель
+    GS::Array<API_Guid> GetScopeElements (bool wholeModel);
+
+    // Хеш-агрегация элементов по произвольному списку колонок
+    GroupResult GroupElements (const GS::Array<API_Guid>& elements,
+                               const GS::Array<Column>& groupBy,
+                               const GS::Array<Column>& aggregateColumns);
+
+} // namespace SelectionGroupHelper
+
+#endif // SELECTIONGROUPHELPER_HPP
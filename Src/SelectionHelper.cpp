@@ -1,4 +1,5 @@
 #include "SelectionHelper.hpp"
+#include "ElementIdIndex.hpp"
 
 namespace SelectionHelper {
 
@@ -58,8 +59,66 @@ void ModifySelection (const GS::UniString& elemGuidStr, SelectionModification mo
     }
 }
 
+// ---------------- Записать ID элементам ----------------
+UpdateElementsIdResult ChangeElementsID (const GS::Array<ElementIdChange>& changes)
+{
+    UpdateElementsIdResult result;
+    result.requested = static_cast<UInt32>(changes.GetSize());
+
+    // Сначала только чтение: запись — это изменение базы и запись в Undo,
+    // а повторное применение того же ID к группе обычно почти ничего не меняет
+    GS::Array<UIndex> toWrite;
+    for (UIndex i = 0; i < changes.GetSize(); ++i) {
+        GS::UniString currentID;
+        const GSErrCode err = ACAPI_Element_GetElementInfoString(&changes[i].guid, &currentID);
+        if (err != NoError) {
+            result.failed++;
+            BatchMutation::ElementError error;
+            error.guid = changes[i].guid;
+            error.code = err;
+            result.elementErrors.Push(error);
+        } else if (currentID == changes[i].newID) {
+            result.unchanged++;
+        } else {
+            toWrite.Push(i);
+        }
+    }
+
+    if (toWrite.IsEmpty()) {
+        return result;
+    }
+
+    UInt32 written = 0;
+    const BatchMutation::Report report = BatchMutation::Run("Change Elements ID", "Изменение ID", toWrite.GetSize(), [&]() -> GSErrCode {
+        for (const UIndex i : toWrite) {
+            GS::UniString id = changes[i].newID;
+            const GSErrCode err = ACAPI_Element_ChangeElementInfoString(&changes[i].guid, &id);
+            if (err == NoError) {
+                written++;
+                const API_Guid guid = changes[i].guid;
+                BatchMutation::OnCommit([guid, id]() { ElementIdIndex::NoteIdChanged(guid, id); });
+            } else {
+                BatchMutation::Fail(changes[i].guid, err);
+            }
+            if (!BatchMutation::Step()) {
+                return APIERR_CANCEL;
+            }
+        }
+        return NoError;
+    });
+
+    result.canceled = report.canceled;
+    result.elementErrors.Append(report.errors);
+    if (!report.success) {
+        written = 0;
+    }
+    result.updated = written;
+    result.failed += static_cast<UInt32>(toWrite.GetSize()) - written;
+    return result;
+}
+
 // ---------------- Изменить ID всех выделенных элементов ----------------
-bool ChangeSelectedElementsID (const GS::UniString& baseID)
+bool ChangeSelectedElementsID (const GS::UniString& baseID, UpdateElementsIdResult* result)
 {
     if (baseID.IsEmpty()) return false;
 
@@ -70,96 +129,110 @@ bool ChangeSelectedElementsID (const GS::UniString& baseID)
 
     if (selNeigs.IsEmpty()) return false;
 
-    // Используем Undo-группу для возможности отмены
-    GSErrCode err = ACAPI_CallUndoableCommand("Change Elements ID", [&]() -> GSErrCode {
-        for (UIndex i = 0; i < selNeigs.GetSize(); ++i) {
-            // Используем базовый ID без порядкового номера
-            GS::UniString newID = baseID;
-
-            // Изменяем ID элемента с помощью правильной функции API
-            if (ACAPI_Element_ChangeElementInfoString(&selNeigs[i].guid, &newID) != NoError) {
-                // Если не удалось изменить ID, пропускаем элемент
-                continue;
-            }
-        }
-        return NoError;
-    });
+    // Базовый ID без порядкового номера
+    GS::Array<ElementIdChange> changes;
+    changes.SetCapacity(selNeigs.GetSize());
+    for (const API_Neig& neig : selNeigs) {
+        ElementIdChange change;
+        change.guid = neig.guid;
+        change.newID = baseID;
+        changes.Push(change);
+    }
 
-    return err == NoError;
+    const UpdateElementsIdResult updateResult = ChangeElementsID(changes);
+    if (result != nullptr) {
+        *result = updateResult;
+    }
+    return updateResult.failed < updateResult.requested;
 }
 
 // ---------------- Применить выделение по списку GUID ----------------
+// Меняется только разница между текущим и нужным выделением: снять выделение с лишних,
+// выделить недостающие. Элементы из текущего выделения заведомо существуют —
+// ACAPI_Element_GetHeader проверяет только новые.
 ApplyCheckedSelectionResult ApplyCheckedSelection (const GS::Array<API_Guid>& guids)
 {
     ApplyCheckedSelectionResult result;
     result.requested = static_cast<UInt32>(guids.GetSize());
-    result.applied = 0;
 
     if (guids.IsEmpty()) {
         return result;
     }
 
-    // Очищаем текущее выделение: получаем все выделенные элементы и удаляем их
     API_SelectionInfo selectionInfo = {};
     GS::Array<API_Neig> selNeigs;
     ACAPI_Selection_Get(&selectionInfo, &selNeigs, false, false);
     BMKillHandle((GSHandle*)&selectionInfo.marquee.coords);
-    
-    // Удаляем все текущие выделенные элементы
-    if (!selNeigs.IsEmpty()) {
-        ACAPI_Selection_Select(selNeigs, false);
+
+    GS::HashTable<API_Guid, bool> requested;
+    for (const API_Guid& guid : guids) {
+        requested.Put(guid, true);
+    }
+
+    // Лишнее в текущем выделении; оставшееся запоминаем, чтобы не выделять повторно
+    GS::HashTable<API_Guid, bool> selected;
+    GS::Array<API_Neig> toDeselect;
+    for (const API_Neig& neig : selNeigs) {
+        if (requested.ContainsKey(neig.guid)) {
+            if (!selected.ContainsKey(neig.guid)) {
+                selected.Add(neig.guid, true);
+                ++result.applied;
+            }
+        } else {
+            toDeselect.Push(neig);
+        }
     }
 
-    // Преобразуем GUID в API_Neig и собираем в массив
-    GS::Array<API_Neig> neigs;
-    for (UIndex i = 0; i < guids.GetSize(); ++i) {
-        API_Neig neig(guids[i]);
-        
+    GS::Array<API_Neig> toSelect;
+    for (const API_Guid& guid : guids) {
+        if (selected.ContainsKey(guid)) {
+            continue;
+        }
+        selected.Add(guid, true);   // повторы в списке проверяются один раз
+
         // Проверяем, существует ли элемент
         API_Elem_Head elemHead = {};
-        elemHead.guid = guids[i];
+        elemHead.guid = guid;
         if (ACAPI_Element_GetHeader(&elemHead) == NoError) {
-            neigs.Push(neig);
+            toSelect.Push(API_Neig(guid));
         }
     }
 
-    if (neigs.IsEmpty()) {
-        return result;
+    if (!toDeselect.IsEmpty()) {
+        ACAPI_Selection_Select(toDeselect, false);
+        result.removed = static_cast<UInt32>(toDeselect.GetSize());
+    }
+    if (!toSelect.IsEmpty()) {
+        ACAPI_Selection_Select(toSelect, true);
+        result.added = static_cast<UInt32>(toSelect.GetSize());
+        result.applied += result.added;
     }
 
-    // Выделяем все элементы одним батчем
-    ACAPI_Selection_Select(neigs, true);
-    result.applied = static_cast<UInt32>(neigs.GetSize());
-
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[SelectionHelper] ApplyCheckedSelection: снято %u, добавлено %u, итого %u", false,
+        (unsigned)result.removed, (unsigned)result.added, (unsigned)result.applied);
+#endif
     return result;
 }
 
 // ---------------- Обновить ID элементов по списку GUID ----------------
 UpdateElementsIdResult UpdateElementsID (const GS::Array<API_Guid>& guids, const GS::UniString& newID)
 {
-    UpdateElementsIdResult result;
-    result.requested = static_cast<UInt32>(guids.GetSize());
-    result.updated = 0;
-
     if (guids.IsEmpty() || newID.IsEmpty()) {
+        UpdateElementsIdResult result;
+        result.requested = static_cast<UInt32>(guids.GetSize());
         return result;
     }
 
-    GSErrCode err = ACAPI_CallUndoableCommand("Change Elements ID", [&]() -> GSErrCode {
-        for (UIndex i = 0; i < guids.GetSize(); ++i) {
-            GS::UniString id = newID;
-            if (ACAPI_Element_ChangeElementInfoString(&guids[i], &id) == NoError) {
-                result.updated++;
-            }
-        }
-        return NoError;
-    });
-
-    if (err != NoError) {
-        result.updated = 0;
+    GS::Array<ElementIdChange> changes;
+    changes.SetCapacity(guids.GetSize());
+    for (const API_Guid& guid : guids) {
+        ElementIdChange change;
+        change.guid = guid;
+        change.newID = newID;
+        changes.Push(change);
     }
-
-    return result;
+    return ChangeElementsID(changes);
 }
 
 } // namespace SelectionHelper
@@ -4,6 +4,7 @@
 #include "APIEnvir.h"
 #include "ACAPinc.h"
 #include "GSRoot.hpp"
+#include "BatchMutation.hpp"
 
 namespace SelectionHelper {
 
@@ -22,24 +23,40 @@ namespace SelectionHelper {
     // Добавить или удалить элемент по GUID
     void ModifySelection (const GS::UniString& elemGuidStr, SelectionModification modification);
 
+    // Результат обновления ID: элементы, у которых ID уже нужный, не записываются
+    struct UpdateElementsIdResult {
+        UInt32                                 updated = 0;       // Записан новый ID
+        UInt32                                 unchanged = 0;     // ID уже был таким
+        UInt32                                 failed = 0;        // Не удалось прочитать или записать
+        UInt32                                 requested = 0;     // Запрошено
+        bool                                   canceled = false;  // Отменено — ничего не записано
+        GS::Array<BatchMutation::ElementError> elementErrors;     // Код ошибки по каждому элементу
+    };
+
+    // Новый ID для элемента
+    struct ElementIdChange {
+        API_Guid      guid = APINULLGuid;
+        GS::UniString newID;
+    };
+
+    // Записать ID одной Undo-командой (BatchMutation: прогресс, отмена с откатом). Текущие ID
+    // читаются заранее, запись — только отличающимся; если менять нечего, Undo-команда не создаётся
+    UpdateElementsIdResult ChangeElementsID (const GS::Array<ElementIdChange>& changes);
+
     // Изменить ID всех выделенных элементов
-    bool ChangeSelectedElementsID (const GS::UniString& baseID);
+    bool ChangeSelectedElementsID (const GS::UniString& baseID, UpdateElementsIdResult* result = nullptr);
 
     // Результат применения выделения
     struct ApplyCheckedSelectionResult {
-        UInt32 applied;    // Количество успешно применённых элементов
-        UInt32 requested;   // Количество запрошенных элементов
+        UInt32 applied = 0;     // Количество успешно применённых элементов
+        UInt32 requested = 0;   // Количество запрошенных элементов
+        UInt32 added = 0;       // Выделено заново (не было в текущем выделении)
+        UInt32 removed = 0;     // Снято с выделения
     };
 
     // Применить выделение по списку GUID
     ApplyCheckedSelectionResult ApplyCheckedSelection (const GS::Array<API_Guid>& guids);
 
-    // Результат обновления ID по списку GUID
-    struct UpdateElementsIdResult {
-        UInt32 updated;    // Успешно обновлено
-        UInt32 requested;  // Запрошено
-    };
-
     // Обновить ID элементов по списку GUID
     UpdateElementsIdResult UpdateElementsID (const GS::Array<API_Guid>& guids, const GS::UniString& newID);
 
@@ -0,0 +1,298 @@
+#include "SelectionSets.hpp"
+#include "AddOnPreferences.hpp"
+#include "GuidSet.hpp"
+
+#include <chrono>
+#include <cstring>
+
+namespace SelectionSets {
+
+static const char*  SectionTag = "selection-sets";
+static const UInt32 FormatVersion = 2;     // 2 — с проектом у каждого набора
+
+static_assert(sizeof(API_Guid) == 16, "API_Guid — 16 байт");
+
+struct NamedSet {
+    GS::UniString project;      // пусто — безымянный проект, в настройки не пишется
+    GS::UniString name;
+    GuidSet::Set  keys;
+};
+
+static GS::Array<NamedSet> sets;
+static bool                setsLoaded = false;
+
+// ---------------- Проект ----------------
+// Путь к файлу проекта или адрес на сервере Teamwork; пусто — проект ещё не сохранён
+static GS::UniString GetProjectKey ()
+{
+    API_ProjectInfo projectInfo = {};
+    if (ACAPI_ProjectOperation_Project(&projectInfo) != NoError) {
+        return GS::UniString();
+    }
+    GS::UniString key;
+    if (!projectInfo.untitled) {
+        if (projectInfo.teamwork && projectInfo.location_team != nullptr) {
+            projectInfo.location_team->ToDisplayText(&key);
+        } else if (projectInfo.location != nullptr) {
+            projectInfo.location->ToDisplayText(&key);
+        }
+    }
+    delete projectInfo.location;
+    delete projectInfo.location_team;
+    delete projectInfo.projectPath;
+    delete projectInfo.projectName;
+    return key;
+}
+
+// ---------------- GUID ----------------
+static GuidSet::Key ToKey (const API_Guid& guid)
+{
+    uint8_t bytes[16];
+    std::memcpy(bytes, &guid, sizeof(bytes));
+    return GuidSet::FromBytes(bytes);
+}
+
+static API_Guid ToGuid (const GuidSet::Key& key)
+{
+    uint8_t bytes[16];
+    GuidSet::ToBytes(key, bytes);
+    API_Guid guid;
+    std::memcpy(&guid, bytes, sizeof(bytes));
+    return guid;
+}
+
+// ---------------- Сериализация ----------------
+static std::string Serialize (const GS::Array<NamedSet>& list)
+{
+    size_t keyCount = 0;
+    UInt32 storedCount = 0;
+    for (const NamedSet& item : list) {
+        if (!item.project.IsEmpty()) {
+            keyCount += item.keys.size();
+            ++storedCount;
+        }
+    }
+
+    std::string out;
+    out.reserve(16 * keyCount + 160 * storedCount + 8);
+    AddOnPreferences::PutUInt32(out, FormatVersion);
+    AddOnPreferences::PutUInt32(out, storedCount);
+    for (const NamedSet& item : list) {
+        if (item.project.IsEmpty()) {
+            continue;
+        }
+        AddOnPreferences::PutString(out, item.project);
+        AddOnPreferences::PutString(out, item.name);
+        AddOnPreferences::PutUInt32(out, static_cast<UInt32>(item.keys.size()));
+        for (const GuidSet::Key& key : item.keys) {
+            AddOnPreferences::PutUInt64(out, key.high);
+            AddOnPreferences::PutUInt64(out, key.low);
+        }
+    }
+    return out;
+}
+
+static bool Deserialize (const std::string& data, GS::Array<NamedSet>& list)
+{
+    AddOnPreferences::Reader reader(data);
+    UInt32 version = 0;
+    UInt32 count = 0;
+    // Версия 1 не знала проекта: чьи в ней GUID, не понять — такие наборы не читаются
+    if (!reader.GetUInt32(version) || version < 2 || version > FormatVersion || !reader.GetUInt32(count)) {
+        return false;
+    }
+
+    for (UInt32 i = 0; i < count; ++i) {
+        NamedSet item;
+        UInt32 keyCount = 0;
+        if (!reader.GetString(item.project) || !reader.GetString(item.name) || !reader.GetUInt32(keyCount)) {
+            return false;
+        }
+        // Длина из повреждённых настроек не должна заказывать память больше, чем осталось данных
+        if (keyCount > reader.GetRemaining() / 16) {
+            return false;
+        }
+        item.keys.resize(keyCount);
+        for (GuidSet::Key& key : item.keys) {
+            UInt64 high = 0;
+            UInt64 low = 0;
+            if (!reader.GetUInt64(high) || !reader.GetUInt64(low)) {
+                return false;
+            }
+            key.high = high;
+            key.low = low;
+        }
+        // Записывается отсортированным; проверка — на случай повреждённых настроек
+        GuidSet::Normalize(item.keys);
+        list.Push(item);
+    }
+    return true;
+}
+
+static void EnsureLoaded ()
+{
+    if (setsLoaded) {
+        return;
+    }
+    setsLoaded = true;
+
+    std::string data;
+    if (AddOnPreferences::ReadSection(SectionTag, data) && !Deserialize(data, sets)) {
+        sets.Clear();
+#ifdef DEBUG_UI_LOGS
+        ACAPI_WriteReport("[SelectionSets] Не удалось прочитать наборы из настроек", false);
+#endif
+    }
+}
+
+static bool Store ()
+{
+    return AddOnPreferences::WriteSection(SectionTag, Serialize(sets));
+}
+
+static const NamedSet* FindSet (const GS::UniString& project, const GS::UniString& name)
+{
+    for (const NamedSet& item : sets) {
+        if (item.project == project && item.name == name) {
+            return &item;
+        }
+    }
+    return nullptr;
+}
+
+// Наборы безымянного проекта живут только в памяти — настройки не переписываются
+static bool StoreKeys (const GS::UniString& project, const GS::UniString& name, const GuidSet::Set& keys)
+{
+    for (NamedSet& item : sets) {
+        if (item.project == project && item.name == name) {
+            item.keys = keys;
+            return project.IsEmpty() || Store();
+        }
+    }
+    NamedSet item;
+    item.project = project;
+    item.name = name;
+    item.keys = keys;
+    sets.Push(item);
+    return project.IsEmpty() || Store();
+}
+
+// ---------------- Наборы ----------------
+GS::Array<SetInfo> GetSets ()
+{
+    EnsureLoaded();
+    const GS::UniString project = GetProjectKey();
+    GS::Array<SetInfo> list;
+    for (const NamedSet& item : sets) {
+        if (item.project != project) {
+            continue;
+        }
+        SetInfo info;
+        info.name = item.name;
+        info.count = static_cast<UInt32>(item.keys.size());
+        list.Push(info);
+    }
+    return list;
+}
+
+bool SaveSet (const GS::UniString& name, const GS::Array<API_Guid>& guids)
+{
+    EnsureLoaded();
+    if (name.IsEmpty()) {
+        return false;
+    }
+
+    GuidSet::Set keys;
+    keys.reserve(guids.GetSize());
+    for (const API_Guid& guid : guids) {
+        keys.push_back(ToKey(guid));
+    }
+    GuidSet::Normalize(keys);
+    return StoreKeys(GetProjectKey(), name, keys);
+}
+
+bool DeleteSet (const GS::UniString& name)
+{
+    EnsureLoaded();
+    const GS::UniString project = GetProjectKey();
+    for (UIndex i = 0; i < sets.GetSize(); ++i) {
+        if (sets[i].project == project && sets[i].name == name) {
+            sets.Delete(i);
+            return project.IsEmpty() || Store();
+        }
+    }
+    return false;
+}
+
+void OnProjectChanged ()
+{
+    for (UIndex i = sets.GetSize(); i > 0; --i) {
+        if (sets[i - 1].project.IsEmpty()) {
+            sets.Delete(i - 1);
+        }
+    }
+}
+
+Operation ParseOperation (const GS::UniString& text)
+{
+    if (text == "union" || text == "+") {
+        return Operation::Union;
+    }
+    if (text == "intersection" || text == "&") {
+        return Operation::Intersection;
+    }
+    if (text == "difference" || text == "-") {
+        return Operation::Difference;
+    }
+    return Operation::None;
+}
+
+// ---------------- Операции ----------------
+ApplyResult Apply (const GS::UniString& left, Operation operation, const GS::UniString& right, const GS::UniString& saveAs)
+{
+    EnsureLoaded();
+    ApplyResult result;
+
+    const GS::UniString project = GetProjectKey();
+    const NamedSet* a = FindSet(project, left);
+    const NamedSet* b = (operation == Operation::None) ? nullptr : FindSet(project, right);
+    if (a == nullptr || (operation != Operation::None && b == nullptr)) {
+        return result;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    GuidSet::Set keys;
+    switch (operation) {
+        case Operation::None:         keys = a->keys; break;
+        case Operation::Union:        keys = GuidSet::Union(a->keys, b->keys); break;
+        case Operation::Intersection: keys = GuidSet::Intersection(a->keys, b->keys); break;
+        case Operation::Difference:   keys = GuidSet::Difference(a->keys, b->keys); break;
+    }
+    result.mergeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.count = static_cast<UInt32>(keys.size());
+    result.success = true;
+
+    // a и b больше не нужны — StoreKeys может переложить массив наборов
+    if (!saveAs.IsEmpty()) {
+        result.saved = StoreKeys(project, saveAs, keys);
+    }
+
+    GS::Array<API_Guid> guids;
+    guids.SetCapacity(static_cast<USize>(keys.size()));
+    for (const GuidSet::Key& key : keys) {
+        guids.Push(ToGuid(key));
+    }
+    if (guids.IsEmpty()) {
+        ACAPI_Selection_DeselectAll();
+    } else {
+        result.selection = SelectionHelper::ApplyCheckedSelection(guids);
+    }
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[SelectionSets] Набор: %u GUID, слияние %.3f мс, выделено %u", false,
+        (unsigned)result.count, result.mergeSeconds * 1000.0, (unsigned)result.selection.applied);
+#endif
+    return result;
+}
+
+} // namespace SelectionSets
@@ -0,0 +1,54 @@
+#ifndef SELECTIONSETS_HPP
+#define SELECTIONSETS_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+#include "SelectionHelper.hpp"
+
+// Именованные наборы выделения — «всё из набора A, кроме набора B» между сеансами.
+// Наборы хранятся в настройках аддона (секция AddOnPreferences) отсортированными массивами
+// 128-битных GUID (GuidSet), поэтому объединение, пересечение и разность — линейное слияние
+// без обращений к модели. Выделение восстанавливается через SelectionHelper::ApplyCheckedSelection:
+// меняется только разница с текущим выделением, элементов, которых нет в модели, оно не касается.
+// GUID имеют смысл только в своём проекте, поэтому набор помнит проект (путь к файлу или
+// адрес на сервере Teamwork), и все функции видят только наборы открытого проекта.
+// Наборы безымянного проекта не записываются в настройки и забываются при смене проекта.
+namespace SelectionSets {
+
+    enum class Operation { None, Union, Intersection, Difference };
+
+    struct SetInfo {
+        GS::UniString name;
+        UInt32        count = 0;
+    };
+
+    // Все наборы открытого проекта (при первом обращении читаются из настроек аддона)
+    GS::Array<SetInfo> GetSets ();
+
+    // Сохранить набор (с тем же именем — заменить) и записать настройки
+    bool SaveSet (const GS::UniString& name, const GS::Array<API_Guid>& guids);
+
+    bool DeleteSet (const GS::UniString& name);
+
+    // "union" / "+", "intersection" / "&", "difference" / "-"; пусто или иное — None
+    Operation ParseOperation (const GS::UniString& text);
+
+    struct ApplyResult {
+        bool                                           success = false;  // наборы найдены
+        UInt32                                         count = 0;        // GUID в результате операции
+        bool                                           saved = false;    // результат сохранён как saveAs
+        double                                         mergeSeconds = 0.0;
+        SelectionHelper::ApplyCheckedSelectionResult   selection;
+    };
+
+    // Выделить left operation right (None — только left); непустой saveAs — сохранить результат
+    // отдельным набором. Пустой результат снимает выделение
+    ApplyResult Apply (const GS::UniString& left, Operation operation, const GS::UniString& right, const GS::UniString& saveAs);
+
+    // Проект сменился — забыть наборы безымянного проекта
+    void OnProjectChanged ();
+
+} // namespace SelectionSets
+
+#endif // SELECTIONSETS_HPP
@@ -0,0 +1,749 @@
+#include "SendXlsHelper.hpp"
+#include "ExportManifest.hpp"
+#include "FileIO.hpp"
+#include "PropertyUtils.hpp"
+#include "CsvWriter.hpp"
+#include "XlsxWriter.hpp"
+#include "OrderedWorkerPool.hpp"
+#include "SnapshotDiff.hpp"
+#include "SnapshotFile.hpp"
+
+#include "DGFileDialog.hpp"
+
+#ifdef GS_WIN
+#include <Windows.h>
+#else
+#include <clocale>
+#endif
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <thread>
+
+namespace SendXlsHelper {
+
+static const UInt32 PipelineMinElements = 2000; // меньше — потоки не окупаются
+static const UInt32 PipelineChunkRows = 1024;
+
+// ---------------- Разобрать колонку экспорта ----------------
+bool ParseColumn (const GS::UniString& token, ExportColumn& column)
+{
+    GS::UniString name = token;
+    name.Trim();
+    if (name.IsEqual("guid", GS::CaseInsensitive)) {
+        column.kind = ExportColumn::Guid;
+        return true;
+    }
+
+    SelectionGroupHelper::Column groupColumn;
+    if (!SelectionGroupHelper::ParseColumn(name, groupColumn)) {
+        return false;
+    }
+
+    switch (groupColumn.kind) {
+        case SelectionGroupHelper::Column::Type:     column.kind = ExportColumn::Type; break;
+        case SelectionGroupHelper::Column::ID:       column.kind = ExportColumn::ID; break;
+        case SelectionGroupHelper::Column::Layer:    column.kind = ExportColumn::Layer; break;
+        case SelectionGroupHelper::Column::Property: column.kind = ExportColumn::Property; break;
+    }
+    column.propertyGuid = groupColumn.propertyGuid;
+    return true;
+}
+
+// ---------------- Источник строк ----------------
+ElementRowSource::ElementRowSource (const GS::Array<API_Guid>& elements, const GS::Array<ExportColumn>& columns, ExportManifest* manifest)
+    : elements(elements)
+    , columns(columns)
+    , manifest(manifest)
+{
+    for (const ExportColumn& column : columns) {
+        if (column.kind == ExportColumn::ID) {
+            needsID = true;
+        } else if (column.kind == ExportColumn::Property && !propertySlots.ContainsKey(column.propertyGuid)) {
+            propertySlots.Add(column.propertyGuid, propertyGuids.GetSize());
+            propertyGuids.Push(column.propertyGuid);
+        }
+    }
+    propertyCells.SetSize(propertyGuids.GetSize());
+}
+
+bool ElementRowSource::Next (GS::Array<ExportCell>& row)
+{
+    while (position < elements.GetSize()) {
+        API_Elem_Head elemHead = {};
+        elemHead.guid = elements[position++];
+        if (ACAPI_Element_GetHeader(&elemHead) != NoError) {
+            continue;
+        }
+
+        GS::UniString elemID;
+        const ExportManifest::Record* cached = (manifest != nullptr) ? manifest->Find(elemHead.guid, elemHead.modiStamp) : nullptr;
+        if (cached != nullptr && cached->cells.GetSize() == propertyCells.GetSize()) {
+            // Элемент не менялся с прошлой выгрузки — API не трогаем
+            elemID = cached->elemID;
+            for (UIndex i = 0; i < propertyCells.GetSize(); ++i) {
+                propertyCells[i] = cached->cells[i];
+            }
+        } else {
+            if (needsID) {
+                ACAPI_Element_GetElementInfoString(&elemHead.guid, &elemID);
+            }
+
+            for (ExportCell& cell : propertyCells) {
+                cell.text.Clear();
+                cell.isNumber = false;
+            }
+            if (!propertyGuids.IsEmpty()) {
+                properties.Clear();
+                if (ACAPI_Element_GetPropertyValuesByGuid(elemHead.guid, propertyGuids, properties) == NoError) {
+                    for (const API_Property& property : properties) {
+                        UIndex slot = 0;
+                        if (!propertySlots.Get(property.definition.guid, &slot)) {
+                            continue;
+                        }
+                        PropertyUtils::PropertyToString(property, propertyCells[slot].text);
+                        propertyCells[slot].isNumber = PropertyUtils::PropertyToDouble(property, propertyCells[slot].number);
+                    }
+                }
+            }
+
+            if (manifest != nullptr) {
+                manifest->Put(elemHead.guid, elemHead.modiStamp, elemID, propertyCells);
+            }
+        }
+
+        row.SetSize(columns.GetSize());
+        for (UIndex c = 0; c < columns.GetSize(); ++c) {
+            ExportCell& cell = row[c];
+            cell.isNumber = false;
+            switch (columns[c].kind) {
+                case ExportColumn::Guid:     cell.text = APIGuidToString(elemHead.guid); break;
+                case ExportColumn::Type:     cell.text = names.GetTypeName(elemHead.type); break;
+                case ExportColumn::ID:       cell.text = elemID; break;
+                case ExportColumn::Layer:    cell.text = names.GetLayerName(elemHead.layer); break;
+                case ExportColumn::Property: cell = propertyCells[propertySlots[columns[c].propertyGuid]]; break;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+// ---------------- Диалог сохранения ----------------
+bool AskSavePath (const GS::UniString& title, const GS::UniString& extension, GS::UniString& path)
+{
+    DG::FileDialog dialog(DG::FileDialog::Save);
+    dialog.SetTitle(title);
+    if (!dialog.Invoke()) {
+        return false;
+    }
+
+    if (dialog.GetSelectedFile().ToPath(&path) != NoError || path.IsEmpty()) {
+        return false;
+    }
+
+    GS::UniString suffix = GS::UniString(".") + extension;
+    if (!path.EndsWith(suffix, GS::CaseInsensitive)) {
+        path += suffix;
+    }
+    return true;
+}
+
+bool AskOpenPath (const GS::UniString& title, GS::UniString& path)
+{
+    DG::FileDialog dialog(DG::FileDialog::OpenFile);
+    dialog.SetTitle(title);
+    if (!dialog.Invoke()) {
+        return false;
+    }
+    return dialog.GetSelectedFile().ToPath(&path) == NoError && !path.IsEmpty();
+}
+
+// ---------------- Разделители CSV по региональным настройкам ----------------
+static CsvWriter::Options GetLocaleCsvOptions ()
+{
+    CsvWriter::Options options;
+#ifdef GS_WIN
+    wchar_t buffer[8] = {};
+    if (GetLocaleInfoEx(LOCALE_NAME_USER_DEFAULT, LOCALE_SDECIMAL, buffer, 8) > 0 && buffer[0] > 0 && buffer[0] < 128) {
+        options.decimalSeparator = static_cast<char>(buffer[0]);
+    }
+    if (GetLocaleInfoEx(LOCALE_NAME_USER_DEFAULT, LOCALE_SLIST, buffer, 8) > 0 && buffer[0] > 0 && buffer[0] < 128) {
+        options.delimiter = static_cast<char>(buffer[0]);
+    }
+#else
+    const std::lconv* conv = std::localeconv();
+    if (conv != nullptr && conv->decimal_point != nullptr && conv->decimal_point[0] != '\0') {
+        options.decimalSeparator = conv->decimal_point[0];
+    }
+#endif
+    // Excel читает "1,5;2,5" и "1.5,2.5", но не "1,5,2,5"
+    if (options.delimiter == options.decimalSeparator) {
+        options.delimiter = (options.decimalSeparator == ',') ? ';' : ',';
+    }
+    return options;
+}
+
+static void WriteTextField (TableWriter& writer, const GS::UniString& text)
+{
+    const auto utf8 = text.ToCStr(0, MaxUSize, CC_UTF8);
+    writer.WriteField(utf8.Get(), std::strlen(utf8.Get()));
+}
+
+// ---------------- Форматтеры ячеек ----------------
+// Тексты переводятся в UTF-8 в главном потоке; если формат ведёт таблицу общих строк,
+// ячейка сразу получает её индекс.
+static void AppendText (TableWriter& writer, const GS::UniString& text, RowChunk& chunk)
+{
+    if (text.IsEmpty()) {
+        chunk.AddEmpty();
+        return;
+    }
+    const auto utf8 = text.ToCStr(0, MaxUSize, CC_UTF8);
+    const size_t length = std::strlen(utf8.Get());
+    uint32_t index = 0;
+    if (writer.InternString(utf8.Get(), length, index)) {
+        chunk.AddSharedString(index);
+    } else {
+        chunk.AddText(utf8.Get(), length);
+    }
+}
+
+static void FormatAuto (TableWriter& writer, const ExportCell& cell, Int32 decimals, RowChunk& chunk)
+{
+    if (cell.isNumber) {
+        chunk.AddNumber(cell.number, decimals);
+    } else {
+        AppendText(writer, cell.text, chunk);
+    }
+}
+
+static void FormatText (TableWriter& writer, const ExportCell& cell, Int32 /*decimals*/, RowChunk& chunk)
+{
+    AppendText(writer, cell.text, chunk);
+}
+
+static void FormatNumber (TableWriter& writer, const ExportCell& cell, Int32 decimals, RowChunk& chunk)
+{
+    if (cell.isNumber) {
+        chunk.AddNumber(cell.number, decimals);
+        return;
+    }
+
+    // Текстовое значение вида "12,5" или "12.5" — тоже число
+    GS::UniString text = cell.text;
+    text.Trim();
+    text.ReplaceAll(",", ".");
+    const auto ascii = text.ToCStr();
+    char* end = nullptr;
+    const double value = std::strtod(ascii.Get(), &end);
+    if (!text.IsEmpty() && end != nullptr && *end == '\0') {
+        chunk.AddNumber(value, decimals);
+    } else {
+        AppendText(writer, cell.text, chunk);
+    }
+}
+
+CellFormatter GetCellFormatter (CellFormat format)
+{
+    switch (format) {
+        case CellFormat::Number: return FormatNumber;
+        case CellFormat::Text:   return FormatText;
+        default:                 return FormatAuto;
+    }
+}
+
+// Заголовки колонок — первой строкой, напрямую в писатель
+static void WriteHeaderRow (TableWriter& writer, const GS::Array<GS::UniString>& headers)
+{
+    for (const GS::UniString& header : headers) {
+        WriteTextField(writer, header);
+    }
+    writer.EndRow();
+}
+
+// Элементы пачками: главный поток читает их через ACAPI, форматирование и сжатие
+// пачек идёт в рабочих потоках (threadCount == 0 — здесь же), готовые пачки пишутся
+// в файл строго по порядку. В работе не больше maxInFlight пачек, поэтому память ограничена.
+static bool WriteRows (TableWriter& writer,
+                       const GS::Array<API_Guid>& elements,
+                       const GS::Array<ExportColumn>& columns,
+                       unsigned threadCount,
+                       ExportManifest* manifest,
+                       ExportResult& result)
+{
+    GS::Array<GS::UniString> headers;
+    GS::Array<CellFormatter> formatters;
+    for (const ExportColumn& column : columns) {
+        headers.Push(column.header);
+        formatters.Push(column.formatter != nullptr ? column.formatter : FormatAuto);
+    }
+    WriteHeaderRow(writer, headers);
+
+    std::unique_ptr<OrderedWorkerPool> pool;
+    if (threadCount > 0) {
+        pool.reset(new OrderedWorkerPool(threadCount));
+    }
+    const size_t maxInFlight = 2 * static_cast<size_t>(threadCount) + 1;
+    const TableWriter* formatter = &writer;
+    bool chunksOk = true;
+
+    ChunkOutput output;
+    auto consume = [&] () {
+        chunksOk = chunksOk && output.ok;
+        if (output.ok) {
+            writer.WriteChunk(output);
+            result.rows += output.rowCount;
+        }
+    };
+
+    uint32_t nextRow = writer.GetNextRow();
+    auto newChunk = [&] () {
+        std::shared_ptr<RowChunk> chunk = std::make_shared<RowChunk>();
+        chunk->firstRow = nextRow;
+        chunk->columnCount = columns.GetSize();
+        chunk->cells.reserve(PipelineChunkRows * columns.GetSize());
+        return chunk;
+    };
+
+    std::shared_ptr<RowChunk> chunk = newChunk();
+    auto submit = [&] () {
+        if (chunk->cells.empty()) {
+            return;
+        }
+        nextRow += chunk->GetRowCount();
+        if (pool == nullptr) {
+            output = writer.FormatChunk(*chunk);
+            consume();
+            chunk = newChunk();
+            return;
+        }
+        while (pool->GetInFlight() >= maxInFlight && pool->Next(output, true)) {
+            consume();
+        }
+        std::shared_ptr<const RowChunk> ready = chunk;
+        pool->Submit([formatter, ready] () { return formatter->FormatChunk(*ready); });
+        chunk = newChunk();
+        while (pool->Next(output, false)) {
+            consume();
+        }
+    };
+
+    ElementRowSource source(elements, columns, manifest);
+    GS::Array<ExportCell> row;
+    while (source.Next(row)) {
+        for (UIndex c = 0; c < row.GetSize(); ++c) {
+            formatters[c](writer, row[c], columns[c].decimals, *chunk);
+        }
+        if (chunk->GetRowCount() >= PipelineChunkRows) {
+            submit();
+        }
+    }
+    submit();
+    while (pool != nullptr && pool->Next(output, true)) {
+        consume();
+    }
+
+    const bool writeOk = writer.Finish();
+    result.bytes = writer.GetBytesWritten();
+    return chunksOk && writeOk;
+}
+
+GS::UniString GetFormatExtension (ExportFormat format)
+{
+    return (format == ExportFormat::Xlsx) ? GS::UniString("xlsx") : GS::UniString("csv");
+}
+
+// Открыть файл, создать писатель нужного формата и отдать его writeRows
+template <typename WriteRowsFn>
+static ExportResult WriteFile (const GS::UniString& path, const ExportOptions& options, WriteRowsFn writeRows)
+{
+    ExportResult result;
+    result.path = path;
+    if (path.IsEmpty()) {
+        return result;
+    }
+
+    std::FILE* file = FileIO::OpenFile(path, "wb");
+    if (file == nullptr) {
+#ifdef DEBUG_UI_LOGS
+        ACAPI_WriteReport("[SendXls] Не удалось открыть файл: %s", true, path.ToCStr().Get());
+#endif
+        return result;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+
+    bool writeOk = false;
+    if (options.format == ExportFormat::Xlsx) {
+        XlsxWriter::Options xlsxOptions;
+        xlsxOptions.sheetName = "Elements";
+        XlsxWriter writer(file, xlsxOptions);
+        writeOk = writeRows(writer, result);
+    } else {
+        CsvWriter::Options csvOptions = GetLocaleCsvOptions();
+        csvOptions.writeBom = options.writeBom;
+        CsvWriter writer(file, csvOptions);
+        writeOk = writeRows(writer, result);
+    }
+    const bool closeOk = (std::fclose(file) == 0);
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.success = writeOk && closeOk;
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[SendXls] %s: %u строк, %.1f МБ за %.2f с (%.1f МБ/с)", false,
+        GetFormatExtension(options.format).ToCStr().Get(),
+        (unsigned)result.rows, result.bytes / 1048576.0, result.seconds,
+        result.seconds > 0.0 ? result.bytes / 1048576.0 / result.seconds : 0.0);
+#endif
+
+    return result;
+}
+
+// Набор данных, которые источник строк читает из API; манифест годится только для того же набора
+static std::string GetManifestSignature (const GS::Array<ExportColumn>& columns)
+{
+    std::string signature;
+    for (const ExportColumn& column : columns) {
+        if (column.kind == ExportColumn::ID) {
+            signature += "id;";
+        } else if (column.kind == ExportColumn::Property) {
+            signature += APIGuidToString(column.propertyGuid).ToCStr().Get();
+            signature += ';';
+        }
+    }
+    return signature;
+}
+
+// ---------------- Потоковый экспорт в CSV / XLSX ----------------
+ExportResult ExportToFile (const GS::Array<API_Guid>& elements,
+                           const GS::Array<ExportColumn>& columns,
+                           const GS::UniString& path,
+                           const ExportOptions& options)
+{
+    if (columns.IsEmpty()) {
+        ExportResult result;
+        result.path = path;
+        return result;
+    }
+
+    // Мелкие выборки — без потоков: конвейер не окупается
+    const unsigned threadCount = (elements.GetSize() < PipelineMinElements || std::thread::hardware_concurrency() < 2)
+        ? 0 : OrderedWorkerPool::GetDefaultThreadCount();
+
+    // Повторная выгрузка: файл пишется заново (форматирование и сжатие дешёвые),
+    // а дорогое чтение свойств через API — только для изменённых и новых элементов
+    std::unique_ptr<ExportManifest> manifest;
+    if (options.manifest != ManifestMode::None && !path.IsEmpty()) {
+        manifest.reset(new ExportManifest(path, GetManifestSignature(columns)));
+        if (options.manifest == ManifestMode::Reuse) {
+            manifest->Load();
+        }
+    }
+
+    ExportResult result = WriteFile(path, options, [&] (TableWriter& writer, ExportResult& result) {
+        return WriteRows(writer, elements, columns, threadCount, manifest.get(), result);
+    });
+
+    if (manifest != nullptr) {
+        result.pulled = manifest->GetPulledCount();
+        result.reused = manifest->GetReusedCount();
+        result.removed = manifest->GetRemovedCount();
+        if (!result.success || !manifest->Save()) {
+            manifest->Remove();
+        }
+#ifdef DEBUG_UI_LOGS
+        ACAPI_WriteReport("[SendXls] Повторная выгрузка: прочитано %u, из манифеста %u, удалено %u", false,
+            (unsigned)result.pulled, (unsigned)result.reused, (unsigned)result.removed);
+#endif
+    } else {
+        result.pulled = result.rows;
+    }
+    return result;
+}
+
+// ---------------- Экспорт сводной по группам ----------------
+ExportResult ExportGroupsToFile (const GS::Array<API_Guid>& elements,
+                                 const GroupedExport& plan,
+                                 const GS::UniString& path,
+                                 const ExportOptions& options)
+{
+    const SelectionGroupHelper::GroupResult groups = SelectionGroupHelper::GroupElements(elements, plan.groupBy, plan.aggregates);
+
+    return WriteFile(path, options, [&] (TableWriter& writer, ExportResult& result) {
+        GS::Array<GS::UniString> headers = plan.groupHeaders;
+        headers.Push("Кол-во");
+        for (const GS::UniString& header : plan.aggregateHeaders) {
+            headers.Push(GS::UniString("Σ ") + header);
+        }
+        WriteHeaderRow(writer, headers);
+
+        for (const SelectionGroupHelper::Group& group : groups.groups) {
+            for (const GS::UniString& key : group.keyValues) {
+                WriteTextField(writer, key);
+            }
+            writer.WriteNumber(group.count, 0);
+            for (UIndex i = 0; i < group.aggregates.GetSize(); ++i) {
+                if (group.aggregates[i].numericCount > 0) {
+                    const Int32 decimals = (i < plan.aggregateDecimals.GetSize()) ? plan.aggregateDecimals[i] : 6;
+                    writer.WriteNumber(group.aggregates[i].sum, decimals);
+                } else {
+                    writer.WriteEmpty();
+                }
+            }
+            writer.EndRow();
+            result.rows++;
+        }
+
+        const bool writeOk = writer.Finish();
+        result.bytes = writer.GetBytesWritten();
+        return writeOk;
+    });
+}
+
+// ---------------- Снимок выделения ----------------
+static std::string ToUtf8 (const GS::UniString& text)
+{
+    return std::string(text.ToCStr(0, MaxUSize, CC_UTF8).Get());
+}
+
+static std::string GetColumnToken (const ExportColumn& column)
+{
+    switch (column.kind) {
+        case ExportColumn::Guid:     return "guid";
+        case ExportColumn::Type:     return "type";
+        case ExportColumn::ID:       return "id";
+        case ExportColumn::Layer:    return "layer";
+        case ExportColumn::Property: return ToUtf8(APIGuidToString(column.propertyGuid));
+    }
+    return std::string();
+}
+
+ExportResult SaveSnapshot (const GS::Array<API_Guid>& elements,
+                           const GS::Array<ExportColumn>& columns,
+                           const GS::UniString& path)
+{
+    ExportResult result;
+    result.path = path;
+    if (columns.IsEmpty() || path.IsEmpty()) {
+        return result;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+
+    std::vector<SnapshotFile::ColumnInfo> infos;
+    for (const ExportColumn& column : columns) {
+        SnapshotFile::ColumnInfo info;
+        info.token = GetColumnToken(column);
+        info.name = ToUtf8(column.header);
+        info.kind = (column.kind == ExportColumn::Guid) ? SnapshotFile::ColumnKind::Guid
+                  : (column.kind == ExportColumn::Property) ? SnapshotFile::ColumnKind::Value
+                  : SnapshotFile::ColumnKind::Text;
+        infos.push_back(info);
+    }
+
+    SnapshotFile::Writer writer(infos);
+    ElementRowSource source(elements, columns);
+    GS::Array<ExportCell> row;
+    while (source.Next(row)) {
+        for (UIndex c = 0; c < row.GetSize(); ++c) {
+            const std::string text = ToUtf8(row[c].text);
+            if (infos[c].kind == SnapshotFile::ColumnKind::Guid) {
+                uint8_t guid[16] = {};
+                SnapshotFile::ParseGuid(text, guid);
+                writer.SetGuid(c, guid);
+            } else {
+                writer.SetValue(c, text.data(), text.size(), row[c].isNumber, row[c].number);
+            }
+        }
+        writer.EndRow();
+    }
+    result.rows = writer.GetRowCount();
+    result.pulled = result.rows;
+
+    std::FILE* file = FileIO::OpenFile(path, "wb");
+    if (file == nullptr) {
+        return result;
+    }
+    const bool writeOk = writer.Write(file, static_cast<uint64_t>(std::time(nullptr)));
+    const long size = std::ftell(file);
+    const bool closeOk = (std::fclose(file) == 0);
+
+    result.bytes = (size > 0) ? static_cast<UInt64>(size) : 0;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    result.success = writeOk && closeOk;
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[SendXls] Снимок: %u строк, %.1f МБ за %.2f с", false,
+        (unsigned)result.rows, result.bytes / 1048576.0, result.seconds);
+#endif
+    return result;
+}
+
+// ---------------- Сравнение снимков ----------------
+static GS::UniString FromUtf8 (std::string_view text)
+{
+    return GS::UniString(std::string(text).c_str(), CC_UTF8);
+}
+
+static bool OpenSnapshot (const GS::UniString& path, SnapshotFile::Reader& reader)
+{
+    if (path.IsEmpty() || !reader.Open(path.ToCStr(0, MaxUSize, CC_UTF8).Get())) {
+#ifdef DEBUG_UI_LOGS
+        ACAPI_WriteReport("[SendXls] Не удалось открыть снимок: %s", false, path.ToCStr().Get());
+#endif
+        return false;
+    }
+    return true;
+}
+
+SnapshotDiffResult CompareSnapshots (const GS::UniString& oldPath, const GS::UniString& newPath, UInt32 maxRows)
+{
+    SnapshotDiffResult result;
+    SnapshotFile::Reader oldSnapshot;
+    SnapshotFile::Reader newSnapshot;
+    if (!OpenSnapshot(oldPath, oldSnapshot) || !OpenSnapshot(newPath, newSnapshot)) {
+        return result;
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const uint32_t oldIdColumn = oldSnapshot.FindColumn("id");
+    const uint32_t newIdColumn = newSnapshot.FindColumn("id");
+
+    SnapshotDiff::Engine engine(oldSnapshot, newSnapshot);
+    const SnapshotDiff::Summary& summary = engine.GetSummary();
+    result.success = engine.Run([&] (const SnapshotDiff::RowDiff& diff) {
+        if (result.rows.GetSize() >= maxRows) {
+            return;
+        }
+        SnapshotDiffRow row;
+        row.status = SnapshotDiff::GetStatusName(diff.status);
+        row.guid = SnapshotFile::FormatGuid(diff.guid).c_str();
+        if (diff.status == SnapshotDiff::RowStatus::Removed) {
+            row.id = (oldIdColumn != SnapshotFile::NoColumn) ? FromUtf8(oldSnapshot.GetText(oldIdColumn, diff.oldRow)) : GS::UniString();
+        } else {
+            row.id = (newIdColumn != SnapshotFile::NoColumn) ? FromUtf8(newSnapshot.GetText(newIdColumn, diff.newRow)) : GS::UniString();
+        }
+        if (diff.changedColumns != nullptr) {
+            for (uint32_t pair : *diff.changedColumns) {
+                if (!row.changedColumns.IsEmpty()) {
+                    row.changedColumns += ", ";
+                }
+                row.changedColumns += FromUtf8(summary.columns[pair].name);
+            }
+        }
+        result.rows.Push(row);
+    });
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    result.added = summary.added;
+    result.removed = summary.removed;
+    result.changed = summary.changed;
+    result.unchanged = summary.unchanged;
+    for (const SnapshotDiff::ColumnPair& column : summary.columns) {
+        result.columnNames.Push(FromUtf8(column.name));
+        result.columnChanges.Push(column.changes);
+    }
+
+#ifdef DEBUG_UI_LOGS
+    ACAPI_WriteReport("[SendXls] Сравнение снимков: +%llu -%llu ~%llu за %.3f с", false,
+        (unsigned long long)result.added, (unsigned long long)result.removed, (unsigned long long)result.changed, result.seconds);
+#endif
+    return result;
+}
+
+static void WriteSnapshotCell (TableWriter& writer, const SnapshotFile::Reader& snapshot, uint32_t column, uint32_t row)
+{
+    double number = 0.0;
+    if (snapshot.GetNumber(column, row, number)) {
+        writer.WriteNumber(number);
+        return;
+    }
+    const std::string_view text = snapshot.GetText(column, row);
+    if (text.empty()) {
+        writer.WriteEmpty();
+    } else {
+        writer.WriteField(text.data(), text.size());
+    }
+}
+
+ExportResult ExportSnapshotDiff (const GS::UniString& oldPath,
+                                 const GS::UniString& newPath,
+                                 const GS::UniString& path,
+                                 const ExportOptions& options)
+{
+    SnapshotFile::Reader oldSnapshot;
+    SnapshotFile::Reader newSnapshot;
+    if (!OpenSnapshot(oldPath, oldSnapshot) || !OpenSnapshot(newPath, newSnapshot)) {
+        ExportResult result;
+        result.path = path;
+        return result;
+    }
+
+    // Строки пишутся прямо из обхода — в памяти не копятся
+    return WriteFile(path, options, [&] (TableWriter& writer, ExportResult& result) {
+        SnapshotDiff::Engine engine(oldSnapshot, newSnapshot);
+        const SnapshotDiff::Summary& summary = engine.GetSummary();
+        if (!engine.Prepare()) {
+            return false;
+        }
+
+        GS::Array<GS::UniString> headers;
+        headers.Push("Статус");
+        headers.Push("GUID");
+        headers.Push("Изменённые колонки");
+        for (const SnapshotDiff::ColumnPair& column : summary.columns) {
+            headers.Push(FromUtf8(column.name) + " (было)");
+            headers.Push(FromUtf8(column.name) + " (стало)");
+        }
+        WriteHeaderRow(writer, headers);
+
+        std::string changedColumns;
+        const bool diffOk = engine.Run([&] (const SnapshotDiff::RowDiff& diff) {
+            switch (diff.status) {
+                case SnapshotDiff::RowStatus::Added:   WriteTextField(writer, "Добавлен"); break;
+                case SnapshotDiff::RowStatus::Removed: WriteTextField(writer, "Удалён"); break;
+                case SnapshotDiff::RowStatus::Changed: WriteTextField(writer, "Изменён"); break;
+            }
+            const std::string guid = SnapshotFile::FormatGuid(diff.guid);
+            writer.WriteField(guid.data(), guid.size());
+
+            changedColumns.clear();
+            if (diff.changedColumns != nullptr) {
+                for (uint32_t pair : *diff.changedColumns) {
+                    if (!changedColumns.empty()) {
+                        changedColumns += ", ";
+                    }
+                    changedColumns += summary.columns[pair].name;
+                }
+            }
+            writer.WriteField(changedColumns.data(), changedColumns.size());
+
+            for (const SnapshotDiff::ColumnPair& column : summary.columns) {
+                if (diff.status == SnapshotDiff::RowStatus::Added) {
+                    writer.WriteEmpty();
+                } else {
+                    WriteSnapshotCell(writer, oldSnapshot, column.oldColumn, diff.oldRow);
+                }
+                if (diff.status == SnapshotDiff::RowStatus::Removed) {
+                    writer.WriteEmpty();
+                } else {
+                    WriteSnapshotCell(writer, newSnapshot, column.newColumn, diff.newRow);
+                }
+            }
+            writer.EndRow();
+            result.rows++;
+        });
+
+        const bool writeOk = writer.Finish();
+        result.bytes = writer.GetBytesWritten();
+        return diffOk && writeOk;
+    });
+}
+
+} // namespace SendXlsHelper
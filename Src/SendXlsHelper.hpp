@@ -0,0 +1,161 @@
+#ifndef SENDXLSHELPER_HPP
+#define SENDXLSHELPER_HPP
+
+#include "APIEnvir.h"
+#include "ACAPinc.h"
+#include "GSRoot.hpp"
+#include "ElementNameCache.hpp"
+#include "SelectionGroupHelper.hpp"
+#include "TableWriter.hpp"
+
+namespace SendXlsHelper {
+
+    // Значение ячейки: текст всегда, число — если свойство числовое
+    struct ExportCell {
+        GS::UniString text;
+        double        number = 0.0;
+        bool          isNumber = false;
+    };
+
+    // Как выводить значение: Auto — числом, если свойство числовое;
+    // Number — ещё и пробовать разобрать текст как число; Text — всегда текстом
+    enum class CellFormat { Auto, Number, Text };
+
+    // Запись значения в пачку строк; выбирается один раз при разборе колонки
+    typedef void (*CellFormatter) (TableWriter& writer, const ExportCell& cell, Int32 decimals, RowChunk& chunk);
+
+    CellFormatter GetCellFormatter (CellFormat format);
+
+    // Колонка экспорта
+    struct ExportColumn {
+        enum Kind { Guid, Type, ID, Layer, Property };
+
+        Kind          kind = Guid;
+        API_Guid      propertyGuid = APINULLGuid; // только для Kind::Property
+        GS::UniString header;                     // Заголовок колонки в файле
+        CellFormatter formatter = nullptr;        // nullptr — CellFormat::Auto
+        Int32         decimals = 6;
+    };
+
+    // Разобрать колонку из строки: "guid", "type", "id", "layer" или GUID свойства
+    bool ParseColumn (const GS::UniString& token, ExportColumn& column);
+
+    class ExportManifest;
+
+    // Источник строк: отдаёт элементы по одному, все свойства элемента читаются одним вызовом API.
+    // В памяти держится только текущая строка. С манифестом значения неизменённых элементов
+    // берутся из него, а прочитанные заново — записываются в него.
+    class ElementRowSource {
+    public:
+        ElementRowSource (const GS::Array<API_Guid>& elements, const GS::Array<ExportColumn>& columns, ExportManifest* manifest = nullptr);
+
+        // Заполнить следующую строку; false, когда элементы закончились
+        bool   Next (GS::Array<ExportCell>& row);
+        UInt32 GetElementCount () const { return elements.GetSize(); }
+
+    private:
+        const GS::Array<API_Guid>&      elements;
+        const GS::Array<ExportColumn>&  columns;
+        GS::Array<API_Guid>             propertyGuids;
+        GS::HashTable<API_Guid, UIndex> propertySlots;
+        bool                            needsID = false;
+        UIndex                          position = 0;
+        ElementNameCache                names;
+        ExportManifest*                 manifest = nullptr;
+
+        GS::Array<API_Property>         properties;
+        GS::Array<ExportCell>           propertyCells;
+    };
+
+    enum class ExportFormat { Csv, Xlsx };
+
+    // Манифест выгрузки (<файл>.tscache): None — не вести; Rebuild — прочитать всё и записать манифест;
+    // Reuse — из API читать только элементы, изменённые с прошлой выгрузки в этот файл
+    enum class ManifestMode { None, Rebuild, Reuse };
+
+    struct ExportOptions {
+        ExportFormat format = ExportFormat::Csv;
+        bool         writeBom = true; // UTF-8 BOM для Excel (только CSV)
+        ManifestMode manifest = ManifestMode::None;
+    };
+
+    struct ExportResult {
+        bool          success = false;
+        UInt32        rows = 0;
+        UInt64        bytes = 0;
+        double        seconds = 0.0;
+        GS::UniString path;
+        UInt32        pulled = 0;   // прочитано из API (при ManifestMode::Reuse — изменённые и новые)
+        UInt32        reused = 0;   // взято из манифеста прошлой выгрузки
+        UInt32        removed = 0;  // было в прошлой выгрузке, теперь нет
+    };
+
+    // Диалог сохранения файла с заголовком title; расширение добавляется, если пользователь его не указал
+    bool AskSavePath (const GS::UniString& title, const GS::UniString& extension, GS::UniString& path);
+
+    // Сводная выгрузка: строка на группу — значения ключей, количество и суммы
+    struct GroupedExport {
+        GS::Array<SelectionGroupHelper::Column> groupBy;
+        GS::Array<GS::UniString>                groupHeaders;
+        GS::Array<SelectionGroupHelper::Column> aggregates;
+        GS::Array<GS::UniString>                aggregateHeaders;
+        GS::Array<Int32>                        aggregateDecimals;
+    };
+
+    // Расширение файла для формата: "csv" или "xlsx"
+    GS::UniString GetFormatExtension (ExportFormat format);
+
+    // Потоковый экспорт элементов в файл.
+    // CSV — разделители по региональным настройкам системы; XLSX — числа числовыми ячейками.
+    ExportResult ExportToFile (const GS::Array<API_Guid>& elements,
+                               const GS::Array<ExportColumn>& columns,
+                               const GS::UniString& path,
+                               const ExportOptions& options);
+
+    // Экспорт сводной по группам в файл
+    ExportResult ExportGroupsToFile (const GS::Array<API_Guid>& elements,
+                                     const GroupedExport& plan,
+                                     const GS::UniString& path,
+                                     const ExportOptions& options);
+
+    // Снимок выделения в колоночный файл .tssnap (SnapshotFile.hpp): GUID, тип, ID, слой и свойства.
+    // Открывается через mmap без разбора — для сравнения снимков и скриптов проверки
+    ExportResult SaveSnapshot (const GS::Array<API_Guid>& elements,
+                               const GS::Array<ExportColumn>& columns,
+                               const GS::UniString& path);
+
+    // Диалог выбора существующего файла
+    bool AskOpenPath (const GS::UniString& title, GS::UniString& path);
+
+    // ---------------- Сравнение снимков ----------------
+    struct SnapshotDiffRow {
+        GS::UniString status;          // "added", "removed", "changed"
+        GS::UniString guid;
+        GS::UniString id;              // из колонки "id", если она есть в снимке
+        GS::UniString changedColumns;  // через запятую (только changed)
+    };
+
+    struct SnapshotDiffResult {
+        bool                       success = false;
+        UInt64                     added = 0;
+        UInt64                     removed = 0;
+        UInt64                     changed = 0;
+        UInt64                     unchanged = 0;
+        double                     seconds = 0.0;
+        GS::Array<GS::UniString>   columnNames;
+        GS::Array<UInt64>          columnChanges;
+        GS::Array<SnapshotDiffRow> rows;   // первые maxRows отличий — для палитры
+    };
+
+    // Сравнить два снимка (SnapshotDiff.hpp): сводка и первые maxRows отличий
+    SnapshotDiffResult CompareSnapshots (const GS::UniString& oldPath, const GS::UniString& newPath, UInt32 maxRows);
+
+    // Все отличия в CSV / XLSX: статус, GUID, изменённые колонки, значения «было» / «стало»
+    ExportResult ExportSnapshotDiff (const GS::UniString& oldPath,
+                                     const GS::UniString& newPath,
+                                     const GS::UniString& path,
+                                     const ExportOptions& options);
+
+} // namespace SendXlsHelper
+
+#endif // SENDXLSHELPER_HPP
@@ -0,0 +1,217 @@
+#include "SnapshotDiff.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+namespace SnapshotDiff {
+
+static const uint32_t NoCode = 0xFFFFFFFFu;
+static const uint64_t DirectRatio = 4;			// словарь больше четверти строк — сравнивать строками
+
+const char* GetStatusName (RowStatus status)
+{
+	switch (status) {
+		case RowStatus::Added:		return "added";
+		case RowStatus::Removed:	return "removed";
+		default:					return "changed";
+	}
+}
+
+Engine::Engine (const SnapshotFile::Reader& oldSnapshot, const SnapshotFile::Reader& newSnapshot)
+	: m_old(oldSnapshot)
+	, m_new(newSnapshot)
+{
+}
+
+// Пары колонок и перевод кодов словаря старого снимка в коды нового
+void Engine::BuildMappings ()
+{
+	m_summary.columns.clear();
+	m_mappings.clear();
+
+	std::unordered_map<std::string_view, uint32_t> newCodes;
+	for (uint32_t oldColumn = 0; oldColumn < m_old.GetColumnCount(); ++oldColumn) {
+		const SnapshotFile::ColumnKind oldKind = m_old.GetColumnKind(oldColumn);
+		if (oldKind == SnapshotFile::ColumnKind::Guid) {
+			continue;
+		}
+		const uint32_t newColumn = m_new.FindColumn(m_old.GetColumnToken(oldColumn));
+		if (newColumn == SnapshotFile::NoColumn || m_new.GetColumnKind(newColumn) == SnapshotFile::ColumnKind::Guid) {
+			continue;
+		}
+
+		ColumnPair pair;
+		pair.token = std::string(m_old.GetColumnToken(oldColumn));
+		pair.name = std::string(m_new.GetColumnName(newColumn));
+		pair.oldColumn = oldColumn;
+		pair.newColumn = newColumn;
+		m_summary.columns.push_back(pair);
+
+		Mapping mapping;
+		mapping.oldCodes = m_old.GetCodes(oldColumn);
+		mapping.newCodes = m_new.GetCodes(newColumn);
+		mapping.oldDictSize = m_old.GetDictionarySize(oldColumn);
+		mapping.newDictSize = m_new.GetDictionarySize(newColumn);
+		if (oldKind == SnapshotFile::ColumnKind::Value && m_new.GetColumnKind(newColumn) == SnapshotFile::ColumnKind::Value) {
+			mapping.oldNumbers = m_old.GetNumbers(oldColumn);
+			mapping.newNumbers = m_new.GetNumbers(newColumn);
+		}
+
+		// Словарь почти с каждой строкой свой — перевод кодов не окупится
+		const uint64_t rows = std::max(m_old.GetRowCount(), m_new.GetRowCount());
+		mapping.direct = static_cast<uint64_t>(mapping.oldDictSize) * DirectRatio > rows;
+		if (mapping.direct) {
+			m_mappings.push_back(std::move(mapping));
+			continue;
+		}
+
+		newCodes.clear();
+		newCodes.reserve(m_new.GetDictionarySize(newColumn));
+		for (uint32_t code = 0; code < m_new.GetDictionarySize(newColumn); ++code) {
+			newCodes.emplace(m_new.GetDictionaryString(newColumn, code), code);
+		}
+		mapping.oldToNew.resize(m_old.GetDictionarySize(oldColumn), NoCode);
+		for (uint32_t code = 0; code < m_old.GetDictionarySize(oldColumn); ++code) {
+			const auto found = newCodes.find(m_old.GetDictionaryString(oldColumn, code));
+			if (found != newCodes.end()) {
+				mapping.oldToNew[code] = found->second;
+			}
+		}
+		m_mappings.push_back(std::move(mapping));
+	}
+}
+
+bool Engine::IsCellChanged (size_t pair, uint32_t oldRow, uint32_t newRow) const
+{
+	const Mapping& mapping = m_mappings[pair];
+
+	if (mapping.oldNumbers != nullptr) {
+		const double oldValue = mapping.oldNumbers[oldRow];
+		const double newValue = mapping.newNumbers[newRow];
+		const bool oldIsNumber = !std::isnan(oldValue);
+		if (oldIsNumber != !std::isnan(newValue) || (oldIsNumber && oldValue != newValue)) {
+			return true;
+		}
+	}
+
+	uint32_t oldCode = mapping.oldCodes[oldRow];
+	uint32_t newCode = mapping.newCodes[newRow];
+	oldCode = (oldCode < mapping.oldDictSize) ? oldCode : 0;
+	newCode = (newCode < mapping.newDictSize) ? newCode : 0;
+	if (!mapping.direct) {
+		return mapping.oldToNew[oldCode] != newCode;
+	}
+	const ColumnPair& columns = m_summary.columns[pair];
+	return m_old.GetDictionaryString(columns.oldColumn, oldCode) != m_new.GetDictionaryString(columns.newColumn, newCode);
+}
+
+bool Engine::Prepare ()
+{
+	if (!m_old.HasGuidIndex() || !m_new.HasGuidIndex()) {
+		return false;
+	}
+	if (!m_prepared) {
+		BuildMappings();
+		m_prepared = true;
+	}
+	return true;
+}
+
+bool Engine::Run (const Visitor& visitor)
+{
+	if (!Prepare()) {
+		return false;
+	}
+	m_summary.added = 0;
+	m_summary.removed = 0;
+	m_summary.changed = 0;
+	m_summary.unchanged = 0;
+	for (ColumnPair& column : m_summary.columns) {
+		column.changes = 0;
+	}
+
+	const uint32_t oldCount = m_old.GetRowCount();
+	const uint32_t newCount = m_new.GetRowCount();
+	std::vector<uint32_t> changedColumns;
+	changedColumns.reserve(m_summary.columns.size());
+
+	RowDiff diff;
+	uint32_t i = 0;
+	uint32_t j = 0;
+	while (i < oldCount || j < newCount) {
+		const uint32_t oldRow = (i < oldCount) ? m_old.GetIndexedRow(i) : 0;
+		const uint32_t newRow = (j < newCount) ? m_new.GetIndexedRow(j) : 0;
+		// Повреждённый индекс — пропускаем запись
+		if (i < oldCount && oldRow >= oldCount) {
+			++i;
+			continue;
+		}
+		if (j < newCount && newRow >= newCount) {
+			++j;
+			continue;
+		}
+
+		int order = 0;
+		if (i == oldCount) {
+			order = 1;
+		} else if (j == newCount) {
+			order = -1;
+		} else {
+			order = std::memcmp(m_old.GetGuid(oldRow), m_new.GetGuid(newRow), 16);
+		}
+
+		if (order < 0) {
+			++m_summary.removed;
+			++i;
+			if (visitor) {
+				diff = RowDiff();
+				diff.status = RowStatus::Removed;
+				diff.oldRow = oldRow;
+				diff.guid = m_old.GetGuid(oldRow);
+				visitor(diff);
+			}
+			continue;
+		}
+		if (order > 0) {
+			++m_summary.added;
+			++j;
+			if (visitor) {
+				diff = RowDiff();
+				diff.status = RowStatus::Added;
+				diff.newRow = newRow;
+				diff.guid = m_new.GetGuid(newRow);
+				visitor(diff);
+			}
+			continue;
+		}
+
+		++i;
+		++j;
+		changedColumns.clear();
+		for (size_t pair = 0; pair < m_summary.columns.size(); ++pair) {
+			if (IsCellChanged(pair, oldRow, newRow)) {
+				++m_summary.columns[pair].changes;
+				changedColumns.push_back(static_cast<uint32_t>(pair));
+			}
+		}
+		if (changedColumns.empty()) {
+			++m_summary.unchanged;
+			continue;
+		}
+		++m_summary.changed;
+		if (visitor) {
+			diff.status = RowStatus::Changed;
+			diff.oldRow = oldRow;
+			diff.newRow = newRow;
+			diff.guid = m_new.GetGuid(newRow);
+			diff.changedColumns = &changedColumns;
+			visitor(diff);
+		}
+	}
+	return true;
+}
+
+} // namespace SnapshotDiff
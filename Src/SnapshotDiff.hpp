@@ -0,0 +1,87 @@
+#pragma once
+
+#include "SnapshotFile.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Сравнение двух снимков (.tssnap): какие элементы добавлены, удалены и изменены,
+// и сколько изменений в каждой колонке.
+// Снимки соединяются по GUID слиянием их отсортированных индексов — без хеш-таблицы
+// по строкам. Строковые колонки сравниваются по кодам словаря: код старого снимка
+// один раз переводится в код нового, дальше строки не сравниваются. Колонки, где почти
+// все значения разные (ID), сравниваются строками — перевод словаря там дороже.
+// Память — переводы словарей, а не число строк.
+namespace SnapshotDiff {
+
+	enum class RowStatus { Added, Removed, Changed };
+
+	// Колонка, присутствующая в обоих снимках (сопоставляются по token)
+	struct ColumnPair {
+		std::string	token;
+		std::string	name;
+		uint32_t	oldColumn = 0;
+		uint32_t	newColumn = 0;
+		uint64_t	changes = 0;
+	};
+
+	struct Summary {
+		uint64_t				added = 0;
+		uint64_t				removed = 0;
+		uint64_t				changed = 0;
+		uint64_t				unchanged = 0;
+		std::vector<ColumnPair>	columns;
+	};
+
+	struct RowDiff {
+		RowStatus						status = RowStatus::Changed;
+		uint32_t						oldRow = 0;			// Removed, Changed
+		uint32_t						newRow = 0;			// Added, Changed
+		const uint8_t*					guid = nullptr;
+		const std::vector<uint32_t>*	changedColumns = nullptr;	// индексы в Summary::columns (Changed)
+	};
+
+	class Engine
+	{
+	public:
+		typedef std::function<void (const RowDiff&)> Visitor;
+
+		Engine (const SnapshotFile::Reader& oldSnapshot, const SnapshotFile::Reader& newSnapshot);
+
+		// Сопоставить колонки снимков (Summary::columns); false — в одном из снимков нет GUID.
+		// Вызывается из Run; отдельно — когда колонки нужны до обхода (заголовки выгрузки).
+		bool			Prepare ();
+
+		// Visitor вызывается для каждой отличающейся строки в порядке GUID;
+		// может быть пустым, если нужна только сводка
+		bool			Run (const Visitor& visitor);
+
+		const Summary&	GetSummary () const { return m_summary; }
+
+	private:
+		struct Mapping {
+			const uint32_t*				oldCodes = nullptr;
+			const uint32_t*				newCodes = nullptr;
+			const double*				oldNumbers = nullptr;	// обе колонки Value, иначе nullptr
+			const double*				newNumbers = nullptr;
+			uint32_t					oldDictSize = 0;
+			uint32_t					newDictSize = 0;
+			bool						direct = false;			// почти все значения разные — сравнивать строки
+			std::vector<uint32_t>		oldToNew;				// код старого словаря -> код нового
+		};
+
+		void		BuildMappings ();
+		bool		IsCellChanged (size_t pair, uint32_t oldRow, uint32_t newRow) const;
+
+		const SnapshotFile::Reader&	m_old;
+		const SnapshotFile::Reader&	m_new;
+		Summary						m_summary;
+		std::vector<Mapping>		m_mappings;
+		bool						m_prepared = false;
+	};
+
+	const char*	GetStatusName (RowStatus status);
+
+} // namespace SnapshotDiff
@@ -0,0 +1,559 @@
+#include "SnapshotFile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SnapshotFile {
+
+static const char	Magic[8] = { 'T', 'S', 'S', 'N', 'A', 'P', '\r', '\n' };
+
+// ---------------- GUID ----------------
+static int HexValue (char c)
+{
+	if (c >= '0' && c <= '9') return c - '0';
+	if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+bool ParseGuid (std::string_view text, uint8_t guid[16])
+{
+	if (text.size() == 38 && text.front() == '{' && text.back() == '}') {
+		text = text.substr(1, 36);
+	}
+	if (text.size() != 36 || text[8] != '-' || text[13] != '-' || text[18] != '-' || text[23] != '-') {
+		return false;
+	}
+
+	size_t byte = 0;
+	for (size_t i = 0; i < text.size() && byte < 16; ) {
+		if (text[i] == '-') {
+			++i;
+			continue;
+		}
+		const int high = HexValue(text[i]);
+		const int low = HexValue(text[i + 1]);
+		if (high < 0 || low < 0) {
+			return false;
+		}
+		guid[byte++] = static_cast<uint8_t>((high << 4) | low);
+		i += 2;
+	}
+	return byte == 16;
+}
+
+std::string FormatGuid (const uint8_t guid[16])
+{
+	static const char digits[] = "0123456789ABCDEF";
+	std::string text;
+	text.reserve(36);
+	for (size_t i = 0; i < 16; ++i) {
+		if (i == 4 || i == 6 || i == 8 || i == 10) {
+			text.push_back('-');
+		}
+		text.push_back(digits[guid[i] >> 4]);
+		text.push_back(digits[guid[i] & 0x0F]);
+	}
+	return text;
+}
+
+static uint64_t Align8 (uint64_t value)
+{
+	return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+// ---------------- Writer ----------------
+Writer::Writer (const std::vector<ColumnInfo>& columns)
+{
+	m_columns.resize(columns.size());
+	for (size_t i = 0; i < columns.size(); ++i) {
+		m_columns[i].info = columns[i];
+		if (columns[i].kind != ColumnKind::Guid) {
+			Intern(m_columns[i], "", 0);
+		}
+	}
+}
+
+uint32_t Writer::Intern (Column& column, const char* utf8, size_t length)
+{
+	auto inserted = column.index.emplace(std::string(utf8, length), static_cast<uint32_t>(column.dictionary.size()));
+	if (inserted.second) {
+		column.dictionary.push_back(&inserted.first->first);
+		column.dictBytes += length;
+	}
+	return inserted.first->second;
+}
+
+void Writer::SetGuid (size_t column, const uint8_t guid[16])
+{
+	Column& target = m_columns[column];
+	if (target.info.kind != ColumnKind::Guid || target.guids.size() > 16 * static_cast<size_t>(m_rowCount)) {
+		return;
+	}
+	target.guids.insert(target.guids.end(), guid, guid + 16);
+}
+
+void Writer::SetText (size_t column, const char* utf8, size_t length)
+{
+	SetValue(column, utf8, length, false, 0.0);
+}
+
+void Writer::SetValue (size_t column, const char* utf8, size_t length, bool isNumber, double number)
+{
+	Column& target = m_columns[column];
+	if (target.info.kind == ColumnKind::Guid || target.codes.size() > m_rowCount) {
+		return;
+	}
+	target.codes.push_back(Intern(target, utf8, length));
+	if (target.info.kind == ColumnKind::Value) {
+		target.numbers.push_back(isNumber ? number : std::numeric_limits<double>::quiet_NaN());
+	}
+}
+
+void Writer::EndRow ()
+{
+	++m_rowCount;
+	for (Column& column : m_columns) {
+		if (column.info.kind == ColumnKind::Guid) {
+			column.guids.resize(16 * static_cast<size_t>(m_rowCount), 0);
+		} else {
+			column.codes.resize(m_rowCount, 0);
+			if (column.info.kind == ColumnKind::Value) {
+				column.numbers.resize(m_rowCount, std::numeric_limits<double>::quiet_NaN());
+			}
+		}
+	}
+}
+
+// Запись с учётом позиции и выравнивания секций
+class SectionWriter
+{
+public:
+	explicit SectionWriter (std::FILE* file) : m_file(file) {}
+
+	void		Write (const void* data, size_t size)
+	{
+		if (size > 0 && std::fwrite(data, 1, size, m_file) != size) {
+			m_error = true;
+		}
+		m_position += size;
+	}
+	void		Pad ()
+	{
+		static const uint8_t zeros[8] = {};
+		Write(zeros, static_cast<size_t>(Align8(m_position) - m_position));
+	}
+	uint64_t	GetPosition () const { return m_position; }
+	bool		HasError () const { return m_error; }
+
+private:
+	std::FILE*	m_file;
+	uint64_t	m_position = 0;
+	bool		m_error = false;
+};
+
+bool Writer::Write (std::FILE* file, uint64_t createdTime) const
+{
+	const uint32_t columnCount = static_cast<uint32_t>(m_columns.size());
+
+	FileHeader header = {};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = FormatVersion;
+	header.columnCount = columnCount;
+	header.rowCount = m_rowCount;
+	header.guidColumn = NoColumn;
+	header.createdTime = createdTime;
+
+	// Блок строк заголовков колонок
+	std::string strings;
+	std::vector<ColumnEntry> entries(columnCount);
+	for (uint32_t c = 0; c < columnCount; ++c) {
+		const ColumnInfo& info = m_columns[c].info;
+		ColumnEntry& entry = entries[c];
+		entry.kind = static_cast<uint32_t>(info.kind);
+		entry.tokenOffset = static_cast<uint32_t>(strings.size());
+		entry.tokenLength = static_cast<uint32_t>(info.token.size());
+		strings += info.token;
+		entry.nameOffset = static_cast<uint32_t>(strings.size());
+		entry.nameLength = static_cast<uint32_t>(info.name.size());
+		strings += info.name;
+		if (info.kind == ColumnKind::Guid && header.guidColumn == NoColumn) {
+			header.guidColumn = c;
+		}
+	}
+
+	// Раскладка секций
+	uint64_t position = sizeof(FileHeader);
+	header.columnsOffset = position;
+	position += sizeof(ColumnEntry) * static_cast<uint64_t>(columnCount);
+	header.stringsOffset = position;
+	header.stringsSize = strings.size();
+	position = Align8(position + strings.size());
+
+	for (uint32_t c = 0; c < columnCount; ++c) {
+		const Column& column = m_columns[c];
+		ColumnEntry& entry = entries[c];
+		entry.dataOffset = position;
+		if (column.info.kind == ColumnKind::Guid) {
+			position = Align8(position + column.guids.size());
+			continue;
+		}
+		position = Align8(position + column.codes.size() * sizeof(uint32_t));
+		entry.dictCount = static_cast<uint32_t>(column.dictionary.size());
+		entry.dictOffsetsOffset = position;
+		position = Align8(position + (column.dictionary.size() + 1) * sizeof(uint32_t));
+		entry.dictBytesOffset = position;
+		entry.dictBytesSize = column.dictBytes;
+		position = Align8(position + column.dictBytes);
+		if (column.info.kind == ColumnKind::Value) {
+			entry.numbersOffset = position;
+			position += column.numbers.size() * sizeof(double);
+		}
+	}
+
+	// Индекс по GUID: номера строк в порядке возрастания GUID
+	std::vector<uint32_t> guidIndex;
+	if (header.guidColumn != NoColumn) {
+		const std::vector<uint8_t>& guids = m_columns[header.guidColumn].guids;
+		guidIndex.resize(m_rowCount);
+		for (uint32_t row = 0; row < m_rowCount; ++row) {
+			guidIndex[row] = row;
+		}
+		std::sort(guidIndex.begin(), guidIndex.end(), [&guids] (uint32_t a, uint32_t b) {
+			return std::memcmp(&guids[16 * static_cast<size_t>(a)], &guids[16 * static_cast<size_t>(b)], 16) < 0;
+		});
+		header.guidIndexOffset = position;
+		position += guidIndex.size() * sizeof(uint32_t);
+	}
+	header.fileSize = position;
+
+	if (header.stringsSize > std::numeric_limits<uint32_t>::max()) {
+		return false;
+	}
+	for (const Column& column : m_columns) {
+		if (column.dictBytes > std::numeric_limits<uint32_t>::max()) {
+			return false;			// смещения словаря 32-битные
+		}
+	}
+
+	// Запись
+	SectionWriter out(file);
+	out.Write(&header, sizeof(header));
+	out.Write(entries.data(), entries.size() * sizeof(ColumnEntry));
+	out.Write(strings.data(), strings.size());
+	out.Pad();
+
+	std::vector<uint32_t> offsets;
+	for (const Column& column : m_columns) {
+		if (column.info.kind == ColumnKind::Guid) {
+			out.Write(column.guids.data(), column.guids.size());
+			out.Pad();
+			continue;
+		}
+		out.Write(column.codes.data(), column.codes.size() * sizeof(uint32_t));
+		out.Pad();
+
+		offsets.clear();
+		offsets.reserve(column.dictionary.size() + 1);
+		uint32_t offset = 0;
+		offsets.push_back(offset);
+		for (const std::string* value : column.dictionary) {
+			offset += static_cast<uint32_t>(value->size());
+			offsets.push_back(offset);
+		}
+		out.Write(offsets.data(), offsets.size() * sizeof(uint32_t));
+		out.Pad();
+		for (const std::string* value : column.dictionary) {
+			out.Write(value->data(), value->size());
+		}
+		out.Pad();
+		if (column.info.kind == ColumnKind::Value) {
+			out.Write(column.numbers.data(), column.numbers.size() * sizeof(double));
+		}
+	}
+	out.Write(guidIndex.data(), guidIndex.size() * sizeof(uint32_t));
+
+	return !out.HasError() && out.GetPosition() == header.fileSize;
+}
+
+// ---------------- Reader ----------------
+Reader::~Reader ()
+{
+	Close();
+}
+
+bool Reader::Open (const char* utf8Path)
+{
+	Close();
+
+#ifdef _WIN32
+	const int wideLength = MultiByteToWideChar(CP_UTF8, 0, utf8Path, -1, nullptr, 0);
+	if (wideLength <= 0) {
+		return false;
+	}
+	std::wstring widePath(static_cast<size_t>(wideLength), L'\0');
+	MultiByteToWideChar(CP_UTF8, 0, utf8Path, -1, &widePath[0], wideLength);
+
+	HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	m_fileHandle = file;
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader))) {
+		Close();
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		Close();
+		return false;
+	}
+	m_mappingHandle = mapping;
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr) {
+		Close();
+		return false;
+	}
+	m_data = static_cast<const uint8_t*>(view);
+	m_size = static_cast<size_t>(size.QuadPart);
+#else
+	const int fd = ::open(utf8Path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	m_fd = fd;
+
+	struct stat info = {};
+	if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+		Close();
+		return false;
+	}
+	void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	if (view == MAP_FAILED) {
+		Close();
+		return false;
+	}
+	m_data = static_cast<const uint8_t*>(view);
+	m_size = static_cast<size_t>(info.st_size);
+#endif
+
+	if (!Validate()) {
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void Reader::Close ()
+{
+#ifdef _WIN32
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+	}
+	if (m_fileHandle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(m_fileHandle));
+	}
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+#else
+	if (m_data != nullptr) {
+		::munmap(const_cast<uint8_t*>(m_data), m_size);
+	}
+	if (m_fd >= 0) {
+		::close(m_fd);
+	}
+	m_fd = -1;
+#endif
+	m_data = nullptr;
+	m_size = 0;
+	m_header = nullptr;
+	m_columns = nullptr;
+	m_guidIndex = nullptr;
+}
+
+bool Reader::IsInside (uint64_t offset, uint64_t size) const
+{
+	return offset <= m_size && size <= m_size - offset;
+}
+
+// Проверка заголовка и границ секций: O(число колонок), строки не трогаются
+bool Reader::Validate ()
+{
+	m_header = reinterpret_cast<const FileHeader*>(m_data);
+	if (std::memcmp(m_header->magic, Magic, sizeof(Magic)) != 0 || m_header->version != FormatVersion ||
+		m_header->fileSize != m_size) {
+		return false;
+	}
+
+	const uint64_t rows = m_header->rowCount;
+	if (m_header->columnsOffset % 8 != 0 ||
+		!IsInside(m_header->columnsOffset, sizeof(ColumnEntry) * static_cast<uint64_t>(m_header->columnCount)) ||
+		!IsInside(m_header->stringsOffset, m_header->stringsSize)) {
+		return false;
+	}
+	m_columns = reinterpret_cast<const ColumnEntry*>(m_data + m_header->columnsOffset);
+
+	for (uint32_t c = 0; c < m_header->columnCount; ++c) {
+		const ColumnEntry& entry = m_columns[c];
+		if (static_cast<uint64_t>(entry.tokenOffset) + entry.tokenLength > m_header->stringsSize ||
+			static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > m_header->stringsSize ||
+			entry.dataOffset % 8 != 0) {
+			return false;
+		}
+
+		const ColumnKind kind = static_cast<ColumnKind>(entry.kind);
+		if (kind == ColumnKind::Guid) {
+			if (!IsInside(entry.dataOffset, 16 * rows)) {
+				return false;
+			}
+			continue;
+		}
+		if (kind != ColumnKind::Text && kind != ColumnKind::Value) {
+			return false;
+		}
+		if (entry.dictCount == 0 || entry.dictOffsetsOffset % 8 != 0 ||
+			!IsInside(entry.dataOffset, sizeof(uint32_t) * rows) ||
+			!IsInside(entry.dictOffsetsOffset, sizeof(uint32_t) * (static_cast<uint64_t>(entry.dictCount) + 1)) ||
+			!IsInside(entry.dictBytesOffset, entry.dictBytesSize)) {
+			return false;
+		}
+		if (kind == ColumnKind::Value && (entry.numbersOffset % 8 != 0 || !IsInside(entry.numbersOffset, sizeof(double) * rows))) {
+			return false;
+		}
+	}
+
+	if (m_header->guidColumn != NoColumn) {
+		if (m_header->guidColumn >= m_header->columnCount ||
+			static_cast<ColumnKind>(m_columns[m_header->guidColumn].kind) != ColumnKind::Guid ||
+			m_header->guidIndexOffset % 4 != 0 || !IsInside(m_header->guidIndexOffset, sizeof(uint32_t) * rows)) {
+			return false;
+		}
+		m_guidIndex = reinterpret_cast<const uint32_t*>(m_data + m_header->guidIndexOffset);
+	}
+	return true;
+}
+
+std::string_view Reader::GetColumnToken (uint32_t column) const
+{
+	const ColumnEntry& entry = m_columns[column];
+	return std::string_view(reinterpret_cast<const char*>(m_data + m_header->stringsOffset + entry.tokenOffset), entry.tokenLength);
+}
+
+std::string_view Reader::GetColumnName (uint32_t column) const
+{
+	const ColumnEntry& entry = m_columns[column];
+	return std::string_view(reinterpret_cast<const char*>(m_data + m_header->stringsOffset + entry.nameOffset), entry.nameLength);
+}
+
+uint32_t Reader::FindColumn (std::string_view token) const
+{
+	for (uint32_t c = 0; c < GetColumnCount(); ++c) {
+		if (GetColumnToken(c) == token) {
+			return c;
+		}
+	}
+	return NoColumn;
+}
+
+const uint8_t* Reader::GetGuid (uint32_t row) const
+{
+	if (m_header == nullptr || m_header->guidColumn == NoColumn) {
+		return nullptr;
+	}
+	return m_data + m_columns[m_header->guidColumn].dataOffset + 16 * static_cast<size_t>(row);
+}
+
+uint32_t Reader::GetCode (uint32_t column, uint32_t row) const
+{
+	const ColumnEntry& entry = m_columns[column];
+	if (static_cast<ColumnKind>(entry.kind) == ColumnKind::Guid) {
+		return 0;
+	}
+	const uint32_t code = reinterpret_cast<const uint32_t*>(m_data + entry.dataOffset)[row];
+	return code < entry.dictCount ? code : 0;
+}
+
+std::string_view Reader::GetDictionaryString (uint32_t column, uint32_t code) const
+{
+	const ColumnEntry& entry = m_columns[column];
+	if (static_cast<ColumnKind>(entry.kind) == ColumnKind::Guid || code >= entry.dictCount) {
+		return std::string_view();
+	}
+	const uint32_t* offsets = reinterpret_cast<const uint32_t*>(m_data + entry.dictOffsetsOffset);
+	const uint32_t begin = offsets[code];
+	const uint32_t end = offsets[code + 1];
+	if (begin > end || end > entry.dictBytesSize) {
+		return std::string_view();
+	}
+	return std::string_view(reinterpret_cast<const char*>(m_data + entry.dictBytesOffset + begin), end - begin);
+}
+
+std::string_view Reader::GetText (uint32_t column, uint32_t row) const
+{
+	return GetDictionaryString(column, GetCode(column, row));
+}
+
+bool Reader::GetNumber (uint32_t column, uint32_t row, double& value) const
+{
+	const ColumnEntry& entry = m_columns[column];
+	if (static_cast<ColumnKind>(entry.kind) != ColumnKind::Value) {
+		return false;
+	}
+	value = reinterpret_cast<const double*>(m_data + entry.numbersOffset)[row];
+	return !std::isnan(value);
+}
+
+const uint32_t* Reader::GetCodes (uint32_t column) const
+{
+	const ColumnEntry& entry = m_columns[column];
+	if (static_cast<ColumnKind>(entry.kind) == ColumnKind::Guid) {
+		return nullptr;
+	}
+	return reinterpret_cast<const uint32_t*>(m_data + entry.dataOffset);
+}
+
+const double* Reader::GetNumbers (uint32_t column) const
+{
+	const ColumnEntry& entry = m_columns[column];
+	if (static_cast<ColumnKind>(entry.kind) != ColumnKind::Value) {
+		return nullptr;
+	}
+	return reinterpret_cast<const double*>(m_data + entry.numbersOffset);
+}
+
+bool Reader::FindRow (const uint8_t guid[16], uint32_t& row) const
+{
+	if (m_guidIndex == nullptr) {
+		return false;
+	}
+	const uint32_t* begin = m_guidIndex;
+	const uint32_t* end = m_guidIndex + GetRowCount();
+	const uint32_t rows = GetRowCount();
+	const uint32_t* found = std::lower_bound(begin, end, guid, [this, rows] (uint32_t candidate, const uint8_t* key) {
+		return candidate < rows && std::memcmp(GetGuid(candidate), key, 16) < 0;
+	});
+	if (found == end || *found >= rows || std::memcmp(GetGuid(*found), guid, 16) != 0) {
+		return false;
+	}
+	row = *found;
+	return true;
+}
+
+} // namespace SnapshotFile
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Снимок таблицы выделения в колоночном бинарном файле (.tssnap).
+// Файл открывается через mmap и читается без разбора: заголовок и каталог колонок
+// дают смещения секций, строки хранятся словарями, по GUID есть отсортированный индекс.
+// Только стандартная библиотека и API ОС — читатель собирается отдельно (Tools/SnapshotDump).
+//
+// Формат (little-endian, секции выровнены на 8 байт, смещения — от начала файла):
+//   FileHeader                               72 байта
+//   ColumnEntry[columnCount]                 64 байта на колонку
+//   строки token/name всех колонок           stringsOffset, stringsSize
+//   по колонкам:
+//     Guid:  uint8[16 * rowCount]            GUID в порядке RFC 4122 (как в тексте)
+//     Text:  uint32 codes[rowCount]          код 0 — пустая строка
+//            uint32 offsets[dictCount + 1]   границы строк словаря в dictBytes
+//            char   dictBytes[]              UTF-8 без завершающих нулей
+//     Value: то же, что Text, плюс double[rowCount] (NaN — значение не числовое)
+//   uint32 guidIndex[rowCount]               номера строк, отсортированные по GUID
+namespace SnapshotFile {
+
+	enum class ColumnKind : uint32_t { Guid = 1, Text = 2, Value = 3 };
+
+	static const uint32_t	FormatVersion = 1;
+	static const uint32_t	NoColumn = 0xFFFFFFFFu;
+
+	struct FileHeader {
+		char		magic[8];			// "TSSNAP\r\n"
+		uint32_t	version;
+		uint32_t	columnCount;
+		uint32_t	rowCount;
+		uint32_t	guidColumn;			// NoColumn — GUID в снимке нет
+		uint64_t	columnsOffset;
+		uint64_t	stringsOffset;
+		uint64_t	stringsSize;
+		uint64_t	guidIndexOffset;	// 0 — индекса нет
+		uint64_t	fileSize;
+		uint64_t	createdTime;		// секунды Unix
+	};
+
+	struct ColumnEntry {
+		uint32_t	kind;
+		uint32_t	dictCount;
+		uint32_t	tokenOffset;		// в блоке строк
+		uint32_t	tokenLength;
+		uint32_t	nameOffset;
+		uint32_t	nameLength;
+		uint64_t	dataOffset;			// Guid — GUID, Text/Value — коды
+		uint64_t	dictOffsetsOffset;
+		uint64_t	dictBytesOffset;
+		uint64_t	dictBytesSize;
+		uint64_t	numbersOffset;		// только Value
+	};
+
+	static_assert(sizeof(FileHeader) == 72, "FileHeader layout");
+	static_assert(sizeof(ColumnEntry) == 64, "ColumnEntry layout");
+
+	// "XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX" <-> 16 байт; фигурные скобки допускаются
+	bool		ParseGuid (std::string_view text, uint8_t guid[16]);
+	std::string	FormatGuid (const uint8_t guid[16]);
+
+	struct ColumnInfo {
+		std::string	token;				// "guid", "type", "id", "layer" или GUID свойства
+		std::string	name;				// заголовок
+		ColumnKind	kind = ColumnKind::Text;
+	};
+
+	// Сборка снимка в памяти построчно и запись одним проходом.
+	// Повторяющиеся значения колонки хранятся один раз.
+	class Writer
+	{
+	public:
+		explicit Writer (const std::vector<ColumnInfo>& columns);
+
+		void		SetGuid (size_t column, const uint8_t guid[16]);
+		void		SetText (size_t column, const char* utf8, size_t length);
+		void		SetValue (size_t column, const char* utf8, size_t length, bool isNumber, double number);
+		// Закрыть строку; колонки, не заданные в ней, остаются пустыми
+		void		EndRow ();
+
+		uint32_t	GetRowCount () const { return m_rowCount; }
+		bool		Write (std::FILE* file, uint64_t createdTime) const;
+
+	private:
+		struct Column {
+			ColumnInfo									info;
+			std::vector<uint8_t>						guids;
+			std::vector<uint32_t>						codes;
+			std::vector<double>							numbers;
+			std::unordered_map<std::string, uint32_t>	index;
+			std::vector<const std::string*>				dictionary;	// ключи живут в index
+			uint64_t									dictBytes = 0;
+		};
+
+		uint32_t	Intern (Column& column, const char* utf8, size_t length);
+
+		std::vector<Column>	m_columns;
+		uint32_t			m_rowCount = 0;
+	};
+
+	// Снимок, отображённый в память. Открытие проверяет только заголовок и границы секций,
+	// поэтому не зависит от числа строк.
+	class Reader
+	{
+	public:
+		Reader () = default;
+		~Reader ();
+
+		Reader (const Reader&) = delete;
+		Reader& operator= (const Reader&) = delete;
+
+		bool				Open (const char* utf8Path);
+		void				Close ();
+		bool				IsOpen () const { return m_data != nullptr; }
+
+		uint32_t			GetRowCount () const { return m_header != nullptr ? m_header->rowCount : 0; }
+		uint32_t			GetColumnCount () const { return m_header != nullptr ? m_header->columnCount : 0; }
+		uint64_t			GetCreatedTime () const { return m_header != nullptr ? m_header->createdTime : 0; }
+		uint32_t			GetGuidColumn () const { return m_header != nullptr ? m_header->guidColumn : NoColumn; }
+
+		ColumnKind			GetColumnKind (uint32_t column) const { return static_cast<ColumnKind>(m_columns[column].kind); }
+		std::string_view	GetColumnToken (uint32_t column) const;
+		std::string_view	GetColumnName (uint32_t column) const;
+		uint32_t			FindColumn (std::string_view token) const;		// NoColumn — нет
+
+		const uint8_t*		GetGuid (uint32_t row) const;					// nullptr — GUID в снимке нет
+		uint32_t			GetCode (uint32_t column, uint32_t row) const;
+		uint32_t			GetDictionarySize (uint32_t column) const { return m_columns[column].dictCount; }
+		std::string_view	GetDictionaryString (uint32_t column, uint32_t code) const;
+		std::string_view	GetText (uint32_t column, uint32_t row) const;
+		bool				GetNumber (uint32_t column, uint32_t row, double& value) const;
+		// Сырые массивы колонки для плотных циклов; коды не проверяются на границы словаря
+		const uint32_t*		GetCodes (uint32_t column) const;						// nullptr — колонка Guid
+		const double*		GetNumbers (uint32_t column) const;						// nullptr — не Value
+
+		// Строка по GUID — двоичный поиск по индексу
+		bool				FindRow (const uint8_t guid[16], uint32_t& row) const;
+		bool				HasGuidIndex () const { return m_guidIndex != nullptr; }
+		// Номер строки, стоящей на месте position в порядке возрастания GUID
+		uint32_t			GetIndexedRow (uint32_t position) const { return m_guidIndex[position]; }
+
+	private:
+		bool				Validate ();
+		bool				IsInside (uint64_t offset, uint64_t size) const;
+
+		const uint8_t*		m_data = nullptr;
+		size_t				m_size = 0;
+		const FileHeader*	m_header = nullptr;
+		const ColumnEntry*	m_columns = nullptr;
+		const uint32_t*		m_guidIndex = nullptr;
+#ifdef _WIN32
+		void*				m_fileHandle = nullptr;
+		void*				m_mappingHandle = nullptr;
+#else
+		int					m_fd = -1;
+#endif
+	};
+
+} // namespace SnapshotFile
@@ -0,0 +1,385 @@
+#include "SpatialOrder.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SpatialOrder {
+
+static const uint32_t HilbertBits = 16;		// сетка 65536 × 65536 — на участке в километр клетка 1,5 см
+
+struct Bounds {
+	double	minX = 0.0;
+	double	minY = 0.0;
+	double	maxX = 0.0;
+	double	maxY = 0.0;
+};
+
+// Значение с долей fraction от начала по возрастанию; values переставляется
+static double GetQuantile (std::vector<double>& values, double fraction)
+{
+	const size_t position = static_cast<size_t>(fraction * static_cast<double>(values.size() - 1));
+	std::nth_element(values.begin(), values.begin() + position, values.end());
+	return values[position];
+}
+
+// Границы по оси без далёких выбросов: [Q1 − 3·IQR, Q3 + 3·IQR], но не уже 1–99 % точек
+// (иначе при IQR = 0 — больше половины точек на одной прямой — отрезались бы соседние ряды)
+static void GetFences (std::vector<double>& values, double& low, double& high)
+{
+	const double p01 = GetQuantile(values, 0.01);
+	const double q1 = GetQuantile(values, 0.25);
+	const double q3 = GetQuantile(values, 0.75);
+	const double p99 = GetQuantile(values, 0.99);
+	const double spread = 3.0 * (q3 - q1);
+	const double lowFence = std::min(q1 - spread, p01);
+	const double highFence = std::max(q3 + spread, p99);
+	// По крайним точкам внутри границ — иначе граница с запасом растянула бы шаг
+	low = q1;
+	high = q3;
+	for (const double value : values) {
+		if (value >= lowFence && value <= highFence) {
+			low = std::min(low, value);
+			high = std::max(high, value);
+		}
+	}
+}
+
+// Габарит основной массы точек. Одна точка за километр от участка не должна растягивать
+// сетку и шаг: точки за границами прижимаются к краю
+static Bounds GetRobustBounds (const std::vector<Point>& points)
+{
+	Bounds bounds;
+	if (points.empty()) {
+		return bounds;
+	}
+	std::vector<double> values(points.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		values[i] = points[i].x;
+	}
+	GetFences(values, bounds.minX, bounds.maxX);
+	for (size_t i = 0; i < points.size(); ++i) {
+		values[i] = points[i].y;
+	}
+	GetFences(values, bounds.minY, bounds.maxY);
+	return bounds;
+}
+
+// Сторона квадрата, приходящегося на одну точку внутри габарита; для точек на одной прямой — шаг вдоль неё
+static double GetSpacing (const std::vector<Point>& points, const Bounds& bounds)
+{
+	size_t count = 0;
+	for (const Point& point : points) {
+		if (point.x >= bounds.minX && point.x <= bounds.maxX && point.y >= bounds.minY && point.y <= bounds.maxY) {
+			++count;
+		}
+	}
+	const double width = bounds.maxX - bounds.minX;
+	const double height = bounds.maxY - bounds.minY;
+	if (count < 2) {
+		return 0.0;
+	}
+	if (width > 0.0 && height > 0.0) {
+		return std::sqrt(width * height / static_cast<double>(count));
+	}
+	return std::max(width, height) / static_cast<double>(count - 1);
+}
+
+// Смещение от min в шагах step, прижатое к [0, last] — до приведения к целому, чтобы не было переполнения
+static double ClampSteps (double value, double min, double step, double last)
+{
+	return std::min(std::max((value - min) / step, 0.0), last);
+}
+
+// ---------------- Кривая Гильберта ----------------
+uint64_t HilbertIndex (uint32_t x, uint32_t y, uint32_t bits)
+{
+	const uint32_t mask = (bits >= 32) ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+	uint64_t index = 0;
+	for (uint32_t s = (bits > 0) ? (1u << (bits - 1)) : 0u; s > 0; s >>= 1) {
+		const uint32_t rx = (x & s) ? 1u : 0u;
+		const uint32_t ry = (y & s) ? 1u : 0u;
+		index += static_cast<uint64_t>(s) * s * ((3u * rx) ^ ry);
+		// Поворот четверти, чтобы младшие разряды шли по той же кривой
+		if (ry == 0) {
+			if (rx == 1) {
+				x = mask - x;
+				y = mask - y;
+			}
+			std::swap(x, y);
+		}
+	}
+	return index;
+}
+
+static std::vector<uint32_t> OrderHilbert (const std::vector<Point>& points)
+{
+	const Bounds bounds = GetRobustBounds(points);
+	const double extent = std::max(bounds.maxX - bounds.minX, bounds.maxY - bounds.minY);
+	// Одинаковый масштаб по осям — иначе вытянутый участок обходился бы с перекосом
+	const double last = static_cast<double>((1u << HilbertBits) - 1u);
+	const double step = (extent > 0.0) ? extent / last : 1.0;
+
+	// Ключ и номер в одном числе: сортировка без сравнения структур, равные ключи — по номеру
+	std::vector<uint64_t> keys(points.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		const uint32_t x = static_cast<uint32_t>(ClampSteps(points[i].x, bounds.minX, step, last));
+		const uint32_t y = static_cast<uint32_t>(ClampSteps(points[i].y, bounds.minY, step, last));
+		keys[i] = (HilbertIndex(x, y, HilbertBits) << 32) | static_cast<uint64_t>(i);
+	}
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<uint32_t> order(points.size());
+	for (size_t i = 0; i < keys.size(); ++i) {
+		order[i] = static_cast<uint32_t>(keys[i] & 0xFFFFFFFFu);
+	}
+	return order;
+}
+
+// ---------------- Полосы змейкой ----------------
+static std::vector<uint32_t> OrderRows (const std::vector<Point>& points, double rowHeight)
+{
+	std::vector<uint32_t> order(points.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		order[i] = static_cast<uint32_t>(i);
+	}
+	if (rowHeight <= 0.0) {
+		rowHeight = GetSpacing(points, GetRobustBounds(points));
+	}
+
+	// Сверху вниз; полоса начинается с верхней ещё не попавшей в полосу точки —
+	// так ряд посадок с небольшим разбросом по Y не режется границей сетки
+	std::stable_sort(order.begin(), order.end(), [&points](uint32_t a, uint32_t b) {
+		return points[a].y > points[b].y;
+	});
+	size_t bandStart = 0;
+	bool leftToRight = true;
+	while (bandStart < order.size()) {
+		const double bandTop = points[order[bandStart]].y;
+		size_t bandEnd = bandStart + 1;
+		while (bandEnd < order.size() && bandTop - points[order[bandEnd]].y <= rowHeight) {
+			++bandEnd;
+		}
+		std::stable_sort(order.begin() + bandStart, order.begin() + bandEnd, [&points, leftToRight](uint32_t a, uint32_t b) {
+			return leftToRight ? points[a].x < points[b].x : points[a].x > points[b].x;
+		});
+		leftToRight = !leftToRight;
+		bandStart = bandEnd;
+	}
+	return order;
+}
+
+// ---------------- Маршрут к ближайшей точке ----------------
+// Точки разложены по клеткам сетки; непройденные точки клетки — в начале её диапазона,
+// пройденная меняется местами с последней непройденной. Сетка покрывает габарит основной
+// массы точек, выбросы прижаты к крайним клеткам: прижатие только сокращает расстояния
+// в клетках, поэтому оценка «следующее кольцо не ближе» остаётся верной
+class NearestGrid
+{
+public:
+	NearestGrid (const std::vector<Point>& points, const Bounds& bounds) :
+		m_points(points),
+		m_bounds(bounds)
+	{
+		const size_t count = points.size();
+		const double width = bounds.maxX - bounds.minX;
+		const double height = bounds.maxY - bounds.minY;
+		m_cellSize = GetSpacing(points, bounds);
+		if (m_cellSize <= 0.0) {
+			m_cellSize = 1.0;
+		}
+		// Не больше клеток, чем точек, — иначе поиск ходил бы по пустым клеткам
+		while ((width / m_cellSize + 1.0) * (height / m_cellSize + 1.0) > 2.0 * static_cast<double>(count) + 1.0) {
+			m_cellSize *= 1.5;
+		}
+		m_columns = static_cast<int32_t>(width / m_cellSize) + 1;
+		m_rows = static_cast<int32_t>(height / m_cellSize) + 1;
+
+		std::vector<uint32_t> cellOf(count);
+		m_cellStart.assign(static_cast<size_t>(m_columns) * m_rows + 1, 0);
+		for (size_t i = 0; i < count; ++i) {
+			cellOf[i] = GetCell(GetColumn(points[i].x), GetRow(points[i].y));
+			++m_cellStart[cellOf[i] + 1];
+		}
+		for (size_t cell = 1; cell < m_cellStart.size(); ++cell) {
+			m_cellStart[cell] += m_cellStart[cell - 1];
+		}
+		m_cellLive.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+		m_items.resize(count);
+		m_position.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t position = m_cellLive[cellOf[i]]++;
+			m_items[position] = static_cast<uint32_t>(i);
+			m_position[i] = position;
+		}
+		// m_cellLive — конец непройденных точек клетки
+	}
+
+	void Remove (uint32_t point)
+	{
+		const uint32_t cell = GetCell(GetColumn(m_points[point].x), GetRow(m_points[point].y));
+		const uint32_t last = --m_cellLive[cell];
+		const uint32_t position = m_position[point];
+		const uint32_t moved = m_items[last];
+		m_items[position] = moved;
+		m_position[moved] = position;
+		m_items[last] = point;
+		m_position[point] = last;
+	}
+
+	// Ближайшая непройденная точка; кольца клеток вокруг текущей, пока следующее кольцо
+	// заведомо не дальше найденной точки
+	uint32_t FindNearest (const Point& from) const
+	{
+		const int32_t column = GetColumn(from.x);
+		const int32_t row = GetRow(from.y);
+		const int32_t maxRadius = std::max(m_columns, m_rows);
+		uint32_t best = UINT32_MAX;
+		double bestDistance = 0.0;
+		for (int32_t radius = 0; radius <= maxRadius; ++radius) {
+			if (best != UINT32_MAX) {
+				const double gap = (radius - 1) * m_cellSize;
+				if (radius > 0 && bestDistance <= gap * gap) {
+					break;
+				}
+			}
+			const int32_t rowFirst = std::max(row - radius, 0);
+			const int32_t rowLast = std::min(row + radius, m_rows - 1);
+			for (int32_t r = rowFirst; r <= rowLast; ++r) {
+				if (r == row - radius || r == row + radius) {
+					const int32_t columnFirst = std::max(column - radius, 0);
+					const int32_t columnLast = std::min(column + radius, m_columns - 1);
+					for (int32_t c = columnFirst; c <= columnLast; ++c) {
+						ScanCell(GetCell(c, r), from, best, bestDistance);
+					}
+				} else {
+					if (column - radius >= 0) {
+						ScanCell(GetCell(column - radius, r), from, best, bestDistance);
+					}
+					if (radius > 0 && column + radius < m_columns) {
+						ScanCell(GetCell(column + radius, r), from, best, bestDistance);
+					}
+				}
+			}
+		}
+		return best;
+	}
+
+private:
+	int32_t GetColumn (double x) const
+	{
+		return static_cast<int32_t>(ClampSteps(x, m_bounds.minX, m_cellSize, m_columns - 1));
+	}
+
+	int32_t GetRow (double y) const
+	{
+		return static_cast<int32_t>(ClampSteps(y, m_bounds.minY, m_cellSize, m_rows - 1));
+	}
+
+	uint32_t GetCell (int32_t column, int32_t row) const
+	{
+		return static_cast<uint32_t>(row) * static_cast<uint32_t>(m_columns) + static_cast<uint32_t>(column);
+	}
+
+	void ScanCell (uint32_t cell, const Point& from, uint32_t& best, double& bestDistance) const
+	{
+		for (uint32_t position = m_cellStart[cell]; position < m_cellLive[cell]; ++position) {
+			const uint32_t point = m_items[position];
+			const double dx = m_points[point].x - from.x;
+			const double dy = m_points[point].y - from.y;
+			const double distance = dx * dx + dy * dy;
+			if (best == UINT32_MAX || distance < bestDistance || (distance == bestDistance && point < best)) {
+				best = point;
+				bestDistance = distance;
+			}
+		}
+	}
+
+	const std::vector<Point>&	m_points;
+	Bounds						m_bounds;
+	double						m_cellSize = 1.0;
+	int32_t						m_columns = 1;
+	int32_t						m_rows = 1;
+	std::vector<uint32_t>		m_cellStart;	// начало клетки в m_items; последний — конец
+	std::vector<uint32_t>		m_cellLive;		// конец непройденных точек клетки
+	std::vector<uint32_t>		m_items;
+	std::vector<uint32_t>		m_position;		// место точки в m_items
+};
+
+static std::vector<uint32_t> OrderNearestPath (const std::vector<Point>& points)
+{
+	std::vector<uint32_t> order;
+	if (points.empty()) {
+		return order;
+	}
+	const Bounds bounds = GetRobustBounds(points);
+
+	// Начало — точка у левого верхнего угла
+	uint32_t current = 0;
+	double currentDistance = -1.0;
+	for (size_t i = 0; i < points.size(); ++i) {
+		const double dx = points[i].x - bounds.minX;
+		const double dy = bounds.maxY - points[i].y;
+		const double distance = dx * dx + dy * dy;
+		if (currentDistance < 0.0 || distance < currentDistance) {
+			current = static_cast<uint32_t>(i);
+			currentDistance = distance;
+		}
+	}
+
+	NearestGrid grid(points, bounds);
+	order.reserve(points.size());
+	order.push_back(current);
+	grid.Remove(current);
+	while (order.size() < points.size()) {
+		current = grid.FindNearest(points[current]);
+		order.push_back(current);
+		grid.Remove(current);
+	}
+	return order;
+}
+
+// ---------------- Выбор способа ----------------
+static std::vector<uint32_t> OrderFinite (const std::vector<Point>& points, Method method, double rowHeight)
+{
+	switch (method) {
+		case Method::Hilbert:		return OrderHilbert(points);
+		case Method::Rows:			return OrderRows(points, rowHeight);
+		case Method::NearestPath:	return OrderNearestPath(points);
+	}
+	return OrderHilbert(points);
+}
+
+std::vector<uint32_t> Order (const std::vector<Point>& points, Method method, double rowHeight)
+{
+	std::vector<uint32_t> finite;
+	finite.reserve(points.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		if (std::isfinite(points[i].x) && std::isfinite(points[i].y)) {
+			finite.push_back(static_cast<uint32_t>(i));
+		}
+	}
+	if (finite.size() == points.size()) {
+		return OrderFinite(points, method, rowHeight);
+	}
+
+	// Точки без координат (NaN, бесконечность) — в конце по номеру
+	std::vector<Point> placed(finite.size());
+	for (size_t i = 0; i < finite.size(); ++i) {
+		placed[i] = points[finite[i]];
+	}
+	std::vector<uint32_t> order = OrderFinite(placed, method, rowHeight);
+	for (uint32_t& index : order) {
+		index = finite[index];
+	}
+	size_t next = 0;
+	for (size_t i = 0; i < points.size(); ++i) {
+		if (next < finite.size() && finite[next] == i) {
+			++next;
+		} else {
+			order.push_back(static_cast<uint32_t>(i));
+		}
+	}
+	return order;
+}
+
+} // namespace SpatialOrder
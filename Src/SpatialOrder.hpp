@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Порядок обхода точек на плане — для нумерации деревьев, светильников, колонн
+// по понятному маршруту, а не в порядке выделения.
+//   Hilbert     — по кривой Гильберта: соседние номера рядом на плане, без длинных скачков;
+//                 начало в левом нижнем углу габарита.
+//   Rows        — змейкой по горизонтальным полосам сверху вниз: первая полоса слева направо,
+//                 следующая справа налево и т.д.
+//   NearestPath — маршрут «к ближайшей непройденной точке» от левого верхнего угла;
+//                 поиск соседа — по равномерной сетке, без перебора всех точек.
+// Сетка, шаг и масштаб считаются по габариту основной массы точек (квартили), поэтому
+// отдельные далёкие точки не портят обход остальных. Точки с NaN или бесконечностью
+// в координатах не упорядочиваются и идут в конце по номеру.
+// Только стандартная библиотека — проверяется и замеряется отдельно (Tools/SpatialOrderBench).
+namespace SpatialOrder {
+
+	enum class Method { Hilbert, Rows, NearestPath };
+
+	struct Point {
+		double	x = 0.0;
+		double	y = 0.0;
+	};
+
+	// Номера точек в порядке обхода. rowHeight — ширина полосы для Rows;
+	// 0 — по средней плотности точек без выбросов (сторона квадрата, приходящегося на одну точку)
+	std::vector<uint32_t>	Order (const std::vector<Point>& points, Method method, double rowHeight = 0.0);
+
+	// Номер клетки (x, y) сетки 2^bits × 2^bits вдоль кривой Гильберта
+	uint64_t				HilbertIndex (uint32_t x, uint32_t y, uint32_t bits);
+
+} // namespace SpatialOrder
@@ -0,0 +1,72 @@
+#include "TableWriter.hpp"
+
+#include <cmath>
+#include <cstdio>
+
+size_t TableWriter::FormatNumber (double value, int maxDecimals, char* buffer, size_t bufferSize)
+{
+	if (!std::isfinite(value) || bufferSize == 0) {
+		return 0;
+	}
+
+	int length = std::snprintf(buffer, bufferSize, "%.*f", ClampDecimals(maxDecimals), value);
+	if (length <= 0 || length >= static_cast<int>(bufferSize)) {
+		return 0;
+	}
+
+	// Убираем хвостовые нули и точку, если дробной части не осталось
+	bool hasPoint = false;
+	for (int i = 0; i < length; ++i) {
+		if (buffer[i] == '.') {
+			hasPoint = true;
+			break;
+		}
+	}
+	if (hasPoint) {
+		while (length > 0 && buffer[length - 1] == '0') {
+			--length;
+		}
+		if (length > 0 && buffer[length - 1] == '.') {
+			--length;
+		}
+	}
+	if (length == 2 && buffer[0] == '-' && buffer[1] == '0') {
+		buffer[0] = '0';
+		length = 1;
+	}
+	buffer[length] = '\0';
+	return static_cast<size_t>(length);
+}
+
+// ---------------- RowChunk ----------------
+void RowChunk::AddText (const char* utf8, size_t length)
+{
+	Cell cell;
+	cell.kind = Cell::Text;
+	cell.offset = static_cast<uint32_t>(textArena.size());
+	cell.length = static_cast<uint32_t>(length);
+	textArena.append(utf8, length);
+	cells.push_back(cell);
+}
+
+void RowChunk::AddSharedString (uint32_t index)
+{
+	Cell cell;
+	cell.kind = Cell::SharedString;
+	cell.length = index;
+	cells.push_back(cell);
+}
+
+void RowChunk::AddNumber (double value, int decimals)
+{
+	Cell cell;
+	cell.kind = Cell::Number;
+	cell.decimals = static_cast<uint8_t>(TableWriter::ClampDecimals(decimals));
+	cell.number = value;
+	cells.push_back(cell);
+}
+
+void RowChunk::AddEmpty ()
+{
+	cells.push_back(Cell());
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Пачка строк таблицы, подготовленная в главном потоке (там, где можно звать ACAPI)
+// и отдаваемая рабочим потокам на форматирование и сжатие.
+// Тексты ячеек лежат в одном буфере, чтобы не плодить мелкие строки.
+struct RowChunk
+{
+	struct Cell {
+		enum Kind : uint8_t { Empty, Text, Number, SharedString };
+
+		Kind		kind = Empty;
+		uint8_t		decimals = 6;		// Number: знаков после точки
+		uint32_t	offset = 0;			// Text: смещение в textArena
+		uint32_t	length = 0;			// Text: длина; SharedString: индекс строки
+		double		number = 0.0;
+	};
+
+	uint32_t			firstRow = 1;	// номер первой строки на листе (с 1)
+	uint32_t			columnCount = 0;
+	std::vector<Cell>	cells;			// rowCount * columnCount
+	std::string			textArena;
+
+	uint32_t	GetRowCount () const { return columnCount > 0 ? static_cast<uint32_t>(cells.size() / columnCount) : 0; }
+	void		Clear () { cells.clear(); textArena.clear(); }
+
+	void		AddText (const char* utf8, size_t length);
+	void		AddSharedString (uint32_t index);
+	void		AddNumber (double value, int decimals = 6);
+	void		AddEmpty ();
+};
+
+// Результат обработки пачки: готовые байты для файла
+struct ChunkOutput
+{
+	std::string	bytes;
+	uint32_t	crc = 0;				// CRC-32 несжатых данных (для ZIP)
+	uint64_t	rawSize = 0;			// размер несжатых данных
+	uint32_t	rowCount = 0;
+	bool		ok = true;
+};
+
+// Общий интерфейс потоковой записи таблицы (CSV, XLSX):
+// ячейки пишутся слева направо, строка закрывается EndRow().
+class TableWriter
+{
+public:
+	virtual ~TableWriter () {}
+
+	// Текст в UTF-8
+	virtual void	WriteField (const char* utf8, size_t length) = 0;
+	void			WriteField (const std::string& utf8) { WriteField(utf8.data(), utf8.size()); }
+	virtual void	WriteNumber (double value, int maxDecimals = 6) = 0;
+	virtual void	WriteEmpty () = 0;
+	virtual void	EndRow () = 0;
+
+	// Дописать всё, что осталось в буферах; false — ошибка записи
+	virtual bool	Finish () = 0;
+	virtual bool	HasError () const = 0;
+	virtual unsigned long long GetBytesWritten () const = 0;
+
+	// Знаков после точки: больше 15 у double — уже шум, а буфер числа рассчитан на этот предел
+	static const int	MaxDecimals = 15;
+	static int			ClampDecimals (int decimals) { return decimals < 0 ? 0 : (decimals > MaxDecimals ? MaxDecimals : decimals); }
+
+	// Число с не более чем maxDecimals (0..MaxDecimals) знаками после точки, без хвостовых нулей и "-0".
+	// Возвращает длину; 0 — число не записать (NaN, бесконечность).
+	static size_t	FormatNumber (double value, int maxDecimals, char* buffer, size_t bufferSize);
+
+	// ---- Пакетная запись (конвейер экспорта) ----
+
+	// Индекс строки в общей таблице формата; false — формат её не ведёт, пишем текстом
+	virtual bool		InternString (const char* /*utf8*/, size_t /*length*/, uint32_t& /*index*/) { return false; }
+
+	// Номер строки, с которой начнётся следующая пачка
+	virtual uint32_t	GetNextRow () const = 0;
+
+	// Отформатировать (и при необходимости сжать) пачку.
+	// Вызывается из рабочих потоков — читает только неизменяемые настройки писателя.
+	virtual ChunkOutput	FormatChunk (const RowChunk& chunk) const = 0;
+
+	// Дописать готовую пачку в файл; пачки передаются в порядке строк
+	virtual void		WriteChunk (const ChunkOutput& output) = 0;
+};
@@ -0,0 +1,410 @@
+#include "XlsxWriter.hpp"
+
+#include <cstring>
+
+namespace {
+
+const size_t SheetFlushSize = 1 << 16;
+
+const char* const XmlHeader = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\r\n";
+const char* const MainNamespace = "http://schemas.openxmlformats.org/spreadsheetml/2006/main";
+const char* const RelNamespace = "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+
+// Текст для XML: экранируем &<> и выбрасываем управляющие символы, недопустимые в XML 1.0.
+// В значении атрибута экранируем и кавычки
+void AppendEscaped (std::string& out, const char* text, size_t length, bool attribute = false)
+{
+	const char* begin = text;
+	const char* end = text + length;
+	for (const char* p = text; p < end; ++p) {
+		const unsigned char c = static_cast<unsigned char>(*p);
+		const char* replacement = nullptr;
+		if (c == '&') {
+			replacement = "&amp;";
+		} else if (c == '<') {
+			replacement = "&lt;";
+		} else if (c == '>') {
+			replacement = "&gt;";
+		} else if (attribute && c == '"') {
+			replacement = "&quot;";
+		} else if (attribute && c == '\'') {
+			replacement = "&apos;";
+		} else if (c < 0x20 && c != '\t' && c != '\n' && c != '\r') {
+			replacement = "";
+		} else {
+			continue;
+		}
+		out.append(begin, static_cast<size_t>(p - begin));
+		out.append(replacement);
+		begin = p + 1;
+	}
+	out.append(begin, static_cast<size_t>(end - begin));
+}
+
+// <t> с пробелами по краям требует xml:space="preserve", иначе Excel их обрежет
+void AppendTextElement (std::string& out, const char* text, size_t length)
+{
+	const bool preserve = length > 0 &&
+		(std::strchr(" \t\r\n", text[0]) != nullptr || std::strchr(" \t\r\n", text[length - 1]) != nullptr);
+	out.append(preserve ? "<t xml:space=\"preserve\">" : "<t>");
+	AppendEscaped(out, text, length);
+	out.append("</t>");
+}
+
+// Имя листа Excel: не длиннее 31 символа и без []:*?/\ .
+// Обрезаем по границе символа UTF-8.
+std::string SanitizeSheetName (const std::string& name)
+{
+	std::string result;
+	size_t characters = 0;
+	for (size_t i = 0; i < name.size() && characters < 31;) {
+		size_t charLength = 1;
+		const unsigned char c = static_cast<unsigned char>(name[i]);
+		if (c >= 0xF0) {
+			charLength = 4;
+		} else if (c >= 0xE0) {
+			charLength = 3;
+		} else if (c >= 0xC0) {
+			charLength = 2;
+		}
+		if (std::strchr("[]:*?/\\", name[i]) != nullptr && charLength == 1) {
+			result.push_back('_');
+		} else {
+			result.append(name, i, charLength);
+		}
+		i += charLength;
+		++characters;
+	}
+	return result.empty() ? std::string("Sheet1") : result;
+}
+
+void AppendColumnName (std::string& out, uint32_t column)
+{
+	char letters[8];
+	int count = 0;
+	uint32_t index = column + 1;
+	while (index > 0 && count < 8) {
+		--index;
+		letters[count++] = static_cast<char>('A' + index % 26);
+		index /= 26;
+	}
+	while (count > 0) {
+		out.push_back(letters[--count]);
+	}
+}
+
+} // namespace
+
+XlsxWriter::XlsxWriter (std::FILE* file, const Options& options)
+	: m_zip(file)
+	, m_options(options)
+{
+	m_sheet.reserve(SheetFlushSize + 4096);
+	m_rowNumber = "1";
+	WriteStaticParts();
+
+	m_zip.BeginEntry("xl/worksheets/sheet1.xml");
+	m_sheet.append(XmlHeader);
+	m_sheet.append("<worksheet xmlns=\"").append(MainNamespace).append("\" xmlns:r=\"").append(RelNamespace).append("\">");
+	if (m_options.headerRow) {
+		m_sheet.append("<sheetViews><sheetView workbookViewId=\"0\">"
+			"<pane ySplit=\"1\" topLeftCell=\"A2\" activePane=\"bottomLeft\" state=\"frozen\"/>"
+			"</sheetView></sheetViews>");
+	}
+	m_sheet.append("<sheetData>");
+}
+
+XlsxWriter::~XlsxWriter ()
+{
+	Finish();
+}
+
+void XlsxWriter::WriteStaticParts ()
+{
+	std::string part;
+
+	part = XmlHeader;
+	part.append("<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+		"<Default Extension=\"rels\" ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+		"<Default Extension=\"xml\" ContentType=\"application/xml\"/>"
+		"<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+		"<Override PartName=\"/xl/worksheets/sheet1.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml\"/>"
+		"<Override PartName=\"/xl/styles.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml\"/>"
+		"<Override PartName=\"/xl/sharedStrings.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sharedStrings+xml\"/>"
+		"</Types>");
+	m_zip.BeginEntry("[Content_Types].xml");
+	m_zip.Write(part);
+
+	part = XmlHeader;
+	part.append("<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+		"<Relationship Id=\"rId1\" Type=\"").append(RelNamespace).append("/officeDocument\" Target=\"xl/workbook.xml\"/>"
+		"</Relationships>");
+	m_zip.BeginEntry("_rels/.rels");
+	m_zip.Write(part);
+
+	part = XmlHeader;
+	part.append("<workbook xmlns=\"").append(MainNamespace).append("\" xmlns:r=\"").append(RelNamespace).append("\">"
+		"<sheets><sheet name=\"");
+	const std::string sheetName = SanitizeSheetName(m_options.sheetName);
+	AppendEscaped(part, sheetName.data(), sheetName.size(), true);
+	part.append("\" sheetId=\"1\" r:id=\"rId1\"/></sheets></workbook>");
+	m_zip.BeginEntry("xl/workbook.xml");
+	m_zip.Write(part);
+
+	part = XmlHeader;
+	part.append("<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+		"<Relationship Id=\"rId1\" Type=\"").append(RelNamespace).append("/worksheet\" Target=\"worksheets/sheet1.xml\"/>"
+		"<Relationship Id=\"rId2\" Type=\"").append(RelNamespace).append("/styles\" Target=\"styles.xml\"/>"
+		"<Relationship Id=\"rId3\" Type=\"").append(RelNamespace).append("/sharedStrings\" Target=\"sharedStrings.xml\"/>"
+		"</Relationships>");
+	m_zip.BeginEntry("xl/_rels/workbook.xml.rels");
+	m_zip.Write(part);
+
+	// Стиль 0 — обычный, стиль 1 — жирный для заголовка
+	part = XmlHeader;
+	part.append("<styleSheet xmlns=\"").append(MainNamespace).append("\">"
+		"<fonts count=\"2\">"
+		"<font><sz val=\"11\"/><name val=\"Calibri\"/><family val=\"2\"/></font>"
+		"<font><b/><sz val=\"11\"/><name val=\"Calibri\"/><family val=\"2\"/></font>"
+		"</fonts>"
+		"<fills count=\"2\"><fill><patternFill patternType=\"none\"/></fill><fill><patternFill patternType=\"gray125\"/></fill></fills>"
+		"<borders count=\"1\"><border><left/><right/><top/><bottom/><diagonal/></border></borders>"
+		"<cellStyleXfs count=\"1\"><xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\"/></cellStyleXfs>"
+		"<cellXfs count=\"2\">"
+		"<xf numFmtId=\"0\" fontId=\"0\" fillId=\"0\" borderId=\"0\" xfId=\"0\"/>"
+		"<xf numFmtId=\"0\" fontId=\"1\" fillId=\"0\" borderId=\"0\" xfId=\"0\" applyFont=\"1\"/>"
+		"</cellXfs>"
+		"<cellStyles count=\"1\"><cellStyle name=\"Normal\" xfId=\"0\" builtinId=\"0\"/></cellStyles>"
+		"</styleSheet>");
+	m_zip.BeginEntry("xl/styles.xml");
+	m_zip.Write(part);
+	m_zip.EndEntry();
+}
+
+// ---------------- Ячейки ----------------
+const std::string& XlsxWriter::GetColumnName (uint32_t column)
+{
+	while (m_columnNames.size() <= column) {
+		std::string name;
+		AppendColumnName(name, static_cast<uint32_t>(m_columnNames.size()));
+		m_columnNames.push_back(name);
+	}
+	return m_columnNames[column];
+}
+
+void XlsxWriter::BeginCell ()
+{
+	if (!m_rowOpen) {
+		m_sheet.append("<row r=\"").append(m_rowNumber).append("\">");
+		m_rowOpen = true;
+	}
+	m_sheet.append("<c r=\"").append(GetColumnName(m_column)).append(m_rowNumber).append("\"");
+	if (m_options.headerRow && m_row == 1) {
+		m_sheet.append(" s=\"1\"");
+	}
+}
+
+void XlsxWriter::WriteField (const char* utf8, size_t length)
+{
+	if (m_finished) {
+		return;
+	}
+	if (length == 0) {
+		WriteEmpty();
+		return;
+	}
+
+	BeginCell();
+
+	uint32_t index = 0;
+	if (InternString(utf8, length, index)) {
+		m_sheet.append(" t=\"s\"><v>").append(std::to_string(index)).append("</v></c>");
+	} else {
+		// Таблица общих строк переполнена — уникальные значения пишем прямо в лист
+		m_sheet.append(" t=\"inlineStr\"><is>");
+		AppendTextElement(m_sheet, utf8, length);
+		m_sheet.append("</is></c>");
+	}
+	m_column++;
+}
+
+bool XlsxWriter::InternString (const char* utf8, size_t length, uint32_t& index)
+{
+	std::string key(utf8, length);
+	auto found = m_stringIndex.find(key);
+	if (found == m_stringIndex.end()) {
+		if (m_stringBytes + length > m_options.maxSharedStringBytes) {
+			return false;
+		}
+		found = m_stringIndex.emplace(std::move(key), static_cast<uint32_t>(m_strings.size())).first;
+		m_strings.push_back(&found->first);
+		m_stringBytes += length;
+	}
+	index = found->second;
+	m_stringRefs++;
+	return true;
+}
+
+void XlsxWriter::WriteNumber (double value, int maxDecimals)
+{
+	if (m_finished) {
+		return;
+	}
+
+	char text[64];
+	const size_t length = FormatNumber(value, maxDecimals, text, sizeof(text));
+	if (length == 0) {
+		WriteEmpty();
+		return;
+	}
+
+	BeginCell();
+	m_sheet.append("><v>").append(text, length).append("</v></c>");
+	m_column++;
+}
+
+void XlsxWriter::WriteEmpty ()
+{
+	m_column++;
+}
+
+void XlsxWriter::EndRow ()
+{
+	if (m_finished) {
+		return;
+	}
+	if (m_rowOpen) {
+		m_sheet.append("</row>");
+		m_rowOpen = false;
+	}
+	SetRow(m_row + 1);
+	FlushSheetIfFull();
+}
+
+void XlsxWriter::SetRow (uint32_t row)
+{
+	m_row = row;
+	m_rowNumber = std::to_string(m_row);
+	m_column = 0;
+}
+
+void XlsxWriter::FlushSheetIfFull ()
+{
+	if (m_sheet.size() >= SheetFlushSize) {
+		m_zip.Write(m_sheet);
+		m_sheet.clear();
+	}
+}
+
+// ---------------- Пакетная запись ----------------
+ChunkOutput XlsxWriter::FormatChunk (const RowChunk& chunk) const
+{
+	const uint32_t rowCount = chunk.GetRowCount();
+	const bool headerStyle = m_options.headerRow && chunk.firstRow == 1;
+
+	std::string xml;
+	xml.reserve(chunk.textArena.size() + chunk.cells.size() * 24);
+	std::string rowNumber;
+	for (uint32_t row = 0; row < rowCount; ++row) {
+		rowNumber = std::to_string(chunk.firstRow + row);
+		xml.append("<row r=\"").append(rowNumber).append("\">");
+		for (uint32_t column = 0; column < chunk.columnCount; ++column) {
+			const RowChunk::Cell& cell = chunk.cells[row * chunk.columnCount + column];
+			if (cell.kind == RowChunk::Cell::Empty) {
+				continue;
+			}
+			char number[64];
+			size_t numberLength = 0;
+			if (cell.kind == RowChunk::Cell::Number) {
+				numberLength = FormatNumber(cell.number, cell.decimals, number, sizeof(number));
+				if (numberLength == 0) {
+					continue;
+				}
+			}
+
+			xml.append("<c r=\"");
+			AppendColumnName(xml, column);
+			xml.append(rowNumber).append("\"");
+			if (headerStyle && row == 0) {
+				xml.append(" s=\"1\"");
+			}
+			switch (cell.kind) {
+				case RowChunk::Cell::SharedString:
+					xml.append(" t=\"s\"><v>").append(std::to_string(cell.length)).append("</v></c>");
+					break;
+				case RowChunk::Cell::Number:
+					xml.append("><v>").append(number, numberLength).append("</v></c>");
+					break;
+				default:
+					xml.append(" t=\"inlineStr\"><is>");
+					AppendTextElement(xml, chunk.textArena.data() + cell.offset, cell.length);
+					xml.append("</is></c>");
+					break;
+			}
+		}
+		xml.append("</row>");
+	}
+
+	ChunkOutput output;
+	output.rowCount = rowCount;
+	output.rawSize = xml.size();
+	output.crc = Crc32Update(0, xml.data(), xml.size());
+
+	DeflateEncoder encoder;
+	encoder.Write(xml.data(), xml.size());
+	encoder.Flush();
+	output.bytes = encoder.TakeOutput();
+	return output;
+}
+
+void XlsxWriter::WriteChunk (const ChunkOutput& output)
+{
+	if (m_finished) {
+		return;
+	}
+	if (m_rowOpen) {
+		EndRow();
+	}
+
+	// Накопленный XML листа должен уйти в архив раньше пачки
+	m_zip.Write(m_sheet);
+	m_sheet.clear();
+	m_zip.WriteDeflated(output.bytes.data(), output.bytes.size(), output.crc, output.rawSize);
+	SetRow(m_row + output.rowCount);
+}
+
+// ---------------- Завершение ----------------
+bool XlsxWriter::Finish ()
+{
+	if (m_finished) {
+		return !m_zip.HasError();
+	}
+	if (m_rowOpen) {
+		EndRow();
+	}
+	m_finished = true;
+
+	m_sheet.append("</sheetData></worksheet>");
+	m_zip.Write(m_sheet);
+	m_sheet.clear();
+	m_zip.EndEntry();
+
+	m_zip.BeginEntry("xl/sharedStrings.xml");
+	m_sheet.append(XmlHeader);
+	m_sheet.append("<sst xmlns=\"").append(MainNamespace).append("\" count=\"").append(std::to_string(m_stringRefs))
+		.append("\" uniqueCount=\"").append(std::to_string(m_strings.size())).append("\">");
+	for (const std::string* text : m_strings) {
+		m_sheet.append("<si>");
+		AppendTextElement(m_sheet, text->data(), text->size());
+		m_sheet.append("</si>");
+		FlushSheetIfFull();
+	}
+	m_sheet.append("</sst>");
+	m_zip.Write(m_sheet);
+	m_sheet.clear();
+	m_zip.EndEntry();
+
+	m_stringIndex.clear();
+	m_strings.clear();
+	return m_zip.Close();
+}
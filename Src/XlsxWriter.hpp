@@ -0,0 +1,73 @@
+#pragma once
+
+#include "TableWriter.hpp"
+#include "ZipWriter.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Минимальный XLSX (один лист) без внешних библиотек.
+// XML листа сжимается и пишется в файл по ходу, в памяти держится только таблица
+// общих строк (sharedStrings) — повторяющиеся значения хранятся один раз.
+// Числа пишутся числовыми ячейками, чтобы Excel не гадал с типами и разделителями.
+class XlsxWriter : public TableWriter
+{
+public:
+	struct Options {
+		std::string	sheetName = "Sheet1";
+		bool		headerRow = true;						// первая строка жирная и закреплена
+		size_t		maxSharedStringBytes = 64u << 20;		// дальше строки пишутся inline
+	};
+
+	XlsxWriter (std::FILE* file, const Options& options);
+	~XlsxWriter ();
+
+	XlsxWriter (const XlsxWriter&) = delete;
+	XlsxWriter& operator= (const XlsxWriter&) = delete;
+
+	using TableWriter::WriteField;
+	void		WriteField (const char* utf8, size_t length) override;
+	void		WriteNumber (double value, int maxDecimals = 6) override;
+	void		WriteEmpty () override;
+	void		EndRow () override;
+
+	// Закрыть лист, записать sharedStrings и каталог архива
+	bool		Finish () override;
+	bool		HasError () const override { return m_zip.HasError(); }
+	unsigned long long GetBytesWritten () const override { return m_zip.GetBytesWritten(); }
+
+	size_t		GetSharedStringCount () const { return m_strings.size(); }
+
+	// Пакетная запись: строки получают индекс в главном потоке, чтобы порядок sharedStrings
+	// не зависел от потоков; XML и deflate пачки — в рабочем потоке
+	bool		InternString (const char* utf8, size_t length, uint32_t& index) override;
+	uint32_t	GetNextRow () const override { return m_row; }
+	ChunkOutput	FormatChunk (const RowChunk& chunk) const override;
+	void		WriteChunk (const ChunkOutput& output) override;
+
+private:
+	void		WriteStaticParts ();
+	void		BeginCell ();
+	const std::string& GetColumnName (uint32_t column);
+	void		SetRow (uint32_t row);
+	void		FlushSheetIfFull ();
+
+	ZipWriter									m_zip;
+	Options										m_options;
+	std::string									m_sheet;		// буфер XML листа перед сжатием
+
+	std::unordered_map<std::string, uint32_t>	m_stringIndex;
+	std::vector<const std::string*>				m_strings;		// порядок индексов; ключи живут в m_stringIndex
+	size_t										m_stringBytes = 0;
+	uint64_t									m_stringRefs = 0;
+
+	std::vector<std::string>					m_columnNames;
+	std::string									m_rowNumber;
+	uint32_t									m_row = 1;
+	uint32_t									m_column = 0;
+	bool										m_rowOpen = false;
+	bool										m_finished = false;
+};
@@ -0,0 +1,298 @@
+#include "ZipWriter.hpp"
+
+#include <ctime>
+
+namespace {
+
+const size_t	EncoderDrainSize = 1 << 20;
+const uint64_t	MaxZip32 = 0xFFFFFFFFull;
+
+struct Crc32Table {
+	uint32_t values[256];
+
+	Crc32Table ()
+	{
+		for (uint32_t i = 0; i < 256; ++i) {
+			uint32_t crc = i;
+			for (int bit = 0; bit < 8; ++bit) {
+				crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : (crc >> 1);
+			}
+			values[i] = crc;
+		}
+	}
+};
+
+// Поля заголовков ZIP — little-endian
+void PutUInt16 (std::string& out, uint32_t value)
+{
+	out.push_back(static_cast<char>(value & 0xFF));
+	out.push_back(static_cast<char>((value >> 8) & 0xFF));
+}
+
+void PutUInt32 (std::string& out, uint64_t value)
+{
+	PutUInt16(out, static_cast<uint32_t>(value & 0xFFFF));
+	PutUInt16(out, static_cast<uint32_t>((value >> 16) & 0xFFFF));
+}
+
+uint32_t Gf2MatrixTimes (const uint32_t* matrix, uint32_t vector)
+{
+	uint32_t sum = 0;
+	while (vector != 0) {
+		if (vector & 1) {
+			sum ^= *matrix;
+		}
+		vector >>= 1;
+		matrix++;
+	}
+	return sum;
+}
+
+void Gf2MatrixSquare (uint32_t* square, const uint32_t* matrix)
+{
+	for (int n = 0; n < 32; ++n) {
+		square[n] = Gf2MatrixTimes(matrix, matrix[n]);
+	}
+}
+
+} // namespace
+
+uint32_t Crc32Combine (uint32_t crc1, uint32_t crc2, uint64_t length2)
+{
+	if (length2 == 0) {
+		return crc1;
+	}
+
+	// Оператор "дописать один нулевой бит" и его квадраты: сдвигаем crc1 на length2 нулевых байт
+	uint32_t odd[32];
+	uint32_t even[32];
+	odd[0] = 0xEDB88320u;
+	uint32_t row = 1;
+	for (int n = 1; n < 32; ++n) {
+		odd[n] = row;
+		row <<= 1;
+	}
+	Gf2MatrixSquare(even, odd);
+	Gf2MatrixSquare(odd, even);
+
+	do {
+		Gf2MatrixSquare(even, odd);
+		if (length2 & 1) {
+			crc1 = Gf2MatrixTimes(even, crc1);
+		}
+		length2 >>= 1;
+		if (length2 == 0) {
+			break;
+		}
+		Gf2MatrixSquare(odd, even);
+		if (length2 & 1) {
+			crc1 = Gf2MatrixTimes(odd, crc1);
+		}
+		length2 >>= 1;
+	} while (length2 != 0);
+
+	return crc1 ^ crc2;
+}
+
+uint32_t Crc32Update (uint32_t crc, const void* data, size_t size)
+{
+	static const Crc32Table table;
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) {
+		crc = table.values[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+ZipWriter::ZipWriter (std::FILE* file)
+	: m_file(file)
+{
+	const std::time_t now = std::time(nullptr);
+	const std::tm* local = std::localtime(&now);
+	if (local != nullptr && local->tm_year >= 80) {
+		m_dosTime = static_cast<uint16_t>((local->tm_hour << 11) | (local->tm_min << 5) | (local->tm_sec / 2));
+		m_dosDate = static_cast<uint16_t>(((local->tm_year - 80) << 9) | ((local->tm_mon + 1) << 5) | local->tm_mday);
+	} else {
+		m_dosDate = (1 << 5) | 1;
+	}
+	m_error = (m_file == nullptr);
+}
+
+bool ZipWriter::BeginEntry (const std::string& name, bool compress)
+{
+	if (m_closed || m_error) {
+		return false;
+	}
+	if (m_entryOpen) {
+		EndEntry();
+	}
+
+	Entry entry;
+	entry.name = name;
+	entry.method = compress ? 8 : 0;
+	entry.offset = m_offset;
+	m_entries.push_back(entry);
+
+	// Локальный заголовок: CRC и размеры нулевые, флаг 3 — они будут в data descriptor
+	std::string header;
+	PutUInt32(header, 0x04034b50);
+	PutUInt16(header, 20);				// версия для распаковки
+	PutUInt16(header, 0x0008);			// data descriptor
+	PutUInt16(header, entry.method);
+	PutUInt16(header, m_dosTime);
+	PutUInt16(header, m_dosDate);
+	PutUInt32(header, 0);
+	PutUInt32(header, 0);
+	PutUInt32(header, 0);
+	PutUInt16(header, static_cast<uint32_t>(name.size()));
+	PutUInt16(header, 0);
+	header += name;
+	WriteRaw(header.data(), header.size());
+
+	if (compress) {
+		m_encoder.reset(new DeflateEncoder());
+	}
+	m_encoderUsed = false;
+	m_entryOpen = true;
+	return !m_error;
+}
+
+void ZipWriter::Write (const void* data, size_t size)
+{
+	if (!m_entryOpen || size == 0) {
+		return;
+	}
+
+	Entry& entry = m_entries.back();
+	entry.crc = Crc32Update(entry.crc, data, size);
+	entry.uncompressedSize += size;
+
+	if (m_encoder) {
+		m_encoderUsed = true;
+		m_encoder->Write(data, size);
+		if (m_encoder->GetOutputSize() >= EncoderDrainSize) {
+			DrainEncoder();
+		}
+	} else {
+		entry.compressedSize += size;
+		WriteRaw(data, size);
+	}
+}
+
+void ZipWriter::WriteDeflated (const void* data, size_t size, uint32_t crc, uint64_t rawSize)
+{
+	if (!m_entryOpen || !m_encoder) {
+		return;
+	}
+
+	// Несжатые данные до этого куска закрываем sync flush; дальше нужен свежий кодер,
+	// иначе его ссылки назад указывали бы мимо вставленного куска
+	if (m_encoderUsed) {
+		m_encoder->Flush();
+		DrainEncoder();
+		m_encoder.reset(new DeflateEncoder());
+		m_encoderUsed = false;
+	}
+
+	Entry& entry = m_entries.back();
+	entry.crc = Crc32Combine(entry.crc, crc, rawSize);
+	entry.uncompressedSize += rawSize;
+	entry.compressedSize += size;
+	WriteRaw(data, size);
+}
+
+bool ZipWriter::EndEntry ()
+{
+	if (!m_entryOpen) {
+		return false;
+	}
+
+	if (m_encoder) {
+		m_encoder->Finish();
+		DrainEncoder();
+		m_encoder.reset();
+	}
+	m_entryOpen = false;
+
+	const Entry& entry = m_entries.back();
+	if (entry.compressedSize > MaxZip32 || entry.uncompressedSize > MaxZip32) {
+		m_error = true;
+	}
+
+	std::string descriptor;
+	PutUInt32(descriptor, 0x08074b50);
+	PutUInt32(descriptor, entry.crc);
+	PutUInt32(descriptor, entry.compressedSize);
+	PutUInt32(descriptor, entry.uncompressedSize);
+	WriteRaw(descriptor.data(), descriptor.size());
+	return !m_error;
+}
+
+bool ZipWriter::Close ()
+{
+	if (m_closed) {
+		return !m_error;
+	}
+	if (m_entryOpen) {
+		EndEntry();
+	}
+	m_closed = true;
+
+	const uint64_t directoryOffset = m_offset;
+	std::string directory;
+	for (const Entry& entry : m_entries) {
+		PutUInt32(directory, 0x02014b50);
+		PutUInt16(directory, 20);			// создано: MS-DOS, версия 2.0
+		PutUInt16(directory, 20);
+		PutUInt16(directory, 0x0008);
+		PutUInt16(directory, entry.method);
+		PutUInt16(directory, m_dosTime);
+		PutUInt16(directory, m_dosDate);
+		PutUInt32(directory, entry.crc);
+		PutUInt32(directory, entry.compressedSize);
+		PutUInt32(directory, entry.uncompressedSize);
+		PutUInt16(directory, static_cast<uint32_t>(entry.name.size()));
+		PutUInt16(directory, 0);			// extra
+		PutUInt16(directory, 0);			// комментарий
+		PutUInt16(directory, 0);			// номер диска
+		PutUInt16(directory, 0);			// внутренние атрибуты
+		PutUInt32(directory, 0);			// внешние атрибуты
+		PutUInt32(directory, entry.offset);
+		directory += entry.name;
+	}
+
+	const size_t directorySize = directory.size();
+	PutUInt32(directory, 0x06054b50);
+	PutUInt16(directory, 0);
+	PutUInt16(directory, 0);
+	PutUInt16(directory, static_cast<uint32_t>(m_entries.size()));
+	PutUInt16(directory, static_cast<uint32_t>(m_entries.size()));
+	PutUInt32(directory, directorySize);
+	PutUInt32(directory, directoryOffset);
+	PutUInt16(directory, 0);
+	WriteRaw(directory.data(), directory.size());
+
+	if (directoryOffset > MaxZip32 || m_entries.size() > 0xFFFF) {
+		m_error = true;
+	}
+	return !m_error;
+}
+
+void ZipWriter::DrainEncoder ()
+{
+	const std::string compressed = m_encoder->TakeOutput();
+	m_entries.back().compressedSize += compressed.size();
+	WriteRaw(compressed.data(), compressed.size());
+}
+
+void ZipWriter::WriteRaw (const void* data, size_t size)
+{
+	if (m_file == nullptr || size == 0) {
+		return;
+	}
+	if (std::fwrite(data, 1, size, m_file) != size) {
+		m_error = true;
+	}
+	m_offset += size;
+}
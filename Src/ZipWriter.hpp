@@ -0,0 +1,68 @@
+#pragma once
+
+#include "DeflateEncoder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// CRC-32 (полином 0xEDB88320), как в zip/gzip
+uint32_t Crc32Update (uint32_t crc, const void* data, size_t size);
+
+// CRC-32 склейки двух блоков по их CRC и длине второго (как crc32_combine в zlib)
+uint32_t Crc32Combine (uint32_t crc1, uint32_t crc2, uint64_t length2);
+
+// Потоковая запись ZIP-архива: записи пишутся по очереди, размеры и CRC
+// уходят в data descriptor после данных, поэтому файл не нужно перематывать.
+// Без ZIP64: каждая запись и архив целиком — до 4 ГБ.
+class ZipWriter
+{
+public:
+	explicit ZipWriter (std::FILE* file);
+
+	ZipWriter (const ZipWriter&) = delete;
+	ZipWriter& operator= (const ZipWriter&) = delete;
+
+	bool		BeginEntry (const std::string& name, bool compress = true);
+	void		Write (const void* data, size_t size);
+	void		Write (const std::string& data) { Write(data.data(), data.size()); }
+
+	// Дописать уже сжатый кусок (raw deflate, не последний блок, выровнен по байту —
+	// DeflateEncoder::Flush()). Так пачки, сжатые в разных потоках, склеиваются в одну запись.
+	void		WriteDeflated (const void* data, size_t size, uint32_t crc, uint64_t rawSize);
+
+	bool		EndEntry ();
+
+	// Центральный каталог; после Close() запись невозможна
+	bool		Close ();
+
+	bool		HasError () const { return m_error; }
+	unsigned long long GetBytesWritten () const { return m_offset; }
+
+private:
+	struct Entry {
+		std::string	name;
+		uint16_t	method = 0;
+		uint32_t	crc = 0;
+		uint64_t	compressedSize = 0;
+		uint64_t	uncompressedSize = 0;
+		uint64_t	offset = 0;
+	};
+
+	void		WriteRaw (const void* data, size_t size);
+	void		DrainEncoder ();
+
+	std::FILE*						m_file;
+	std::vector<Entry>				m_entries;
+	std::unique_ptr<DeflateEncoder>	m_encoder;
+	uint64_t						m_offset = 0;
+	uint16_t						m_dosTime = 0;
+	uint16_t						m_dosDate = 0;
+	bool							m_entryOpen = false;
+	bool							m_encoderUsed = false;
+	bool							m_closed = false;
+	bool							m_error = false;
+};
@@ -0,0 +1,248 @@
+// Замер и проверка потоковой записи CSV (CsvWriter).
+// Пишет N строк (по умолчанию 1 000 000) по 6 колонок во временный файл в двух вариантах:
+//   plain   — GUID, тип, ID, слой и два числа, кавычки не нужны;
+//   quoted  — в текстах разделители, кавычки и переводы строк, почти каждое поле в кавычках.
+// Строки берутся по кругу из заранее собранного набора (8 192 строки), чтобы замер мерил запись,
+// а не сборку строк. Печатает время и скорость в МБ/с для прямой записи и для записи пачками (FormatChunk).
+// Проверки: выходной файл разбирается обратно по RFC 4180 (на 20 000 строк) и совпадает
+// с исходными ячейками; запись пачками даёт те же байты, что и прямая.
+//
+// Сборка (Linux / macOS):
+//   g++ -std=c++17 -O2 -I ../../Src CsvWriterBench.cpp ../../Src/CsvWriter.cpp ../../Src/TableWriter.cpp -o csv_writer_bench
+// Запуск:
+//   ./csv_writer_bench [строк]
+
+#include "CsvWriter.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint32_t ColumnCount = 6;
+static const uint32_t ChunkRows = 4096;
+static const uint32_t PoolSize = 8192;
+
+static double SecondsSince (Clock::time_point started)
+{
+	return std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+// Ячейки строки: 4 текста и 2 числа
+struct Row {
+	std::string	texts[4];
+	double		numbers[2];
+};
+
+static Row MakeRow (uint32_t index, bool quoted)
+{
+	static const char* const types[] = { "Объект", "Лампа", "Колонна", "Стена" };
+	static const char* const layers[] = { "Озеленение", "Освещение", "Конструкции", "МАФ" };
+	char guid[48];
+	std::snprintf(guid, sizeof(guid), "%08X-%04X-4%03X-8%03X-%012X", index * 2654435761u, index & 0xFFFF, index & 0xFFF, (index >> 12) & 0xFFF, index);
+
+	Row row;
+	row.texts[0] = guid;
+	row.texts[1] = types[index % 4];
+	row.texts[2] = "T-" + std::to_string(index);
+	row.texts[3] = layers[(index / 7) % 4];
+	if (quoted) {
+		row.texts[1] += "; кадка \"Большая\"";
+		row.texts[2] += "\r\nвторая строка";
+		row.texts[3] = "\"" + row.texts[3] + "\"; 60×40";
+	}
+	row.numbers[0] = index * 0.125;
+	row.numbers[1] = -static_cast<double>(index % 1000) / 3.0;
+	return row;
+}
+
+static void WriteRow (TableWriter& writer, const Row& row)
+{
+	for (const std::string& text : row.texts) {
+		writer.WriteField(text);
+	}
+	writer.WriteNumber(row.numbers[0], 3);
+	writer.WriteNumber(row.numbers[1], 3);
+	writer.EndRow();
+}
+
+static void AddRow (RowChunk& chunk, const Row& row)
+{
+	for (const std::string& text : row.texts) {
+		chunk.AddText(text.data(), text.size());
+	}
+	chunk.AddNumber(row.numbers[0], 3);
+	chunk.AddNumber(row.numbers[1], 3);
+}
+
+static std::vector<Row> MakePool (bool quoted)
+{
+	std::vector<Row> pool;
+	pool.reserve(PoolSize);
+	for (uint32_t i = 0; i < PoolSize; ++i) {
+		pool.push_back(MakeRow(i, quoted));
+	}
+	return pool;
+}
+
+// Прямая запись в файл; возвращает байты файла или -1 при ошибке
+static long long WriteDirect (std::FILE* file, uint32_t rowCount, const std::vector<Row>& pool)
+{
+	CsvWriter writer(file, CsvWriter::Options());
+	for (uint32_t i = 0; i < rowCount; ++i) {
+		WriteRow(writer, pool[i % PoolSize]);
+	}
+	return writer.Finish() ? static_cast<long long>(writer.GetBytesWritten()) : -1;
+}
+
+static long long WriteChunked (std::FILE* file, uint32_t rowCount, const std::vector<Row>& pool)
+{
+	CsvWriter writer(file, CsvWriter::Options());
+	RowChunk chunk;
+	chunk.columnCount = ColumnCount;
+	for (uint32_t i = 0; i < rowCount; ++i) {
+		AddRow(chunk, pool[i % PoolSize]);
+		if (chunk.GetRowCount() == ChunkRows || i + 1 == rowCount) {
+			chunk.firstRow = writer.GetNextRow();
+			writer.WriteChunk(writer.FormatChunk(chunk));
+			chunk.Clear();
+		}
+	}
+	return writer.Finish() ? static_cast<long long>(writer.GetBytesWritten()) : -1;
+}
+
+// Разбор CSV по RFC 4180: поля через ';', в кавычках "" — кавычка, переводы строк внутри кавычек
+static bool ParseCsv (const std::string& text, std::vector<std::vector<std::string>>& records)
+{
+	size_t position = (text.compare(0, 3, "\xEF\xBB\xBF") == 0) ? 3 : 0;
+	std::vector<std::string> record;
+	std::string field;
+	while (position < text.size()) {
+		if (text[position] == '"') {
+			++position;
+			for (;;) {
+				if (position >= text.size()) {
+					return false;
+				}
+				if (text[position] == '"') {
+					if (position + 1 < text.size() && text[position + 1] == '"') {
+						field.push_back('"');
+						position += 2;
+						continue;
+					}
+					++position;
+					break;
+				}
+				field.push_back(text[position++]);
+			}
+		} else {
+			while (position < text.size() && text[position] != ';' && text[position] != '\r') {
+				field.push_back(text[position++]);
+			}
+		}
+		record.push_back(field);
+		field.clear();
+		if (position < text.size() && text[position] == ';') {
+			++position;
+		} else if (text.compare(position, 2, "\r\n") == 0) {
+			position += 2;
+			records.push_back(record);
+			record.clear();
+		} else {
+			return false;
+		}
+	}
+	return record.empty();
+}
+
+static std::string ReadFile (std::FILE* file)
+{
+	std::string text;
+	std::rewind(file);
+	char buffer[65536];
+	size_t read = 0;
+	while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		text.append(buffer, read);
+	}
+	return text;
+}
+
+static std::string Expected (double value)
+{
+	char text[64];
+	const size_t length = TableWriter::FormatNumber(value, 3, text, sizeof(text));
+	return std::string(text, length);
+}
+
+static bool CheckRoundTrip (const std::vector<Row>& pool)
+{
+	const uint32_t rowCount = 20000;
+	std::FILE* direct = std::tmpfile();
+	std::FILE* chunked = std::tmpfile();
+	if (direct == nullptr || chunked == nullptr || WriteDirect(direct, rowCount, pool) < 0 || WriteChunked(chunked, rowCount, pool) < 0) {
+		return false;
+	}
+	const std::string text = ReadFile(direct);
+	const bool sameBytes = (text == ReadFile(chunked));
+	std::fclose(direct);
+	std::fclose(chunked);
+	if (!sameBytes) {
+		std::printf("chunked output differs from direct output\n");
+		return false;
+	}
+
+	std::vector<std::vector<std::string>> records;
+	if (!ParseCsv(text, records) || records.size() != rowCount) {
+		std::printf("parsed %zu records of %u\n", records.size(), rowCount);
+		return false;
+	}
+	for (uint32_t i = 0; i < rowCount; ++i) {
+		const Row& row = pool[i % PoolSize];
+		const std::vector<std::string>& record = records[i];
+		if (record.size() != ColumnCount ||
+			record[0] != row.texts[0] || record[1] != row.texts[1] || record[2] != row.texts[2] || record[3] != row.texts[3] ||
+			record[4] != Expected(row.numbers[0]) || record[5] != Expected(row.numbers[1])) {
+			std::printf("row %u differs after round trip\n", i);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main (int argc, char** argv)
+{
+	const uint32_t rowCount = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000u;
+	std::printf("rows: %u x %u columns\n", rowCount, ColumnCount);
+
+	bool ok = true;
+	const std::vector<Row> plainPool = MakePool(false);
+	const std::vector<Row> quotedPool = MakePool(true);
+	for (const bool quoted : { false, true }) {
+		const std::vector<Row>& pool = quoted ? quotedPool : plainPool;
+		for (const bool chunked : { false, true }) {
+			std::FILE* file = std::tmpfile();
+			if (file == nullptr) {
+				std::printf("cannot create temporary file\n");
+				return 1;
+			}
+			const Clock::time_point started = Clock::now();
+			const long long bytes = chunked ? WriteChunked(file, rowCount, pool) : WriteDirect(file, rowCount, pool);
+			const double elapsed = SecondsSince(started);
+			std::fclose(file);
+			ok = ok && bytes >= 0;
+			const double megabytes = bytes / 1048576.0;
+			std::printf("%-7s %-8s %8.1f MB %8.3f s %8.1f MB/s\n", quoted ? "quoted" : "plain", chunked ? "chunked" : "direct",
+				megabytes, elapsed, elapsed > 0.0 ? megabytes / elapsed : 0.0);
+		}
+	}
+
+	const bool plain = CheckRoundTrip(plainPool);
+	const bool quoted = CheckRoundTrip(quotedPool);
+	std::printf("round trip: plain %s, quoted %s\n", plain ? "OK" : "FAIL", quoted ? "OK" : "FAIL");
+	ok = ok && plain && quoted;
+	std::printf("%s\n", ok ? "OK" : "FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+// Замер и проверка операций над множествами GUID (GuidSet) для наборов выделения.
+// Строит два множества по N GUID (по умолчанию 200 000) с общей половиной, нормализует их
+// и меряет объединение, пересечение и разность. Проверки:
+//   - FromBytes / ToBytes — взаимно обратны, порядок ключей совпадает с memcmp по байтам;
+//   - размеры результатов: |A ∪ B| = |A| + |B| − |A ∩ B|, |A \ B| = |A| − |A ∩ B|;
+//   - каждая операция совпадает с перебором по std::set (на 5 000 GUID).
+//
+// Сборка (Linux / macOS):
+//   g++ -std=c++17 -O2 -I ../../Src GuidSetBench.cpp ../../Src/GuidSet.cpp -o guid_set_bench
+// Запуск:
+//   ./guid_set_bench [GUID в множестве]
+
+#include "GuidSet.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <set>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double MillisecondsSince (Clock::time_point started)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+}
+
+static GuidSet::Key RandomKey (std::mt19937_64& random)
+{
+	GuidSet::Key key;
+	key.high = random();
+	key.low = random();
+	return key;
+}
+
+// Два множества по count GUID, из них shared общих; порядок — случайный, как в выделении
+static void MakeSets (size_t count, size_t shared, std::mt19937_64& random, GuidSet::Set& a, GuidSet::Set& b)
+{
+	a.clear();
+	b.clear();
+	for (size_t i = 0; i < shared; ++i) {
+		const GuidSet::Key key = RandomKey(random);
+		a.push_back(key);
+		b.push_back(key);
+	}
+	while (a.size() < count) {
+		a.push_back(RandomKey(random));
+	}
+	while (b.size() < count) {
+		b.push_back(RandomKey(random));
+	}
+	std::shuffle(a.begin(), a.end(), random);
+	std::shuffle(b.begin(), b.end(), random);
+}
+
+static bool CheckBytes (std::mt19937_64& random)
+{
+	for (int n = 0; n < 10000; ++n) {
+		uint8_t first[16];
+		uint8_t second[16];
+		for (int i = 0; i < 16; ++i) {
+			first[i] = static_cast<uint8_t>(random());
+			second[i] = (n % 4 == 0 && i < 12) ? first[i] : static_cast<uint8_t>(random());
+		}
+		const GuidSet::Key a = GuidSet::FromBytes(first);
+		const GuidSet::Key b = GuidSet::FromBytes(second);
+		uint8_t back[16];
+		GuidSet::ToBytes(a, back);
+		if (std::memcmp(back, first, 16) != 0) {
+			return false;
+		}
+		const int byBytes = std::memcmp(first, second, 16);
+		if ((byBytes < 0) != (a < b) || (byBytes == 0) != (a == b)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool CheckAgainstStdSet (std::mt19937_64& random)
+{
+	GuidSet::Set a;
+	GuidSet::Set b;
+	MakeSets(5000, 1700, random, a, b);
+	a.push_back(a.front());		// повтор должен исчезнуть при нормализации
+	const std::set<GuidSet::Key> setA(a.begin(), a.end());
+	const std::set<GuidSet::Key> setB(b.begin(), b.end());
+	GuidSet::Normalize(a);
+	GuidSet::Normalize(b);
+	if (!GuidSet::IsNormalized(a) || a.size() != setA.size()) {
+		return false;
+	}
+
+	GuidSet::Set expectedUnion;
+	GuidSet::Set expectedIntersection;
+	GuidSet::Set expectedDifference;
+	std::set<GuidSet::Key> all(setA);
+	all.insert(setB.begin(), setB.end());
+	expectedUnion.assign(all.begin(), all.end());
+	for (const GuidSet::Key& key : setA) {
+		if (setB.count(key) != 0) {
+			expectedIntersection.push_back(key);
+		} else {
+			expectedDifference.push_back(key);
+		}
+	}
+	return GuidSet::Union(a, b) == expectedUnion &&
+		GuidSet::Intersection(a, b) == expectedIntersection &&
+		GuidSet::Difference(a, b) == expectedDifference &&
+		GuidSet::Contains(a, expectedIntersection.front()) &&
+		!GuidSet::Contains(expectedDifference, expectedIntersection.front());
+}
+
+int main (int argc, char** argv)
+{
+	const size_t count = (argc > 1) ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 200000u;
+
+	std::mt19937_64 random(50);
+	GuidSet::Set a;
+	GuidSet::Set b;
+	MakeSets(count, count / 2, random, a, b);
+	std::printf("sets: 2 x %zu GUID, %zu shared\n", count, count / 2);
+
+	Clock::time_point started = Clock::now();
+	GuidSet::Normalize(a);
+	GuidSet::Normalize(b);
+	std::printf("normalize     %8.2f ms (both sets, from selection order)\n", MillisecondsSince(started));
+
+	started = Clock::now();
+	GuidSet::Normalize(a);
+	std::printf("normalized    %8.2f ms (already sorted — check only)\n", MillisecondsSince(started));
+
+	started = Clock::now();
+	const GuidSet::Set united = GuidSet::Union(a, b);
+	std::printf("union         %8.2f ms, %zu GUID\n", MillisecondsSince(started), united.size());
+
+	started = Clock::now();
+	const GuidSet::Set common = GuidSet::Intersection(a, b);
+	std::printf("intersection  %8.2f ms, %zu GUID\n", MillisecondsSince(started), common.size());
+
+	started = Clock::now();
+	const GuidSet::Set difference = GuidSet::Difference(a, b);
+	std::printf("difference    %8.2f ms, %zu GUID\n", MillisecondsSince(started), difference.size());
+
+	const bool sizes = united.size() == a.size() + b.size() - common.size() &&
+		difference.size() == a.size() - common.size() &&
+		GuidSet::IsNormalized(united) && GuidSet::IsNormalized(common) && GuidSet::IsNormalized(difference);
+	const bool bytes = CheckBytes(random);
+	const bool reference = CheckAgainstStdSet(random);
+	std::printf("sizes %s, bytes %s, std::set reference %s\n",
+		sizes ? "OK" : "FAIL", bytes ? "OK" : "FAIL", reference ? "OK" : "FAIL");
+	const bool ok = sizes && bytes && reference;
+	std::printf("%s\n", ok ? "OK" : "FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+// Замер поиска по слоям (LayerSearchIndex) на синтетическом наборе.
+// Строит N слоёв (по умолчанию 10 000) в папках глубиной до 4, затем «печатает» запросы
+// по одному символу, как пользователь в палитре, и меряет время каждого нажатия.
+// Точные совпадения сверяются с полным перебором.
+//
+// Сборка (Linux / macOS):
+//   g++ -std=c++17 -O2 -I ../../Src LayerSearchBench.cpp ../../Src/LayerSearchIndex.cpp -o layer_search_bench
+// Запуск:
+//   ./layer_search_bench [слоёв]
+
+#include "LayerSearchIndex.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double MicrosecondsSince (Clock::time_point started)
+{
+	return std::chrono::duration<double, std::micro>(Clock::now() - started).count();
+}
+
+static const char* folderWords[] = { "Ландшафт", "Растения", "Деревья", "Кустарники", "Газоны", "Покрытия", "Малые формы",
+	"Освещение", "Сети", "Architecture", "Walls", "Slabs", "Interior", "Furniture", "Обмерный план", "Существующее" };
+static const char* nameWords[] = { "Сосна", "Ель", "Берёза", "Клён", "Дуб", "Липа", "Туя", "Можжевельник", "Сирень", "Газон",
+	"Плитка", "Брусчатка", "Скамья", "Урна", "Фонарь", "Wall", "Slab", "Door", "Window", "Column", "обыкновенная",
+	"колючая", "повислая", "проект", "демонтаж", "новый", "existing", "new", "demo" };
+
+// Все записи, где каждый терм запроса (3+ символа) — подстрока «папка/имя» без учёта регистра
+static size_t BruteForceCount (const LayerSearchIndex& index, const std::string& query)
+{
+	std::vector<std::u32string> terms;
+	const std::u32string normalized = LayerSearchIndex::Normalize(query);
+	size_t start = 0;
+	while (start <= normalized.size()) {
+		const size_t end = std::min(normalized.find(U' ', start), normalized.size());
+		if (end > start) {
+			terms.push_back(normalized.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+
+	size_t count = 0;
+	for (uint32_t entry = 0; entry < index.GetSize(); ++entry) {
+		const LayerSearchIndex::Entry& item = index.GetEntry(entry);
+		const std::u32string text = LayerSearchIndex::Normalize(item.folder.empty() ? item.name : item.folder + "/" + item.name);
+		bool all = true;
+		for (const std::u32string& term : terms) {
+			all = all && text.find(term) != std::u32string::npos;
+		}
+		count += all ? 1 : 0;
+	}
+	return count;
+}
+
+int main (int argc, char** argv)
+{
+	const uint32_t count = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 10000u;
+
+	std::mt19937 random(40);
+	const size_t folderWordCount = sizeof(folderWords) / sizeof(folderWords[0]);
+	const size_t nameWordCount = sizeof(nameWords) / sizeof(nameWords[0]);
+	std::vector<LayerSearchIndex::Entry> entries;
+	entries.reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		LayerSearchIndex::Entry entry;
+		const uint32_t depth = random() % 5;
+		for (uint32_t d = 0; d < depth; ++d) {
+			entry.folder += (d > 0 ? "/" : "") + std::string(folderWords[random() % folderWordCount]);
+		}
+		entry.name = std::string(nameWords[random() % nameWordCount]) + " " + nameWords[random() % nameWordCount] + " " + std::to_string(i);
+		entries.push_back(entry);
+	}
+
+	LayerSearchIndex index;
+	Clock::time_point started = Clock::now();
+	index.Build(entries);
+	std::printf("build: %.2f ms for %u layers\n", MicrosecondsSince(started) / 1000.0, count);
+
+	const char* queries[] = { "сосна обыкн", "берез", "ландшафт/дер", "wall new", "можжевельник", "сосан", "плтка", "ель 12", "demo" };
+	double worst = 0.0;
+	double total = 0.0;
+	size_t keystrokes = 0;
+	bool ok = true;
+	for (const char* query : queries) {
+		const std::string full = query;
+		double queryWorst = 0.0;
+		size_t lastCount = 0;
+		// Печатаем по одному символу (UTF-8 — по целому символу)
+		for (size_t length = 1; length <= full.size(); ++length) {
+			if (length < full.size() && (static_cast<unsigned char>(full[length]) & 0xC0) == 0x80) {
+				continue;
+			}
+			const std::string prefix = full.substr(0, length);
+			started = Clock::now();
+			const std::vector<LayerSearchIndex::Match> matches = index.Search(prefix, 200);
+			const double elapsed = MicrosecondsSince(started);
+			queryWorst = std::max(queryWorst, elapsed);
+			total += elapsed;
+			++keystrokes;
+			lastCount = matches.size();
+		}
+		worst = std::max(worst, queryWorst);
+
+		// Точные совпадения без ограничения — сравниваем с перебором (термы от 3 символов)
+		bool longTerms = true;
+		for (size_t start = 0, end = 0; start < full.size(); start = end + 1) {
+			end = std::min(full.find(' ', start), full.size());
+			longTerms = longTerms && LayerSearchIndex::Normalize(full.substr(start, end - start)).size() >= 3;
+		}
+		size_t exact = 0;
+		for (const LayerSearchIndex::Match& match : index.Search(full, count)) {
+			exact += (match.score >= 100) ? 1 : 0;
+		}
+		const size_t expected = longTerms ? BruteForceCount(index, full) : exact;
+		ok = ok && exact == expected;
+
+		const std::vector<LayerSearchIndex::Match> top = index.Search(full, 1);
+		const std::string best = top.empty() ? std::string("-") :
+			(index.GetEntry(top[0].entry).folder + "/" + index.GetEntry(top[0].entry).name);
+		std::printf("%-16s worst %7.1f us, shown %3zu, exact %5zu (brute force %5zu), top: %s\n",
+			query, queryWorst, lastCount, exact, expected, best.c_str());
+	}
+	std::printf("keystrokes: %zu, average %.1f us, worst %.1f us — %s\n", keystrokes, total / keystrokes, worst, ok ? "OK" : "MISMATCH");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,282 @@
+// Замер обхода дерева папок слоёв (LayerHelper::GetLayersList) на синтетическом дереве.
+// Archicad API заменён моделью: дерево папок в памяти, каждый «вызов API» считается.
+// Сравниваются прежний рекурсивный обход (линейный поиск по обработанным путям, сборка
+// пути заново на каждом уровне, GetFolder по пути и запрос каждого слоя по GUID) и
+// обход явным стеком (хеш посещённых, путь от родителя, один пакетный запрос слоёв).
+// Оба обхода должны вернуть одинаковый список.
+//
+// Сборка (Linux / macOS):
+//   g++ -std=c++17 -O2 LayerTreeBench.cpp -o layer_tree_bench
+// Запуск:
+//   ./layer_tree_bench [слоёв] [глубина] [ветвление]      по умолчанию 10000 8 3
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double SecondsSince (Clock::time_point started)
+{
+	return std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+// ---------------- Модель API ----------------
+
+struct Folder {
+	uint64_t					guid = 0;
+	std::vector<std::string>	path;			// полный путь, первый элемент — "Слои"
+	std::vector<size_t>			subFolders;
+	std::vector<uint64_t>		layers;
+};
+
+struct ApiModel {
+	std::vector<Folder>									folders;		// 0 — корень
+	std::unordered_map<uint64_t, std::string>			layerNames;
+	std::unordered_map<std::string, size_t>				folderByPath;	// как ищет ACAPI_Attribute_GetFolder
+	mutable uint64_t									calls = 0;
+
+	static std::string Key (const std::vector<std::string>& path)
+	{
+		std::string key;
+		for (const std::string& part : path) {
+			key += part;
+			key += '\x1F';
+		}
+		return key;
+	}
+
+	bool GetFolder (const std::vector<std::string>& path, size_t& folder) const
+	{
+		++calls;
+		const auto found = folderByPath.find(Key(path));
+		if (found == folderByPath.end()) {
+			return false;
+		}
+		folder = found->second;
+		return true;
+	}
+
+	const Folder& GetFolderContent (size_t folder) const
+	{
+		++calls;
+		return folders[folder];
+	}
+
+	bool GetAttribute (uint64_t guid, std::string& name) const
+	{
+		++calls;
+		const auto found = layerNames.find(guid);
+		if (found == layerNames.end()) {
+			return false;
+		}
+		name = found->second;
+		return true;
+	}
+
+	std::vector<std::pair<uint64_t, std::string>> GetAttributesByType () const
+	{
+		++calls;
+		std::vector<std::pair<uint64_t, std::string>> result(layerNames.begin(), layerNames.end());
+		return result;
+	}
+};
+
+static ApiModel BuildTree (uint32_t layerCount, uint32_t depth, uint32_t branching)
+{
+	ApiModel api;
+	Folder root;
+	root.path.push_back("Слои");
+	api.folders.push_back(root);
+	api.folderByPath.emplace(ApiModel::Key(root.path), 0);
+
+	std::vector<size_t> level(1, 0);
+	for (uint32_t d = 0; d < depth; ++d) {
+		std::vector<size_t> next;
+		for (size_t parent : level) {
+			for (uint32_t b = 0; b < branching; ++b) {
+				Folder folder;
+				folder.guid = api.folders.size();
+				folder.path = api.folders[parent].path;
+				folder.path.push_back("Папка " + std::to_string(d) + "-" + std::to_string(b));
+				const size_t index = api.folders.size();
+				api.folderByPath.emplace(ApiModel::Key(folder.path), index);
+				api.folders.push_back(folder);
+				api.folders[parent].subFolders.push_back(index);
+				next.push_back(index);
+			}
+		}
+		level.swap(next);
+	}
+
+	for (uint32_t i = 0; i < layerCount; ++i) {
+		const uint64_t guid = 1000000000ull + i;
+		const size_t folder = (static_cast<size_t>(i) * 7919u) % api.folders.size();
+		api.folders[folder].layers.push_back(guid);
+		api.layerNames.emplace(guid, "Слой " + std::to_string(i));
+	}
+	return api;
+}
+
+struct LayerInfo {
+	std::string	name;
+	std::string	folder;
+};
+
+static std::string RemoveRootFolderPrefix (const std::string& path)
+{
+	static const std::string prefix = "Слои/";
+	if (path.compare(0, prefix.size(), prefix) == 0) {
+		return path.substr(prefix.size());
+	}
+	return path == "Слои" ? std::string() : path;
+}
+
+static std::vector<std::string> RemoveRootFolderFromPath (const std::vector<std::string>& path)
+{
+	if (!path.empty() && path[0] == "Слои") {
+		return std::vector<std::string>(path.begin() + 1, path.end());
+	}
+	return path;
+}
+
+static std::string Join (const std::vector<std::string>& path)
+{
+	std::string result;
+	for (size_t i = 0; i < path.size(); ++i) {
+		if (i > 0) {
+			result += "/";
+		}
+		result += path[i];
+	}
+	return result;
+}
+
+// ---------------- Прежний обход ----------------
+
+static void OldRecursive (const ApiModel& api, const std::vector<std::string>& folderPath, std::string currentPathStr,
+	std::vector<LayerInfo>& layers, std::vector<std::string>& processedPaths)
+{
+	if (currentPathStr.empty() && !folderPath.empty()) {
+		currentPathStr = Join(folderPath);
+	}
+	for (const std::string& processed : processedPaths) {
+		if (processed == currentPathStr) {
+			return;
+		}
+	}
+	processedPaths.push_back(currentPathStr);
+
+	size_t folder = 0;
+	if (!folderPath.empty()) {
+		std::vector<std::string> fullPath(1, "Слои");
+		fullPath.insert(fullPath.end(), folderPath.begin(), folderPath.end());
+		if (!api.GetFolder(fullPath, folder)) {
+			return;
+		}
+	}
+	const Folder& content = api.GetFolderContent(folder);
+	for (uint64_t guid : content.layers) {
+		LayerInfo info;
+		if (api.GetAttribute(guid, info.name)) {
+			info.folder = RemoveRootFolderPrefix(currentPathStr);
+			layers.push_back(info);
+		}
+	}
+	for (size_t sub : content.subFolders) {
+		const std::vector<std::string>& subPath = api.folders[sub].path;
+		OldRecursive(api, RemoveRootFolderFromPath(subPath), RemoveRootFolderPrefix(Join(subPath)), layers, processedPaths);
+	}
+}
+
+static std::vector<LayerInfo> OldGetLayersList (const ApiModel& api)
+{
+	std::vector<LayerInfo> layers;
+	std::vector<std::string> processedPaths;
+	OldRecursive(api, std::vector<std::string>(), std::string(), layers, processedPaths);
+	return layers;
+}
+
+// ---------------- Новый обход ----------------
+
+static std::vector<LayerInfo> NewGetLayersList (const ApiModel& api)
+{
+	struct Pending {
+		size_t		folder;
+		std::string	path;
+	};
+
+	std::unordered_map<uint64_t, std::string> names;
+	for (auto& layer : api.GetAttributesByType()) {
+		names.emplace(layer.first, std::move(layer.second));
+	}
+
+	std::vector<LayerInfo> layers;
+	std::unordered_set<uint64_t> visited;
+	std::vector<Pending> stack(1, Pending { 0, std::string() });
+	bool isRoot = true;
+	while (!stack.empty()) {
+		const Pending current = std::move(stack.back());
+		stack.pop_back();
+		if (!isRoot && !visited.insert(api.folders[current.folder].guid).second) {
+			continue;
+		}
+		isRoot = false;
+
+		const Folder& content = api.GetFolderContent(current.folder);
+		for (uint64_t guid : content.layers) {
+			LayerInfo info;
+			info.folder = current.path;
+			const auto found = names.find(guid);
+			if (found != names.end()) {
+				info.name = found->second;
+			} else if (!api.GetAttribute(guid, info.name)) {
+				continue;
+			}
+			layers.push_back(std::move(info));
+		}
+		for (size_t i = content.subFolders.size(); i > 0; --i) {
+			const std::vector<std::string>& subPath = api.folders[content.subFolders[i - 1]].path;
+			Pending child { content.subFolders[i - 1], std::string() };
+			child.path = current.path.empty() ? Join(RemoveRootFolderFromPath(subPath)) : current.path + "/" + subPath.back();
+			stack.push_back(std::move(child));
+		}
+	}
+	return layers;
+}
+
+int main (int argc, char** argv)
+{
+	const uint32_t layerCount = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 10000u;
+	const uint32_t depth = (argc > 2) ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 8u;
+	const uint32_t branching = (argc > 3) ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 3u;
+
+	const ApiModel api = BuildTree(layerCount, depth, branching);
+	std::printf("folders: %zu, layers: %u, depth: %u\n", api.folders.size() - 1, layerCount, depth);
+
+	api.calls = 0;
+	Clock::time_point started = Clock::now();
+	const std::vector<LayerInfo> oldLayers = OldGetLayersList(api);
+	const double oldSeconds = SecondsSince(started);
+	const uint64_t oldCalls = api.calls;
+
+	api.calls = 0;
+	started = Clock::now();
+	const std::vector<LayerInfo> newLayers = NewGetLayersList(api);
+	const double newSeconds = SecondsSince(started);
+	const uint64_t newCalls = api.calls;
+
+	bool same = oldLayers.size() == newLayers.size();
+	for (size_t i = 0; same && i < oldLayers.size(); ++i) {
+		same = oldLayers[i].name == newLayers[i].name && oldLayers[i].folder == newLayers[i].folder;
+	}
+
+	std::printf("recursive: %.3f s, %llu API calls\n", oldSeconds, static_cast<unsigned long long>(oldCalls));
+	std::printf("iterative: %.3f s, %llu API calls\n", newSeconds, static_cast<unsigned long long>(newCalls));
+	std::printf("layers listed: %zu — %s\n", newLayers.size(), same ? "OK" : "MISMATCH");
+	return same ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// Замер сравнения снимков на синтетических данных.
+// Строит два снимка по N строк (по умолчанию 1 000 000): во втором 1% строк удалён,
+// 1% добавлен, у 5% изменено одно свойство и у 1% — слой. Затем сравнивает их и
+// проверяет, что счётчики совпадают с заложенными изменениями.
+//
+// Сборка (Linux / macOS):
+//   g++ -std=c++17 -O2 -I ../../Src SnapshotDiffBench.cpp ../../Src/SnapshotFile.cpp ../../Src/SnapshotDiff.cpp -o snapshot_diff_bench
+// Запуск:
+//   ./snapshot_diff_bench [строк] [папка для временных файлов]
+
+#include "SnapshotDiff.hpp"
+#include "SnapshotFile.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double SecondsSince (Clock::time_point started)
+{
+	return std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+struct Expected {
+	uint64_t	added = 0;
+	uint64_t	removed = 0;
+	uint64_t	changed = 0;
+	uint64_t	areaChanges = 0;
+	uint64_t	layerChanges = 0;
+};
+
+static std::vector<SnapshotFile::ColumnInfo> GetColumns ()
+{
+	return {
+		{ "guid", "GUID", SnapshotFile::ColumnKind::Guid },
+		{ "type", "Тип", SnapshotFile::ColumnKind::Text },
+		{ "id", "ID", SnapshotFile::ColumnKind::Text },
+		{ "layer", "Слой", SnapshotFile::ColumnKind::Text },
+		{ "6C1A2F3B-0000-4000-8000-000000000001", "Площадь", SnapshotFile::ColumnKind::Value },
+	};
+}
+
+static void AddRow (SnapshotFile::Writer& writer, const uint8_t guid[16], uint32_t id, uint32_t layer, double area)
+{
+	static const char* types[] = { "Стена", "Перекрытие", "Колонна", "Балка", "Объект" };
+	char text[64];
+
+	writer.SetGuid(0, guid);
+	writer.SetText(1, types[id % 5], std::strlen(types[id % 5]));
+	int length = std::snprintf(text, sizeof(text), "EL-%06u", id);
+	writer.SetText(2, text, static_cast<size_t>(length));
+	length = std::snprintf(text, sizeof(text), "Слой %02u", layer);
+	writer.SetText(3, text, static_cast<size_t>(length));
+	length = std::snprintf(text, sizeof(text), "%.2f", area);
+	writer.SetValue(4, text, static_cast<size_t>(length), true, area);
+	writer.EndRow();
+}
+
+static bool Save (const SnapshotFile::Writer& writer, const std::string& path)
+{
+	std::FILE* file = std::fopen(path.c_str(), "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	const bool ok = writer.Write(file, 0);
+	return (std::fclose(file) == 0) && ok;
+}
+
+int main (int argc, char** argv)
+{
+	const uint32_t rows = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000u;
+	const std::string folder = (argc > 2) ? argv[2] : ".";
+	const std::string oldPath = folder + "/bench_old.tssnap";
+	const std::string newPath = folder + "/bench_new.tssnap";
+
+	// Синтетические снимки
+	Clock::time_point started = Clock::now();
+	Expected expected;
+	{
+		std::mt19937_64 random(27);
+		SnapshotFile::Writer oldWriter(GetColumns());
+		SnapshotFile::Writer newWriter(GetColumns());
+		uint8_t guid[16];
+		for (uint32_t id = 0; id < rows; ++id) {
+			const uint64_t high = random();
+			const uint64_t low = random();
+			std::memcpy(guid, &high, 8);
+			std::memcpy(guid + 8, &low, 8);
+
+			const uint32_t layer = id % 40;
+			const double area = (id % 1000) * 0.25;
+			AddRow(oldWriter, guid, id, layer, area);
+
+			const uint32_t bucket = id % 100;
+			if (bucket == 0) {
+				++expected.removed;
+				continue;
+			}
+			const bool areaChanged = (bucket >= 1 && bucket <= 5);
+			const bool layerChanged = (bucket == 6);
+			expected.areaChanges += areaChanged ? 1 : 0;
+			expected.layerChanges += layerChanged ? 1 : 0;
+			expected.changed += (areaChanged || layerChanged) ? 1 : 0;
+			AddRow(newWriter, guid, id, layerChanged ? (layer + 1) % 40 : layer, areaChanged ? area + 1.0 : area);
+		}
+		for (uint32_t id = rows; id < rows + rows / 100; ++id) {
+			const uint64_t high = random();
+			const uint64_t low = random();
+			std::memcpy(guid, &high, 8);
+			std::memcpy(guid + 8, &low, 8);
+			AddRow(newWriter, guid, id, id % 40, 1.0);
+			++expected.added;
+		}
+		if (!Save(oldWriter, oldPath) || !Save(newWriter, newPath)) {
+			std::fprintf(stderr, "cannot write snapshots to %s\n", folder.c_str());
+			return 1;
+		}
+	}
+	std::printf("generate+write: %.2f s\n", SecondsSince(started));
+
+	// Открытие и сравнение
+	started = Clock::now();
+	SnapshotFile::Reader oldSnapshot;
+	SnapshotFile::Reader newSnapshot;
+	if (!oldSnapshot.Open(oldPath.c_str()) || !newSnapshot.Open(newPath.c_str())) {
+		std::fprintf(stderr, "cannot open snapshots\n");
+		return 1;
+	}
+	std::printf("open: %.4f s\n", SecondsSince(started));
+
+	SnapshotDiff::Engine engine(oldSnapshot, newSnapshot);
+	uint64_t visited = 0;
+	double best = 0.0;
+	for (int pass = 0; pass < 3; ++pass) {
+		visited = 0;
+		started = Clock::now();
+		engine.Run([&visited] (const SnapshotDiff::RowDiff&) { ++visited; });
+		const double seconds = SecondsSince(started);
+		best = (pass == 0 || seconds < best) ? seconds : best;
+		std::printf("diff pass %d: %.3f s\n", pass + 1, seconds);
+	}
+
+	const SnapshotDiff::Summary& summary = engine.GetSummary();
+	std::printf("rows old/new: %u / %u\n", oldSnapshot.GetRowCount(), newSnapshot.GetRowCount());
+	std::printf("added %llu, removed %llu, changed %llu, unchanged %llu, visited %llu\n",
+		static_cast<unsigned long long>(summary.added), static_cast<unsigned long long>(summary.removed),
+		static_cast<unsigned long long>(summary.changed), static_cast<unsigned long long>(summary.unchanged),
+		static_cast<unsigned long long>(visited));
+	for (const SnapshotDiff::ColumnPair& column : summary.columns) {
+		std::printf("  %s: %llu\n", column.name.c_str(), static_cast<unsigned long long>(column.changes));
+	}
+
+	uint64_t areaChanges = 0;
+	uint64_t layerChanges = 0;
+	for (const SnapshotDiff::ColumnPair& column : summary.columns) {
+		areaChanges += (column.token == "6C1A2F3B-0000-4000-8000-000000000001") ? column.changes : 0;
+		layerChanges += (column.token == "layer") ? column.changes : 0;
+	}
+	const bool ok = summary.added == expected.added && summary.removed == expected.removed &&
+		summary.changed == expected.changed && areaChanges == expected.areaChanges && layerChanges == expected.layerChanges &&
+		visited == expected.added + expected.removed + expected.changed;
+
+	std::remove(oldPath.c_str());
+	std::remove(newPath.c_str());
+
+	std::printf("best diff: %.3f s (%.1f M rows/s) — %s\n", best, best > 0.0 ? rows / best / 1e6 : 0.0, ok ? "OK" : "MISMATCH");
+	return ok ? 0 : 1;
+}
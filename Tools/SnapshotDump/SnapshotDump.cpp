@@ -0,0 +1,152 @@
+// Чтение снимков выделения (.tssnap) вне Archicad — для скриптов проверки.
+//
+// Сборка (Linux / macOS):
+//   g++ -std=c++17 -O2 -I ../../Src SnapshotDump.cpp ../../Src/SnapshotFile.cpp ../../Src/SnapshotDiff.cpp -o snapshot_dump
+// Сборка (Windows, Developer Command Prompt):
+//   cl /std:c++17 /O2 /EHsc /I ..\..\Src SnapshotDump.cpp ..\..\Src\SnapshotFile.cpp ..\..\Src\SnapshotDiff.cpp
+//
+// Использование:
+//   snapshot_dump <файл.tssnap>                  все строки в TSV (первая строка — заголовки)
+//   snapshot_dump <файл.tssnap> --info           число строк, колонки, размеры словарей
+//   snapshot_dump <файл.tssnap> --guid <GUID>    одна строка по GUID (через индекс)
+//   snapshot_dump <файл.tssnap> --limit <N>      первые N строк
+//   snapshot_dump <старый.tssnap> --diff <новый.tssnap>
+//                                                сводка и отличающиеся строки: статус, GUID, изменённые колонки
+
+#include "SnapshotDiff.hpp"
+#include "SnapshotFile.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static void PrintField (std::string_view text)
+{
+	// Табуляции и переводы строк внутри значения ломают TSV — заменяем пробелами
+	for (char c : text) {
+		std::putchar((c == '\t' || c == '\n' || c == '\r') ? ' ' : c);
+	}
+}
+
+static void PrintRow (const SnapshotFile::Reader& reader, uint32_t row)
+{
+	for (uint32_t c = 0; c < reader.GetColumnCount(); ++c) {
+		if (c > 0) {
+			std::putchar('\t');
+		}
+		double number = 0.0;
+		if (reader.GetColumnKind(c) == SnapshotFile::ColumnKind::Guid) {
+			std::fputs(SnapshotFile::FormatGuid(reader.GetGuid(row)).c_str(), stdout);
+		} else if (reader.GetNumber(c, row, number)) {
+			std::printf("%.15g", number);
+		} else {
+			PrintField(reader.GetText(c, row));
+		}
+	}
+	std::putchar('\n');
+}
+
+static void PrintInfo (const SnapshotFile::Reader& reader)
+{
+	static const char* kindNames[] = { "?", "guid", "text", "value" };
+	std::printf("rows\t%u\ncolumns\t%u\ncreated\t%llu\n", reader.GetRowCount(), reader.GetColumnCount(),
+		static_cast<unsigned long long>(reader.GetCreatedTime()));
+	for (uint32_t c = 0; c < reader.GetColumnCount(); ++c) {
+		const uint32_t kind = static_cast<uint32_t>(reader.GetColumnKind(c));
+		std::printf("column\t%u\t%s\t", c, kindNames[kind <= 3 ? kind : 0]);
+		PrintField(reader.GetColumnToken(c));
+		std::putchar('\t');
+		PrintField(reader.GetColumnName(c));
+		std::printf("\t%u\n", reader.GetDictionarySize(c));
+	}
+}
+
+static int PrintDiff (const SnapshotFile::Reader& oldSnapshot, const char* newPath)
+{
+	SnapshotFile::Reader newSnapshot;
+	if (!newSnapshot.Open(newPath)) {
+		std::fprintf(stderr, "cannot open snapshot: %s\n", newPath);
+		return 1;
+	}
+
+	SnapshotDiff::Engine engine(oldSnapshot, newSnapshot);
+	const SnapshotDiff::Summary& summary = engine.GetSummary();
+	const bool ok = engine.Run([&summary] (const SnapshotDiff::RowDiff& diff) {
+		std::printf("%s\t%s\t", SnapshotDiff::GetStatusName(diff.status), SnapshotFile::FormatGuid(diff.guid).c_str());
+		if (diff.changedColumns != nullptr) {
+			for (size_t i = 0; i < diff.changedColumns->size(); ++i) {
+				if (i > 0) {
+					std::putchar(',');
+				}
+				PrintField(summary.columns[(*diff.changedColumns)[i]].name);
+			}
+		}
+		std::putchar('\n');
+	});
+	if (!ok) {
+		std::fprintf(stderr, "snapshots without GUID index cannot be compared\n");
+		return 1;
+	}
+
+	std::fprintf(stderr, "added %llu, removed %llu, changed %llu, unchanged %llu\n",
+		static_cast<unsigned long long>(summary.added), static_cast<unsigned long long>(summary.removed),
+		static_cast<unsigned long long>(summary.changed), static_cast<unsigned long long>(summary.unchanged));
+	for (const SnapshotDiff::ColumnPair& column : summary.columns) {
+		std::fprintf(stderr, "  %s: %llu\n", column.name.c_str(), static_cast<unsigned long long>(column.changes));
+	}
+	return 0;
+}
+
+int main (int argc, char** argv)
+{
+	if (argc < 2) {
+		std::fprintf(stderr, "usage: %s <file.tssnap> [--info | --guid <GUID> | --limit <N> | --diff <new.tssnap>]\n", argv[0]);
+		return 2;
+	}
+
+	SnapshotFile::Reader reader;
+	if (!reader.Open(argv[1])) {
+		std::fprintf(stderr, "cannot open snapshot: %s\n", argv[1]);
+		return 1;
+	}
+
+	uint32_t limit = reader.GetRowCount();
+	for (int i = 2; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--info") == 0) {
+			PrintInfo(reader);
+			return 0;
+		}
+		if (std::strcmp(argv[i], "--diff") == 0 && i + 1 < argc) {
+			return PrintDiff(reader, argv[i + 1]);
+		}
+		if (std::strcmp(argv[i], "--guid") == 0 && i + 1 < argc) {
+			uint8_t guid[16];
+			uint32_t row = 0;
+			if (!SnapshotFile::ParseGuid(argv[i + 1], guid) || !reader.FindRow(guid, row)) {
+				std::fprintf(stderr, "not found: %s\n", argv[i + 1]);
+				return 1;
+			}
+			PrintRow(reader, row);
+			return 0;
+		}
+		if (std::strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+			const unsigned long value = std::strtoul(argv[++i], nullptr, 10);
+			if (value < limit) {
+				limit = static_cast<uint32_t>(value);
+			}
+		}
+	}
+
+	for (uint32_t c = 0; c < reader.GetColumnCount(); ++c) {
+		if (c > 0) {
+			std::putchar('\t');
+		}
+		PrintField(reader.GetColumnName(c));
+	}
+	std::putchar('\n');
+	for (uint32_t row = 0; row < limit; ++row) {
+		PrintRow(reader, row);
+	}
+	return 0;
+}
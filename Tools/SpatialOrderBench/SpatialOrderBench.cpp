@@ -0,0 +1,256 @@
+// Замер и проверка порядка обхода точек (SpatialOrder) на синтетических координатах.
+// Строит N точек (по умолчанию 100 000): посадки рядами с разбросом и случайные точки,
+// упорядочивает каждым способом и печатает время и длину маршрута в сравнении с исходным
+// порядком. Проверки:
+//   - результат каждого способа — перестановка всех точек;
+//   - кривая Гильберта на сетке 64 × 64 проходит клетки по соседним;
+//   - «змейка» по рядам посадок выдаёт ряды целиком, сверху вниз;
+//   - маршрут к ближайшей точке совпадает с полным перебором (на 3 000 точек, в том числе с выбросами);
+//   - одна точка за 1 000 км не замедляет способы и не удлиняет маршрут остальных точек;
+//   - точки с NaN и бесконечностью в координатах идут в конце по номеру.
+//
+// Сборка (Linux / macOS):
+//   g++ -std=c++17 -O2 -I ../../Src SpatialOrderBench.cpp ../../Src/SpatialOrder.cpp -o spatial_order_bench
+// Запуск:
+//   ./spatial_order_bench [точек]
+
+#include "SpatialOrder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static double MillisecondsSince (Clock::time_point started)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+}
+
+static double PathLength (const std::vector<SpatialOrder::Point>& points, const std::vector<uint32_t>& order)
+{
+	double length = 0.0;
+	for (size_t i = 1; i < order.size(); ++i) {
+		length += std::hypot(points[order[i]].x - points[order[i - 1]].x, points[order[i]].y - points[order[i - 1]].y);
+	}
+	return length;
+}
+
+static bool IsPermutation (const std::vector<uint32_t>& order, size_t count)
+{
+	if (order.size() != count) {
+		return false;
+	}
+	std::vector<bool> seen(count, false);
+	for (const uint32_t index : order) {
+		if (index >= count || seen[index]) {
+			return false;
+		}
+		seen[index] = true;
+	}
+	return true;
+}
+
+// Ряды посадок: rows рядов через 6 м, в ряду шаг 4 м, разброс ±0,5 м; остальное — случайно
+static std::vector<SpatialOrder::Point> MakePoints (uint32_t count, uint32_t rows, std::mt19937& random)
+{
+	std::uniform_real_distribution<double> jitter(-0.5, 0.5);
+	std::vector<SpatialOrder::Point> points;
+	points.reserve(count);
+	const uint32_t planted = count / 2;
+	const uint32_t perRow = (planted + rows - 1) / rows;
+	for (uint32_t i = 0; i < planted; ++i) {
+		SpatialOrder::Point point;
+		point.x = (i % perRow) * 4.0 + jitter(random);
+		point.y = (i / perRow) * 6.0 + jitter(random);
+		points.push_back(point);
+	}
+	const double width = perRow * 4.0;
+	const double height = rows * 6.0;
+	std::uniform_real_distribution<double> x(0.0, width);
+	std::uniform_real_distribution<double> y(height + 10.0, height * 2.0 + 10.0);
+	while (points.size() < count) {
+		SpatialOrder::Point point;
+		point.x = x(random);
+		point.y = y(random);
+		points.push_back(point);
+	}
+	std::shuffle(points.begin(), points.end(), random);
+	return points;
+}
+
+static bool CheckHilbertGrid ()
+{
+	const uint32_t bits = 6;
+	const uint32_t side = 1u << bits;
+	std::vector<uint32_t> cellAt(side * side, UINT32_MAX);
+	for (uint32_t y = 0; y < side; ++y) {
+		for (uint32_t x = 0; x < side; ++x) {
+			const uint64_t index = SpatialOrder::HilbertIndex(x, y, bits);
+			if (index >= cellAt.size() || cellAt[index] != UINT32_MAX) {
+				return false;
+			}
+			cellAt[index] = y * side + x;
+		}
+	}
+	for (size_t i = 1; i < cellAt.size(); ++i) {
+		const int dx = std::abs(static_cast<int>(cellAt[i] % side) - static_cast<int>(cellAt[i - 1] % side));
+		const int dy = std::abs(static_cast<int>(cellAt[i] / side) - static_cast<int>(cellAt[i - 1] / side));
+		if (dx + dy != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool CheckRows (std::mt19937& random)
+{
+	// Только посадки: 10 рядов по 30 деревьев
+	std::uniform_real_distribution<double> jitter(-0.5, 0.5);
+	std::vector<SpatialOrder::Point> points;
+	for (uint32_t i = 0; i < 300; ++i) {
+		points.push_back({ (i % 30) * 4.0 + jitter(random), (i / 30) * 6.0 + jitter(random) });
+	}
+	const std::vector<uint32_t> order = SpatialOrder::Order(points, SpatialOrder::Method::Rows, 2.0);
+	for (size_t i = 0; i < order.size(); ++i) {
+		const uint32_t expectedRow = 9 - static_cast<uint32_t>(i / 30);
+		const uint32_t expectedColumn = ((i / 30) % 2 == 0) ? static_cast<uint32_t>(i % 30) : 29 - static_cast<uint32_t>(i % 30);
+		if (order[i] / 30 != expectedRow || order[i] % 30 != expectedColumn) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool CheckNearestPath (const std::vector<SpatialOrder::Point>& points)
+{
+	const std::vector<uint32_t> order = SpatialOrder::Order(points, SpatialOrder::Method::NearestPath);
+	if (!IsPermutation(order, points.size())) {
+		return false;
+	}
+	std::vector<bool> visited(points.size(), false);
+	visited[order[0]] = true;
+	for (size_t i = 1; i < order.size(); ++i) {
+		const SpatialOrder::Point& from = points[order[i - 1]];
+		uint32_t best = UINT32_MAX;
+		double bestDistance = 0.0;
+		for (uint32_t j = 0; j < points.size(); ++j) {
+			if (visited[j]) {
+				continue;
+			}
+			const double dx = points[j].x - from.x;
+			const double dy = points[j].y - from.y;
+			const double distance = dx * dx + dy * dy;
+			if (best == UINT32_MAX || distance < bestDistance || (distance == bestDistance && j < best)) {
+				best = j;
+				bestDistance = distance;
+			}
+		}
+		if (best != order[i]) {
+			std::printf("path mismatch at step %zu: %u vs %u\n", i, order[i], best);
+			return false;
+		}
+		visited[best] = true;
+	}
+	return true;
+}
+
+// Путь без перехода к выбросу и обратно: выбросы — последние outliers точек
+static double PathLengthWithout (const std::vector<SpatialOrder::Point>& points, const std::vector<uint32_t>& order, size_t outliers)
+{
+	std::vector<uint32_t> kept;
+	kept.reserve(order.size());
+	for (const uint32_t index : order) {
+		if (index < points.size() - outliers) {
+			kept.push_back(index);
+		}
+	}
+	return PathLength(points, kept);
+}
+
+// Одна точка далеко от участка: время и длина маршрута по остальным — почти как без неё
+static bool CheckOutlier (const std::vector<SpatialOrder::Point>& points, const char* name, SpatialOrder::Method method)
+{
+	std::vector<SpatialOrder::Point> withOutlier = points;
+	withOutlier.push_back({ 1.0e6, 1.0e6 });
+
+	Clock::time_point started = Clock::now();
+	const double plainLength = PathLength(points, SpatialOrder::Order(points, method));
+	const double plainTime = MillisecondsSince(started);
+	started = Clock::now();
+	const std::vector<uint32_t> order = SpatialOrder::Order(withOutlier, method);
+	const double outlierTime = MillisecondsSince(started);
+	const double outlierLength = PathLengthWithout(withOutlier, order, 1);
+
+	const bool valid = IsPermutation(order, withOutlier.size()) && outlierLength <= plainLength * 1.1 && outlierTime <= plainTime * 3.0 + 20.0;
+	std::printf("%-13s with outlier %8.2f ms (%.2f), path %10.0f m (%.0f)%s\n", name, outlierTime, plainTime,
+		outlierLength, plainLength, valid ? "" : " — DEGRADED");
+	return valid;
+}
+
+static bool CheckNonFinite (std::mt19937& random)
+{
+	std::vector<SpatialOrder::Point> points = MakePoints(1000, 10, random);
+	points[3].x = std::nan("");
+	points[500].y = std::numeric_limits<double>::infinity();
+	points[999] = { -std::numeric_limits<double>::infinity(), std::nan("") };
+	for (const SpatialOrder::Method method : { SpatialOrder::Method::Hilbert, SpatialOrder::Method::Rows, SpatialOrder::Method::NearestPath }) {
+		const std::vector<uint32_t> order = SpatialOrder::Order(points, method);
+		if (!IsPermutation(order, points.size()) || order[997] != 3 || order[998] != 500 || order[999] != 999) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main (int argc, char** argv)
+{
+	const uint32_t count = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 100000u;
+
+	std::mt19937 random(46);
+	const std::vector<SpatialOrder::Point> points = MakePoints(count, 100, random);
+	std::vector<uint32_t> identity(points.size());
+	for (uint32_t i = 0; i < identity.size(); ++i) {
+		identity[i] = i;
+	}
+	std::printf("points: %u, path in input order: %.0f m\n", count, PathLength(points, identity));
+
+	bool ok = true;
+	const struct { SpatialOrder::Method method; const char* name; } methods[] = {
+		{ SpatialOrder::Method::Hilbert, "hilbert" },
+		{ SpatialOrder::Method::Rows, "rows" },
+		{ SpatialOrder::Method::NearestPath, "nearest path" },
+	};
+	for (const auto& item : methods) {
+		const Clock::time_point started = Clock::now();
+		const std::vector<uint32_t> order = SpatialOrder::Order(points, item.method);
+		const double elapsed = MillisecondsSince(started);
+		const bool valid = IsPermutation(order, points.size());
+		ok = ok && valid;
+		std::printf("%-13s %8.2f ms, path %10.0f m%s\n", item.name, elapsed, PathLength(points, order), valid ? "" : " — NOT A PERMUTATION");
+	}
+
+	for (const auto& item : methods) {
+		ok = CheckOutlier(points, item.name, item.method) && ok;
+	}
+
+	const bool hilbert = CheckHilbertGrid();
+	const bool rows = CheckRows(random);
+	std::vector<SpatialOrder::Point> sample = MakePoints(3000, 20, random);
+	const bool path = CheckNearestPath(sample);
+	sample.push_back({ 5.0e5, -3.0e5 });
+	sample.push_back({ -1.0e6, 2.0e4 });
+	sample.push_back({ 40.0, 1.0e6 });
+	const bool pathOutliers = CheckNearestPath(sample);
+	const bool nonFinite = CheckNonFinite(random);
+	std::printf("hilbert grid %s, rows %s, nearest path vs brute force %s, with outliers %s, non-finite %s\n",
+		hilbert ? "OK" : "FAIL", rows ? "OK" : "FAIL", path ? "OK" : "FAIL", pathOutliers ? "OK" : "FAIL", nonFinite ? "OK" : "FAIL");
+	ok = ok && hilbert && rows && path && pathOutliers && nonFinite;
+	std::printf("%s\n", ok ? "OK" : "FAILED");
+	return ok ? 0 : 1;
+}
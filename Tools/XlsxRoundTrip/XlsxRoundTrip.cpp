@@ -0,0 +1,472 @@
+// Проверка XLSX (XlsxWriter, ZipWriter, DeflateEncoder) чтением обратно и замер записи.
+// Пишет N строк (по умолчанию 200 000) по 7 колонок двумя способами — ячейками (WriteField)
+// и пачками (FormatChunk, как конвейер экспорта), затем читает каждый файл как ZIP:
+//   - каталог архива разбирается по EOCD, у каждой записи сверяется локальный заголовок;
+//   - каждая часть распаковывается zlib (независимо от нашего DeflateEncoder),
+//     размер и CRC-32 сверяются с каталогом;
+//   - лист и sharedStrings разбираются, каждая ячейка каждой строки сверяется с исходной;
+//   - имя листа с кавычками и &<> в workbook.xml экранировано как значение атрибута.
+// Печатает время записи и проверки, размер файла и степень сжатия.
+//
+// Сборка (Linux / macOS, нужен zlib — только для проверки):
+//   g++ -std=c++17 -O2 -I ../../Src XlsxRoundTrip.cpp ../../Src/XlsxWriter.cpp ../../Src/ZipWriter.cpp ../../Src/DeflateEncoder.cpp ../../Src/TableWriter.cpp -lz -o xlsx_round_trip
+// Запуск:
+//   ./xlsx_round_trip [строк]
+
+#include "XlsxWriter.hpp"
+
+#include <zlib.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint32_t ColumnCount = 7;
+static const uint32_t ChunkRows = 4096;
+static const char* const SheetName = "План \"А\" & <сад> '1'";
+static const char* const EscapedSheetName = "План &quot;А&quot; &amp; &lt;сад&gt; &apos;1&apos;";
+
+static double SecondsSince (Clock::time_point started)
+{
+	return std::chrono::duration<double>(Clock::now() - started).count();
+}
+
+// ---------------- Исходные данные ----------------
+struct Cell {
+	bool		number = false;
+	std::string	text;
+	double		value = 0.0;
+};
+
+static std::vector<Cell> MakeRow (uint32_t index)
+{
+	static const char* const types[] = { "Объект", "Лампа", "Колонна", "Стена" };
+	static const char* const layers[] = { "Озеленение", "Освещение", "Конструкции", "МАФ" };
+	std::vector<Cell> row(ColumnCount);
+	if (index == 0) {
+		const char* const headers[] = { "GUID", "Тип", "ID", "Слой", "Примечание", "Площадь", "Высота" };
+		for (uint32_t column = 0; column < ColumnCount; ++column) {
+			row[column].text = headers[column];
+		}
+		return row;
+	}
+
+	char guid[48];
+	std::snprintf(guid, sizeof(guid), "%08X-%04X-4%03X-8%03X-%012X", index * 2654435761u, index & 0xFFFF, index & 0xFFF, (index >> 12) & 0xFFF, index);
+	row[0].text = guid;
+	row[1].text = types[index % 4];
+	row[2].text = "T-" + std::to_string(index);
+	row[3].text = layers[(index / 7) % 4];
+	// Экранирование, пробелы по краям (xml:space) и пустые ячейки
+	switch (index % 5) {
+		case 0:		row[4].text = "<a & b> \"кавычки\" 'апострофы'"; break;
+		case 1:		row[4].text = " пробел по краям "; break;
+		case 2:		row[4].text = "строка 1\nстрока 2"; break;
+		default:	break;
+	}
+	row[5].number = true;
+	row[5].value = index * 0.125;
+	row[6].number = true;
+	row[6].value = -static_cast<double>(index % 1000) / 3.0;
+	return row;
+}
+
+// Так ячейку должен прочитать Excel: текст как есть, число — как его форматирует писатель
+static std::string ExpectedText (const Cell& cell)
+{
+	if (!cell.number) {
+		return cell.text;
+	}
+	char text[64];
+	const size_t length = TableWriter::FormatNumber(cell.value, 3, text, sizeof(text));
+	return std::string(text, length);
+}
+
+// ---------------- Запись ----------------
+static XlsxWriter::Options MakeOptions ()
+{
+	XlsxWriter::Options options;
+	options.sheetName = SheetName;
+	return options;
+}
+
+static bool WriteCells (std::FILE* file, uint32_t rowCount)
+{
+	XlsxWriter writer(file, MakeOptions());
+	for (uint32_t i = 0; i < rowCount; ++i) {
+		for (const Cell& cell : MakeRow(i)) {
+			if (cell.number) {
+				writer.WriteNumber(cell.value, 3);
+			} else {
+				writer.WriteField(cell.text);
+			}
+		}
+		writer.EndRow();
+	}
+	return writer.Finish();
+}
+
+// Повторяющиеся колонки (тип, слой, примечание) — общими строками, остальное inline, как в экспорте
+static bool WriteChunks (std::FILE* file, uint32_t rowCount)
+{
+	XlsxWriter writer(file, MakeOptions());
+	RowChunk chunk;
+	chunk.columnCount = ColumnCount;
+	for (uint32_t i = 0; i < rowCount; ++i) {
+		const std::vector<Cell> row = MakeRow(i);
+		for (uint32_t column = 0; column < ColumnCount; ++column) {
+			const Cell& cell = row[column];
+			uint32_t index = 0;
+			if (cell.number) {
+				chunk.AddNumber(cell.value, 3);
+			} else if (cell.text.empty()) {
+				chunk.AddEmpty();
+			} else if ((column == 1 || column == 3 || column == 4) && writer.InternString(cell.text.data(), cell.text.size(), index)) {
+				chunk.AddSharedString(index);
+			} else {
+				chunk.AddText(cell.text.data(), cell.text.size());
+			}
+		}
+		if (chunk.GetRowCount() == ChunkRows || i + 1 == rowCount) {
+			chunk.firstRow = writer.GetNextRow();
+			writer.WriteChunk(writer.FormatChunk(chunk));
+			chunk.Clear();
+		}
+	}
+	return writer.Finish();
+}
+
+// ---------------- Чтение ZIP ----------------
+static uint32_t Get16 (const std::string& data, size_t position)
+{
+	return static_cast<uint8_t>(data[position]) | (static_cast<uint32_t>(static_cast<uint8_t>(data[position + 1])) << 8);
+}
+
+static uint32_t Get32 (const std::string& data, size_t position)
+{
+	return Get16(data, position) | (Get16(data, position + 2) << 16);
+}
+
+struct Part {
+	std::string	name;
+	std::string	content;
+};
+
+static bool Inflate (const std::string& compressed, uint32_t expectedSize, std::string& out)
+{
+	z_stream stream = {};
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+		return false;
+	}
+	out.assign(expectedSize, '\0');
+	stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.data()));
+	stream.avail_in = static_cast<uInt>(compressed.size());
+	stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+	stream.avail_out = static_cast<uInt>(out.size());
+	const int result = inflate(&stream, Z_FINISH);
+	const bool ok = result == Z_STREAM_END && stream.total_out == expectedSize && stream.avail_in == 0;
+	inflateEnd(&stream);
+	return ok;
+}
+
+// Все части архива; проверяет каталог, локальные заголовки, размеры и CRC
+static bool ReadZip (const std::string& data, std::vector<Part>& parts)
+{
+	if (data.size() < 22) {
+		return false;
+	}
+	size_t eocd = data.size() - 22;
+	while (Get32(data, eocd) != 0x06054b50) {
+		if (eocd == 0 || data.size() - eocd > 22 + 65535) {
+			std::printf("zip: end of central directory not found\n");
+			return false;
+		}
+		--eocd;
+	}
+	const uint32_t entryCount = Get16(data, eocd + 10);
+	size_t position = Get32(data, eocd + 16);
+	for (uint32_t i = 0; i < entryCount; ++i) {
+		if (position + 46 > data.size() || Get32(data, position) != 0x02014b50) {
+			std::printf("zip: bad central directory entry %u\n", i);
+			return false;
+		}
+		const uint32_t method = Get16(data, position + 10);
+		const uint32_t crc = Get32(data, position + 16);
+		const uint32_t compressedSize = Get32(data, position + 20);
+		const uint32_t size = Get32(data, position + 24);
+		const uint32_t nameLength = Get16(data, position + 28);
+		const uint32_t skip = Get16(data, position + 30) + Get16(data, position + 32);
+		const uint32_t local = Get32(data, position + 42);
+		Part part;
+		part.name = data.substr(position + 46, nameLength);
+		position += 46 + nameLength + skip;
+
+		if (local + 30 > data.size() || Get32(data, local) != 0x04034b50 ||
+			data.compare(local + 30, Get16(data, local + 26), part.name) != 0) {
+			std::printf("zip: bad local header of %s\n", part.name.c_str());
+			return false;
+		}
+		const size_t dataStart = local + 30 + Get16(data, local + 26) + Get16(data, local + 28);
+		if (dataStart + compressedSize > data.size()) {
+			std::printf("zip: %s is truncated\n", part.name.c_str());
+			return false;
+		}
+		const std::string compressed = data.substr(dataStart, compressedSize);
+		if (method == 8) {
+			if (!Inflate(compressed, size, part.content)) {
+				std::printf("zip: cannot inflate %s\n", part.name.c_str());
+				return false;
+			}
+		} else if (method == 0 && compressedSize == size) {
+			part.content = compressed;
+		} else {
+			std::printf("zip: %s has method %u\n", part.name.c_str(), method);
+			return false;
+		}
+		const uint32_t actualCrc = static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(part.content.data()), static_cast<uInt>(part.content.size())));
+		if (actualCrc != crc) {
+			std::printf("zip: CRC mismatch in %s: %08X vs %08X\n", part.name.c_str(), actualCrc, crc);
+			return false;
+		}
+		parts.push_back(part);
+	}
+	return true;
+}
+
+// ---------------- Разбор XML ----------------
+static bool StartsWith (const std::string& text, size_t position, const char* prefix)
+{
+	return text.compare(position, std::strlen(prefix), prefix) == 0;
+}
+
+static std::string Unescape (const std::string& text, size_t begin, size_t end)
+{
+	static const struct { const char* entity; char c; } entities[] = {
+		{ "&amp;", '&' }, { "&lt;", '<' }, { "&gt;", '>' }, { "&quot;", '"' }, { "&apos;", '\'' },
+	};
+	std::string result;
+	result.reserve(end - begin);
+	for (size_t i = begin; i < end; ) {
+		bool replaced = false;
+		if (text[i] == '&') {
+			for (const auto& item : entities) {
+				const size_t length = std::strlen(item.entity);
+				if (text.compare(i, length, item.entity) == 0) {
+					result.push_back(item.c);
+					i += length;
+					replaced = true;
+					break;
+				}
+			}
+		}
+		if (!replaced) {
+			result.push_back(text[i++]);
+		}
+	}
+	return result;
+}
+
+// Текст первого <t> после position (до limit); position — за </t>
+static bool ReadTextElement (const std::string& xml, size_t& position, size_t limit, std::string& text)
+{
+	const size_t open = xml.find("<t", position);
+	if (open == std::string::npos || open >= limit) {
+		return false;
+	}
+	const size_t begin = xml.find('>', open) + 1;
+	const size_t end = xml.find("</t>", begin);
+	if (end == std::string::npos || end > limit) {
+		return false;
+	}
+	const bool preserve = StartsWith(xml, open, "<t xml:space=\"preserve\">");
+	text = Unescape(xml, begin, end);
+	if (!preserve && !text.empty() && (std::strchr(" \t\r\n", text.front()) != nullptr || std::strchr(" \t\r\n", text.back()) != nullptr)) {
+		std::printf("xml: text with edge spaces without xml:space=\"preserve\"\n");
+		return false;
+	}
+	position = end + 4;
+	return true;
+}
+
+static std::string ColumnName (uint32_t column)
+{
+	std::string name;
+	for (uint32_t index = column + 1; index > 0; index = (index - 1) / 26) {
+		name.insert(name.begin(), static_cast<char>('A' + (index - 1) % 26));
+	}
+	return name;
+}
+
+static bool ReadSharedStrings (const std::string& xml, std::vector<std::string>& strings)
+{
+	size_t position = 0;
+	while ((position = xml.find("<si>", position)) != std::string::npos) {
+		const size_t end = xml.find("</si>", position);
+		std::string text;
+		if (end == std::string::npos || !ReadTextElement(xml, position, end, text)) {
+			return false;
+		}
+		strings.push_back(text);
+		position = end + 5;
+	}
+	return true;
+}
+
+// Каждая строка листа против MakeRow: номера строк и ячеек, стиль заголовка, значения
+static bool CheckSheet (const std::string& xml, const std::vector<std::string>& strings, uint32_t rowCount)
+{
+	size_t position = xml.find("<sheetData>");
+	if (position == std::string::npos || xml.find("</sheetData></worksheet>") == std::string::npos) {
+		std::printf("sheet: no sheetData\n");
+		return false;
+	}
+	for (uint32_t i = 0; i < rowCount; ++i) {
+		const std::string rowNumber = std::to_string(i + 1);
+		const std::string rowOpen = "<row r=\"" + rowNumber + "\">";
+		position = xml.find("<row", position);
+		if (position == std::string::npos || xml.compare(position, rowOpen.size(), rowOpen) != 0) {
+			std::printf("sheet: row %u not found in order\n", i + 1);
+			return false;
+		}
+		const size_t rowEnd = xml.find("</row>", position);
+		position += rowOpen.size();
+
+		const std::vector<Cell> row = MakeRow(i);
+		for (uint32_t column = 0; column < ColumnCount; ++column) {
+			const std::string expected = ExpectedText(row[column]);
+			if (expected.empty()) {
+				continue;
+			}
+			std::string cellOpen = "<c r=\"" + ColumnName(column) + rowNumber + "\"";
+			if (i == 0) {
+				cellOpen += " s=\"1\"";
+			}
+			if (xml.compare(position, cellOpen.size(), cellOpen) != 0) {
+				std::printf("sheet: cell %s%s not found\n", ColumnName(column).c_str(), rowNumber.c_str());
+				return false;
+			}
+			position += cellOpen.size();
+
+			std::string actual;
+			const size_t cellEnd = xml.find("</c>", position);
+			if (StartsWith(xml, position, " t=\"s\"><v>")) {
+				const size_t index = std::strtoul(xml.c_str() + position + std::strlen(" t=\"s\"><v>"), nullptr, 10);
+				if (index >= strings.size()) {
+					std::printf("sheet: shared string %zu out of range\n", index);
+					return false;
+				}
+				actual = strings[index];
+			} else if (StartsWith(xml, position, " t=\"inlineStr\"><is>")) {
+				if (!ReadTextElement(xml, position, cellEnd, actual)) {
+					std::printf("sheet: bad inline string in row %u\n", i + 1);
+					return false;
+				}
+			} else if (StartsWith(xml, position, "><v>")) {
+				actual = xml.substr(position + 4, xml.find("</v>", position) - position - 4);
+			}
+			if (actual != expected) {
+				std::printf("sheet: row %u column %u: \"%s\" vs \"%s\"\n", i + 1, column + 1, actual.c_str(), expected.c_str());
+				return false;
+			}
+			position = cellEnd + 4;
+		}
+		if (position != rowEnd) {
+			std::printf("sheet: extra cells in row %u\n", i + 1);
+			return false;
+		}
+		position = rowEnd + 6;
+	}
+	if (xml.find("<row", position) != std::string::npos) {
+		std::printf("sheet: more rows than written\n");
+		return false;
+	}
+	return true;
+}
+
+static const Part* FindPart (const std::vector<Part>& parts, const char* name)
+{
+	for (const Part& part : parts) {
+		if (part.name == name) {
+			return &part;
+		}
+	}
+	return nullptr;
+}
+
+static bool CheckFile (std::FILE* file, uint32_t rowCount, size_t& rawBytes)
+{
+	std::string data;
+	std::rewind(file);
+	char buffer[65536];
+	size_t read = 0;
+	while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		data.append(buffer, read);
+	}
+
+	std::vector<Part> parts;
+	if (!ReadZip(data, parts)) {
+		return false;
+	}
+	const char* const required[] = { "[Content_Types].xml", "_rels/.rels", "xl/workbook.xml", "xl/_rels/workbook.xml.rels",
+		"xl/styles.xml", "xl/worksheets/sheet1.xml", "xl/sharedStrings.xml" };
+	for (const char* name : required) {
+		if (FindPart(parts, name) == nullptr) {
+			std::printf("zip: part %s is missing\n", name);
+			return false;
+		}
+	}
+	rawBytes = 0;
+	for (const Part& part : parts) {
+		rawBytes += part.content.size();
+	}
+
+	const std::string sheetAttribute = std::string("<sheet name=\"") + EscapedSheetName + "\"";
+	if (FindPart(parts, "xl/workbook.xml")->content.find(sheetAttribute) == std::string::npos) {
+		std::printf("workbook: sheet name is not escaped as an attribute\n");
+		return false;
+	}
+	std::vector<std::string> strings;
+	if (!ReadSharedStrings(FindPart(parts, "xl/sharedStrings.xml")->content, strings)) {
+		std::printf("sharedStrings: cannot parse\n");
+		return false;
+	}
+	return CheckSheet(FindPart(parts, "xl/worksheets/sheet1.xml")->content, strings, rowCount);
+}
+
+int main (int argc, char** argv)
+{
+	const uint32_t rowCount = (argc > 1) ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 200000u;
+	std::printf("rows: %u x %u columns (with header)\n", rowCount, ColumnCount);
+
+	bool ok = true;
+	for (const bool chunked : { false, true }) {
+		std::FILE* file = std::tmpfile();
+		if (file == nullptr) {
+			std::printf("cannot create temporary file\n");
+			return 1;
+		}
+		Clock::time_point started = Clock::now();
+		const bool written = chunked ? WriteChunks(file, rowCount) : WriteCells(file, rowCount);
+		const double writeSeconds = SecondsSince(started);
+		std::fflush(file);
+		const long fileSize = std::ftell(file);
+
+		started = Clock::now();
+		size_t rawBytes = 0;
+		const bool valid = written && CheckFile(file, rowCount, rawBytes);
+		const double checkSeconds = SecondsSince(started);
+		std::fclose(file);
+
+		std::printf("%-7s write %7.3f s, %6.1f MB (%.1f MB unpacked, x%.1f), check %7.3f s — %s\n",
+			chunked ? "chunked" : "cells", writeSeconds, fileSize / 1048576.0, rawBytes / 1048576.0,
+			fileSize > 0 ? rawBytes / static_cast<double>(fileSize) : 0.0, checkSeconds, valid ? "OK" : "FAIL");
+		ok = ok && valid;
+	}
+	std::printf("%s\n", ok ? "OK" : "FAILED");
+	return ok ? 0 : 1;
+}